@@ -0,0 +1,25 @@
+// libFuzzer entry point for the KWP1281 session's receive path: every
+// input is one session against Sim::FuzzKLine (see Sim::runFuzzInput()
+// for the input format). Hangs and broken invariants abort; ASan/UBSan
+// catch out-of-bounds writes. test/test_kwp_fuzz.cpp runs the same
+// harness over seeded mutations with the native tests.
+//
+// Host only, outside PlatformIO; with clang from the repository root
+// (one command):
+//   clang++ -std=gnu++11 -g -O1 -fsanitize=fuzzer,address,undefined
+//     -Inative_arduino -Isrc fuzz/kwp_receive_fuzzer.cpp
+//     src/obd/KWP/*.cpp src/obd/Model/*.cpp src/obd/Sim/*.cpp
+//     -o kwp_receive_fuzzer
+//   mkdir -p corpus && ./kwp_receive_fuzzer -timeout=10 corpus
+// AFL++ works the same way with afl-clang-fast++ and -fsanitize=fuzzer.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "obd/Sim/FuzzKLine.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    obd::Sim::runFuzzInput(data, size);
+    return 0;
+}
@@ -1,25 +1,61 @@
 #pragma once
 
 // Minimal Arduino.h shim for native tests. This is intentionally
-// tiny and only provides what the model code needs. Do NOT use in
-// firmware builds; it's only for [env:native].
+// tiny and only provides what the model and KWP code need. Do NOT use
+// in firmware builds; it's only for [env:native].
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <string>
 
 // Basic Arduino-style types
 using byte = uint8_t;
 using String = std::string;
 
-// millis() / delay() stubs
+// Flash string helpers: on the host PROGMEM data is ordinary memory.
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define PROGMEM
+#define pgm_read_byte(p) (*reinterpret_cast<const uint8_t *>(p))
+#define pgm_read_word(p) (*reinterpret_cast<const uint16_t *>(p))
+#define pgm_read_dword(p) (*reinterpret_cast<const uint32_t *>(p))
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+
+namespace native_arduino {
+
+// Virtual microsecond clock behind millis()/micros()/delay(). It only
+// moves when code sleeps, when a simulated transport advances it, or by
+// PollCostUs per clock read so that busy-wait loops always terminate.
+// Tests that need a known starting point call setClockUs().
+static constexpr uint64_t PollCostUs = 1;
+
+inline uint64_t &clockUs()
+{
+    static uint64_t us = 0;
+    return us;
+}
+
+inline void setClockUs(uint64_t us) { clockUs() = us; }
+inline void advanceClockUs(uint64_t us) { clockUs() += us; }
+
+} // namespace native_arduino
+
+// millis() / micros() / delay() stubs driven by the virtual clock
+inline unsigned long micros()
+{
+    native_arduino::advanceClockUs(native_arduino::PollCostUs);
+    return static_cast<unsigned long>(native_arduino::clockUs());
+}
+
 inline unsigned long millis()
 {
-    // For deterministic unit tests, just return 0 unless overridden
-    return 0;
+    return micros() / 1000UL;
 }
 
-inline void delay(unsigned long) {}
+inline void delay(unsigned long ms) { native_arduino::advanceClockUs(ms * 1000ULL); }
+inline void delayMicroseconds(unsigned int us) { native_arduino::advanceClockUs(us); }
 
 // abs overloads as in Arduino
 using ::abs;
@@ -0,0 +1,53 @@
+#pragma once
+
+// Minimal EEPROM.h shim for native tests: 1 KB of in-memory EEPROM (the
+// Uno's size), erased to 0xFF like a fresh part. Shared by every
+// translation unit; tests that need a known state call eepromErase().
+
+#include "Arduino.h"
+
+namespace native_arduino {
+
+static constexpr uint16_t EepromSize = 1024;
+
+inline uint8_t *eepromBytes()
+{
+    static uint8_t bytes[EepromSize];
+    static bool erased = false;
+    if (!erased) {
+        memset(bytes, 0xFF, sizeof(bytes));
+        erased = true;
+    }
+    return bytes;
+}
+
+// Number of cells actually written (update() skips unchanged ones).
+inline uint32_t &eepromWrites()
+{
+    static uint32_t writes = 0;
+    return writes;
+}
+
+inline void eepromErase()
+{
+    memset(eepromBytes(), 0xFF, EepromSize);
+    eepromWrites() = 0;
+}
+
+} // namespace native_arduino
+
+struct EEPROMClass {
+    uint8_t read(int idx) { return native_arduino::eepromBytes()[idx % native_arduino::EepromSize]; }
+    void write(int idx, uint8_t val)
+    {
+        native_arduino::eepromBytes()[idx % native_arduino::EepromSize] = val;
+        ++native_arduino::eepromWrites();
+    }
+    void update(int idx, uint8_t val)
+    {
+        if (read(idx) != val) write(idx, val);
+    }
+    uint16_t length() { return native_arduino::EepromSize; }
+};
+
+static EEPROMClass EEPROM __attribute__((unused));
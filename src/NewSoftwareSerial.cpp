@@ -373,6 +373,11 @@ void NewSoftwareSerial::setRX(uint8_t rx)
   _receivePortRegister = portInputRegister(port);
 }
 
+uint16_t NewSoftwareSerial::interpolate(uint16_t fast, uint16_t slow, unsigned long f256)
+{
+  return (uint16_t)(fast + (((unsigned long)(slow - fast) * f256 + 128) >> 8));
+}
+
 //
 // Public methods
 //
@@ -392,6 +397,24 @@ void NewSoftwareSerial::begin(long speed)
       _tx_delay = pgm_read_word(&table[i].tx_delay);
       break;
     }
+    // Rates between two table rows (e.g. one measured off an ECU's sync
+    // byte): the delays are near linear in the bit time, so interpolate
+    // in 1/baud between the faster row (i-1) and this slower one.
+    if (i > 0 && baud < speed)
+    {
+      long fast = pgm_read_dword(&table[i-1].baud);
+      if (speed < fast)
+      {
+        // Share of the way from the fast row to this one, in 1/256
+        unsigned long f = (unsigned long)(fast - speed) * 256UL / (unsigned long)(fast - baud);
+        f = f * (unsigned long)baud / (unsigned long)speed;
+        _rx_delay_centering = interpolate(pgm_read_word(&table[i-1].rx_delay_centering), pgm_read_word(&table[i].rx_delay_centering), f);
+        _rx_delay_intrabit = interpolate(pgm_read_word(&table[i-1].rx_delay_intrabit), pgm_read_word(&table[i].rx_delay_intrabit), f);
+        _rx_delay_stopbit = interpolate(pgm_read_word(&table[i-1].rx_delay_stopbit), pgm_read_word(&table[i].rx_delay_stopbit), f);
+        _tx_delay = interpolate(pgm_read_word(&table[i-1].tx_delay), pgm_read_word(&table[i].tx_delay), f);
+      }
+      break;
+    }
   }
   //Serial.println(_rx_delay_stopbit);
 
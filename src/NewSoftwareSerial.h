@@ -77,6 +77,7 @@ private:
 
   // private static method for timing
   static inline void tunedDelay(uint16_t delay);
+  static uint16_t interpolate(uint16_t fast, uint16_t slow, unsigned long f256);
 
 public:
   // public methods
@@ -93,6 +94,12 @@ public:
   virtual int read();
   virtual int available();
   virtual void flush();
+  // Drives the TX pin directly (idle = high), e.g. for the slow 5-baud
+  // address init of a K-line ECU.
+  void setTxLevel(bool high) { tx_pin_write((high != (bool)_inverse_logic) ? HIGH : LOW); }
+  // Reads the RX pin directly (idle = high). Call end() first: the
+  // receive interrupt would otherwise swallow the edges being timed.
+  bool rxHigh() { return (rx_pin_read() != 0) != (bool)_inverse_logic; }
   
   using Print::write;
 
@@ -1,4 +1,7 @@
 #include "DisplayManager.h"
+#include "../Model/DtcText.h"
+#include "../Model/FixedPoint.h"
+#include "../StackMonitor.h"
 
 namespace obd {
 namespace Display {
@@ -110,6 +113,25 @@ static void printCockpitFloat(DisplayManager &dm,
     updated = false;
 }
 
+static void printCockpitFixed(DisplayManager &dm,
+                              uint8_t x,
+                              uint8_t y,
+                              int32_t scaled,
+                              uint8_t decimals,
+                              uint8_t width,
+                              bool &updated,
+                              bool forceUpdate)
+{
+    if (!(updated || forceUpdate)) return;
+    dm.clearRegion(x, y, width);
+    char buf[14];
+    uint8_t len = Model::formatFixed(scaled, decimals, buf, sizeof(buf));
+    if (len > 0 && len <= width) {
+        dm.print(x, y, buf, 0);
+    }
+    updated = false;
+}
+
 static void printCockpitString(DisplayManager &dm,
                                uint8_t x,
                                uint8_t y,
@@ -124,6 +146,21 @@ static void printCockpitString(DisplayManager &dm,
     updated = false;
 }
 
+// Where the 16-character window on a DTC description of length chars
+// starts at nowMs: at the front for a moment, then one character a step
+// to the end, held there, and around again.
+static uint8_t dtcTextScroll(uint8_t length, uint32_t nowMs)
+{
+    const uint8_t Cols = 16;
+    const uint8_t HoldSteps = 4;
+    const uint16_t StepMs = 350;
+    if (length <= Cols) return 0;
+    const uint8_t travel = length - Cols;
+    const uint16_t step = (uint16_t)((nowMs / StepMs) % (travel + 2 * HoldSteps));
+    if (step < HoldSteps) return 0;
+    return step - HoldSteps < travel ? (uint8_t)(step - HoldSteps) : travel;
+}
+
 void DisplayManager::initMenu(const Input::MenuState &menuState,
                               uint8_t addrSelected,
                               int kwpModeInt)
@@ -131,13 +168,14 @@ void DisplayManager::initMenu(const Input::MenuState &menuState,
     (void)kwpModeInt;
     switch (menuState.currentMenu()) {
     case MenuId::Cockpit:
-        initMenuCockpit(menuState.cockpitScreen(), addrSelected);
+        initMenuCockpit(menuState.cockpitScreen() % Input::MenuState::CockpitScreensPerEcu,
+                        addrSelected);
         break;
     case MenuId::Experimental:
         initMenuExperimental();
         break;
     case MenuId::Debug:
-        initMenuDebug();
+        initMenuDebug(menuState.debugScreen());
         break;
     case MenuId::Dtc:
         initMenuDtc(menuState.dtcScreen());
@@ -153,12 +191,13 @@ void DisplayManager::render(const Input::MenuState &menuState,
                             const Model::DTCStore &dtcStore,
                             uint8_t addrSelected,
                             int kwpModeInt,
+                            const DebugStatus &debug,
                             bool forceUpdate)
 {
     switch (menuState.currentMenu()) {
     case MenuId::Cockpit:
-        displayMenuCockpit(menuState.cockpitScreen(), addrSelected,
-                           signals, forceUpdate);
+        displayMenuCockpit(menuState.cockpitScreen() % Input::MenuState::CockpitScreensPerEcu,
+                           addrSelected, signals, forceUpdate);
         break;
     case MenuId::Experimental:
         displayMenuExperimental(menuState.experimentalScreen(),
@@ -166,7 +205,7 @@ void DisplayManager::render(const Input::MenuState &menuState,
         break;
     case MenuId::Debug:
         displayMenuDebug(menuState.debugScreen(),
-                         signals, kwpModeInt, forceUpdate);
+                         kwpModeInt, debug, forceUpdate);
         break;
     case MenuId::Dtc:
         displayMenuDtc(menuState.dtcScreen(), dtcStore, forceUpdate);
@@ -285,8 +324,37 @@ void DisplayManager::initMenuExperimental()
     print(0, 1, F("S:"));
 }
 
-void DisplayManager::initMenuDebug()
+void DisplayManager::initMenuDebug(uint8_t screen)
 {
+    switch (screen) {
+    case 1:
+        // Stack headroom, see StackMonitor
+        print(0, 0, F("Stack now:"));
+        print(0, 1, F("Stack min:"));
+        return;
+    case 2:
+        // Measured over the last second, see KWP::BusStats
+        print(0, 0, F("Blocks/s:"));
+        print(0, 1, F("Groups/s:"));
+        return;
+    case 3:
+        // Timeouts, complement errors, counter errors, retries
+        print(0, 0, F("TO:"));
+        print(8, 0, F("CE:"));
+        print(0, 1, F("CN:"));
+        print(8, 1, F("RT:"));
+        return;
+    case 4:
+        // Round trip mean and max in ms: keep-alive, group read
+        print(0, 0, F("ACK"));
+        print(9, 0, F("mx"));
+        print(0, 1, F("GRP"));
+        print(9, 1, F("mx"));
+        return;
+    default:
+        break;
+    }
+
     // Status bar
     print(0, 0, F("C:"));
     print(4, 0, F("A:"));
@@ -311,11 +379,10 @@ void DisplayManager::initMenuDtc(uint8_t screen)
         print(15, 1, F(">"));
         break;
     default:
-        // 2-9 share the same static labels
-        print(1, 0, F("/"));
-        print(10, 0, F("St:"));
-        print(0, 1, F("/8"));
-        print(10, 1, F("St:"));
+        // One code a page, "nn/mm 00532 S035", over its description;
+        // displayMenuDtc() fills in the numbers and the text.
+        print(2, 0, F("/"));
+        print(12, 0, F("S"));
         break;
     }
 }
@@ -333,6 +400,10 @@ void DisplayManager::initMenuSettings(uint8_t screen)
         print(0, 1, F("<"));
         print(15, 1, F(">"));
         break;
+    case 2:
+        print(0, 0, F("Scan groups:"));
+        print(0, 1, F("< Press select >"));
+        break;
     default:
         print(0, 0, F("Screen"));
         print(7, 0, String(screen));
@@ -478,12 +549,22 @@ void DisplayManager::displayMenuExperimental(uint8_t /*screen*/,
                         sideUpdated, true);
     eg.groupSideUpdated = false;
 
+    if (eg.unsupported) {
+        if (eg.vUpdated || eg.unitUpdated || forceUpdate) {
+            clearRegion(4, 0, 12);
+            clearRegion(4, 1, 12);
+            print(4, 0, F("n/a"));
+        }
+        eg.vUpdated = eg.unitUpdated = false;
+        return;
+    }
+
     uint8_t first = eg.groupSide ? 2 : 0;
     uint8_t second = eg.groupSide ? 3 : 1;
 
-    printCockpitFloat(*this, 4, 0, eg.v[first], 7,
+    printCockpitFixed(*this, 4, 0, eg.v[first], eg.decimals[first], 7,
                       eg.vUpdated, true);
-    printCockpitFloat(*this, 4, 1, eg.v[second], 7,
+    printCockpitFixed(*this, 4, 1, eg.v[second], eg.decimals[second], 7,
                       eg.vUpdated, true);
     eg.vUpdated = false;
 
@@ -494,78 +575,130 @@ void DisplayManager::displayMenuExperimental(uint8_t /*screen*/,
     eg.unitUpdated = false;
 }
 
-void DisplayManager::displayMenuDebug(uint8_t /*screen*/,
-                                      const Model::OBDSignals &signals,
+void DisplayManager::displayMenuDebug(uint8_t screen,
                                       int kwpModeInt,
+                                      const DebugStatus &debug,
                                       bool forceUpdate)
 {
     (void)forceUpdate;
+    const KWP::BusStats &bus = *debug.bus;
+    bool updated = true;
 
-    // Match old display_menu_debug as closely as possible using
-    // available model data.
+    switch (screen) {
+    case 1:
+        printCockpitNumeric(*this, 11, 0, stackFreeNow(), 5, updated, true);
+        updated = true;
+        printCockpitNumeric(*this, 11, 1, stackFreeMin(), 5, updated, true);
+        return;
+    case 2:
+        printCockpitFixed(*this, 10, 0, bus.blocksPerSecondX10(), 1, 6, updated, true);
+        updated = true;
+        printCockpitFixed(*this, 10, 1, bus.groupsPerSecondX10(), 1, 6, updated, true);
+        return;
+    case 3:
+        printCockpitNumeric(*this, 3, 0, bus.timeouts(), 5, updated, true);
+        updated = true;
+        printCockpitNumeric(*this, 11, 0, bus.complementErrors(), 5, updated, true);
+        updated = true;
+        printCockpitNumeric(*this, 3, 1, bus.counterErrors(), 5, updated, true);
+        updated = true;
+        printCockpitNumeric(*this, 11, 1, bus.retries(), 5, updated, true);
+        return;
+    case 4: {
+        const KWP::BusStats::Latency &ack = bus.latency(KWP::BusStats::Kind::Ack);
+        const KWP::BusStats::Latency &grp = bus.latency(KWP::BusStats::Kind::GroupRead);
+        printCockpitNumeric(*this, 4, 0, ack.meanMs(), 5, updated, true);
+        updated = true;
+        printCockpitNumeric(*this, 11, 0, ack.maxMs, 5, updated, true);
+        updated = true;
+        printCockpitNumeric(*this, 4, 1, grp.meanMs(), 5, updated, true);
+        updated = true;
+        printCockpitNumeric(*this, 11, 1, grp.maxMs, 5, updated, true);
+        return;
+    }
+    default:
+        break;
+    }
 
-    bool updatedDummy = true;
+    // Status bar, laid out like the old display_menu_debug.
 
-    // C: connection flag at column 2. We don't have a model flag here,
-    // but we at least ensure the region is cleared and stable.
-    printCockpitNumeric(*this, 2, 0, 0, 1, updatedDummy, true);
+    // C: connection flag at column 2.
+    printCockpitNumeric(*this, 2, 0, debug.connected ? 1 : 0, 1, updated, true);
 
     // A: available bytes at column 6 (no real available() in model).
     // Keep width small enough that it does not overwrite the 'B' of
     // the "BC:" label at column 9.
-    updatedDummy = true;
-    printCockpitNumeric(*this, 6, 0, 0, 3, updatedDummy, true);
+    updated = true;
+    printCockpitNumeric(*this, 6, 0, 0, 3, updated, true);
 
-    // BC: block counter at 13,0. For now we just show a stable
-    // placeholder (0) so the "BC:" label has a clean numeric
-    // field next to it.
-    uint8_t bcValue = 0;
-    (void)signals; // avoid unused warning if we later feed a real counter
-    updatedDummy = true;
-    printCockpitNumeric(*this, 13, 0, bcValue, 3, updatedDummy, true);
+    // BC: block counter at 13,0
+    updated = true;
+    printCockpitNumeric(*this, 13, 0, debug.blockCounter, 3, updated, true);
 
     // KWP mode numeric at 5,1
-    updatedDummy = true;
-    printCockpitNumeric(*this, 5, 1, kwpModeInt, 1, updatedDummy, true);
+    updated = true;
+    printCockpitNumeric(*this, 5, 1, kwpModeInt, 1, updated, true);
 
-    // FPS value at 12,1: theoretical frame rate 1000 / DISPLAY_FRAME_LENGTH.
-    updatedDummy = true;
-    printCockpitNumeric(*this, 12, 1, static_cast<int>(1000 / 177), 3,
-                        updatedDummy, true);
+    // FPS at 11,1: frames actually drawn over the last second
+    updated = true;
+    printCockpitFixed(*this, 11, 1, debug.framesPerSecondX10, 1, 5, updated, true);
 }
 
 void DisplayManager::displayMenuDtc(uint8_t screen,
                                     const Model::DTCStore &dtcStore,
                                     bool forceUpdate)
 {
-    if (screen == 0 || screen == 1) {
+    bool updatedDummy = true; // DTCStore does not track updated flags; always force
+    if (screen == 0) {
+        // Codes held so far (a read fills the store block by block), and
+        // "+n" for any that did not fit.
+        String held(dtcStore.count());
+        if (dtcStore.overflow() > 0) {
+            held += '+';
+            held += dtcStore.overflow();
+        }
+        printCockpitString(*this, 10, 1, held, 5, updatedDummy, forceUpdate);
+        return;
+    }
+    if (screen == 1) {
         return;
     }
 
-    uint8_t dtcPointer = screen - 2;
-    if (dtcPointer > 7) return;
-
-    bool updatedDummy = true; // DTCStore does not track updated flags; always force
-    uint16_t e0 = dtcStore.errorAt(dtcPointer * 2);
-    uint8_t s0 = dtcStore.statusAt(dtcPointer * 2);
-    uint16_t e1 = dtcStore.errorAt(dtcPointer * 2 + 1);
-    uint8_t s1 = dtcStore.statusAt(dtcPointer * 2 + 1);
+    const uint8_t idx = screen - 2;
+    if (idx >= dtcStore.capacity()) return;
+    const uint8_t pages = dtcStore.count() > 1 ? dtcStore.count() : 1;
+    const uint16_t code = dtcStore.errorAt(idx);
 
-    printCockpitNumeric(*this, 0, 0, (uint8_t)(dtcPointer + 1), 1,
+    printCockpitNumeric(*this, 0, 0, (uint8_t)(idx + 1), 2,
                         updatedDummy, forceUpdate);
     updatedDummy = true;
-    printCockpitString(*this, 3, 0, String(e0), 6,
-                       updatedDummy, forceUpdate);
-    updatedDummy = true;
-    printCockpitNumeric(*this, 13, 0, s0, 3,
+    printCockpitNumeric(*this, 3, 0, pages, 2,
                         updatedDummy, forceUpdate);
-
     updatedDummy = true;
-    printCockpitString(*this, 3, 1, String(e1), 6,
-                       updatedDummy, forceUpdate);
-    updatedDummy = true;
-    printCockpitNumeric(*this, 13, 1, s1, 3,
+    printCockpitNumeric(*this, 13, 0, dtcStore.statusAt(idx), 3,
                         updatedDummy, forceUpdate);
+
+    // VAG codes are always written with five digits ("00532")
+    char digits[6] = "-----";
+    if (code != Model::DTCStore::NoCode) {
+        uint16_t rest = code;
+        for (int8_t k = 4; k >= 0; --k) {
+            digits[k] = (char)('0' + rest % 10);
+            rest /= 10;
+        }
+    }
+    print(6, 0, digits, 5);
+
+    char text[Model::DtcTextMaxLength + 1];
+    const uint8_t length = Model::describeDtc(code, text, sizeof(text));
+    if (code != Model::DTCStore::NoCode && length == 0) {
+        clearRegion(0, 1, 16);
+        print(0, 1, F("no description"));
+        return;
+    }
+    const uint8_t from = dtcTextScroll(length, millis());
+    if (length > from + 16) text[from + 16] = '\0';
+    print(0, 1, text + from, 16);
 }
 
 void DisplayManager::displayMenuSettings(uint8_t screen,
@@ -17,6 +17,8 @@ public:
     void begin(uint8_t cols, uint8_t rows);
     void clear();
 
+    // addrSelected is the ECU the screen shows: with two ECUs on the
+    // dashboard, the one the current cockpit screen belongs to.
     void initMenu(const Input::MenuState &menuState,
                   uint8_t addrSelected,
                   int kwpModeInt);
@@ -26,6 +28,7 @@ public:
                 const Model::DTCStore &dtcStore,
                 uint8_t addrSelected,
                 int kwpModeInt,
+                const DebugStatus &debug,
                 bool forceUpdate);
 
     void print(uint8_t x, uint8_t y, const __FlashStringHelper *s);
@@ -42,7 +45,7 @@ private:
 
     void initMenuCockpit(uint8_t screen, uint8_t addrSelected);
     void initMenuExperimental();
-    void initMenuDebug();
+    void initMenuDebug(uint8_t screen);
     void initMenuDtc(uint8_t screen);
     void initMenuSettings(uint8_t screen);
 
@@ -53,8 +56,8 @@ private:
                                  const Model::OBDSignals &signals,
                                  bool forceUpdate);
     void displayMenuDebug(uint8_t screen,
-                          const Model::OBDSignals &signals,
                           int kwpModeInt,
+                          const DebugStatus &debug,
                           bool forceUpdate);
     void displayMenuDtc(uint8_t screen,
                         const Model::DTCStore &dtcStore,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include "../KWP/BusStats.h"
 
 namespace obd {
 namespace Display {
@@ -13,5 +14,13 @@ enum class MenuId : uint8_t {
     Settings = 4
 };
 
+// Live numbers for the Debug screens, gathered by OBDDisplay each frame.
+struct DebugStatus {
+    bool connected;
+    uint8_t blockCounter;        // the session's, as in the next block
+    uint16_t framesPerSecondX10; // LCD frames actually drawn
+    const KWP::BusStats *bus;
+};
+
 } // namespace Display
 } // namespace obd
@@ -70,13 +70,16 @@ bool ButtonInput::update(MenuState &menuState, InputActions &actions)
             else if (isDown(v)) { menuState.prevSettingsScreen(); any = true; }
             else if (isSelect(v)) {
                 // Map settings actions to match old behaviour: screen 0 = Exit,
-                // screen 1 = KWP mode cycling.
+                // screen 1 = KWP mode cycling, screen 2 = group scan.
                 if (menuState.settingsScreen() == 0) {
                     actions.requestExit = true;
                     any = true;
                 } else if (menuState.settingsScreen() == 1) {
                     actions.toggleKwpMode = true;
                     any = true;
+                } else if (menuState.settingsScreen() == 2) {
+                    actions.scanGroups = true;
+                    any = true;
                 }
             }
             break;
@@ -19,6 +19,8 @@ struct InputActions {
 
     bool toggleKwpMode = false;
 
+    bool scanGroups = false;
+
     // optional changes for KWP mode/group can be requested via
     // toggleKwpMode and are applied in OBDDisplay.
 };
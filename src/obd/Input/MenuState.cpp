@@ -6,13 +6,13 @@ namespace Input {
 MenuState::MenuState()
     : currentMenu_(Display::MenuId::Cockpit)
     , cockpitScreen_(0)
-    , cockpitScreenMax_(4)
+    , cockpitScreenMax_(CockpitScreensPerEcu - 1)
     , experimentalScreen_(0)
     , experimentalScreenMax_(64)
     , debugScreen_(0)
     , debugScreenMax_(4)
     , dtcScreen_(0)
-    , dtcScreenMax_(9)
+    , dtcScreenMax_(1 + Model::DTCStore::MaxCount) // read, clear, one code a page
     , settingsScreen_(0)
     , settingsScreenMax_(10)
     , menuChanged_(false)
@@ -20,6 +20,46 @@ MenuState::MenuState()
 {
 }
 
+void MenuState::setCockpitEcus(uint8_t count)
+{
+    cockpitScreenMax_ = static_cast<uint8_t>((count > 0 ? count : 1) * CockpitScreensPerEcu - 1);
+    if (cockpitScreen_ > cockpitScreenMax_) cockpitScreen_ = 0;
+}
+
+uint8_t MenuState::currentScreen() const
+{
+    switch (currentMenu_) {
+    case Display::MenuId::Cockpit:
+        return cockpitScreen_;
+    case Display::MenuId::Experimental:
+        return experimentalScreen_;
+    case Display::MenuId::Debug:
+        return debugScreen_;
+    case Display::MenuId::Dtc:
+        return dtcScreen_;
+    case Display::MenuId::Settings:
+    default:
+        return settingsScreen_;
+    }
+}
+
+uint8_t MenuState::currentScreenCount() const
+{
+    switch (currentMenu_) {
+    case Display::MenuId::Cockpit:
+        return cockpitScreenMax_ + 1;
+    case Display::MenuId::Experimental:
+        return experimentalScreenMax_ + 1;
+    case Display::MenuId::Debug:
+        return debugScreenMax_ + 1;
+    case Display::MenuId::Dtc:
+        return dtcScreenMax_ + 1;
+    case Display::MenuId::Settings:
+    default:
+        return settingsScreenMax_ + 1;
+    }
+}
+
 void MenuState::nextMenu()
 {
     uint8_t val = static_cast<uint8_t>(currentMenu_);
@@ -2,16 +2,23 @@
 
 #include <Arduino.h>
 #include "../Display/DisplayTypes.h"
+#include "../Model/DTCStore.h"
 
 namespace obd {
 namespace Input {
 
 class MenuState {
 public:
+    // Cockpit screens of one ECU; with two ECUs on the dashboard the
+    // second one's follow the first one's (see setCockpitEcus()).
+    static constexpr uint8_t CockpitScreensPerEcu = 5;
+
     MenuState();
 
     Display::MenuId currentMenu() const { return currentMenu_; }
     uint8_t cockpitScreen() const { return cockpitScreen_; }
+    // Number of ECUs whose cockpit screens are shown, one after another.
+    void setCockpitEcus(uint8_t count);
     uint8_t experimentalScreen() const { return experimentalScreen_; }
     void setExperimentalScreen(uint8_t v) { experimentalScreen_ = v; }
     uint8_t debugScreen() const { return debugScreen_; }
@@ -19,6 +26,10 @@ public:
     uint8_t settingsScreen() const { return settingsScreen_; }
     void setSettingsScreen(uint8_t v) { settingsScreen_ = v; }
 
+    // Screen index and number of screens of the current menu.
+    uint8_t currentScreen() const;
+    uint8_t currentScreenCount() const;
+
     void nextMenu();
     void prevMenu();
 
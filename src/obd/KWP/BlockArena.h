@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace KWP {
+
+// The block buffers of one KWP session.
+//
+// Every exchange (connect, keep-alive, group read, DTC read/delete, exit,
+// resume) works out of these two buffers instead of its own stack arrays,
+// so the session's RAM is one fixed, statically accounted block and the
+// deepest call path no longer carries 64-byte frames. Only one exchange
+// runs at a time; acquire() makes that explicit and fails while another
+// owner still holds the buffers (e.g. a non-blocking group read that has
+// not been completed).
+class BlockArena {
+public:
+    // Largest block the ECUs we talk to send (length byte + 63).
+    static constexpr uint8_t RxSize = 64;
+    // Largest block we send: the group read request (5 bytes).
+    static constexpr uint8_t TxSize = 8;
+
+    enum class Owner : uint8_t {
+        None = 0,
+        Connect,
+        KeepAlive,
+        GroupRead,
+        DtcRead,
+        DtcDelete,
+        Exit,
+        Resume
+    };
+
+    BlockArena() : owner_(Owner::None) {}
+
+    // Takes the buffers for `owner`. Re-acquiring by the current owner is
+    // allowed; any other owner gets false until release().
+    bool acquire(Owner owner)
+    {
+        if (owner_ != Owner::None && owner_ != owner) {
+            return false;
+        }
+        owner_ = owner;
+        return true;
+    }
+
+    void release() { owner_ = Owner::None; }
+
+    Owner owner() const { return owner_; }
+    bool held() const { return owner_ != Owner::None; }
+
+    uint8_t *rx() { return rx_; }
+    const uint8_t *rx() const { return rx_; }
+    uint8_t *tx() { return tx_; }
+
+    // Fills tx with a 4-byte control block (ACK, DTC read, exit, ...).
+    uint8_t *control(uint8_t counter, uint8_t title)
+    {
+        tx_[0] = 0x03;
+        tx_[1] = counter;
+        tx_[2] = title;
+        tx_[3] = 0x03;
+        return tx_;
+    }
+
+private:
+    Owner owner_;
+    uint8_t rx_[RxSize];
+    uint8_t tx_[TxSize];
+};
+
+// Holds the arena for the scope of one blocking exchange.
+class ArenaLease {
+public:
+    ArenaLease(BlockArena &arena, BlockArena::Owner owner)
+        : arena_(arena)
+        , ok_(arena.acquire(owner))
+    {
+    }
+    ~ArenaLease()
+    {
+        if (ok_) arena_.release();
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+    ArenaLease(const ArenaLease &);
+    ArenaLease &operator=(const ArenaLease &);
+
+    BlockArena &arena_;
+    bool ok_;
+};
+
+} // namespace KWP
+} // namespace obd
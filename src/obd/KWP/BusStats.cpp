@@ -0,0 +1,65 @@
+#include "BusStats.h"
+
+namespace obd {
+namespace KWP {
+
+BusStats::BusStats()
+{
+    reset(0);
+}
+
+void BusStats::reset(uint32_t nowMs)
+{
+    blocks_ = Model::RateMeter();
+    groups_ = Model::RateMeter();
+    blocks_.reset(nowMs);
+    groups_.reset(nowMs);
+    timeouts_ = 0;
+    complementErrors_ = 0;
+    counterErrors_ = 0;
+    retries_ = 0;
+    memset(latency_, 0, sizeof(latency_));
+}
+
+BusStats::Kind BusStats::kindOf(uint8_t title)
+{
+    switch (title) {
+    case 0x09: return Kind::Ack;
+    case 0x29: return Kind::GroupRead;
+    case 0x05:
+    case 0x07: return Kind::Dtc;
+    default: return Kind::Other;
+    }
+}
+
+uint8_t BusStats::binOf(uint32_t ms)
+{
+    uint8_t bin = 0;
+    for (uint32_t limit = FirstBinMs; ms >= limit && bin < Bins - 1; limit <<= 1) {
+        ++bin;
+    }
+    return bin;
+}
+
+void BusStats::onRoundTrip(Kind kind, uint32_t us)
+{
+    Latency &l = latency_[static_cast<uint8_t>(kind)];
+    const uint32_t ms = us / 1000;
+    bump_(l.bins[binOf(ms)]);
+    if (l.count != 0xFFFF) {
+        ++l.count;
+        l.sumMs += ms;
+    }
+    if (ms > l.maxMs) {
+        l.maxMs = ms > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(ms);
+    }
+}
+
+void BusStats::update(uint32_t nowMs)
+{
+    blocks_.update(nowMs);
+    groups_.update(nowMs);
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../Model/RateMeter.h"
+
+namespace obd {
+namespace KWP {
+
+// Live statistics of one KWP session, in fixed-size counters for the
+// Debug screens: block and group rates, line errors, and per request
+// type a histogram of the round trip from the first byte of our block
+// to the last byte of the ECU's answer.
+class BusStats {
+public:
+    enum class Kind : uint8_t {
+        Ack = 0,     // keep-alive and the connect's identification blocks
+        GroupRead,
+        Dtc,         // read and delete
+        Other,       // exit, error recovery
+        Count
+    };
+    static constexpr uint8_t KindCount = static_cast<uint8_t>(Kind::Count);
+
+    // Bin 0 is under 16 ms, every further bin doubles the limit, and the
+    // last one takes everything from 1024 ms up.
+    static constexpr uint8_t Bins = 8;
+    static constexpr uint8_t FirstBinMs = 16;
+
+    struct Latency {
+        uint16_t bins[Bins];   // saturate at 0xFFFF
+        uint16_t count;        // saturates too; see sumMs
+        uint16_t maxMs;
+        uint32_t sumMs;        // over the first 0xFFFF samples
+
+        uint16_t meanMs() const { return count ? static_cast<uint16_t>(sumMs / count) : 0; }
+    };
+
+    BusStats();
+    void reset(uint32_t nowMs);
+
+    static Kind kindOf(uint8_t title);
+    static uint8_t binOf(uint32_t ms);
+
+    void onBlockSent() { blocks_.add(); }
+    void onBlockReceived() { blocks_.add(); }
+    void onGroupRead() { groups_.add(); }
+    void onRoundTrip(Kind kind, uint32_t us);
+    void onTimeout() { bump_(timeouts_); }
+    void onComplementError() { bump_(complementErrors_); }
+    void onCounterError() { bump_(counterErrors_); }
+    // Error block recovery or resume() attempt
+    void onRetry() { bump_(retries_); }
+
+    // Rolls the blocks/s and groups/s windows; call from the loop.
+    void update(uint32_t nowMs);
+
+    uint32_t blocks() const { return blocks_.count(); }
+    uint16_t blocksPerSecondX10() const { return blocks_.perSecondX10(); }
+    uint16_t groupsPerSecondX10() const { return groups_.perSecondX10(); }
+    uint16_t timeouts() const { return timeouts_; }
+    uint16_t complementErrors() const { return complementErrors_; }
+    uint16_t counterErrors() const { return counterErrors_; }
+    uint16_t retries() const { return retries_; }
+    const Latency &latency(Kind kind) const { return latency_[static_cast<uint8_t>(kind)]; }
+
+private:
+    Model::RateMeter blocks_;
+    Model::RateMeter groups_;
+    uint16_t timeouts_;
+    uint16_t complementErrors_;
+    uint16_t counterErrors_;
+    uint16_t retries_;
+    Latency latency_[KindCount];
+
+    static void bump_(uint16_t &counter)
+    {
+        if (counter != 0xFFFF) ++counter;
+    }
+};
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace KWP {
+
+// Where the session keeps what it learned about ECUs across power cycles.
+// Each region starts with a version byte; a region whose byte does not
+// match is treated as blank and reformatted, so changing a region's
+// format only means bumping its version.
+namespace EepromLayout {
+
+static constexpr uint16_t RejectedGroupsBase = 0x000;
+static constexpr uint8_t RejectedGroupsVersion = 0x01;
+
+static constexpr uint16_t GroupCapabilitiesBase = 0x100;
+static constexpr uint8_t GroupCapabilitiesVersion = 0x01;
+
+static constexpr uint16_t IdentityCacheBase = 0x390;
+static constexpr uint8_t IdentityCacheVersion = 0x01;
+
+} // namespace EepromLayout
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,52 @@
+#include "FiveBaudInit.h"
+
+namespace obd {
+namespace KWP {
+
+FiveBaudInit::FiveBaudInit()
+    : address_(0)
+    , next_(Bits)
+    , startUs_(0)
+{
+}
+
+void FiveBaudInit::begin(uint8_t address, uint32_t nowUs)
+{
+    address_ = address;
+    next_ = 0;
+    startUs_ = nowUs;
+}
+
+bool FiveBaudInit::step(uint32_t nowUs, bool &high)
+{
+    // Unsigned subtraction keeps this right across micros() wrap.
+    if (next_ >= Bits || static_cast<int32_t>(nowUs - nextEdgeUs()) < 0) {
+        return false;
+    }
+    high = bitLevel(address_, next_);
+    ++next_;
+    return true;
+}
+
+bool FiveBaudInit::done(uint32_t nowUs) const
+{
+    return next_ >= Bits && static_cast<int32_t>(nowUs - nextEdgeUs()) >= 0;
+}
+
+bool FiveBaudInit::bitLevel(uint8_t address, uint8_t i)
+{
+    if (i == 0) return false;      // start bit
+    if (i == Bits - 1) return true; // stop bit
+    if (i == Bits - 2) {
+        // Odd parity over the 7 data bits
+        bool odd = true;
+        for (uint8_t b = 0; b < 7; ++b) {
+            odd ^= ((address >> b) & 1) != 0;
+        }
+        return odd;
+    }
+    return ((address >> (i - 1)) & 1) != 0;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace KWP {
+
+// Bit clock of the 5-baud address init: the ECU address sent as 7O1
+// (start bit, 7 data bits LSB first, odd parity, stop bit) at 5 bit/s,
+// 2 s in all.
+//
+// Every bit edge is scheduled against the start of the init rather than
+// the previous edge, so a late poll shifts one edge but never the ones
+// after it. step() is meant to be called from a loop that does other
+// work in between; it never waits.
+class FiveBaudInit {
+public:
+    static constexpr uint32_t BitUs = 200000;
+    static constexpr uint8_t Bits = 10;
+
+    FiveBaudInit();
+
+    void begin(uint8_t address, uint32_t nowUs);
+
+    // If the next bit is due at nowUs, sets `high` to the level to put
+    // on the line and returns true.
+    bool step(uint32_t nowUs, bool &high);
+    // True once the stop bit has been on the line for a full bit time.
+    bool done(uint32_t nowUs) const;
+
+    uint8_t bitsSent() const { return next_; }
+    // When the next edge (or the end of the stop bit) is due.
+    uint32_t nextEdgeUs() const { return startUs_ + next_ * BitUs; }
+
+    // Level of bit i (0 = start bit) of the 7O1 frame for address.
+    static bool bitLevel(uint8_t address, uint8_t i);
+
+private:
+    uint8_t address_;
+    uint8_t next_;      // bits already put on the line
+    uint32_t startUs_;
+};
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,152 @@
+#include "GroupCapabilities.h"
+#include "EepromLayout.h"
+#include <EEPROM.h>
+
+namespace obd {
+namespace KWP {
+
+GroupCapabilities::GroupCapabilities(uint16_t eepromBase)
+    : base_(eepromBase)
+    , slot_(NoSlot)
+    , count_(0)
+    , covered_(0)
+    , recording_(false)
+    , full_(false)
+{
+}
+
+uint16_t GroupCapabilities::slotAddr_(uint8_t slot) const
+{
+    return static_cast<uint16_t>(base_ + 2 + slot * SlotBytes);
+}
+
+uint32_t GroupCapabilities::readIdentity_(uint8_t slot) const
+{
+    uint16_t addr = slotAddr_(slot);
+    uint32_t identity = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        identity |= static_cast<uint32_t>(EEPROM.read(addr + i)) << (8 * i);
+    }
+    return identity;
+}
+
+void GroupCapabilities::prepare_()
+{
+    if (EEPROM.read(base_) == EepromLayout::GroupCapabilitiesVersion) {
+        return;
+    }
+    for (uint8_t i = 0; i < MaxSlots; ++i) {
+        EEPROM.update(slotAddr_(i) + 4, Invalid);
+    }
+    EEPROM.update(base_ + 1, 0);
+    EEPROM.update(base_, EepromLayout::GroupCapabilitiesVersion);
+}
+
+bool GroupCapabilities::select(uint32_t identity)
+{
+    prepare_();
+    slot_ = NoSlot;
+    recording_ = false;
+    for (uint8_t i = 0; i < MaxSlots; ++i) {
+        uint16_t addr = slotAddr_(i);
+        uint8_t count = EEPROM.read(addr + 4);
+        if (count != Invalid && count <= MaxEntries && readIdentity_(i) == identity) {
+            slot_ = i;
+            count_ = count;
+            covered_ = EEPROM.read(addr + 5);
+            break;
+        }
+    }
+    return known();
+}
+
+int16_t GroupCapabilities::find_(uint8_t group) const
+{
+    // Entries are sorted, so stop at the first larger group.
+    uint16_t addr = slotAddr_(slot_) + HeaderBytes;
+    for (uint8_t i = 0; i < count_; ++i, addr += EntryBytes) {
+        uint8_t g = EEPROM.read(addr);
+        if (g == group) return static_cast<int16_t>(addr);
+        if (g > group) break;
+    }
+    return -1;
+}
+
+bool GroupCapabilities::absent(uint8_t group) const
+{
+    if (!known() || group > covered_) return false;
+    return find_(group) < 0;
+}
+
+bool GroupCapabilities::formulas(uint8_t group, uint8_t out[Formulas]) const
+{
+    if (!known()) return false;
+    int16_t addr = find_(group);
+    if (addr < 0) return false;
+    for (uint8_t i = 0; i < Formulas; ++i) {
+        out[i] = EEPROM.read(addr + 1 + i);
+    }
+    return true;
+}
+
+void GroupCapabilities::beginRecord(uint32_t identity)
+{
+    prepare_();
+
+    uint8_t slot = NoSlot;
+    for (uint8_t i = 0; i < MaxSlots && slot == NoSlot; ++i) {
+        if (readIdentity_(i) == identity) slot = i;
+    }
+    for (uint8_t i = 0; i < MaxSlots && slot == NoSlot; ++i) {
+        if (EEPROM.read(slotAddr_(i) + 4) == Invalid) slot = i;
+    }
+    if (slot == NoSlot) {
+        slot = static_cast<uint8_t>(EEPROM.read(base_ + 1) % MaxSlots);
+        EEPROM.update(base_ + 1, static_cast<uint8_t>((slot + 1) % MaxSlots));
+    }
+
+    // Invalidate first, then claim.
+    uint16_t addr = slotAddr_(slot);
+    EEPROM.update(addr + 4, Invalid);
+    for (uint8_t i = 0; i < 4; ++i) {
+        EEPROM.update(addr + i, static_cast<uint8_t>(identity >> (8 * i)));
+    }
+
+    slot_ = slot;
+    count_ = 0;
+    covered_ = 0;
+    recording_ = true;
+    full_ = false;
+}
+
+void GroupCapabilities::record(uint8_t group, bool responds, const uint8_t formulas[Formulas])
+{
+    if (!recording_ || full_) return;
+    if (responds) {
+        if (count_ >= MaxEntries) {
+            // Groups from here on are not covered by the map.
+            full_ = true;
+            return;
+        }
+        uint16_t addr = slotAddr_(slot_) + HeaderBytes + count_ * EntryBytes;
+        EEPROM.update(addr, group);
+        for (uint8_t i = 0; i < Formulas; ++i) {
+            EEPROM.update(addr + 1 + i, formulas[i]);
+        }
+        ++count_;
+    }
+    covered_ = group;
+}
+
+void GroupCapabilities::endRecord()
+{
+    if (!recording_) return;
+    uint16_t addr = slotAddr_(slot_);
+    EEPROM.update(addr + 5, covered_);
+    // The entry count goes last; it is what makes the map valid.
+    EEPROM.update(addr + 4, count_);
+    recording_ = false;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace KWP {
+
+// Result of a full group scan, stored in EEPROM per ECU identity.
+//
+// A scan walks groups 0-255 once and records which of them answer with
+// measurement data, together with the four formula bytes of each, so a
+// later session with the same ECU knows its layout right after connect:
+// groups outside the map are skipped without a bus round-trip and the
+// experimental view can label a group's values before they arrive.
+//
+// Only responding groups are stored (5 bytes each), in ascending order.
+// If a scan finds more than MaxEntries of them, the map covers groups up
+// to the last one that fit and everything above stays "unknown".
+class GroupCapabilities {
+public:
+    static constexpr uint8_t Formulas = 4;
+    static constexpr uint8_t MaxSlots = 2;
+    static constexpr uint16_t SlotBytes = 320;
+    // identity (4), entry count, last covered group
+    static constexpr uint8_t HeaderBytes = 6;
+    static constexpr uint8_t EntryBytes = 1 + Formulas;
+    static constexpr uint8_t MaxEntries = (SlotBytes - HeaderBytes) / EntryBytes;
+    // version byte, next slot to reuse, slots
+    static constexpr uint16_t RegionBytes = 2 + MaxSlots * SlotBytes;
+
+    explicit GroupCapabilities(uint16_t eepromBase);
+
+    // Looks up the map of an ECU identity. Returns known().
+    bool select(uint32_t identity);
+    bool known() const { return slot_ != NoSlot && !recording_; }
+
+    // True if the map says the group does not answer. False for groups
+    // the map does not cover, and whenever nothing is known().
+    bool absent(uint8_t group) const;
+    // Formula bytes of a responding group (0 where it has fewer triplets).
+    bool formulas(uint8_t group, uint8_t out[Formulas]) const;
+    uint8_t count() const { return known() ? count_ : 0; }
+
+    // Recording a scan: beginRecord(), then record() for every group in
+    // ascending order, then endRecord(). The old map of that identity is
+    // invalid from beginRecord() on, so an interrupted scan leaves no
+    // half-written map behind.
+    void beginRecord(uint32_t identity);
+    void record(uint8_t group, bool responds, const uint8_t formulas[Formulas]);
+    void endRecord();
+
+private:
+    static constexpr uint8_t NoSlot = 0xFF;
+    static constexpr uint8_t Invalid = 0xFF; // entry count of an unused slot
+
+    uint16_t base_;
+    uint8_t slot_;
+    uint8_t count_;
+    uint8_t covered_;   // last group the map speaks for
+    bool recording_;
+    bool full_;
+
+    uint16_t slotAddr_(uint8_t slot) const;
+    uint32_t readIdentity_(uint8_t slot) const;
+    int16_t find_(uint8_t group) const;
+    void prepare_();
+};
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,76 @@
+#include "GroupPayloadCache.h"
+
+namespace obd {
+namespace KWP {
+
+static_assert(GroupPayloadCache::MaxTriplets <= 8, "update() answers in one byte");
+
+GroupPayloadCache::GroupPayloadCache()
+{
+    clear();
+}
+
+void GroupPayloadCache::clear()
+{
+    for (uint8_t i = 0; i < Slots; ++i) {
+        slots_[i].count = 0;
+    }
+    tick_ = 0;
+    shownCount_ = 0;
+}
+
+uint8_t GroupPayloadCache::update(uint8_t group, const uint8_t *triplets, uint8_t count)
+{
+    if (count > MaxTriplets) count = MaxTriplets;
+    ++tick_;
+
+    // The group's slot, or else a free one, or else the oldest
+    Slot *slot = nullptr;
+    Slot *spare = &slots_[0];
+    for (uint8_t i = 0; i < Slots; ++i) {
+        Slot &s = slots_[i];
+        if (s.count > 0 && s.group == group) {
+            slot = &s;
+            break;
+        }
+        if (spare->count > 0
+            && (s.count == 0 || (uint16_t)(tick_ - s.stamp) > (uint16_t)(tick_ - spare->stamp))) {
+            spare = &s;
+        }
+    }
+
+    uint8_t changed = AllChanged;
+    if (slot != nullptr && slot->count == count) {
+        changed = 0;
+        for (uint8_t i = 0; i < count; ++i) {
+            const uint8_t *held = &slot->bytes[i * 3];
+            const uint8_t *now = &triplets[i * 3];
+            if (held[0] != now[0] || held[1] != now[1] || held[2] != now[2]) {
+                changed |= (uint8_t)(1 << i);
+            }
+        }
+    }
+    if (slot == nullptr) slot = spare;
+    slot->group = group;
+    slot->count = count;
+    slot->stamp = tick_;
+    memcpy(slot->bytes, triplets, count * 3);
+    return changed;
+}
+
+void GroupPayloadCache::forget(uint8_t group)
+{
+    for (uint8_t i = 0; i < Slots; ++i) {
+        if (slots_[i].group == group) slots_[i].count = 0;
+    }
+    if (shown_ == group) shownCount_ = 0;
+}
+
+void GroupPayloadCache::show(uint8_t group, uint8_t count)
+{
+    shown_ = group;
+    shownCount_ = count;
+}
+
+} // namespace KWP
+} // namespace obd
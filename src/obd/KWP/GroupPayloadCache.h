@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../Model/OBDSignals.h"
+
+namespace obd {
+namespace KWP {
+
+// The raw triplets of the last answer to each of a few measurement
+// groups, so a group read decodes only what changed.
+//
+// Most of what a dashboard shows barely moves between reads (temperatures,
+// odometer, fuel level), and the ECU then sends the very same bytes again.
+// update() compares a new answer with the one held and says which triplets
+// differ; only those go through decodeMeasurement() and the signal
+// bindings. The cache also remembers which group the experimental slots
+// of OBDSignals show, so a re-read of that group does not clear and
+// rewrite them (see prepareGroupRead() in TripletDecode.h).
+//
+// Slots are reused least recently updated first; a group that is not
+// held is decoded in full, as before. Bytes only mean something to the
+// session that read them: clear() on every new connect.
+class GroupPayloadCache {
+public:
+    static constexpr uint8_t Slots = 4;
+    static constexpr uint8_t MaxTriplets = Model::ExperimentalGroup::Count;
+    // update()'s answer for a group not held, or sent with another count
+    static constexpr uint8_t AllChanged = (1 << MaxTriplets) - 1;
+
+    GroupPayloadCache();
+
+    void clear();
+
+    // Stores count (at most MaxTriplets) triplets of group and returns a
+    // bit per triplet (bit i for triplet i) whose bytes differ from the
+    // ones held.
+    uint8_t update(uint8_t group, const uint8_t *triplets, uint8_t count);
+    // Drops group, e.g. after an answer that was not decoded into it.
+    void forget(uint8_t group);
+
+    // The experimental slots hold the decode of count triplets of group.
+    void show(uint8_t group, uint8_t count);
+    bool shows(uint8_t group) const { return shownCount_ > 0 && shown_ == group; }
+    uint8_t shownCount() const { return shownCount_; }
+
+private:
+    struct Slot {
+        uint8_t group;
+        uint8_t count;     // 0: free
+        uint16_t stamp;    // tick_ at the last update
+        uint8_t bytes[MaxTriplets * 3];
+    };
+
+    Slot slots_[Slots];
+    uint16_t tick_;
+    uint8_t shown_;
+    uint8_t shownCount_; // 0: the slots show no cached group
+};
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,46 @@
+#include "GroupScan.h"
+
+namespace obd {
+namespace KWP {
+
+GroupScan::GroupScan(KWP1281Session &kwp)
+    : kwp_(kwp)
+    , next_(256)
+    , found_(0)
+    , failed_(false)
+{
+}
+
+void GroupScan::begin()
+{
+    next_ = 0;
+    found_ = 0;
+    failed_ = false;
+    kwp_.clearRejectedGroups();
+    kwp_.capabilities().beginRecord(kwp_.identity());
+}
+
+bool GroupScan::step(Model::OBDSignals &signals)
+{
+    if (done()) return false;
+
+    uint8_t group = static_cast<uint8_t>(next_);
+    bool ok = kwp_.readSensorsGroup(group, signals);
+    if (!ok && !kwp_.groupRejected(group)) {
+        failed_ = true;
+        return false;
+    }
+
+    bool responds = ok && !signals.experimental.unsupported;
+    kwp_.capabilities().record(group, responds, signals.experimental.k);
+    if (responds) ++found_;
+
+    if (++next_ > 255) {
+        kwp_.capabilities().endRecord();
+        return false;
+    }
+    return true;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+#include "KWP1281Session.h"
+
+namespace obd {
+namespace KWP {
+
+// Walks measurement groups 0-255 once and stores which of them answer,
+// with their formula bytes, in the session's GroupCapabilities under the
+// ECU's identity. Each step() is one blocking group read, back to back
+// with no keep-alives in between, so the scan runs as fast as the line
+// does. begin() forgets the ECU's refused groups, so a rescan asks every
+// group again. The caller draws progress between steps.
+class GroupScan {
+public:
+    explicit GroupScan(KWP1281Session &kwp);
+
+    void begin();
+
+    // Reads the next group. Returns false once the scan is over, either
+    // complete or failed() on a line error (the session should then be
+    // dropped; the identity has no map until a scan completes).
+    bool step(Model::OBDSignals &signals);
+
+    uint16_t nextGroup() const { return next_; }
+    uint16_t found() const { return found_; }
+    bool done() const { return next_ > 255 || failed_; }
+    bool failed() const { return failed_; }
+
+private:
+    KWP1281Session &kwp_;
+    uint16_t next_;
+    uint16_t found_;
+    bool failed_;
+};
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,121 @@
+#include "GroupScheduler.h"
+
+namespace obd {
+namespace KWP {
+
+GroupScheduler::GroupScheduler()
+    : count_(0)
+{
+}
+
+void GroupScheduler::clear()
+{
+    count_ = 0;
+}
+
+int8_t GroupScheduler::find_(uint8_t group) const
+{
+    for (uint8_t i = 0; i < count_; ++i) {
+        if (entries_[i].group == group) {
+            return static_cast<int8_t>(i);
+        }
+    }
+    return -1;
+}
+
+bool GroupScheduler::request(uint8_t group, uint16_t periodMs)
+{
+    int8_t i = find_(group);
+    if (i >= 0) {
+        if (periodMs < entries_[i].periodMs) {
+            entries_[i].periodMs = periodMs;
+        }
+        return true;
+    }
+    if (count_ >= MaxGroups) {
+        return false;
+    }
+
+    Entry &e = entries_[count_++];
+    e.group = group;
+    e.read = false;
+    e.periodMs = periodMs;
+    e.lastMs = 0;
+    return true;
+}
+
+uint16_t GroupScheduler::periodMs(uint8_t group) const
+{
+    int8_t i = find_(group);
+    return (i >= 0) ? entries_[i].periodMs : 0;
+}
+
+bool GroupScheduler::next(uint32_t nowMs, uint8_t &group)
+{
+    int8_t best = -1;
+    bool bestSlow = false;
+    int32_t bestLateness = 0;
+
+    for (uint8_t i = 0; i < count_; ++i) {
+        const Entry &e = entries_[i];
+        if (!e.read) {
+            best = static_cast<int8_t>(i);
+            break;
+        }
+        // Unsigned subtraction keeps this right across millis() wrap.
+        int32_t lateness = static_cast<int32_t>(nowMs - e.lastMs) - e.periodMs;
+        if (lateness < 0) {
+            continue;
+        }
+        // A due slow group goes before every fast one, however long the
+        // fast ones have waited.
+        const bool slow = e.periodMs != AsFastAsPossible;
+        if (best < 0 || (slow && !bestSlow)
+            || (slow == bestSlow && lateness > bestLateness)) {
+            best = static_cast<int8_t>(i);
+            bestSlow = slow;
+            bestLateness = lateness;
+        }
+    }
+
+    if (best < 0) {
+        return false;
+    }
+
+    Entry &e = entries_[best];
+    e.read = true;
+    e.lastMs = nowMs;
+    group = e.group;
+    return true;
+}
+
+bool GroupScheduler::nextSoonest(uint32_t nowMs, uint8_t &group)
+{
+    if (next(nowMs, group)) {
+        return true;
+    }
+    if (count_ == 0) {
+        return false;
+    }
+
+    // Nothing is due, so every entry has been read: the one with the
+    // least time left until its period runs out goes.
+    uint8_t best = 0;
+    int32_t bestLeft = 0;
+    for (uint8_t i = 0; i < count_; ++i) {
+        const Entry &e = entries_[i];
+        int32_t left = e.periodMs - static_cast<int32_t>(nowMs - e.lastMs);
+        if (i == 0 || left < bestLeft) {
+            best = i;
+            bestLeft = left;
+        }
+    }
+
+    Entry &e = entries_[best];
+    e.lastMs = nowMs;
+    group = e.group;
+    return true;
+}
+
+} // namespace KWP
+} // namespace obd
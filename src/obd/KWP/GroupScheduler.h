@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace KWP {
+
+// Decides which measurement group to read next in Mode::ReadSensors.
+//
+// Each group has a refresh period: how old its values may get before it
+// should be read again. next() hands out the slow group (period above 0)
+// that is furthest past its period, and only when none is due the most
+// overdue fast group (period 0), so fast groups take whatever bus time
+// the slow ones do not need. A due slow group waits for the exchange in
+// flight and for slow groups due before it, never for a fast one. Groups
+// that have not been read yet go first, in the order they were requested.
+class GroupScheduler {
+public:
+    static constexpr uint8_t MaxGroups = 8;
+    static constexpr uint16_t AsFastAsPossible = 0;
+
+    GroupScheduler();
+
+    void clear();
+
+    // Adds the group, or tightens its period if it is already scheduled.
+    // Returns false if the table is full.
+    bool request(uint8_t group, uint16_t periodMs);
+
+    // Picks the group to read now and marks it as read at nowMs. Returns
+    // false if every group is still fresh.
+    bool next(uint32_t nowMs, uint8_t &group);
+    // Like next(), but hands out the group closest to its deadline even
+    // if none is due yet: for when the bus has to carry something anyway
+    // (a keep-alive), a group read early beats an empty ACK. False only
+    // if nothing is scheduled.
+    bool nextSoonest(uint32_t nowMs, uint8_t &group);
+
+    uint8_t size() const { return count_; }
+    bool contains(uint8_t group) const { return find_(group) >= 0; }
+    uint16_t periodMs(uint8_t group) const;
+
+private:
+    struct Entry {
+        uint8_t group;
+        bool read;       // read at least once since it was requested
+        uint16_t periodMs;
+        uint32_t lastMs; // when it was last handed out by next()
+    };
+
+    Entry entries_[MaxGroups];
+    uint8_t count_;
+
+    int8_t find_(uint8_t group) const;
+};
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,98 @@
+#include "IdentParser.h"
+
+namespace obd {
+namespace KWP {
+
+using Model::EcuIdentity;
+
+static void trimRight(char *s)
+{
+    size_t n = strlen(s);
+    while (n > 0 && s[n - 1] == ' ') {
+        s[--n] = '\0';
+    }
+}
+
+IdentParser::IdentParser(EcuIdentity &out)
+    : out_(out)
+    , partLen_(0)
+    , compPos_(0)
+    , tokLen_(0)
+    , tokStart_(0)
+    , tokNumeric_(true)
+    , tokValue_(0)
+    , numbers_(0)
+    , number_()
+    , numberStart_()
+{
+    out_.reset();
+}
+
+void IdentParser::feed(const uint8_t *text, uint8_t len)
+{
+    if (len > 0) out_.valid = true;
+
+    for (uint8_t i = 0; i < len; ++i) {
+        char c = static_cast<char>(text[i]);
+        if (c < ' ' || c > '~') c = ' ';
+
+        if (partLen_ < EcuIdentity::PartNumberWidth) {
+            out_.partNumber[partLen_++] = c;
+            continue;
+        }
+
+        if (compPos_ < EcuIdentity::ComponentWidth) {
+            out_.component[compPos_] = c;
+        }
+
+        if (c == ' ') {
+            endToken_();
+        } else {
+            if (tokLen_ == 0) {
+                tokStart_ = compPos_;
+                tokNumeric_ = true;
+                tokValue_ = 0;
+            }
+            ++tokLen_;
+            if (c >= '0' && c <= '9' && tokLen_ <= 5) {
+                tokValue_ = tokValue_ * 10 + static_cast<uint32_t>(c - '0');
+            } else {
+                tokNumeric_ = false;
+            }
+        }
+
+        if (compPos_ < 0xFF) ++compPos_;
+    }
+}
+
+void IdentParser::endToken_()
+{
+    if (tokLen_ == 0) return;
+    if (tokNumeric_) {
+        number_[0] = number_[1];
+        numberStart_[0] = numberStart_[1];
+        number_[1] = tokValue_;
+        numberStart_[1] = tokStart_;
+        if (numbers_ < 2) ++numbers_;
+    } else {
+        numbers_ = 0;
+    }
+    tokLen_ = 0;
+}
+
+void IdentParser::finish()
+{
+    endToken_();
+    if (numbers_ == 2) {
+        out_.coding = number_[0];
+        out_.workshopCode = number_[1];
+        if (numberStart_[0] < EcuIdentity::ComponentWidth) {
+            out_.component[numberStart_[0]] = '\0';
+        }
+    }
+    trimRight(out_.partNumber);
+    trimRight(out_.component);
+}
+
+} // namespace KWP
+} // namespace obd
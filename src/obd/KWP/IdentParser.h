@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../Model/EcuIdentity.h"
+
+namespace obd {
+namespace KWP {
+
+// Turns the text of the 0xF6 identification blocks into an EcuIdentity,
+// one block at a time, without buffering the whole text.
+//
+// The first 12 characters are the part number. The rest is the component
+// name, except that two trailing numbers of up to five digits are the
+// coding and the workshop code (as in "... V01   00142 31414").
+class IdentParser {
+public:
+    explicit IdentParser(Model::EcuIdentity &out);
+
+    void feed(const uint8_t *text, uint8_t len);
+    void finish();
+
+private:
+    Model::EcuIdentity &out_;
+    uint8_t partLen_;
+    uint8_t compPos_;   // component characters seen (stored or not)
+
+    // Current whitespace-separated token of the component text
+    uint8_t tokLen_;
+    uint8_t tokStart_;
+    bool tokNumeric_;
+    uint32_t tokValue_;
+
+    // Last two numeric tokens, [1] being the most recent
+    uint8_t numbers_;
+    uint32_t number_[2];
+    uint8_t numberStart_[2];
+
+    void endToken_();
+};
+
+} // namespace KWP
+} // namespace obd
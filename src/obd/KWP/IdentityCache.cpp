@@ -0,0 +1,148 @@
+#include "IdentityCache.h"
+#include "EepromLayout.h"
+#include <EEPROM.h>
+
+namespace obd {
+namespace KWP {
+
+using Model::EcuIdentity;
+
+// Field offsets within a slot
+static constexpr uint8_t OffBaud = 1;
+static constexpr uint8_t OffIdentity = 3;
+static constexpr uint8_t OffPacing = 7;
+static constexpr uint8_t OffPart = 9;
+static constexpr uint8_t OffComponent = OffPart + EcuIdentity::PartNumberWidth;
+static constexpr uint8_t OffCoding = OffComponent + EcuIdentity::ComponentWidth;
+static constexpr uint8_t OffWorkshop = OffCoding + 4;
+
+static uint32_t readLe(uint16_t addr, uint8_t bytes)
+{
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < bytes; ++i) {
+        v |= static_cast<uint32_t>(EEPROM.read(addr + i)) << (8 * i);
+    }
+    return v;
+}
+
+static void writeLe(uint16_t addr, uint32_t v, uint8_t bytes)
+{
+    for (uint8_t i = 0; i < bytes; ++i) {
+        EEPROM.update(addr + i, static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+static void readText(uint16_t addr, char *text, uint8_t width)
+{
+    for (uint8_t i = 0; i < width; ++i) {
+        text[i] = static_cast<char>(EEPROM.read(addr + i));
+    }
+    text[width] = '\0';
+}
+
+static void writeText(uint16_t addr, const char *text, uint8_t width)
+{
+    // Unused tail stored as NULs so the record reads back unchanged.
+    bool end = false;
+    for (uint8_t i = 0; i < width; ++i) {
+        if (text[i] == '\0') end = true;
+        EEPROM.update(addr + i, end ? 0 : static_cast<uint8_t>(text[i]));
+    }
+}
+
+IdentityCache::IdentityCache(uint16_t eepromBase)
+    : base_(eepromBase)
+{
+}
+
+uint16_t IdentityCache::slotAddr_(uint8_t slot) const
+{
+    return static_cast<uint16_t>(base_ + 2 + slot * SlotBytes);
+}
+
+void IdentityCache::prepare_()
+{
+    if (EEPROM.read(base_) == EepromLayout::IdentityCacheVersion) {
+        return;
+    }
+    for (uint8_t i = 0; i < MaxSlots; ++i) {
+        EEPROM.update(slotAddr_(i), FreeTag);
+    }
+    EEPROM.update(base_ + 1, 0);
+    EEPROM.update(base_, EepromLayout::IdentityCacheVersion);
+}
+
+uint8_t IdentityCache::find_(uint8_t ecuAddr, uint16_t baudRate) const
+{
+    for (uint8_t i = 0; i < MaxSlots; ++i) {
+        uint16_t addr = slotAddr_(i);
+        if (EEPROM.read(addr) == ecuAddr && readLe(addr + OffBaud, 2) == baudRate) {
+            return i;
+        }
+    }
+    return NoSlot;
+}
+
+bool IdentityCache::load(uint8_t ecuAddr, uint16_t baudRate, uint32_t &identity,
+                         uint16_t &pacingUs, EcuIdentity &ident)
+{
+    prepare_();
+    uint8_t slot = find_(ecuAddr, baudRate);
+    if (slot == NoSlot) return false;
+
+    uint16_t addr = slotAddr_(slot);
+    identity = readLe(addr + OffIdentity, 4);
+    pacingUs = static_cast<uint16_t>(readLe(addr + OffPacing, 2));
+    ident.reset();
+    readText(addr + OffPart, ident.partNumber, EcuIdentity::PartNumberWidth);
+    readText(addr + OffComponent, ident.component, EcuIdentity::ComponentWidth);
+    ident.coding = readLe(addr + OffCoding, 4);
+    ident.workshopCode = readLe(addr + OffWorkshop, 4);
+    ident.valid = true;
+    return true;
+}
+
+void IdentityCache::store(uint8_t ecuAddr, uint16_t baudRate, uint32_t identity,
+                          uint16_t pacingUs, const EcuIdentity &ident)
+{
+    prepare_();
+    uint8_t slot = find_(ecuAddr, baudRate);
+    if (slot == NoSlot) {
+        for (uint8_t i = 0; i < MaxSlots && slot == NoSlot; ++i) {
+            if (EEPROM.read(slotAddr_(i)) == FreeTag) slot = i;
+        }
+    }
+    if (slot == NoSlot) {
+        slot = static_cast<uint8_t>(EEPROM.read(base_ + 1) % MaxSlots);
+        EEPROM.update(base_ + 1, static_cast<uint8_t>((slot + 1) % MaxSlots));
+    }
+
+    uint16_t addr = slotAddr_(slot);
+    const bool sameEcu = EEPROM.read(addr) == ecuAddr
+                         && readLe(addr + OffBaud, 2) == baudRate
+                         && readLe(addr + OffIdentity, 4) == identity;
+    if (!sameEcu) {
+        // Free the slot while it holds half of two records.
+        EEPROM.update(addr, FreeTag);
+    }
+    writeLe(addr + OffBaud, baudRate, 2);
+    writeLe(addr + OffIdentity, identity, 4);
+    writeLe(addr + OffPacing, pacingUs, 2);
+    writeText(addr + OffPart, ident.partNumber, EcuIdentity::PartNumberWidth);
+    writeText(addr + OffComponent, ident.component, EcuIdentity::ComponentWidth);
+    writeLe(addr + OffCoding, ident.coding, 4);
+    writeLe(addr + OffWorkshop, ident.workshopCode, 4);
+    EEPROM.update(addr, ecuAddr);
+}
+
+void IdentityCache::forget(uint8_t ecuAddr, uint16_t baudRate)
+{
+    prepare_();
+    uint8_t slot = find_(ecuAddr, baudRate);
+    if (slot != NoSlot) {
+        EEPROM.update(slotAddr_(slot), FreeTag);
+    }
+}
+
+} // namespace KWP
+} // namespace obd
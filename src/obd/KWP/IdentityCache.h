@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../Model/EcuIdentity.h"
+
+namespace obd {
+namespace KWP {
+
+// Last known identity of the ECU at an (address, baud rate), plus the
+// per-ECU settings the session derived for it, kept in EEPROM.
+//
+// With a cached entry a reconnect starts from the learned inter-byte gap
+// instead of calibrating at the conservative one through the whole
+// connect phase, and the identity is in the model before the ECU has
+// finished sending it. The entry is checked against what the ECU then
+// actually sends and rewritten if another ECU answers at that address.
+class IdentityCache {
+public:
+    static constexpr uint8_t MaxSlots = 2;
+    // address, baud rate, identity, pacing, part number, component,
+    // coding, workshop code
+    static constexpr uint8_t SlotBytes = 1 + 2 + 4 + 2
+                                         + Model::EcuIdentity::PartNumberWidth
+                                         + Model::EcuIdentity::ComponentWidth
+                                         + 4 + 4;
+    // version byte, next slot to reuse, slots
+    static constexpr uint16_t RegionBytes = 2 + MaxSlots * SlotBytes;
+
+    explicit IdentityCache(uint16_t eepromBase);
+
+    // identity is KWP1281Session::identity() of the ECU, pacingUs the
+    // KWPPacing target learned for it.
+    bool load(uint8_t ecuAddr, uint16_t baudRate, uint32_t &identity,
+              uint16_t &pacingUs, Model::EcuIdentity &ident);
+    // Writes only the bytes that changed.
+    void store(uint8_t ecuAddr, uint16_t baudRate, uint32_t identity,
+               uint16_t pacingUs, const Model::EcuIdentity &ident);
+    void forget(uint8_t ecuAddr, uint16_t baudRate);
+
+private:
+    static constexpr uint8_t NoSlot = 0xFF;
+    static constexpr uint8_t FreeTag = 0xFF;
+
+    uint16_t base_;
+
+    uint16_t slotAddr_(uint8_t slot) const;
+    uint8_t find_(uint8_t ecuAddr, uint16_t baudRate) const;
+    void prepare_();
+};
+
+} // namespace KWP
+} // namespace obd
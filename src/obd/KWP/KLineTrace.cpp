@@ -0,0 +1,104 @@
+#include "KLineTrace.h"
+
+namespace obd {
+namespace KWP {
+
+static_assert(KLineTrace::Size == 0
+              || (KLineTrace::Size >= 16 && KLineTrace::Size <= 256
+                  && (KLineTrace::Size & (KLineTrace::Size - 1)) == 0),
+              "OBD_TRACE_SIZE must be 0 or a power of two from 16 to 256");
+
+KLineTrace::KLineTrace()
+{
+    clear(0);
+}
+
+void KLineTrace::clear(uint32_t nowUs)
+{
+    head_ = 0;
+    tail_ = 0;
+    used_ = 0;
+    dropped_ = 0;
+    baseUnits_ = (nowUs >> UnitShift) & UnitMask;
+    lastUnits_ = baseUnits_;
+}
+
+void KLineTrace::record(bool tx, uint8_t data, uint32_t nowUs)
+{
+    if (Size == 0) return;
+    const uint32_t units = (nowUs >> UnitShift) & UnitMask;
+    uint32_t value = (((units - lastUnits_) & UnitMask) << 1) | (tx ? 1u : 0u);
+    lastUnits_ = units;
+
+    uint8_t header[4];
+    uint8_t n = 0;
+    do {
+        uint8_t b = value & 0x7F;
+        value >>= 7;
+        header[n++] = value ? static_cast<uint8_t>(b | 0x80) : b;
+    } while (value);
+
+    while (used_ + n + 1u > Size) {
+        dropOldest_();
+    }
+    for (uint8_t i = 0; i < n; ++i) {
+        buf_[head_] = header[i];
+        head_ = wrap_(head_ + 1);
+    }
+    buf_[head_] = data;
+    head_ = wrap_(head_ + 1);
+    used_ += n + 1;
+}
+
+uint8_t KLineTrace::readHeader_(uint8_t pos, uint16_t avail, uint32_t &value) const
+{
+    value = 0;
+    for (uint8_t n = 0; n < 4 && n < avail; ++n) {
+        uint8_t b = buf_[pos];
+        pos = wrap_(pos + 1);
+        value |= static_cast<uint32_t>(b & 0x7F) << (7 * n);
+        if (!(b & 0x80)) {
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+void KLineTrace::dropOldest_()
+{
+    uint32_t value;
+    uint8_t n = readHeader_(tail_, used_, value);
+    // A record always ends in its data byte, so n + 1 <= used_.
+    tail_ = wrap_(tail_ + n + 1);
+    used_ -= n + 1;
+    baseUnits_ = (baseUnits_ + (value >> 1)) & UnitMask;
+    ++dropped_;
+}
+
+KLineTrace::Reader::Reader(const KLineTrace &trace)
+    : trace_(trace)
+    , pos_(trace.tail_)
+    , left_(trace.used_)
+    , units_(0)
+{
+}
+
+bool KLineTrace::Reader::next(Entry &entry)
+{
+    uint32_t value;
+    uint8_t n = trace_.readHeader_(pos_, left_, value);
+    if (n == 0 || left_ < n + 1u) {
+        return false;
+    }
+    pos_ = wrap_(pos_ + n);
+    units_ += value >> 1;
+    entry.us = units_ << UnitShift;
+    entry.tx = value & 1;
+    entry.data = trace_.buf_[pos_];
+    pos_ = wrap_(pos_ + 1);
+    left_ -= n + 1;
+    return true;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Bytes of RAM the trace ring takes: a power of two from 16 to 256, or 0
+// to record nothing (the firmware then leaves the hardware Serial port
+// closed too). Override with -DOBD_TRACE_SIZE=<n> in build_flags (see
+// docs/BUILD_FLAGS.md).
+#ifndef OBD_TRACE_SIZE
+#define OBD_TRACE_SIZE 256
+#endif
+
+namespace obd {
+namespace KWP {
+
+// Every byte the session put on or took off the K-line, with its time,
+// in a ring of OBD_TRACE_SIZE bytes; at the default 256 the last ~120
+// bytes (a few blocks, or seconds of idle keep-alives) before a dropped
+// session can be looked at afterwards (tools/kline_trace.py decodes a
+// dump).
+//
+// A record is the time since the previous record and the direction,
+// packed as a little-endian base-128 varint ((delta << 1) | tx, 7 bits
+// per byte, high bit = more follows), then the data byte. Time counts in
+// 128 us units, so a byte less than 8 ms after the one before costs one
+// extra byte; only gaps over 1 s take more than two. When the ring is
+// full the oldest records go and base() moves up to keep the rest exact.
+class KLineTrace {
+public:
+    static constexpr uint16_t Size = OBD_TRACE_SIZE;
+    static constexpr uint8_t UnitShift = 7;            // 128 us
+    static constexpr uint32_t UnitMask = 0x1FFFFFFUL;  // micros() >> 7
+
+    struct Entry {
+        uint32_t us;   // since base(), 128 us resolution
+        bool tx;
+        uint8_t data;
+    };
+
+    KLineTrace();
+
+    // Empties the ring; the next record's time counts from nowUs.
+    void clear(uint32_t nowUs);
+    void record(bool tx, uint8_t data, uint32_t nowUs);
+
+    uint16_t used() const { return used_; }
+    uint16_t dropped() const { return dropped_; }   // records pushed out
+    // Time of the oldest record's predecessor, in 128 us units.
+    uint32_t base() const { return baseUnits_; }
+
+    // Walks the records oldest first.
+    class Reader {
+    public:
+        explicit Reader(const KLineTrace &trace);
+        bool next(Entry &entry);
+
+    private:
+        const KLineTrace &trace_;
+        uint8_t pos_;
+        uint16_t left_;
+        uint32_t units_;
+    };
+
+    // Writes the ring as text for the host tool:
+    //   #KLT1 <base> <dropped> <bytes>
+    //   <raw ring bytes, oldest first, hex, 32 per line>
+    //   #END
+    // Out needs write(uint8_t) (any Arduino Print, e.g. Serial).
+    template <class Out>
+    void dump(Out &out) const
+    {
+        putText_(out, "#KLT1 ");
+        putHex_(out, baseUnits_, 8);
+        out.write(' ');
+        putHex_(out, dropped_, 4);
+        out.write(' ');
+        putHex_(out, used_, 4);
+        out.write('\n');
+        uint8_t pos = tail_;
+        for (uint16_t i = 0; i < used_; ++i) {
+            putHex_(out, buf_[pos], 2);
+            pos = wrap_(pos + 1);
+            if ((i & 31) == 31 || i + 1 == used_) out.write('\n');
+        }
+        putText_(out, "#END\n");
+    }
+
+private:
+    uint8_t buf_[Size > 0 ? Size : 1];
+    uint8_t head_;       // next write
+    uint8_t tail_;       // oldest record
+    uint16_t used_;
+    uint16_t dropped_;
+    uint32_t baseUnits_;
+    uint32_t lastUnits_;
+
+    static uint8_t wrap_(uint16_t pos) { return static_cast<uint8_t>(pos & (Size - 1)); }
+    // Decodes the varint at pos; returns its length (0 if truncated).
+    uint8_t readHeader_(uint8_t pos, uint16_t avail, uint32_t &value) const;
+    void dropOldest_();
+
+    template <class Out>
+    static void putText_(Out &out, const char *s)
+    {
+        while (*s) out.write(static_cast<uint8_t>(*s++));
+    }
+
+    template <class Out>
+    static void putHex_(Out &out, uint32_t value, uint8_t digits)
+    {
+        while (digits-- > 0) {
+            uint8_t d = (value >> (digits * 4)) & 0x0F;
+            out.write(static_cast<uint8_t>(d < 10 ? '0' + d : 'A' + d - 10));
+        }
+    }
+};
+
+} // namespace KWP
+} // namespace obd
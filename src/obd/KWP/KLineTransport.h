@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Selects the concrete K-line port type used by the KWP sessions. The
+// firmware talks to the real bus through NewSoftwareSerial; host builds
+// plug in a simulated line (see obd/Sim).
+//
+// BasicKWP1281Session and BasicKWP2000Session are bound to their line
+// and clock at compile time, so any type with the members below will do;
+// nothing is virtual on AVR.
+//   Line:  begin(long), end(), write(uint8_t), read(), available(),
+//          flush(), setTxLevel(bool) (5-baud and fast init), rxHigh()
+//          (sync byte)
+//   Clock: static millis(), micros(), delay(ms), delayMicroseconds(us)
+
+#if defined(ARDUINO)
+#include "../../NewSoftwareSerial.h"
+#else
+#include "../Sim/HostKLine.h"
+#endif
+
+namespace obd {
+namespace KWP {
+
+#if defined(ARDUINO)
+using KLineSerial = NewSoftwareSerial;
+#else
+using KLineSerial = Sim::HostKLine;
+#endif
+
+// The Arduino core's time functions (the native shim's virtual clock on
+// the host), at the Uno's 32 bits everywhere so host runs wrap like the
+// firmware does.
+struct ArduinoClock {
+    static uint32_t millis() { return static_cast<uint32_t>(::millis()); }
+    static uint32_t micros() { return static_cast<uint32_t>(::micros()); }
+    static void delay(uint32_t ms) { ::delay(ms); }
+    static void delayMicroseconds(unsigned int us) { ::delayMicroseconds(us); }
+};
+
+} // namespace KWP
+} // namespace obd
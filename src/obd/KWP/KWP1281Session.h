@@ -1,9 +1,20 @@
 #pragma once
 
 #include <Arduino.h>
-#include "../../NewSoftwareSerial.h"
+#include "BlockArena.h"
+#include "BusStats.h"
+#include "FiveBaudInit.h"
+#include "GroupCapabilities.h"
+#include "GroupPayloadCache.h"
+#include "IdentParser.h"
+#include "IdentityCache.h"
+#include "KLineTrace.h"
+#include "KLineTransport.h"
+#include "KWPPacing.h"
+#include "RejectedGroups.h"
 #include "../Model/OBDSignals.h"
 #include "../Model/DTCStore.h"
+#include "../Model/EcuIdentity.h"
 
 namespace obd {
 namespace KWP {
@@ -14,45 +25,233 @@ enum class Mode : uint8_t {
     ReadGroup = 2
 };
 
-class KWP1281Session {
+// Result of one non-blocking step of a KWP exchange.
+enum class PollStatus : uint8_t {
+    Idle = 0,  // nothing in flight
+    Busy = 1,  // waiting for the line; call poll() again
+    Done = 2,  // exchange finished successfully
+    Error = 3  // exchange failed (timeout, complement or counter error)
+};
+
+// One KWP1281 session over a K-line. Line and Clock are described in
+// KLineTransport.h; the member functions live in KWP1281SessionImpl.h
+// and are instantiated in KWP1281Session.cpp for the firmware's line and
+// in obd/Sim/SimSessions.cpp for the host stand-ins.
+template <class Line, class Clock = ArduinoClock>
+class BasicKWP1281Session {
 public:
-    explicit KWP1281Session(NewSoftwareSerial &serial);
+    explicit BasicKWP1281Session(Line &serial);
 
     void setConfig(uint16_t baudRate, uint8_t ecuAddr);
 
+    // Blocking connect: 5-baud address init, then sync, keywords and
+    // identification blocks. A baudRate of 0 means detect it from the
+    // ECU's sync byte; baudRate() then reports what was found.
     bool connectToEcu(bool simulationMode,
                       bool autoSetup,
                       uint16_t &baudRate,
                       uint8_t &addrSelected);
 
+    // The same in two parts, for callers that keep the UI running during
+    // the 2 s address init: startConnect() begins it, poll() clocks the
+    // bits out and returns Done after the stop bit, then finishConnect()
+    // reads the ECU's answer (blocking, a few hundred ms).
+    void startConnect(uint16_t baudRate, uint8_t ecuAddr);
+    bool finishConnect();
+    const FiveBaudInit &addressInit() const { return init_; }
+    uint16_t baudRate() const { return baudRate_; }
+    uint8_t blockCounter() const { return blockCounter_; }
+
     void disconnect();
 
+    // Blocking exchanges, built on the non-blocking ones below.
     bool keepAlive();
     bool readSensorsGroup(uint8_t group, Model::OBDSignals &signals);
+    // The codes held (see DTCStore::overflow() for any that did not
+    // fit), or -1 if the exchange failed.
     int8_t readDtcCodes(Model::DTCStore &dtcStore);
     bool deleteDtcCodes();
     bool exitSession();
 
+    // Picks the session up again after a failed exchange, without a new
+    // 5-baud init: waits for the ECU to give up the block it was on,
+    // sends an ACK and takes the block counter from whatever the ECU
+    // answers. Gives up once the ECU's session timeout is near; the
+    // caller then has to disconnect() and connect again.
+    bool resume();
+
+    // Non-blocking exchanges: start one, then call poll() from the main
+    // loop. Each poll() moves the current block forward by whatever bytes
+    // the line has ready and returns without waiting. Only one exchange
+    // can be in flight; start*() returns false while busy().
+    // startGroupRead() also returns false, without touching the bus, for
+    // a group this ECU has refused before (see groupRejected()); it then
+    // marks the experimental values "n/a" right away.
+    bool startKeepAlive();
+    // True once the line has been quiet for KeepAliveIdleMs: the ECU
+    // drops the session after ~1.1 s without a block from us, so an ACK
+    // (or any other exchange) should go out now. Until then the session
+    // can sit idle with the line free.
+    bool keepAliveDue() const;
+    static constexpr uint16_t KeepAliveIdleMs = 700;
+    bool startGroupRead(uint8_t group, Model::OBDSignals &signals);
+    // Reads the ECU's fault codes into dtcStore (emptied first), one 0xFC
+    // block per exchange step: each block's codes are in the store as
+    // soon as it has arrived, so a DTC screen fills while the ECU sends.
+    // dtcStore must outlive the exchange. poll() returns Done after the
+    // ECU's closing ACK.
+    bool startDtcRead(Model::DTCStore &dtcStore);
+    PollStatus poll(Model::OBDSignals &signals);
+    bool busy() const { return op_ != Op::None; }
+    // Runs the in-flight exchange (if any) to completion. Must be called
+    // before any of the blocking exchanges while an exchange is in flight.
+    bool completePending(Model::OBDSignals &signals);
+
+    // Groups the connected ECU answered without measurement data, twice
+    // in a row on clean exchanges (a line error never counts). Kept in
+    // EEPROM per ECU address, so they stay skipped after a power cycle;
+    // GroupScan::begin() forgets them to ask again.
+    bool groupRejected(uint8_t group) const { return rejected_.rejected(group); }
+    void clearRejectedGroups() { rejected_.clear(); }
+
+    // Hash of the ECU address and the identification blocks it sent at
+    // connect; keys the stored group scan (see GroupScan).
+    uint32_t identity() const { return identity_; }
+    // Part number, component, coding and workshop code from the same
+    // blocks. An ECU seen before at this address and baud rate also gets
+    // its learned pacing back from EEPROM at connect (see IdentityCache).
+    const Model::EcuIdentity &ecuIdentity() const { return ecuIdent_; }
+    // Group map of the connected ECU, if it was scanned before. Groups it
+    // lists as absent are skipped like refused ones, and startGroupRead()
+    // pre-fills the experimental formulas and units of a listed group.
+    GroupCapabilities &capabilities() { return caps_; }
+
+    const KWPPacing &pacing() const { return pacing_; }
+    const BlockArena &arena() const { return arena_; }
+    // The last bytes on the wire (including the 5-baud address and the
+    // measured sync byte), kept across reconnects.
+    KLineTrace &trace() { return trace_; }
+    // Rates, line errors and round-trip latencies (see BusStats); the
+    // caller rolls the rate windows with stats().update().
+    BusStats &stats() { return stats_; }
+    // Bytes of the last block the ECU sent (length byte to block end), for
+    // checks that a finished exchange rests on a whole block.
+    uint8_t lastBlockSize() const { return lastBlockSize_; }
+
 private:
-    NewSoftwareSerial &obd_;
+    Line &obd_;
     uint16_t baudRate_;
+    bool autoBaud_;       // baudRate_ measured from the sync byte at connect
     uint8_t ecuAddr_;
     uint8_t blockCounter_;
     bool connected_;
     bool comError_;
-    uint16_t timeoutMs_;
+    uint16_t timeoutMs_;      // first byte of a block
+    uint16_t byteTimeoutMs_;  // every later byte and complement
+
+    KWPPacing pacing_;
+    RejectedGroups rejected_;
+    GroupCapabilities caps_;
+    GroupPayloadCache payloads_; // last answer per group, for decodeTriplets()
+    uint32_t identity_;
+    Model::EcuIdentity ecuIdent_;
+    IdentityCache idCache_;
+    uint32_t lastLineUs_;   // end of the last byte sent or received
+    bool lastWasTx_;
+
+    // Every block sent or received goes through here; see BlockArena.
+    BlockArena arena_;
+    FiveBaudInit init_;
+    KLineTrace trace_;
+    BusStats stats_;
+    uint32_t requestUs_;          // first byte of the last block we sent
+    BusStats::Kind requestKind_;
+    bool requestOpen_;            // its answer has not arrived yet
+    uint8_t lastBlockSize_;       // see lastBlockSize()
+
+    // Byte-level transfer of one block, advanced by pollTransfer_().
+    enum class Xfer : uint8_t { None, Send, Receive };
+    struct Transfer {
+        Xfer kind;
+        uint8_t *buf;
+        int maxSize;
+        int size;
+        int count;             // bytes written (send) or received so far
+        int source;
+        bool initPhase;
+        bool ackEachByte;
+        bool framed;           // size from the length byte, block end checked
+        bool awaitingComplement;
+        bool adoptCounter;     // take the ECU's block counter (resume)
+        bool writePending;     // buf[count] (send) / pendingByte (receive) due
+        uint8_t pendingByte;
+        uint8_t initRetryCount; // 0x0F repeats in the slow-baud init phase
+        uint32_t waitStartMs;  // the wait for the next byte began here
+        uint16_t waitMs;       // and ends after this long
+
+        void startWait(uint16_t ms)
+        {
+            waitStartMs = Clock::millis();
+            waitMs = ms;
+        }
+        // Unsigned subtraction keeps this right across millis() wrap.
+        bool waitOver() const { return Clock::millis() - waitStartMs >= waitMs; }
+    };
+    Transfer xfer_;
+
+    // Exchange (sequence of blocks) advanced by poll().
+    enum class Op : uint8_t { None, AddressInit, KeepAlive, GroupRead, DtcRead };
+    enum class Step : uint8_t { Request, Response, ErrorAck, ErrorResponse };
+    Op op_;
+    Step step_;
+    uint8_t opGroup_;
+    // What the group answer was, kept while error recovery reuses rx
+    enum class GroupAnswer : uint8_t { Decoded, Refused, Invalid };
+    GroupAnswer opAnswer_;
+    // Group the last clean answer refused, or NoGroup; a second refusal
+    // in a row makes it a rejected group.
+    static constexpr uint16_t NoGroup = 0x100;
+    uint16_t lastRefused_;
+    Model::DTCStore *opDtcs_;
+    uint8_t opBlocks_; // DTC blocks received so far
 
     void incrementBlockCounter_();
+    uint16_t byteTimeUs_() const;
+    bool gapElapsed_() const;
+    void waitGap_();
+    void writeNow_(uint8_t data);
     void writeByte_(uint8_t data);
     int16_t readByte_();
+
+    void startSend_(uint8_t *data, int size);
+    void startReceive_(uint8_t *buffer, int maxSize, int size,
+                       int source = -1, bool initializationPhase = false);
+    PollStatus pollTransfer_();
+    PollStatus pollSend_();
+    PollStatus pollReceive_();
+    PollStatus finishReceive_();
+    PollStatus runTransfer_();
+
+    PollStatus finishOp_(bool ok);
+    PollStatus advanceAddressInit_();
+    PollStatus advanceKeepAlive_();
+    PollStatus advanceGroupRead_(Model::OBDSignals &signals);
+    PollStatus advanceDtcRead_();
+    GroupAnswer decodeGroup_(uint8_t group, const uint8_t *s, int size,
+                             Model::OBDSignals &signals);
+
     bool sendBlock_(uint8_t *data, int size);
     bool receiveBlock_(uint8_t *buffer, int maxSize, int &size,
                        int source = -1, bool initializationPhase = false);
     bool sendAckBlock_();
-    bool receiveAckBlock_();
-    bool readConnectBlocks_(bool initializationPhase);
-    bool perform5BaudInit_();
+    bool readConnectBlocks_(bool initializationPhase, IdentParser &ident);
+    uint16_t measureSyncBaud_();
+    bool handshake_(bool syncMeasured);
+    bool waitQuiet_(uint32_t startMs);
+    bool readResumeAnswer_();
 };
 
+using KWP1281Session = BasicKWP1281Session<KLineSerial>;
+
 } // namespace KWP
 } // namespace obd
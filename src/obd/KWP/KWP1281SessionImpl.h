@@ -0,0 +1,1113 @@
+#pragma once
+
+// Member definitions of BasicKWP1281Session. Only the translation units
+// that instantiate the session include this: KWP1281Session.cpp for the
+// firmware's line, obd/Sim/SimSessions.cpp for the host stand-ins.
+
+#include "KWP1281Session.h"
+#include "EepromLayout.h"
+#include "KWPFormula.h"
+#include "TripletDecode.h"
+
+namespace obd {
+namespace KWP {
+
+// Resume: how long the line must stay silent before the ECU is taken to
+// have dropped the block it was on, how long after the error it is still
+// worth trying (the ECU ends the session after ~1.1 s without a byte from
+// us), how many ACKs to try, and how many leftover answer blocks to
+// acknowledge before the ECU's own ACK.
+static constexpr uint16_t ResumeQuietMs = 60;
+static constexpr uint16_t ResumeWindowMs = 1000;
+static constexpr uint8_t ResumeAttempts = 3;
+static constexpr uint8_t ResumeMaxBlocks = 16;
+
+// Baud rate detection: how long after the address init the sync byte
+// may take (W1 is up to 300 ms), the longest bit we accept, and the
+// rates a measured value is snapped to.
+static constexpr uint16_t SyncWaitMs = 350;
+static constexpr uint16_t SyncEdgeTimeoutUs = 2000;
+static const uint16_t KLineRates[] PROGMEM = {1200, 2400, 4800, 9600, 10400};
+
+// Most identification and DTC blocks we take before giving up on an ECU
+// that keeps sending them (real ones send a handful); otherwise a
+// babbling line would hold the dashboard in the exchange for good.
+static constexpr uint8_t MaxConnectBlocks = 16;
+static constexpr uint8_t MaxDtcBlocks = 16;
+
+template <class Line, class Clock>
+BasicKWP1281Session<Line, Clock>::BasicKWP1281Session(Line &serial)
+    : obd_(serial)
+    , baudRate_(0)
+    , autoBaud_(false)
+    , ecuAddr_(0)
+    , blockCounter_(0)
+    , connected_(false)
+    , comError_(false)
+    , timeoutMs_(1100)
+    , byteTimeoutMs_(200)
+    , pacing_()
+    , rejected_(EepromLayout::RejectedGroupsBase)
+    , caps_(EepromLayout::GroupCapabilitiesBase)
+    , payloads_()
+    , identity_(0)
+    , ecuIdent_()
+    , idCache_(EepromLayout::IdentityCacheBase)
+    , lastLineUs_(0)
+    , lastWasTx_(false)
+    , arena_()
+    , init_()
+    , trace_()
+    , stats_()
+    , requestUs_(0)
+    , requestKind_(BusStats::Kind::Other)
+    , requestOpen_(false)
+    , lastBlockSize_(0)
+    , xfer_()
+    , op_(Op::None)
+    , step_(Step::Request)
+    , opGroup_(0)
+    , opAnswer_(GroupAnswer::Invalid)
+    , lastRefused_(NoGroup)
+    , opDtcs_(nullptr)
+    , opBlocks_(0)
+{
+}
+
+template <class Line, class Clock>
+void BasicKWP1281Session<Line, Clock>::setConfig(uint16_t baudRate, uint8_t ecuAddr)
+{
+    baudRate_ = baudRate;
+    ecuAddr_ = ecuAddr;
+    pacing_.select(ecuAddr_, baudRate_);
+}
+
+template <class Line, class Clock>
+void BasicKWP1281Session<Line, Clock>::incrementBlockCounter_()
+{
+    if (blockCounter_ >= 255) {
+        blockCounter_ = 0;
+    } else {
+        ++blockCounter_;
+    }
+}
+
+template <class Line, class Clock>
+uint16_t BasicKWP1281Session<Line, Clock>::byteTimeUs_() const
+{
+    // 8N1: start + 8 data + stop bits
+    return baudRate_ > 0 ? static_cast<uint16_t>(10000000UL / baudRate_) : 0;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::gapElapsed_() const
+{
+    return (Clock::micros() - lastLineUs_) >= pacing_.gapUs();
+}
+
+template <class Line, class Clock>
+void BasicKWP1281Session<Line, Clock>::waitGap_()
+{
+    // Only wait for whatever part of the gap has not already passed since
+    // the last byte on the line.
+    uint32_t gap = pacing_.gapUs();
+    uint32_t elapsed = Clock::micros() - lastLineUs_;
+    if (elapsed >= gap) return;
+
+    uint32_t remaining = gap - elapsed;
+    if (remaining >= 1000) {
+        Clock::delay(remaining / 1000);
+        remaining %= 1000;
+    }
+    if (remaining > 0) {
+        Clock::delayMicroseconds(static_cast<unsigned int>(remaining));
+    }
+}
+
+template <class Line, class Clock>
+void BasicKWP1281Session<Line, Clock>::writeNow_(uint8_t data)
+{
+    obd_.write(data);
+    lastLineUs_ = Clock::micros();
+    lastWasTx_ = true;
+    trace_.record(true, data, lastLineUs_);
+}
+
+template <class Line, class Clock>
+void BasicKWP1281Session<Line, Clock>::writeByte_(uint8_t data)
+{
+    // Debug printing is handled in the original file; here we
+    // focus on timing and transmission.
+    waitGap_();
+    writeNow_(data);
+}
+
+template <class Line, class Clock>
+int16_t BasicKWP1281Session<Line, Clock>::readByte_()
+{
+    const uint32_t startMs = Clock::millis();
+    while (!obd_.available()) {
+        if (Clock::millis() - startMs >= timeoutMs_) {
+            return -1;
+        }
+    }
+    int16_t data = obd_.read();
+
+    // A byte right after one of ours tells us how quickly the ECU turns
+    // the line around; feed that to the pacing engine while connecting.
+    uint32_t now = Clock::micros();
+    if (lastWasTx_) {
+        uint32_t sinceTx = now - lastLineUs_;
+        uint16_t frame = byteTimeUs_();
+        pacing_.addTurnaroundSample(sinceTx > frame ? sinceTx - frame : 0);
+    }
+    lastLineUs_ = now;
+    lastWasTx_ = false;
+    trace_.record(false, static_cast<uint8_t>(data), now);
+    return data;
+}
+
+// ---- Block transfer state machine ----
+
+template <class Line, class Clock>
+void BasicKWP1281Session<Line, Clock>::startSend_(uint8_t *s, int size)
+{
+    xfer_.kind = Xfer::Send;
+    xfer_.buf = s;
+    xfer_.maxSize = size;
+    xfer_.size = size;
+    xfer_.count = 0;
+    xfer_.awaitingComplement = false;
+    xfer_.writePending = true;
+}
+
+template <class Line, class Clock>
+void BasicKWP1281Session<Line, Clock>::startReceive_(uint8_t s[], int maxsize, int size,
+                                   int source, bool initializationPhase)
+{
+    xfer_.kind = Xfer::Receive;
+    xfer_.buf = s;
+    xfer_.maxSize = maxsize;
+    xfer_.size = size;
+    xfer_.count = 0;
+    xfer_.source = source;
+    xfer_.initPhase = initializationPhase;
+    xfer_.ackEachByte = (size == 0);
+    xfer_.framed = false;
+    xfer_.writePending = false;
+    xfer_.adoptCounter = false;
+    xfer_.initRetryCount = 0; // For communication errors in startup procedure (1200 baud)
+    xfer_.startWait(timeoutMs_);
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::pollTransfer_()
+{
+    switch (xfer_.kind) {
+    case Xfer::Send:
+        return pollSend_();
+    case Xfer::Receive:
+        return pollReceive_();
+    case Xfer::None:
+    default:
+        return PollStatus::Idle;
+    }
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::pollSend_()
+{
+    Transfer &t = xfer_;
+    while (true) {
+        if (t.writePending) {
+            if (!gapElapsed_()) return PollStatus::Busy;
+            uint8_t data = t.buf[t.count];
+            writeNow_(data);
+            t.writePending = false;
+            if (t.count == 0 && t.size > 2) {
+                // Round trip runs to the end of the answer, see finishReceive_().
+                requestUs_ = lastLineUs_;
+                requestKind_ = BusStats::kindOf(t.buf[2]);
+                requestOpen_ = true;
+            }
+            ++t.count;
+
+            if (t.count >= t.size) {
+                // The block end byte is never complemented.
+                t.kind = Xfer::None;
+                incrementBlockCounter_();
+                pacing_.onBlockOk();
+                stats_.onBlockSent();
+                return PollStatus::Done;
+            }
+            t.awaitingComplement = true;
+            t.startWait(byteTimeoutMs_);
+        }
+
+        if (!obd_.available()) {
+            if (!t.waitOver()) return PollStatus::Busy;
+            t.kind = Xfer::None;
+            if (t.buf[2] == 0x06 && t.buf[3] == 0x03) {
+                // Manual KWP exit: the ECU may stop echoing right away
+                return PollStatus::Done;
+            }
+            pacing_.onError();
+            stats_.onTimeout();
+            return PollStatus::Error;
+        }
+
+        int16_t complement = readByte_();
+        if (complement != (t.buf[t.count - 1] ^ 0xFF)) {
+            t.kind = Xfer::None;
+            pacing_.onError();
+            stats_.onComplementError();
+            return PollStatus::Error;
+        }
+        t.awaitingComplement = false;
+        t.writePending = true;
+    }
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::finishReceive_()
+{
+    Transfer &t = xfer_;
+    t.kind = Xfer::None;
+    if (t.framed) {
+        lastBlockSize_ = static_cast<uint8_t>(t.size);
+        // Whatever came in without the block end is not a block; callers
+        // would read its title from what the last one left in the buffer.
+        if (t.buf[t.size - 1] != 0x03) {
+            pacing_.onError();
+            return PollStatus::Error;
+        }
+    }
+    incrementBlockCounter_();
+    stats_.onBlockReceived();
+    if (requestOpen_) {
+        stats_.onRoundTrip(requestKind_, lastLineUs_ - requestUs_);
+        requestOpen_ = false;
+    }
+    return PollStatus::Done;
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::pollReceive_()
+{
+    Transfer &t = xfer_;
+    const bool slowInit = (baudRate_ == 1200 || baudRate_ == 2400 || baudRate_ == 4800)
+                          && t.initPhase;
+
+    if (t.size > t.maxSize) {
+        t.kind = Xfer::None;
+        return PollStatus::Error;
+    }
+
+    while (true) {
+        if (t.writePending) {
+            // Complement queued by the previous byte; it goes out once the
+            // pacing gap has passed.
+            if (!gapElapsed_()) return PollStatus::Busy;
+            writeNow_(t.pendingByte);
+            t.writePending = false;
+        }
+
+        if (t.count != 0 && t.count == t.size && !(slowInit && obd_.available())) {
+            return finishReceive_();
+        }
+
+        if (!obd_.available()) {
+            if (t.waitOver()) {
+                t.kind = Xfer::None;
+                pacing_.onError();
+                stats_.onTimeout();
+                return PollStatus::Error;
+            }
+            return PollStatus::Busy;
+        }
+
+        int16_t data = readByte_();
+        if (data == -1) {
+            t.kind = Xfer::None;
+            return PollStatus::Error;
+        }
+        if (t.count < t.maxSize) {
+            t.buf[t.count] = (uint8_t)data;
+        }
+        ++t.count;
+
+        // 1200/2400/4800 baud init-phase fix, mirrored from original
+        if (slowInit && (t.count > t.maxSize)) {
+            if (data == 0x55) {
+                t.initRetryCount = 0;
+                t.buf[0] = 0x55;
+                t.size = 3;
+                t.framed = false;
+                t.count = 1;
+                t.startWait(timeoutMs_);
+            } else if (data == 0xFF) {
+                t.initRetryCount = 0;
+            } else if (data == 0x0F) {
+                if (t.initRetryCount >= 1) {
+                    t.pendingByte = data ^ 0xFF;
+                    t.writePending = true;
+                    t.startWait(timeoutMs_);
+                    t.initRetryCount = 0;
+                } else {
+                    ++t.initRetryCount;
+                }
+            } else {
+                t.initRetryCount = 0;
+            }
+            continue;
+        }
+
+        if ((t.size == 0) && (t.count == 1)) {
+            // A group answer is 0x0F long, an ACK 0x03. Anything else with
+            // the next byte already waiting (the ECU did not wait for our
+            // complement) is the ECU's error pattern.
+            if (t.source == 1 && data != 0x0F && data != 0x03 && obd_.available()) {
+                comError_ = true;
+                t.size = 6;
+            } else {
+                t.size = data + 1;
+                t.framed = true;
+                if (t.size < 4) {
+                    // Shorter than length, counter, title and end byte
+                    t.kind = Xfer::None;
+                    pacing_.onError();
+                    return PollStatus::Error;
+                }
+            }
+            if (t.size > t.maxSize) {
+                t.kind = Xfer::None;
+                return PollStatus::Error;
+            }
+        }
+
+        if (comError_) {
+            if (t.count == 1) {
+                t.ackEachByte = false;
+            } else if (t.count == 3) {
+                t.ackEachByte = true;
+            } else if (t.count == 4) {
+                t.ackEachByte = false;
+            } else if (t.count == 6) {
+                t.ackEachByte = true;
+            }
+            continue;
+        }
+
+        if ((t.ackEachByte) && (t.count == 2)) {
+            if (data != blockCounter_) {
+                if (data == 0x00 || t.adoptCounter) {
+                    blockCounter_ = (uint8_t)data; // Reset during init-phase errors, or resume
+                } else {
+                    t.kind = Xfer::None;
+                    pacing_.onError();
+                    stats_.onCounterError();
+                    return PollStatus::Error;
+                }
+            }
+        }
+
+        if (((!t.ackEachByte) && (t.count == t.size)) ||
+            ((t.ackEachByte) && (t.count < t.size))) {
+            t.pendingByte = data ^ 0xFF;
+            t.writePending = true;
+        }
+        // Once a block has started the ECU keeps its bytes coming; a
+        // long pause means a byte was lost, so resume() still has time.
+        t.startWait(t.initPhase ? timeoutMs_ : byteTimeoutMs_);
+    }
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::runTransfer_()
+{
+    PollStatus status;
+    while ((status = pollTransfer_()) == PollStatus::Busy) {
+        // Blocking callers have nothing else to do: sleep out the gap.
+        if (xfer_.writePending) waitGap_();
+    }
+    return status;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::sendBlock_(uint8_t *s, int size)
+{
+    startSend_(s, size);
+    return runTransfer_() == PollStatus::Done;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::receiveBlock_(uint8_t s[], int maxsize, int &size,
+                                   int source, bool initializationPhase)
+{
+    startReceive_(s, maxsize, size, source, initializationPhase);
+    PollStatus status = runTransfer_();
+    size = xfer_.size;
+    return status == PollStatus::Done;
+}
+
+// Callers hold the arena; the ACK goes out of tx so rx keeps the block
+// being acknowledged.
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::sendAckBlock_()
+{
+    return sendBlock_(arena_.control(blockCounter_, 0x09), 4);
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::readConnectBlocks_(bool initializationPhase, IdentParser &ident)
+{
+    uint8_t *s = arena_.rx();
+    for (uint8_t blocks = 0; ; ++blocks) {
+        if (blocks >= MaxConnectBlocks) return false;
+        int size = 0;
+        if (!receiveBlock_(s, BlockArena::RxSize, size, -1, initializationPhase)) {
+            return false;
+        }
+        if (size == 0) return false;
+        if (s[2] == 0x09) break; // ACK
+        if (s[2] != 0xF6) {
+            return false;
+        }
+        // FNV-1a over the identification text
+        for (int i = 3; i < size - 1; ++i) {
+            identity_ = (identity_ ^ s[i]) * 16777619UL;
+        }
+        if (size > 4) {
+            ident.feed(&s[3], static_cast<uint8_t>(size - 4));
+        }
+        if (!sendAckBlock_()) return false;
+    }
+    return true;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::connectToEcu(bool simulationMode,
+                                  bool autoSetup,
+                                  uint16_t &baudRate,
+                                  uint8_t &addrSelected)
+{
+    (void)simulationMode;
+    (void)autoSetup;
+
+    startConnect(baudRate, addrSelected);
+    while (advanceAddressInit_() == PollStatus::Busy) {
+        // Nothing else to do here: sleep until the next bit edge.
+        uint32_t waitUs = init_.nextEdgeUs() - Clock::micros();
+        if (static_cast<int32_t>(waitUs) > 0) {
+            Clock::delay(waitUs / 1000);
+            Clock::delayMicroseconds(static_cast<unsigned int>(waitUs % 1000));
+        }
+    }
+    return finishConnect();
+}
+
+template <class Line, class Clock>
+void BasicKWP1281Session<Line, Clock>::startConnect(uint16_t baudRate, uint8_t ecuAddr)
+{
+    setConfig(baudRate, ecuAddr);
+    autoBaud_ = (baudRate_ == 0);
+
+    // A (re)connect abandons whatever exchange was in flight, including
+    // the block counter of a connect attempt that failed half way.
+    op_ = Op::None;
+    xfer_.kind = Xfer::None;
+    arena_.release();
+    connected_ = false;
+    blockCounter_ = 0;
+    requestOpen_ = false;
+    pacing_.select(ecuAddr_, baudRate_);
+
+    if (autoBaud_) {
+        // The rate comes from timing the sync byte on the RX pin, which
+        // the software UART's receive interrupt would stall.
+        obd_.end();
+    } else {
+        // The UART is listening (and idling TX high) before the address
+        // goes out, as the sync byte can follow the stop bit within 20 ms.
+        obd_.begin(baudRate_);
+    }
+    init_.begin(ecuAddr_, Clock::micros());
+    // The address goes out at 5 baud; it is traced at the start bit.
+    trace_.record(true, ecuAddr_, Clock::micros());
+    op_ = Op::AddressInit;
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::advanceAddressInit_()
+{
+    const uint32_t now = Clock::micros();
+    bool high;
+    if (init_.step(now, high)) {
+        obd_.setTxLevel(high);
+    }
+    if (!init_.done(now)) return PollStatus::Busy;
+
+    // Drop the echo of our own bits; the K-line is a single wire.
+    obd_.flush();
+    lastLineUs_ = Clock::micros();
+    lastWasTx_ = false;
+    op_ = Op::None;
+    return PollStatus::Done;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::finishConnect()
+{
+    if (op_ != Op::None) {
+        // Address init not finished (or another exchange in flight)
+        return false;
+    }
+    if (autoBaud_) {
+        const uint16_t detected = measureSyncBaud_();
+        if (detected == 0) {
+            return false;
+        }
+        baudRate_ = detected;
+        pacing_.select(ecuAddr_, baudRate_);
+        obd_.begin(baudRate_);
+        lastLineUs_ = Clock::micros();
+        lastWasTx_ = false;
+        trace_.record(false, 0x55, lastLineUs_);
+    }
+
+    // An ECU connected before at this address and baud rate starts from
+    // the gap learned for it then. Otherwise the connect blocks run with
+    // the fixed timing while the pacing engine watches the ECU's
+    // turnaround.
+    uint32_t cachedIdentity = 0;
+    uint16_t cachedPacingUs = 0;
+    const bool cached = idCache_.load(ecuAddr_, baudRate_, cachedIdentity,
+                                      cachedPacingUs, ecuIdent_);
+    if (cached) {
+        pacing_.restore(cachedPacingUs);
+    } else {
+        pacing_.beginCalibration();
+    }
+    bool ok;
+    {
+        ArenaLease lease(arena_, BlockArena::Owner::Connect);
+        ok = handshake_(autoBaud_);
+    }
+    if (!cached) {
+        pacing_.endCalibration();
+    }
+
+    if (ok) {
+        rejected_.select(ecuAddr_);
+        caps_.select(identity_);
+        payloads_.clear();
+        lastRefused_ = NoGroup;
+        // Rewritten only where it differs, e.g. another ECU at this address.
+        idCache_.store(ecuAddr_, baudRate_, identity_, pacing_.targetUs(), ecuIdent_);
+    } else if (cached) {
+        // The learned gap may be what failed; calibrate next time.
+        idCache_.forget(ecuAddr_, baudRate_);
+    }
+    connected_ = ok;
+    return ok;
+}
+
+// Times the ECU's 0x55 sync byte on the RX pin. Sent 8N1, 0x55 toggles
+// the line at every bit boundary, so the falling edge of the start bit
+// and the rising edge into the stop bit are 9 bit times apart. Returns
+// the rate, snapped to a K-line rate within 3 %, or 0 if no clean sync
+// byte arrived.
+template <class Line, class Clock>
+uint16_t BasicKWP1281Session<Line, Clock>::measureSyncBaud_()
+{
+    const uint32_t waitStart = Clock::millis();
+    while (obd_.rxHigh()) {
+        if (Clock::millis() - waitStart >= SyncWaitMs) return 0;
+    }
+    const uint32_t startUs = Clock::micros();
+    uint32_t edgeUs = startUs;
+    uint32_t minBitUs = 0xFFFFFFFFUL;
+    uint32_t maxBitUs = 0;
+    bool high = false;
+    for (uint8_t edge = 1; edge < 10; ++edge) {
+        while (obd_.rxHigh() == high) {
+            if (Clock::micros() - edgeUs > SyncEdgeTimeoutUs) return 0;
+        }
+        const uint32_t now = Clock::micros();
+        const uint32_t bitUs = now - edgeUs;
+        if (bitUs < minBitUs) minBitUs = bitUs;
+        if (bitUs > maxBitUs) maxBitUs = bitUs;
+        edgeUs = now;
+        high = !high;
+    }
+    // Uneven bits: noise, or some other byte than the sync
+    if (maxBitUs > 2 * minBitUs) return 0;
+
+    const uint32_t nineBitsUs = edgeUs - startUs;
+    const uint32_t baud = (9000000UL + nineBitsUs / 2) / nineBitsUs;
+    if (baud < 1000 || baud > 20000) return 0;
+    for (uint8_t i = 0; i < sizeof(KLineRates) / sizeof(KLineRates[0]); ++i) {
+        const uint32_t rate = pgm_read_word(&KLineRates[i]);
+        const uint32_t diff = baud > rate ? baud - rate : rate - baud;
+        if (diff * 100 <= rate * 3) return static_cast<uint16_t>(rate);
+    }
+    return static_cast<uint16_t>(baud);
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::handshake_(bool syncMeasured)
+{
+    identity_ = (2166136261UL ^ ecuAddr_) * 16777619UL;
+
+    // Expect 0x55, 0x01, 0x8A; the 0x55 is gone already if its timing
+    // gave us the baud rate.
+    uint8_t *response = arena_.rx();
+    response[0] = response[1] = response[2] = 0;
+    int responseSize = syncMeasured ? 2 : 3;
+    if (!receiveBlock_(response, 3, responseSize, -1, true)) {
+        return false;
+    }
+    const uint8_t *keyword = (responseSize == 3) ? response + 1 : response;
+    if ((responseSize == 3 && response[0] != 0x55) || keyword[0] != 0x01 || keyword[1] != 0x8A) {
+        return false;
+    }
+    IdentParser ident(ecuIdent_);
+    bool ok = readConnectBlocks_(false, ident);
+    ident.finish();
+    return ok;
+}
+
+template <class Line, class Clock>
+void BasicKWP1281Session<Line, Clock>::disconnect()
+{
+    op_ = Op::None;
+    xfer_.kind = Xfer::None;
+    arena_.release();
+    if (!connected_) return;
+    // Keep whatever the pacing engine learned since connect (e.g. a gap
+    // raised after line errors) for the next session with this ECU.
+    idCache_.store(ecuAddr_, baudRate_, identity_, pacing_.targetUs(), ecuIdent_);
+    obd_.end();
+    connected_ = false;
+    blockCounter_ = 0;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::resume()
+{
+    op_ = Op::None;
+    xfer_.kind = Xfer::None;
+    arena_.release();
+    comError_ = false;
+    requestOpen_ = false;
+    if (!connected_) return false;
+
+    ArenaLease lease(arena_, BlockArena::Owner::Resume);
+    const uint32_t startMs = Clock::millis();
+    for (uint8_t attempt = 0; attempt < ResumeAttempts; ++attempt) {
+        if (!waitQuiet_(startMs)) return false;
+        stats_.onRetry();
+        if (sendAckBlock_() && readResumeAnswer_()) return true;
+        if (Clock::millis() - startMs >= ResumeWindowMs) break;
+    }
+    return false;
+}
+
+// Drops whatever is left of the interrupted block and waits until the
+// ECU has been silent for ResumeQuietMs. False if the resume window ran
+// out first.
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::waitQuiet_(uint32_t startMs)
+{
+    uint32_t quietSince = Clock::millis();
+    while (Clock::millis() - quietSince < ResumeQuietMs) {
+        if (Clock::millis() - startMs >= ResumeWindowMs) return false;
+        if (obd_.available()) {
+            int16_t data = obd_.read();
+            quietSince = Clock::millis();
+            lastLineUs_ = Clock::micros();
+            lastWasTx_ = false;
+            trace_.record(false, static_cast<uint8_t>(data), lastLineUs_);
+        }
+    }
+    return true;
+}
+
+// The ECU answers our ACK with the rest of anything it still had queued
+// (e.g. a DTC answer cut short) and then its own ACK. Its first block
+// carries the counter we continue from.
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::readResumeAnswer_()
+{
+    uint8_t *s = arena_.rx();
+    for (uint8_t i = 0; i < ResumeMaxBlocks; ++i) {
+        startReceive_(s, BlockArena::RxSize, 0);
+        xfer_.adoptCounter = (i == 0);
+        if (runTransfer_() != PollStatus::Done) return false;
+        if (s[2] == 0x09) return true;
+        if (!sendAckBlock_()) return false;
+    }
+    return false;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::keepAlive()
+{
+    if (!startKeepAlive()) return false;
+    PollStatus status;
+    while ((status = advanceKeepAlive_()) == PollStatus::Busy) {
+        if (xfer_.writePending) waitGap_();
+    }
+    return status == PollStatus::Done;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::readSensorsGroup(uint8_t group, Model::OBDSignals &signals)
+{
+    if (!startGroupRead(group, signals)) return false;
+    return completePending(signals);
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::completePending(Model::OBDSignals &signals)
+{
+    PollStatus status;
+    while ((status = poll(signals)) == PollStatus::Busy) {
+        if (xfer_.writePending) waitGap_();
+    }
+    return status != PollStatus::Error;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::startKeepAlive()
+{
+    if (busy() || !arena_.acquire(BlockArena::Owner::KeepAlive)) return false;
+
+    startSend_(arena_.control(blockCounter_, 0x09), 4);
+    op_ = Op::KeepAlive;
+    step_ = Step::Request;
+    return true;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::keepAliveDue() const
+{
+    return connected_ && !busy()
+           && (Clock::micros() - lastLineUs_) >= KeepAliveIdleMs * 1000UL;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::startGroupRead(uint8_t group, Model::OBDSignals &signals)
+{
+    if (busy()) return false;
+    if (rejected_.rejected(group) || caps_.absent(group)) {
+        markGroupUnsupported(group, signals);
+        return false;
+    }
+    if (!arena_.acquire(BlockArena::Owner::GroupRead)) return false;
+
+    // A scanned group's layout is known before its answer arrives.
+    uint8_t layout[GroupCapabilities::Formulas];
+    const bool haveLayout = caps_.formulas(group, layout);
+
+    prepareGroupRead(group, haveLayout ? layout : nullptr, payloads_, signals);
+
+    uint8_t *req = arena_.tx();
+    req[0] = 0x04;
+    req[1] = blockCounter_;
+    req[2] = 0x29;
+    req[3] = group;
+    req[4] = 0x03;
+    startSend_(req, 5);
+    op_ = Op::GroupRead;
+    step_ = Step::Request;
+    opGroup_ = group;
+    opAnswer_ = GroupAnswer::Invalid;
+    return true;
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::poll(Model::OBDSignals &signals)
+{
+    if (op_ == Op::None) return PollStatus::Idle;
+
+    switch (op_) {
+    case Op::AddressInit:
+        return advanceAddressInit_();
+    case Op::KeepAlive:
+        return advanceKeepAlive_();
+    case Op::GroupRead:
+        return advanceGroupRead_(signals);
+    case Op::DtcRead:
+        return advanceDtcRead_();
+    case Op::None:
+    default:
+        return PollStatus::Idle;
+    }
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::finishOp_(bool ok)
+{
+    op_ = Op::None;
+    xfer_.kind = Xfer::None;
+    arena_.release();
+    return ok ? PollStatus::Done : PollStatus::Error;
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::advanceKeepAlive_()
+{
+    PollStatus status = pollTransfer_();
+    if (status == PollStatus::Busy) return status;
+    if (status == PollStatus::Error) {
+        if (step_ == Step::ErrorAck) comError_ = false;
+        return finishOp_(false);
+    }
+
+    switch (step_) {
+    case Step::Request:
+        startReceive_(arena_.rx(), BlockArena::RxSize, 0);
+        step_ = Step::Response;
+        return PollStatus::Busy;
+    case Step::Response:
+        if (arena_.rx()[2] != 0x09) {
+            return finishOp_(false);
+        }
+        if (comError_) {
+            // Error block handling: send error block then read response
+            startSend_(arena_.control(blockCounter_, 0x00), 4);
+            stats_.onRetry();
+            step_ = Step::ErrorAck;
+            return PollStatus::Busy;
+        }
+        return finishOp_(true);
+    case Step::ErrorAck:
+        blockCounter_ = 0;
+        comError_ = false;
+        startReceive_(arena_.rx(), BlockArena::RxSize, 0);
+        step_ = Step::ErrorResponse;
+        return PollStatus::Busy;
+    case Step::ErrorResponse:
+    default:
+        return finishOp_(false);
+    }
+}
+
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::advanceGroupRead_(Model::OBDSignals &signals)
+{
+    PollStatus status = pollTransfer_();
+    if (status == PollStatus::Busy) return status;
+    if (status == PollStatus::Error) {
+        if (step_ == Step::ErrorAck) comError_ = false;
+        failGroupRead(opGroup_, payloads_, signals);
+        return finishOp_(false);
+    }
+
+    switch (step_) {
+    case Step::Request:
+        startReceive_(arena_.rx(), BlockArena::RxSize, 0, 1);
+        step_ = Step::Response;
+        return PollStatus::Busy;
+    case Step::Response:
+        if (comError_) {
+            // The ECU's error pattern, not an answer: nothing to decode,
+            // and nothing learned about the group.
+            opAnswer_ = GroupAnswer::Invalid;
+            startSend_(arena_.control(blockCounter_, 0x00), 4);
+            stats_.onRetry();
+            step_ = Step::ErrorAck;
+            return PollStatus::Busy;
+        }
+        opAnswer_ = decodeGroup_(opGroup_, arena_.rx(), xfer_.size, signals);
+        break;
+    case Step::ErrorAck:
+        blockCounter_ = 0;
+        comError_ = false;
+        startReceive_(arena_.rx(), BlockArena::RxSize, 0);
+        step_ = Step::ErrorResponse;
+        return PollStatus::Busy;
+    case Step::ErrorResponse:
+    default:
+        break;
+    }
+
+    if (opAnswer_ == GroupAnswer::Decoded) stats_.onGroupRead();
+    if (opAnswer_ == GroupAnswer::Invalid) failGroupRead(opGroup_, payloads_, signals);
+    return finishOp_(opAnswer_ != GroupAnswer::Invalid);
+}
+
+template <class Line, class Clock>
+typename BasicKWP1281Session<Line, Clock>::GroupAnswer
+BasicKWP1281Session<Line, Clock>::decodeGroup_(uint8_t group, const uint8_t *s, int size,
+                                              Model::OBDSignals &signals)
+{
+    if (s[2] != 0xE7) {
+        bool isSpecialCase = false;
+        bool isSuperSpecialCase = false;
+
+        bool refused = false;
+        if (s[2] == 0x09 || s[2] == 0x0A) {
+            // ACK or NAK instead of measurement data
+            refused = true;
+        } else if (baudRate_ == 9600 && ecuAddr_ == 0x01) {
+            if (s[2] == 0x02) {
+                isSpecialCase = true;
+            } else if (s[2] == 0xF4) {
+                isSuperSpecialCase = true;
+            } else {
+                // Unknown title: a failed read, not a refusal
+                return GroupAnswer::Invalid;
+            }
+        }
+
+        if (refused) {
+            // The exchange itself went fine, so the session stays up. The
+            // group is only skipped for good once the ECU refuses it twice
+            // in a row, so one odd answer cannot hide it.
+            if (lastRefused_ == group) {
+                rejected_.markRejected(group);
+                lastRefused_ = NoGroup;
+            } else {
+                lastRefused_ = group;
+            }
+            markGroupUnsupported(group, signals);
+            return GroupAnswer::Refused;
+        }
+
+        if (isSpecialCase) {
+            // Not decoded into the experimental slots
+            payloads_.forget(group);
+            switch (group) {
+                case 1: {
+                    if (size < 13) break;   // three triplets and the end byte
+                    // Fixed layout: rpm, coolant, voltage triplets
+                    uint16_t rpm = (uint16_t)decodeMeasurement(1, s[4], s[5]).whole();
+                    if (signals.instruments.engineRpm != rpm) {
+                        signals.instruments.engineRpm = rpm;
+                        signals.instruments.engineRpmUpdated = true;
+                    }
+
+                    uint8_t cool = (uint8_t)decodeMeasurement(5, s[7], s[8]).whole();
+                    if (signals.instruments.coolantTemp != cool) {
+                        signals.instruments.coolantTemp = cool;
+                        signals.instruments.coolantTempUpdated = true;
+                    }
+
+                    float volt = decodeMeasurement(6, s[10], s[11]).toFloat();
+                    if (signals.engine.voltage != volt) {
+                        signals.engine.voltage = volt;
+                        signals.engine.voltageUpdated = true;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+            return GroupAnswer::Decoded;
+        }
+
+        if (isSuperSpecialCase) {
+            return GroupAnswer::Decoded;
+        }
+    }
+
+    // Triplets sit between the title and the block end; the ECU may send
+    // more than there are slots (the length byte is its word).
+    decodeTriplets(ecuAddr_, group, s + 3, (size - 4) / 3, payloads_, signals);
+    if (lastRefused_ == group) lastRefused_ = NoGroup;
+
+    return GroupAnswer::Decoded;
+}
+
+template <class Line, class Clock>
+int8_t BasicKWP1281Session<Line, Clock>::readDtcCodes(Model::DTCStore &dtcStore)
+{
+    if (!startDtcRead(dtcStore)) return -1;
+    PollStatus status;
+    while ((status = advanceDtcRead_()) == PollStatus::Busy) {
+        if (xfer_.writePending) waitGap_();
+    }
+    return status == PollStatus::Done ? (int8_t)dtcStore.count() : -1;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::startDtcRead(Model::DTCStore &dtcStore)
+{
+    if (busy() || !arena_.acquire(BlockArena::Owner::DtcRead)) return false;
+
+    dtcStore.reset();
+    startSend_(arena_.control(blockCounter_, 0x07), 4);
+    op_ = Op::DtcRead;
+    step_ = Step::Request;
+    opDtcs_ = &dtcStore;
+    opBlocks_ = 0;
+    return true;
+}
+
+// Request, then one 0xFC block after another, each taken into the store
+// and ACKed, until the ECU's ACK says there are no more.
+template <class Line, class Clock>
+PollStatus BasicKWP1281Session<Line, Clock>::advanceDtcRead_()
+{
+    PollStatus status = pollTransfer_();
+    if (status == PollStatus::Busy) return status;
+    if (status == PollStatus::Error) return finishOp_(false);
+
+    if (step_ == Step::Request) {
+        // Our request or the ACK for the last block is out.
+        if (opBlocks_ >= MaxDtcBlocks) return finishOp_(false);
+        startReceive_(arena_.rx(), BlockArena::RxSize, 0);
+        step_ = Step::Response;
+        return PollStatus::Busy;
+    }
+
+    const uint8_t *s = arena_.rx();
+    if (s[2] == 0x09) return finishOp_(true); // No more DTC blocks
+    if (s[2] != 0xFC) return finishOp_(false);
+    ++opBlocks_;
+
+    const int count = (xfer_.size - 4) / 3;
+    for (int i = 0; i < count; ++i) {
+        const uint8_t byteHigh = s[3 + 3 * i];
+        const uint8_t byteLow = s[3 + 3 * i + 1];
+        const uint8_t byteStatus = s[3 + 3 * i + 2];
+        if (byteHigh == 0xFF && byteLow == 0xFF && byteStatus == 0x88) {
+            continue; // No DTC codes
+        }
+        opDtcs_->add((uint16_t)((byteHigh << 8) | byteLow), byteStatus);
+    }
+
+    startSend_(arena_.control(blockCounter_, 0x09), 4);
+    step_ = Step::Request;
+    return PollStatus::Busy;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::deleteDtcCodes()
+{
+    ArenaLease lease(arena_, BlockArena::Owner::DtcDelete);
+    if (!lease.ok()) return false;
+    if (!sendBlock_(arena_.control(blockCounter_, 0x05), 4)) return false;
+
+    int size = 0;
+    uint8_t *resp = arena_.rx();
+    if (!receiveBlock_(resp, BlockArena::RxSize, size)) return false;
+    if (resp[2] != 0x09) return false;
+    return true;
+}
+
+template <class Line, class Clock>
+bool BasicKWP1281Session<Line, Clock>::exitSession()
+{
+    ArenaLease lease(arena_, BlockArena::Owner::Exit);
+    if (!lease.ok()) return false;
+    if (!sendBlock_(arena_.control(blockCounter_, 0x06), 4)) {
+        return false;
+    }
+    return true;
+}
+
+} // namespace KWP
+} // namespace obd
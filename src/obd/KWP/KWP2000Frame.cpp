@@ -0,0 +1,131 @@
+#include "KWP2000Frame.h"
+
+namespace obd {
+namespace KWP {
+
+static uint8_t clampField(uint32_t value)
+{
+    return value > 0xFF ? 0xFF : static_cast<uint8_t>(value);
+}
+
+void KWP2000Timing::encode(uint8_t out[5]) const
+{
+    out[0] = clampField(p2Min * 2UL);
+    out[1] = clampField((p2Max + 24UL) / 25);
+    out[2] = clampField(p3Min * 2UL);
+    out[3] = clampField((p3Max + 249UL) / 250);
+    out[4] = clampField(p4Min * 2UL);
+}
+
+bool KWP2000Timing::decode(const uint8_t in[5])
+{
+    if (in[1] == 0 || in[3] == 0) return false;
+    // Half-ms fields round up, so a decoded minimum is never shorter
+    // than the one asked for.
+    p2Min = static_cast<uint16_t>((in[0] + 1) / 2);
+    p2Max = static_cast<uint16_t>(in[1] * 25);
+    p3Min = static_cast<uint16_t>((in[2] + 1) / 2);
+    p3Max = static_cast<uint16_t>(in[3] * 250);
+    p4Min = static_cast<uint8_t>((in[4] + 1) / 2);
+    return true;
+}
+
+KWP2000Frame::KWP2000Frame()
+{
+    reset();
+}
+
+void KWP2000Frame::reset()
+{
+    field_ = Field::Format;
+    format_ = 0;
+    target_ = 0;
+    source_ = 0;
+    length_ = 0;
+    size_ = 0;
+    sum_ = 0;
+}
+
+KWP2000Frame::Status KWP2000Frame::fail_()
+{
+    field_ = Field::Format;
+    size_ = 0;
+    return Status::Error;
+}
+
+KWP2000Frame::Status KWP2000Frame::feed(uint8_t data)
+{
+    if (field_ == Field::Checksum) {
+        field_ = Field::Format;
+        return data == sum_ ? Status::Done : fail_();
+    }
+    if (field_ == Field::Format) {
+        reset();
+    }
+    sum_ = static_cast<uint8_t>(sum_ + data);
+
+    switch (field_) {
+    case Field::Format:
+        format_ = data;
+        length_ = data & 0x3F;
+        if (data & 0xC0) {
+            field_ = Field::Target;
+        } else {
+            field_ = length_ == 0 ? Field::Length : Field::Data;
+        }
+        break;
+    case Field::Target:
+        target_ = data;
+        field_ = Field::Source;
+        break;
+    case Field::Source:
+        source_ = data;
+        field_ = length_ == 0 ? Field::Length : Field::Data;
+        break;
+    case Field::Length:
+        length_ = data;
+        field_ = Field::Data;
+        break;
+    case Field::Data:
+        data_[size_++] = data;
+        break;
+    case Field::Checksum:
+        break;
+    }
+
+    if (field_ == Field::Data) {
+        if (length_ == 0 || length_ > MaxData) return fail_();
+        if (size_ == length_) field_ = Field::Checksum;
+    }
+    return Status::More;
+}
+
+uint8_t KWP2000Frame::build(uint8_t *out, uint8_t target, uint8_t source,
+                            const uint8_t *data, uint8_t size)
+{
+    if (size == 0 || size > MaxData) return 0;
+
+    uint8_t n = 0;
+    if (size <= 0x3F) {
+        out[n++] = static_cast<uint8_t>(0x80 | size);
+        out[n++] = target;
+        out[n++] = source;
+    } else {
+        out[n++] = 0x80;
+        out[n++] = target;
+        out[n++] = source;
+        out[n++] = size;
+    }
+    for (uint8_t i = 0; i < size; ++i) {
+        out[n++] = data[i];
+    }
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < n; ++i) {
+        sum = static_cast<uint8_t>(sum + out[i]);
+    }
+    out[n++] = sum;
+    return n;
+}
+
+} // namespace KWP
+} // namespace obd
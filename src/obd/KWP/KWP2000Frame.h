@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace KWP {
+
+// ISO 14230-2 timing, in ms. P2: from the end of a request to the ECU's
+// answer; P3: from the end of an answer to the next request (P3max is
+// the ECU's session timeout); P4: between the tester's own bytes. The
+// defaults are the standard's.
+struct KWP2000Timing {
+    uint16_t p2Min = 25;
+    uint16_t p2Max = 50;
+    uint16_t p3Min = 55;
+    uint16_t p3Max = 5000;
+    uint8_t p4Min = 5;
+
+    // AccessTimingParameters (set values) encoding: P2min, P3min and
+    // P4min in 0.5 ms, P2max in 25 ms and P3max in 250 ms steps. decode()
+    // rejects a P2max or P3max of 0; values past a field's range are
+    // clamped by encode().
+    void encode(uint8_t out[5]) const;
+    bool decode(const uint8_t in[5]);
+};
+
+// ISO 14230-2 (KWP2000 on the K-line) framing. A frame is a format byte
+// (address mode in bits 7..6, data length in bits 5..0), target and
+// source address unless the mode is 0, a length byte of its own when
+// the format byte's length is 0, the service data and a checksum: the
+// sum of all bytes before it, mod 256. There is no per-byte echo; a
+// frame that fails its checksum is dropped whole.
+//
+// feed() takes the bytes of an incoming frame one at a time; the
+// service data stays in the parser until reset() or the next frame.
+class KWP2000Frame {
+public:
+    // Service identifiers; a positive answer is the request's + 0x40.
+    static constexpr uint8_t StartCommunication = 0x81;
+    static constexpr uint8_t StopCommunication = 0x82;
+    static constexpr uint8_t AccessTimingParameters = 0x83;
+    static constexpr uint8_t ReadDataByLocalId = 0x21;
+    static constexpr uint8_t TesterPresent = 0x3E;
+    static constexpr uint8_t NegativeResponse = 0x7F;
+    static constexpr uint8_t PositiveOffset = 0x40;
+
+    // Negative response codes the session acts on
+    static constexpr uint8_t ServiceNotSupported = 0x11;
+    static constexpr uint8_t SubFunctionNotSupported = 0x12;
+    static constexpr uint8_t RequestOutOfRange = 0x31;
+    static constexpr uint8_t ResponsePending = 0x78;
+
+    static constexpr uint8_t TesterAddress = 0xF1;
+    // Longest service data kept; longer frames fail. A full group (title,
+    // identifier and ten triplets) is 32.
+    static constexpr uint8_t MaxData = 64;
+    // Header (format, target, source, length) and checksum around it
+    static constexpr uint8_t MaxFrame = MaxData + 5;
+
+    enum class Status : uint8_t {
+        More = 0,   // frame not complete yet
+        Done = 1,   // frame complete and its checksum right
+        Error = 2   // bad checksum, or longer than MaxData
+    };
+
+    KWP2000Frame();
+
+    void reset();
+    // Next byte of an incoming frame. After Done or Error the next byte
+    // starts a new frame.
+    Status feed(uint8_t data);
+
+    // The last complete frame. target() and source() are 0 when the
+    // format byte carried no addresses.
+    uint8_t format() const { return format_; }
+    uint8_t target() const { return target_; }
+    uint8_t source() const { return source_; }
+    const uint8_t *data() const { return data_; }
+    uint8_t size() const { return size_; }
+    uint8_t service() const { return size_ > 0 ? data_[0] : 0; }
+
+    // Writes a physically addressed frame for size bytes of service data
+    // into out (at least size + 5 bytes). Returns the frame length, or 0
+    // if size is 0 or more than MaxData.
+    static uint8_t build(uint8_t *out, uint8_t target, uint8_t source,
+                         const uint8_t *data, uint8_t size);
+
+private:
+    enum class Field : uint8_t { Format, Target, Source, Length, Data, Checksum };
+
+    Field field_;
+    uint8_t format_;
+    uint8_t target_;
+    uint8_t source_;
+    uint8_t length_;   // service data bytes announced
+    uint8_t size_;     // received so far
+    uint8_t sum_;
+    uint8_t data_[MaxData];
+
+    Status fail_();
+};
+
+} // namespace KWP
+} // namespace obd
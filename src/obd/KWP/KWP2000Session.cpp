@@ -0,0 +1,11 @@
+#include "KWP2000SessionImpl.h"
+
+namespace obd {
+namespace KWP {
+
+// The firmware's line (HostKLine on the host). The simulated ECU bound
+// directly is instantiated in obd/Sim/SimSessions.cpp.
+template class BasicKWP2000Session<KLineSerial>;
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Arduino.h>
+#include "GroupPayloadCache.h"
+#include "KLineTransport.h"
+#include "KWP2000Frame.h"
+#include "../Model/OBDSignals.h"
+
+namespace obd {
+namespace KWP {
+
+// One KWP2000 (ISO 14230) session over the same K-line as
+// BasicKWP1281Session: a 50 ms fast init at 10400 baud instead of the
+// 2 s 5-baud address, then request/answer frames with a checksum
+// instead of a complement for every byte. Measurement groups are read
+// with ReadDataByLocalIdentifier, the group number as the identifier;
+// VAG ECUs answer with the same (formula, a, b) triplets as KWP1281, so
+// they land in the same OBDSignals fields (see TripletDecode.h).
+//
+// All exchanges block until the answer is in (tens of ms). Line and
+// Clock are described in KLineTransport.h; the member functions live in
+// KWP2000SessionImpl.h and are instantiated in KWP2000Session.cpp (and
+// obd/Sim/SimSessions.cpp on the host).
+template <class Line, class Clock = ArduinoClock>
+class BasicKWP2000Session {
+public:
+    static constexpr uint16_t BaudRate = 10400;
+    // Quiet bus before the wake-up pattern (W5), its low part (TiniL)
+    // and its whole length (TWuP).
+    static constexpr uint16_t IdleBeforeInitMs = 300;
+    static constexpr uint8_t InitLowMs = 25;
+    static constexpr uint8_t InitMs = 50;
+    // Longest gap between two bytes of the ECU's answer (P1max), how
+    // long an ECU that answered "response pending" may still take
+    // (P2*max), and how many such answers we wait through.
+    static constexpr uint8_t ByteTimeoutMs = 20;
+    static constexpr uint16_t PendingTimeoutMs = 5000;
+    static constexpr uint8_t MaxPending = 8;
+    // Idle time after which keepAliveDue() asks for a TesterPresent,
+    // well inside the default P3max.
+    static constexpr uint16_t KeepAliveIdleMs = 2000;
+
+    enum class Result : uint8_t {
+        Ok = 0,
+        Negative = 1,   // the ECU refused; see lastNegative()
+        NoAnswer = 2,   // nothing, or not all of it, within the timeout
+        BadFrame = 3    // checksum, length, or an answer to something else
+    };
+
+    explicit BasicKWP2000Session(Line &line);
+
+    // Fast init and StartCommunication. Blocking: up to IdleBeforeInitMs
+    // of quiet line (less if the session has seen it quiet already),
+    // the 50 ms pattern and the ECU's answer. Resets the timing to the
+    // standard's defaults.
+    bool connect(uint8_t ecuAddr);
+    // StopCommunication if connected, then releases the line.
+    void disconnect();
+
+    // Asks the ECU for other timing (AccessTimingParameters); once it
+    // agrees the session keeps to it. Shorter P2 and P3 are most of what
+    // makes a group read faster than the defaults allow.
+    bool setTiming(const KWP2000Timing &timing);
+
+    // ReadDataByLocalIdentifier for group, decoded into the experimental
+    // view and the bound signals. A group the ECU refuses is marked
+    // "n/a" and still counts as read.
+    bool readGroup(uint8_t group, Model::OBDSignals &signals);
+
+    // TesterPresent, to hold the session while nothing else is read.
+    bool keepAlive();
+    bool keepAliveDue() const;
+
+    bool connected() const { return connected_; }
+    uint8_t ecuAddress() const { return ecuAddr_; }
+    // Key bytes from the StartCommunication answer, KB1 in the low byte.
+    uint16_t keyBytes() const { return keyBytes_; }
+    const KWP2000Timing &timing() const { return timing_; }
+    // Code of the last negative answer, 0 if there was none yet.
+    uint8_t lastNegative() const { return lastNrc_; }
+    Result lastResult() const { return lastResult_; }
+    // The last frame the ECU sent.
+    const KWP2000Frame &answer() const { return rx_; }
+
+private:
+    Line &obd_;
+    uint8_t ecuAddr_;
+    bool connected_;
+    bool lineSeen_;        // lastLineUs_ is valid
+    uint16_t keyBytes_;
+    uint8_t lastNrc_;
+    Result lastResult_;
+    KWP2000Timing timing_;
+    uint32_t lastLineUs_;  // end of the last byte either way
+    KWP2000Frame rx_;
+    GroupPayloadCache payloads_; // last answer per group, for decodeTriplets()
+
+    void sleepUs_(uint32_t us);
+    void waitSince_(uint32_t us);
+    void send_(const uint8_t *data, uint8_t size);
+    Result receive_(uint16_t timeoutMs);
+    Result request_(const uint8_t *data, uint8_t size);
+};
+
+using KWP2000Session = BasicKWP2000Session<KLineSerial>;
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,243 @@
+#pragma once
+
+// Member definitions of BasicKWP2000Session. Only the translation units
+// that instantiate the session include this: KWP2000Session.cpp for the
+// firmware's line, obd/Sim/SimSessions.cpp for the host stand-ins.
+
+#include "KWP2000Session.h"
+#include "TripletDecode.h"
+
+namespace obd {
+namespace KWP {
+
+// Longest request the session builds: AccessTimingParameters with its
+// five timing bytes and the sub-function.
+static constexpr uint8_t MaxRequest = 7;
+
+template <class Line, class Clock>
+BasicKWP2000Session<Line, Clock>::BasicKWP2000Session(Line &line)
+    : obd_(line)
+    , ecuAddr_(0)
+    , connected_(false)
+    , lineSeen_(false)
+    , keyBytes_(0)
+    , lastNrc_(0)
+    , lastResult_(Result::Ok)
+    , timing_()
+    , lastLineUs_(0)
+    , rx_()
+    , payloads_()
+{
+}
+
+template <class Line, class Clock>
+void BasicKWP2000Session<Line, Clock>::sleepUs_(uint32_t us)
+{
+    if (us >= 1000) {
+        Clock::delay(us / 1000);
+        us %= 1000;
+    }
+    if (us > 0) {
+        Clock::delayMicroseconds(static_cast<unsigned int>(us));
+    }
+}
+
+// Waits for whatever part of us has not already passed since the last
+// byte on the line.
+template <class Line, class Clock>
+void BasicKWP2000Session<Line, Clock>::waitSince_(uint32_t us)
+{
+    const uint32_t elapsed = Clock::micros() - lastLineUs_;
+    if (elapsed < us) sleepUs_(us - elapsed);
+}
+
+template <class Line, class Clock>
+bool BasicKWP2000Session<Line, Clock>::connect(uint8_t ecuAddr)
+{
+    connected_ = false;
+    ecuAddr_ = ecuAddr;
+    keyBytes_ = 0;
+    lastNrc_ = 0;
+    timing_ = KWP2000Timing();
+    payloads_.clear();
+
+    // The wake-up pattern is driven on the pin, not through the UART.
+    obd_.end();
+    obd_.setTxLevel(true);
+    if (lineSeen_) {
+        waitSince_(IdleBeforeInitMs * 1000UL);
+    } else {
+        sleepUs_(IdleBeforeInitMs * 1000UL);
+    }
+    obd_.setTxLevel(false);
+    sleepUs_(InitLowMs * 1000UL);
+    obd_.setTxLevel(true);
+    sleepUs_((InitMs - InitLowMs) * 1000UL);
+    obd_.begin(BaudRate);
+    lastLineUs_ = Clock::micros();
+    lineSeen_ = true;
+
+    const uint8_t request = KWP2000Frame::StartCommunication;
+    if (request_(&request, 1) != Result::Ok || rx_.size() < 3) {
+        return false;
+    }
+    keyBytes_ = static_cast<uint16_t>(rx_.data()[1] | (rx_.data()[2] << 8));
+    connected_ = true;
+    return true;
+}
+
+template <class Line, class Clock>
+void BasicKWP2000Session<Line, Clock>::disconnect()
+{
+    if (connected_) {
+        const uint8_t request = KWP2000Frame::StopCommunication;
+        request_(&request, 1);
+        connected_ = false;
+    }
+    obd_.end();
+}
+
+template <class Line, class Clock>
+bool BasicKWP2000Session<Line, Clock>::setTiming(const KWP2000Timing &timing)
+{
+    if (!connected_) return false;
+
+    uint8_t request[MaxRequest] = {KWP2000Frame::AccessTimingParameters, 0x03};
+    timing.encode(&request[2]);
+    // What the ECU is asked for, at the resolution it is sent with
+    KWP2000Timing agreed;
+    if (!agreed.decode(&request[2])) return false;
+
+    if (request_(request, MaxRequest) != Result::Ok || rx_.size() < 2 || rx_.data()[1] != 0x03) {
+        return false;
+    }
+    timing_ = agreed;
+    return true;
+}
+
+template <class Line, class Clock>
+bool BasicKWP2000Session<Line, Clock>::readGroup(uint8_t group, Model::OBDSignals &signals)
+{
+    if (!connected_) return false;
+
+    prepareGroupRead(group, nullptr, payloads_, signals);
+    const uint8_t request[2] = {KWP2000Frame::ReadDataByLocalId, group};
+    const Result result = request_(request, 2);
+    if (result == Result::Negative
+        && (lastNrc_ == KWP2000Frame::RequestOutOfRange
+            || lastNrc_ == KWP2000Frame::SubFunctionNotSupported
+            || lastNrc_ == KWP2000Frame::ServiceNotSupported)) {
+        markGroupUnsupported(group, signals);
+        return true;
+    }
+    if (result != Result::Ok || rx_.size() < 2 || rx_.data()[1] != group) {
+        failGroupRead(group, payloads_, signals);
+        return false;
+    }
+    // Service and identifier, then the triplets
+    decodeTriplets(ecuAddr_, group, rx_.data() + 2, (rx_.size() - 2) / 3, payloads_, signals);
+    return true;
+}
+
+template <class Line, class Clock>
+bool BasicKWP2000Session<Line, Clock>::keepAlive()
+{
+    if (!connected_) return false;
+    const uint8_t request = KWP2000Frame::TesterPresent;
+    return request_(&request, 1) == Result::Ok;
+}
+
+template <class Line, class Clock>
+bool BasicKWP2000Session<Line, Clock>::keepAliveDue() const
+{
+    return connected_ && (Clock::micros() - lastLineUs_) >= KeepAliveIdleMs * 1000UL;
+}
+
+template <class Line, class Clock>
+void BasicKWP2000Session<Line, Clock>::send_(const uint8_t *data, uint8_t size)
+{
+    uint8_t frame[MaxRequest + 5];
+    if (size > MaxRequest) return;
+    const uint8_t length = KWP2000Frame::build(frame, ecuAddr_, KWP2000Frame::TesterAddress,
+                                               data, size);
+
+    // StartCommunication goes out right after the wake-up pattern;
+    // everything later keeps P3 to the ECU's last answer.
+    if (connected_) {
+        waitSince_(timing_.p3Min * 1000UL);
+    }
+    // Anything still arriving belongs to an answer we are done with.
+    while (obd_.available() > 0) {
+        obd_.read();
+    }
+    for (uint8_t i = 0; i < length; ++i) {
+        if (i > 0 && timing_.p4Min > 0) {
+            sleepUs_(timing_.p4Min * 1000UL);
+        }
+        obd_.write(frame[i]);
+    }
+    lastLineUs_ = Clock::micros();
+}
+
+template <class Line, class Clock>
+typename BasicKWP2000Session<Line, Clock>::Result
+BasicKWP2000Session<Line, Clock>::receive_(uint16_t timeoutMs)
+{
+    rx_.reset();
+    uint32_t startMs = Clock::millis();
+    uint16_t limitMs = timeoutMs;
+    for (;;) {
+        if (obd_.available() > 0) {
+            const int data = obd_.read();
+            if (data < 0) continue;
+            lastLineUs_ = Clock::micros();
+            startMs = Clock::millis();
+            limitMs = ByteTimeoutMs;
+            const KWP2000Frame::Status status = rx_.feed(static_cast<uint8_t>(data));
+            if (status == KWP2000Frame::Status::Done) return Result::Ok;
+            if (status == KWP2000Frame::Status::Error) return Result::BadFrame;
+        } else if (Clock::millis() - startMs >= limitMs) {
+            return Result::NoAnswer;
+        }
+    }
+}
+
+template <class Line, class Clock>
+typename BasicKWP2000Session<Line, Clock>::Result
+BasicKWP2000Session<Line, Clock>::request_(const uint8_t *data, uint8_t size)
+{
+    send_(data, size);
+
+    uint16_t timeoutMs = timing_.p2Max;
+    uint8_t pending = 0;
+    Result result;
+    for (;;) {
+        result = receive_(timeoutMs);
+        if (result != Result::Ok) break;
+
+        // Addressed answers must come from the ECU we asked, to us.
+        if ((rx_.format() & 0xC0)
+            && (rx_.target() != KWP2000Frame::TesterAddress || rx_.source() != ecuAddr_)) {
+            result = Result::BadFrame;
+            break;
+        }
+        if (rx_.service() == KWP2000Frame::NegativeResponse) {
+            lastNrc_ = rx_.size() >= 3 ? rx_.data()[2] : 0;
+            if (lastNrc_ == KWP2000Frame::ResponsePending && pending < MaxPending) {
+                // The real answer follows within P2*max.
+                ++pending;
+                timeoutMs = PendingTimeoutMs;
+                continue;
+            }
+            result = Result::Negative;
+        } else if (rx_.service() != static_cast<uint8_t>(data[0] + KWP2000Frame::PositiveOffset)) {
+            result = Result::BadFrame;
+        }
+        break;
+    }
+    lastResult_ = result;
+    return result;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,261 @@
+#include "KWPFormula.h"
+
+namespace obd {
+namespace KWP {
+
+namespace {
+
+enum Unit : uint8_t {
+    UnitNone, UnitRpm, UnitPercent, UnitDeg, UnitAtdc, UnitDegC, UnitVolt,
+    UnitKmh, UnitOhm, UnitMm, UnitBar, UnitMs, UnitMbar, UnitLitre, UnitAmp,
+    UnitGs, UnitDegKw, UnitKw, UnitLh, UnitKm, UnitAdp, UnitMgh, UnitAh,
+    UnitClock, UnitNm, UnitCount, UnitWsc, UnitSec, UnitSiemens, UnitDegS,
+    UnitMs2, UnitWarm, UnitCold
+};
+
+// "\xDF" is the degree sign in the HD44780 character ROM.
+const char UNITS[][8] PROGMEM = {
+    "", "rpm", "%", "Deg", "ATDC", "\xDF" "C", "V",
+    "km/h", "Ohm", "mm", "bar", "ms", "mbar", "l", "A",
+    "g/s", "Deg k/w", "kW", "l/h", "km", "ADP", "mg/h", "Ah",
+    "hhmm", "Nm", "count", "WSC", "s", "S", "deg/s",
+    "m/s^2", "WARM", "COLD"
+};
+const uint8_t UNIT_COUNT = sizeof(UNITS) / sizeof(UNITS[0]);
+
+// How the operand x is formed from a and b.
+enum Op : uint8_t {
+    OpAB,        // a * (b + bias)
+    OpAAbsB,     // a * |b + bias|
+    OpABPlus,    // a * b + bias
+    OpAPlusB,    // a + b
+    OpBMinusA,   // b - a
+    OpB,         // b + bias
+    OpWord,      // 256 * a + b
+    OpWordHigh,  // 65536 + 256 * a + b
+    OpA255B,     // 255 * a + b
+    OpBOverA,    // (b + bias) / a, mul applied before the division
+    // Formulas that do not fit x * num / den + offset
+    OpWarmCold,
+    OpClock,
+    OpMaf25,
+    OpMaf53,
+    OpAngle67,
+    OpUnknown
+};
+
+// value * 10^decimals = round(x * num / den) + offset
+//
+// num/den is stored as mul / 2^shift so that decoding is one 32-bit
+// multiply and a shift; a 32-bit division costs several hundred cycles on
+// the AVR. Fractional ratios keep mul below 2^14, so x * mul cannot
+// overflow for any 17-bit operand and the relative error stays below
+// 1e-4.
+struct Formula {
+    uint8_t op;
+    uint8_t decimals;
+    uint8_t unit;
+    uint8_t shift;
+    int16_t bias;
+    uint16_t mul;
+    int16_t offset;
+};
+
+static constexpr int64_t MaxMul = 16383;
+
+constexpr uint8_t fractionShift(int64_t num, int64_t den, uint8_t shift)
+{
+    return (shift < 30 && ((num << (shift + 1)) + den / 2) / den <= MaxMul)
+               ? fractionShift(num, den, static_cast<uint8_t>(shift + 1))
+               : shift;
+}
+
+// Whole-number ratios need no shift at all.
+constexpr uint8_t scaleShift(int64_t num, int64_t den)
+{
+    return (num % den == 0) ? 0 : fractionShift(num, den, 0);
+}
+
+constexpr uint16_t scaleMul(int64_t num, int64_t den)
+{
+    return static_cast<uint16_t>(((num << scaleShift(num, den)) + den / 2) / den);
+}
+
+#define KWP_FORMULA(op, decimals, unit, bias, num, den, offset) \
+    {op, decimals, unit, scaleShift(num, den), bias, scaleMul(num, den), offset}
+
+// Indexed by formula byte; the comment is the real-valued formula.
+const Formula FORMULAS[] PROGMEM = {
+    KWP_FORMULA(OpUnknown,  0, UnitNone,    0,     1,    1,        0), //  0
+    KWP_FORMULA(OpAB,       0, UnitRpm,     0,     1,    5,        0), //  1: 0.2*a*b
+    KWP_FORMULA(OpAB,       1, UnitPercent, 0,     1,    50,       0), //  2: 0.002*a*b
+    KWP_FORMULA(OpAB,       1, UnitDeg,     0,     1,    50,       0), //  3: 0.002*a*b
+    KWP_FORMULA(OpAAbsB,    1, UnitAtdc,    -127,  1,    10,       0), //  4: 0.01*a*|b-127|
+    KWP_FORMULA(OpAB,       1, UnitDegC,    -100,  1,    1,        0), //  5: 0.1*a*(b-100)
+    KWP_FORMULA(OpAB,       2, UnitVolt,    0,     1,    10,       0), //  6: 0.001*a*b
+    KWP_FORMULA(OpAB,       1, UnitKmh,     0,     1,    10,       0), //  7: 0.01*a*b
+    KWP_FORMULA(OpAB,       1, UnitNone,    0,     1,    1,        0), //  8: 0.1*a*b
+    KWP_FORMULA(OpAB,       1, UnitDeg,     -127,  1,    5,        0), //  9: 0.02*a*(b-127)
+    KWP_FORMULA(OpWarmCold, 0, UnitNone,    0,     1,    1,        0), // 10: b ? WARM : COLD
+    KWP_FORMULA(OpAB,       3, UnitNone,    -128,  1,    10,    1000), // 11: 0.0001*a*(b-128)+1
+    KWP_FORMULA(OpAB,       2, UnitOhm,     0,     1,    10,       0), // 12: 0.001*a*b
+    KWP_FORMULA(OpAB,       2, UnitMm,      -127,  1,    10,       0), // 13: 0.001*a*(b-127)
+    KWP_FORMULA(OpAB,       2, UnitBar,     0,     1,    2,        0), // 14: 0.005*a*b
+    KWP_FORMULA(OpAB,       1, UnitMs,      0,     1,    10,       0), // 15: 0.01*a*b
+    KWP_FORMULA(OpUnknown,  0, UnitNone,    0,     1,    1,        0), // 16
+    KWP_FORMULA(OpUnknown,  0, UnitNone,    0,     1,    1,        0), // 17
+    KWP_FORMULA(OpAB,       0, UnitMbar,    0,     1,    25,       0), // 18: 0.04*a*b
+    KWP_FORMULA(OpAB,       1, UnitLitre,   0,     1,    10,       0), // 19: 0.01*a*b
+    KWP_FORMULA(OpAB,       1, UnitPercent, -128,  5,    64,       0), // 20: a*(b-128)/128
+    KWP_FORMULA(OpAB,       2, UnitVolt,    0,     1,    10,       0), // 21: 0.001*a*b
+    KWP_FORMULA(OpAB,       2, UnitMs,      0,     1,    10,       0), // 22: 0.001*a*b
+    KWP_FORMULA(OpAB,       1, UnitPercent, 0,     5,    128,      0), // 23: a*b/256
+    KWP_FORMULA(OpAB,       2, UnitAmp,     0,     1,    10,       0), // 24: 0.001*a*b
+    KWP_FORMULA(OpMaf25,    2, UnitGs,      0,     1,    1,        0), // 25: 1.421*b + a/182
+    KWP_FORMULA(OpBMinusA,  0, UnitDegC,    0,     1,    1,        0), // 26: b-a
+    KWP_FORMULA(OpAAbsB,    1, UnitDeg,     -128,  1,    10,       0), // 27: 0.01*a*|b-128|
+    KWP_FORMULA(OpBMinusA,  0, UnitNone,    0,     1,    1,        0), // 28: b-a
+    KWP_FORMULA(OpUnknown,  0, UnitNone,    0,     1,    1,        0), // 29
+    KWP_FORMULA(OpAB,       1, UnitDegKw,   0,     5,    6,        0), // 30: a*b/12
+    KWP_FORMULA(OpAB,       1, UnitDegC,    0,     1,    256,      0), // 31: a*b/2560
+    KWP_FORMULA(OpUnknown,  0, UnitNone,    0,     1,    1,        0), // 32
+    KWP_FORMULA(OpBOverA,   1, UnitPercent, 0,     1000, 1,        0), // 33: 100*b/a
+    KWP_FORMULA(OpAB,       1, UnitKw,      -128,  1,    10,       0), // 34: 0.01*a*(b-128)
+    KWP_FORMULA(OpAB,       1, UnitLh,      0,     1,    10,       0), // 35: 0.01*a*b
+    KWP_FORMULA(OpWord,     0, UnitKm,      0,     10,   1,        0), // 36: 2560*a + 10*b
+    KWP_FORMULA(OpB,        0, UnitAdp,     0,     1,    1,        0), // 37: b
+    KWP_FORMULA(OpAB,       2, UnitDegKw,   -128,  1,    10,       0), // 38: 0.001*a*(b-128)
+    KWP_FORMULA(OpAB,       1, UnitMgh,     0,     5,    128,      0), // 39: a*b/256
+    KWP_FORMULA(OpA255B,    1, UnitAmp,     0,     1,    1,    -4000), // 40: 0.1*b + 25.5*a - 400
+    KWP_FORMULA(OpA255B,    0, UnitAh,      0,     1,    1,        0), // 41: b + 255*a
+    KWP_FORMULA(OpA255B,    1, UnitKw,      0,     1,    1,    -4000), // 42: 0.1*b + 25.5*a - 400
+    KWP_FORMULA(OpA255B,    1, UnitVolt,    0,     1,    1,        0), // 43: 0.1*b + 25.5*a
+    KWP_FORMULA(OpClock,    0, UnitClock,   0,     1,    1,        0), // 44: a:b as hhmm
+    KWP_FORMULA(OpAB,       2, UnitNone,    0,     1,    10,       0), // 45: 0.001*a*b
+    KWP_FORMULA(OpABPlus,   1, UnitDegKw,   -3200, 27,   1000,     0), // 46: 0.0027*(a*b-3200)
+    KWP_FORMULA(OpAB,       0, UnitMs,      -128,  1,    1,        0), // 47: a*(b-128)
+    KWP_FORMULA(OpA255B,    0, UnitNone,    0,     1,    1,        0), // 48: b + 255*a
+    KWP_FORMULA(OpAB,       2, UnitMgh,     0,     5,    2,        0), // 49: 0.025*a*b
+    KWP_FORMULA(OpBOverA,   0, UnitMbar,    -128,  100,  1,        0), // 50: 100*(b-128)/a
+    KWP_FORMULA(OpAB,       1, UnitMgh,     -128,  2,    51,       0), // 51: a*(b-128)/255
+    KWP_FORMULA(OpAB,       1, UnitNm,      -50,   1,    5,        0), // 52: 0.02*a*b - a
+    KWP_FORMULA(OpMaf53,    2, UnitGs,      0,     1,    1,        0), // 53: 1.4222*(b-128) + 0.006*a
+    KWP_FORMULA(OpWord,     0, UnitCount,   0,     1,    1,        0), // 54: 256*a + b
+    KWP_FORMULA(OpAB,       2, UnitSec,     0,     1,    2,        0), // 55: a*b/200
+    KWP_FORMULA(OpWord,     0, UnitWsc,     0,     1,    1,        0), // 56: 256*a + b
+    KWP_FORMULA(OpWordHigh, 0, UnitWsc,     0,     1,    1,        0), // 57: 256*a + b + 65536
+    KWP_FORMULA(OpUnknown,  0, UnitNone,    0,     1,    1,        0), // 58
+    KWP_FORMULA(OpWord,     3, UnitGs,      0,     125,  4096,     0), // 59: (256*a + b)/32768
+    KWP_FORMULA(OpWord,     2, UnitSec,     0,     1,    1,        0), // 60: 0.01*(256*a + b)
+    KWP_FORMULA(OpUnknown,  0, UnitNone,    0,     1,    1,        0), // 61
+    KWP_FORMULA(OpAB,       1, UnitSiemens, 0,     64,   25,       0), // 62: 0.256*a*b
+    KWP_FORMULA(OpUnknown,  0, UnitNone,    0,     1,    1,        0), // 63
+    KWP_FORMULA(OpAPlusB,   0, UnitOhm,     0,     1,    1,        0), // 64: a + b
+    KWP_FORMULA(OpAB,       2, UnitMm,      -127,  1,    1,        0), // 65: 0.01*a*(b-127)
+    KWP_FORMULA(OpAB,       2, UnitVolt,    0,     1250, 6389,     0), // 66: a*b/511.12
+    KWP_FORMULA(OpAngle67,  1, UnitDeg,     0,     1,    1,        0), // 67: 640*a + 2.5*b
+    KWP_FORMULA(OpWord,     1, UnitDegS,    0,     2000, 1473,     0), // 68: (256*a + b)/7.365
+    KWP_FORMULA(OpWord,     2, UnitBar,     0,     1627, 50,       0), // 69: 0.3254*(256*a + b)
+    KWP_FORMULA(OpWord,     2, UnitMs2,     0,     96,   5,        0), // 70: 0.192*(256*a + b)
+};
+const uint8_t FORMULA_COUNT = sizeof(FORMULAS) / sizeof(FORMULAS[0]);
+
+#undef KWP_FORMULA
+
+// Division rounded half away from zero; den > 0.
+int32_t divRound(int32_t num, int32_t den)
+{
+    return (num >= 0) ? (num + den / 2) / den : (num - den / 2) / den;
+}
+
+// round(x * mul / 2^shift), half away from zero.
+int32_t mulShiftRound(int32_t x, uint16_t mul, uint8_t shift)
+{
+    if (shift == 0) {
+        return x * mul;
+    }
+    const int32_t half = static_cast<int32_t>(1) << (shift - 1);
+    return (x >= 0) ? (x * mul + half) >> shift : -((-x * mul + half) >> shift);
+}
+
+} // namespace
+
+Measurement decodeMeasurement(uint8_t formula, uint8_t a, uint8_t b)
+{
+    Measurement m;
+    Formula f;
+    if (formula < FORMULA_COUNT) {
+        memcpy_P(&f, &FORMULAS[formula], sizeof(f));
+    } else {
+        f.op = OpUnknown;
+    }
+
+    const int32_t ia = a;
+    const int32_t ib = b;
+    if (f.op == OpUnknown) {
+        m.scaled = (ia << 8) + ib;
+        m.decimals = 0;
+        m.unit = UnitNone;
+        m.known = false;
+        return m;
+    }
+    m.decimals = f.decimals;
+    m.unit = f.unit;
+    m.known = true;
+
+    int32_t x = 0;
+    switch (f.op) {
+    case OpAB:       x = ia * (ib + f.bias); break;
+    case OpAAbsB: {
+        int32_t d = ib + f.bias;
+        x = ia * (d < 0 ? -d : d);
+        break;
+    }
+    case OpABPlus:   x = ia * ib + f.bias; break;
+    case OpAPlusB:   x = ia + ib; break;
+    case OpBMinusA:  x = ib - ia; break;
+    case OpB:        x = ib + f.bias; break;
+    case OpWord:     x = (ia << 8) + ib; break;
+    case OpWordHigh: x = 65536L + (ia << 8) + ib; break;
+    case OpA255B:    x = 255 * ia + ib; break;
+    case OpBOverA:
+        // mul/shift holds the numerator scale here, the divisor is a.
+        m.scaled = (a == 0) ? 0 : divRound(mulShiftRound(ib + f.bias, f.mul, f.shift), ia);
+        return m;
+    case OpWarmCold:
+        m.scaled = (b == 0) ? 0 : 1;
+        m.unit = (b == 0) ? UnitCold : UnitWarm;
+        return m;
+    case OpClock:
+        m.scaled = ia * 100 + ib;
+        return m;
+    case OpMaf25:
+        // 100 * (1.421*b + a/182)
+        m.scaled = divRound(ib * 1421, 10) + divRound(ia * 100, 182);
+        return m;
+    case OpMaf53:
+        // 100 * (1.4222*(b-128) + 0.006*a)
+        m.scaled = divRound((ib - 128) * 14222 + ia * 60, 100);
+        return m;
+    case OpAngle67:
+        // 10 * (640*a + 2.5*b)
+        m.scaled = ia * 6400 + ib * 25;
+        return m;
+    default:
+        break;
+    }
+
+    m.scaled = mulShiftRound(x, f.mul, f.shift) + f.offset;
+    return m;
+}
+
+const __FlashStringHelper *unitText(uint8_t unit)
+{
+    if (unit >= UNIT_COUNT) {
+        unit = UnitNone;
+    }
+    return reinterpret_cast<const __FlashStringHelper *>(UNITS[unit]);
+}
+
+} // namespace KWP
+} // namespace obd
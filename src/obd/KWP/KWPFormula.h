@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../Model/FixedPoint.h"
+
+namespace obd {
+namespace KWP {
+
+// One decoded (formula, a, b) measurement triplet.
+struct Measurement {
+    int32_t scaled;   // value * 10^decimals
+    uint8_t decimals;
+    uint8_t unit;     // see unitText()
+    bool known;       // false: formula byte not in the table, value is 256*a+b
+
+    int32_t whole() const { return Model::fixedWhole(scaled, decimals); }
+    float toFloat() const { return Model::fixedToFloat(scaled, decimals); }
+};
+
+// Decodes a KWP1281 measurement triplet through the PROGMEM formula table
+// (the formula set of the original firmware, all of it). Integer math
+// only. Unknown formula bytes decode to the raw 16-bit value without unit
+// so the experimental view still shows something.
+Measurement decodeMeasurement(uint8_t formula, uint8_t a, uint8_t b);
+
+// Unit label in flash, at most Model::ExperimentalGroup::UnitWidth chars.
+const __FlashStringHelper *unitText(uint8_t unit);
+
+} // namespace KWP
+} // namespace obd
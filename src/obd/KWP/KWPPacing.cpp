@@ -0,0 +1,144 @@
+#include "KWPPacing.h"
+
+namespace obd {
+namespace KWP {
+
+KWPPacing::KWPPacing()
+    : active_(0)
+    , used_(0)
+    , nextEvict_(0)
+    , calibrating_(false)
+    , minSampleUs_(0xFFFF)
+    , samples_(0)
+{
+    select(0x00, 0);
+}
+
+uint16_t KWPPacing::conservativeGapUs(uint16_t baudRate)
+{
+    // The fixed delays the firmware has always used.
+    switch (baudRate) {
+    case 1200:
+    case 2400:
+    case 4800:
+        return 15000; // For old ECUs
+    case 9600:
+        return 10000;
+    default:
+        return 5000;
+    }
+}
+
+void KWPPacing::select(uint8_t ecuAddr, uint16_t baudRate)
+{
+    for (uint8_t i = 0; i < used_; ++i) {
+        if (profiles_[i].ecuAddr == ecuAddr && profiles_[i].baudRate == baudRate) {
+            active_ = i;
+            return;
+        }
+    }
+
+    uint8_t slot;
+    if (used_ < MaxProfiles) {
+        slot = used_++;
+    } else {
+        slot = nextEvict_;
+        nextEvict_ = static_cast<uint8_t>((nextEvict_ + 1) % MaxProfiles);
+    }
+
+    const uint16_t conservative = conservativeGapUs(baudRate);
+    Profile &p = profiles_[slot];
+    p.ecuAddr = ecuAddr;
+    p.baudRate = baudRate;
+    p.targetUs = conservative;
+    p.minSafeUs = FloorUs;
+    p.gapUs = conservative;
+    p.okStreak = 0;
+    active_ = slot;
+}
+
+void KWPPacing::restore(uint16_t targetUs)
+{
+    Profile &p = profiles_[active_];
+    const uint16_t conservative = conservativeGapUs(p.baudRate);
+    if (targetUs < p.minSafeUs) targetUs = p.minSafeUs;
+    if (targetUs > conservative) targetUs = conservative;
+    p.targetUs = targetUs;
+    p.gapUs = targetUs;
+    p.okStreak = 0;
+}
+
+void KWPPacing::beginCalibration()
+{
+    calibrating_ = true;
+    minSampleUs_ = 0xFFFF;
+    samples_ = 0;
+}
+
+void KWPPacing::addTurnaroundSample(uint32_t turnaroundUs)
+{
+    if (!calibrating_) return;
+    if (turnaroundUs < minSampleUs_) {
+        minSampleUs_ = turnaroundUs > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(turnaroundUs);
+    }
+    if (samples_ < 0xFF) ++samples_;
+}
+
+void KWPPacing::endCalibration()
+{
+    calibrating_ = false;
+    Profile &p = profiles_[active_];
+    const uint16_t conservative = conservativeGapUs(p.baudRate);
+
+    // Too few samples to judge the ECU: stay with what we had.
+    if (samples_ < 4) {
+        return;
+    }
+
+    // The ECU is ready to listen about as quickly as it answers; keep a
+    // 25 % margin on its fastest observed turnaround.
+    uint32_t target = static_cast<uint32_t>(minSampleUs_) + minSampleUs_ / 4;
+    if (target < p.minSafeUs) target = p.minSafeUs;
+    if (target > conservative) target = conservative;
+
+    p.targetUs = static_cast<uint16_t>(target);
+    p.gapUs = p.targetUs;
+    p.okStreak = 0;
+}
+
+void KWPPacing::onBlockOk()
+{
+    Profile &p = profiles_[active_];
+    if (p.gapUs <= p.targetUs) return;
+
+    if (++p.okStreak >= RecoverAfterBlocks) {
+        p.gapUs = static_cast<uint16_t>(p.gapUs - (p.gapUs - p.targetUs) / 2);
+        p.okStreak = 0;
+    }
+}
+
+void KWPPacing::onError()
+{
+    Profile &p = profiles_[active_];
+    const uint16_t conservative = conservativeGapUs(p.baudRate);
+
+    uint32_t doubled = static_cast<uint32_t>(p.gapUs) * 2;
+    if (doubled > conservative) doubled = conservative;
+
+    if (doubled > p.minSafeUs) p.minSafeUs = static_cast<uint16_t>(doubled);
+    if (p.targetUs < p.minSafeUs) p.targetUs = p.minSafeUs;
+    p.gapUs = static_cast<uint16_t>(doubled);
+    p.okStreak = 0;
+}
+
+uint16_t KWPPacing::gapUs() const
+{
+    // The connect phase always runs with the proven fixed timing.
+    if (calibrating_) {
+        return conservativeGapUs(profiles_[active_].baudRate);
+    }
+    return profiles_[active_].gapUs;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace KWP {
+
+// Inter-byte pacing for the tester side of KWP1281.
+//
+// The original firmware waited a fixed 5/10/15 ms before every byte. This
+// engine starts from those conservative values, measures how fast the ECU
+// turns a byte around while the connect blocks are exchanged, and then
+// uses the smallest gap that ECU has shown it can handle. Profiles are
+// kept per (ECU address, baud rate). Any line error doubles the gap and
+// raises the profile's known-safe minimum, so a too-eager gap is only
+// ever tried once.
+class KWPPacing {
+public:
+    static constexpr uint8_t MaxProfiles = 4;
+    // Never go below this, whatever the ECU turnaround looks like.
+    static constexpr uint16_t FloorUs = 1000;
+    // Consecutive good blocks before a backed-off gap is tightened again.
+    static constexpr uint8_t RecoverAfterBlocks = 16;
+
+    KWPPacing();
+
+    static uint16_t conservativeGapUs(uint16_t baudRate);
+
+    void select(uint8_t ecuAddr, uint16_t baudRate);
+
+    // Takes over a target learned in an earlier session (see
+    // IdentityCache) instead of calibrating again.
+    void restore(uint16_t targetUs);
+    void beginCalibration();
+    void addTurnaroundSample(uint32_t turnaroundUs);
+    void endCalibration();
+    bool calibrating() const { return calibrating_; }
+
+    void onBlockOk();
+    void onError();
+
+    uint16_t gapUs() const;
+    uint16_t targetUs() const { return profiles_[active_].targetUs; }
+
+private:
+    struct Profile {
+        uint8_t ecuAddr;
+        uint16_t baudRate;
+        uint16_t targetUs;  // smallest gap believed safe
+        uint16_t minSafeUs; // raised whenever a gap caused an error
+        uint16_t gapUs;     // gap currently in use
+        uint8_t okStreak;
+    };
+
+    Profile profiles_[MaxProfiles];
+    uint8_t active_;
+    uint8_t used_;
+    uint8_t nextEvict_;
+
+    bool calibrating_;
+    uint16_t minSampleUs_;
+    uint8_t samples_;
+};
+
+} // namespace KWP
+} // namespace obd
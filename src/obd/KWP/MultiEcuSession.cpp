@@ -0,0 +1,265 @@
+#include "MultiEcuSession.h"
+#include "ScreenGroups.h"
+
+namespace obd {
+namespace KWP {
+
+MultiEcuSession::MultiEcuSession(KWP1281Session &kwp)
+    : kwp_(kwp)
+    , slots_()
+    , count_(0)
+    , foreground_(NoEcu)
+    , foregroundMoved_(false)
+    , state_(State::Idle)
+    , active_(NoEcu)
+    , sliceStartMs_(0)
+    , sliceReads_(0)
+    , quietFromMs_(0)
+    , quietMs_(0)
+    , switchStartMs_(0)
+    , switches_(0)
+    , lastSwitchMs_(0)
+    , failures_(0)
+{
+}
+
+void MultiEcuSession::reset()
+{
+    state_ = State::Idle;
+    active_ = NoEcu;
+    foregroundMoved_ = false;
+}
+
+void MultiEcuSession::clear()
+{
+    reset();
+    count_ = 0;
+    foreground_ = NoEcu;
+}
+
+bool MultiEcuSession::addEcu(uint8_t ecuAddr)
+{
+    if (count_ >= MaxEcus || find_(ecuAddr) >= 0) return false;
+    Slot &slot = slots_[count_++];
+    slot.addr = ecuAddr;
+    slot.baudRate = 0;
+    slot.failed = false;
+    slot.failedAtMs = 0;
+    slot.scheduler.clear();
+    return true;
+}
+
+int8_t MultiEcuSession::find_(uint8_t ecuAddr) const
+{
+    for (uint8_t i = 0; i < count_; ++i) {
+        if (slots_[i].addr == ecuAddr) return static_cast<int8_t>(i);
+    }
+    return -1;
+}
+
+void MultiEcuSession::plan(uint8_t ecuAddr, Display::MenuId menu, uint8_t screen,
+                           uint8_t screenCount)
+{
+    const int8_t i = find_(ecuAddr);
+    if (i < 0) return;
+    planScreenGroups(ecuAddr, menu, screen, screenCount, slots_[i].scheduler);
+}
+
+void MultiEcuSession::unplan(uint8_t ecuAddr)
+{
+    const int8_t i = find_(ecuAddr);
+    if (i >= 0) slots_[i].scheduler.clear();
+}
+
+void MultiEcuSession::setForeground(uint8_t ecuAddr)
+{
+    const int8_t i = find_(ecuAddr);
+    const uint8_t slot = i >= 0 ? static_cast<uint8_t>(i) : NoEcu;
+    if (slot == foreground_) return;
+    foreground_ = slot;
+    foregroundMoved_ = slot != NoEcu;
+}
+
+uint8_t MultiEcuSession::activeAddress() const
+{
+    return state_ == State::Reading ? slots_[active_].addr : 0;
+}
+
+// Whether the ECU in `slot` may have the line: it answered its last init,
+// or that was long enough ago to try again.
+bool MultiEcuSession::ready_(uint8_t slot, uint32_t nowMs) const
+{
+    if (slot >= count_) return false;
+    return !slots_[slot].failed || nowMs - slots_[slot].failedAtMs >= ForegroundSliceMs;
+}
+
+// The ECU after `after` (in the order they were added) that is not the
+// foreground one and has something planned; NoEcu if there is none.
+uint8_t MultiEcuSession::nextBackground_(uint8_t after, uint32_t nowMs) const
+{
+    for (uint8_t n = 1; n <= count_; ++n) {
+        const uint8_t i = static_cast<uint8_t>((after + n) % count_);
+        if (i != foreground_ && slots_[i].scheduler.size() > 0 && ready_(i, nowMs)) return i;
+    }
+    return NoEcu;
+}
+
+// Which ECU should have the line now.
+uint8_t MultiEcuSession::wanted_(uint32_t nowMs) const
+{
+    if (!ready_(foreground_, nowMs)) {
+        // Nothing on screen belongs to an ECU that answers: no reason to
+        // switch.
+        if (active_ != NoEcu) return active_;
+        for (uint8_t i = 0; i < count_; ++i) {
+            if (ready_(i, nowMs)) return i;
+        }
+        return NoEcu;
+    }
+    if (active_ == NoEcu) return foreground_;
+
+    if (active_ != foreground_) {
+        // A background visit lasts one round of its groups, unless the
+        // user has just moved to a screen of another ECU.
+        if (foregroundMoved_) return foreground_;
+        if (sliceReads_ < slots_[active_].scheduler.size()
+            && nowMs - sliceStartMs_ < BackgroundSliceMs) {
+            return active_;
+        }
+        const uint8_t next = nextBackground_(active_, nowMs);
+        return (next != NoEcu && next > active_) ? next : foreground_;
+    }
+
+    if (nowMs - sliceStartMs_ < ForegroundSliceMs) return foreground_;
+    const uint8_t next = nextBackground_(foreground_, nowMs);
+    return next != NoEcu ? next : foreground_;
+}
+
+void MultiEcuSession::leave_(uint16_t quietMs, uint8_t next)
+{
+    state_ = State::Quiet;
+    quietFromMs_ = millis();
+    quietMs_ = quietMs;
+    active_ = next;
+}
+
+void MultiEcuSession::lost()
+{
+    if (state_ != State::Reading) return;
+    kwp_.disconnect();
+    ++failures_;
+    switchStartMs_ = millis();
+    leave_(LostQuietMs, active_);
+}
+
+bool MultiEcuSession::settle(Model::OBDSignals &signals)
+{
+    if (state_ != State::Reading) return false;
+    if (!kwp_.completePending(signals)) {
+        lost();
+        return false;
+    }
+    return true;
+}
+
+PollStatus MultiEcuSession::poll(Model::OBDSignals &signals)
+{
+    switch (state_) {
+    case State::Idle: {
+        const uint8_t next = wanted_(millis());
+        if (next == NoEcu) return PollStatus::Idle;
+        // The first init waits for a quiet line like any other.
+        switchStartMs_ = millis();
+        leave_(ExitQuietMs, next);
+        return PollStatus::Busy;
+    }
+    case State::Quiet:
+        if (millis() - quietFromMs_ < quietMs_) return PollStatus::Busy;
+        kwp_.startConnect(slots_[active_].baudRate, slots_[active_].addr);
+        state_ = State::Connect;
+        return PollStatus::Busy;
+    case State::Connect: {
+        const PollStatus status = kwp_.poll(signals);
+        if (status == PollStatus::Busy) return PollStatus::Busy;
+        if (status == PollStatus::Done && kwp_.finishConnect()) {
+            slots_[active_].baudRate = kwp_.baudRate();
+            slots_[active_].failed = false;
+            state_ = State::Reading;
+            sliceStartMs_ = millis();
+            sliceReads_ = 0;
+            if (active_ == foreground_) foregroundMoved_ = false;
+            ++switches_;
+            lastSwitchMs_ = sliceStartMs_ - switchStartMs_;
+            return PollStatus::Done;
+        }
+        // An ECU that does not answer should not hold the others up: the
+        // next one gets its turn, after the timeout of the one that may
+        // have half heard us.
+        kwp_.disconnect();
+        ++failures_;
+        const uint32_t now = millis();
+        slots_[active_].failed = true;
+        slots_[active_].failedAtMs = now;
+        if (active_ == foreground_) foregroundMoved_ = false;
+        active_ = NoEcu;
+        const uint8_t next = wanted_(now);
+        if (next == NoEcu) {
+            state_ = State::Idle;
+        } else {
+            switchStartMs_ = now;
+            leave_(LostQuietMs, next);
+        }
+        return PollStatus::Error;
+    }
+    case State::Reading:
+    default:
+        return read_(signals);
+    }
+}
+
+PollStatus MultiEcuSession::read_(Model::OBDSignals &signals)
+{
+    PollStatus status = kwp_.poll(signals);
+    if (status == PollStatus::Busy || status == PollStatus::Done) {
+        return status;
+    }
+    if (status == PollStatus::Error) {
+        if (kwp_.resume()) return PollStatus::Busy;
+        lost();
+        return PollStatus::Error;
+    }
+
+    const uint32_t now = millis();
+    const uint8_t next = wanted_(now);
+    if (next != active_) {
+        // End Output: the ECU lets go now, not after its timeout.
+        switchStartMs_ = now;
+        kwp_.exitSession();
+        kwp_.disconnect();
+        leave_(ExitQuietMs, next);
+        return PollStatus::Busy;
+    }
+
+    GroupScheduler &scheduler = slots_[active_].scheduler;
+    uint8_t group = 0;
+    bool started = false;
+    if (scheduler.next(now, group)) {
+        ++sliceReads_;
+        started = kwp_.startGroupRead(group, signals);
+    } else {
+        // Nothing due: a background visit has had its round.
+        sliceReads_ = scheduler.size();
+    }
+    if (!started && kwp_.keepAliveDue()) {
+        // As on a single ECU: a group read early beats an empty ACK.
+        started = scheduler.nextSoonest(now, group) && kwp_.startGroupRead(group, signals);
+        if (!started) {
+            kwp_.startKeepAlive();
+        }
+        return PollStatus::Busy;
+    }
+    return started ? PollStatus::Busy : PollStatus::Idle;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <Arduino.h>
+#include "GroupScheduler.h"
+#include "KWP1281Session.h"
+#include "../Display/DisplayTypes.h"
+#include "../Model/OBDSignals.h"
+
+namespace obd {
+namespace KWP {
+
+// Keeps more than one ECU (engine 0x01 and instruments 0x17) on the
+// dashboard by time-slicing the one K-line session between them.
+//
+// KWP1281 talks to one ECU at a time, so switching means ending the
+// session and a new 5-baud init. The switch here is the shortest one the
+// protocol allows: an End Output block (the ECU drops the session at
+// once instead of after its 1.1 s timeout), W5 of quiet line, then the
+// address of the next ECU, at the baud rate it answered with last time.
+// The session's EEPROM caches are kept per ECU (learned pacing and
+// identity per address, refused groups, group map per identity), so
+// after the first visit each switch only costs the init and the
+// identification blocks.
+//
+// Each ECU has its own GroupScheduler, planned for what the LCD shows
+// (see plan()). The ECU the visible screen belongs to holds the line for
+// ForegroundSliceMs at a time; then every other ECU with anything
+// planned gets one round of its groups (or BackgroundSliceMs) before
+// the line goes back. A screen that belongs to no ECU (Debug, DTC,
+// Settings) makes no switches. An ECU that did not answer its init is
+// left alone for ForegroundSliceMs, as if it had nothing planned. All
+// ECUs decode into the same OBDSignals.
+class MultiEcuSession {
+public:
+    static constexpr uint8_t MaxEcus = 2;
+    static constexpr uint8_t NoEcu = 0xFF;
+    // Line idle after the End Output block (W5) before the next address,
+    // and after a lost session (the ECU's own timeout, as it never saw
+    // an End Output).
+    static constexpr uint16_t ExitQuietMs = 300;
+    static constexpr uint16_t LostQuietMs = 1300;
+    static constexpr uint16_t ForegroundSliceMs = 20000;
+    static constexpr uint16_t BackgroundSliceMs = 3000;
+
+    explicit MultiEcuSession(KWP1281Session &kwp);
+
+    // Forgets the session state (after the caller ended or lost the
+    // session itself); the next poll() starts over with a connect.
+    void reset();
+    // The same, and drops every ECU.
+    void clear();
+    // Adds an ECU; its baud rate is detected at its first connect.
+    bool addEcu(uint8_t ecuAddr);
+    uint8_t ecuCount() const { return count_; }
+    uint8_t ecuAddress(uint8_t index) const { return slots_[index].addr; }
+
+    // Plans an ECU's groups for the screen it is shown on (see
+    // planScreenGroups()); unplan() leaves it off the bus.
+    void plan(uint8_t ecuAddr, Display::MenuId menu, uint8_t screen, uint8_t screenCount);
+    void unplan(uint8_t ecuAddr);
+    const GroupScheduler &scheduler(uint8_t index) const { return slots_[index].scheduler; }
+    // The ECU the visible screen belongs to (0 for none). Moving it to
+    // another ECU switches there as soon as the exchange in flight is
+    // over.
+    void setForeground(uint8_t ecuAddr);
+
+    // One step from the main loop: moves the exchange in flight on,
+    // starts the next group read or keep-alive, or works through a
+    // switch. Returns Busy while either is under way, Done when an
+    // exchange or a connect finished, Error when a connect failed or the
+    // session was lost (the next ECU is then tried by itself after the
+    // ECU's timeout) and Idle when there is nothing to do, or no ECU to
+    // try. Blocks only
+    // where the session does: the exit block and the connect blocks
+    // after the address init.
+    PollStatus poll(Model::OBDSignals &signals);
+
+    // The ECU the session is connected to, 0 while switching.
+    uint8_t activeAddress() const;
+    bool switching() const { return state_ != State::Reading; }
+    // Runs the exchange in flight to completion, for the blocking
+    // exchanges (DTCs, group scan) on the active ECU. False while
+    // switching, or if the session was lost on the way.
+    bool settle(Model::OBDSignals &signals);
+    // The caller lost the session in a blocking exchange: connect again
+    // after the ECU's timeout.
+    void lost();
+
+    uint16_t switches() const { return switches_; }
+    // Line time of the last switch, from the exit block to the end of
+    // the connect.
+    uint32_t lastSwitchMs() const { return lastSwitchMs_; }
+    uint16_t failures() const { return failures_; }
+
+private:
+    enum class State : uint8_t {
+        Idle,      // no session, next ECU not chosen yet
+        Quiet,     // waiting for the line to be free for the next init
+        Connect,   // 5-baud address init of the next ECU in progress
+        Reading    // connected to slots_[active_]
+    };
+
+    struct Slot {
+        uint8_t addr;
+        uint16_t baudRate;     // 0 until the first connect measured it
+        bool failed;           // last connect got no answer...
+        uint32_t failedAtMs;   // ...at this time
+        GroupScheduler scheduler;
+    };
+
+    KWP1281Session &kwp_;
+    Slot slots_[MaxEcus];
+    uint8_t count_;
+    uint8_t foreground_;     // slot of the visible screen's ECU, or NoEcu
+    bool foregroundMoved_;   // since the last switch
+    State state_;
+    uint8_t active_;         // slot connected (Reading) or being connected
+    uint32_t sliceStartMs_;
+    uint8_t sliceReads_;     // groups handed out this slice
+    uint32_t quietFromMs_;
+    uint16_t quietMs_;
+    uint32_t switchStartMs_;
+    uint16_t switches_;
+    uint32_t lastSwitchMs_;
+    uint16_t failures_;
+
+    int8_t find_(uint8_t ecuAddr) const;
+    bool ready_(uint8_t slot, uint32_t nowMs) const;
+    uint8_t wanted_(uint32_t nowMs) const;
+    uint8_t nextBackground_(uint8_t after, uint32_t nowMs) const;
+    void leave_(uint16_t quietMs, uint8_t next);
+    PollStatus read_(Model::OBDSignals &signals);
+};
+
+} // namespace KWP
+} // namespace obd
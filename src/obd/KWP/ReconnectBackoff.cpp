@@ -0,0 +1,49 @@
+#include "ReconnectBackoff.h"
+
+namespace obd {
+namespace KWP {
+
+ReconnectBackoff::ReconnectBackoff()
+    : active_(false)
+    , attempt_(0)
+    , delayMs_(0)
+    , dueMs_(0)
+{
+}
+
+void ReconnectBackoff::start(uint32_t nowMs)
+{
+    active_ = true;
+    attempt_ = 1;
+    delayMs_ = FirstDelayMs;
+    dueMs_ = nowMs + delayMs_;
+}
+
+bool ReconnectBackoff::failed(uint32_t nowMs)
+{
+    if (!active_ || attempt_ >= MaxAttempts) {
+        reset();
+        return false;
+    }
+    ++attempt_;
+    delayMs_ = (delayMs_ >= MaxDelayMs / 2) ? MaxDelayMs
+                                            : static_cast<uint16_t>(delayMs_ * 2);
+    dueMs_ = nowMs + delayMs_;
+    return true;
+}
+
+void ReconnectBackoff::reset()
+{
+    active_ = false;
+    attempt_ = 0;
+    delayMs_ = 0;
+}
+
+bool ReconnectBackoff::due(uint32_t nowMs) const
+{
+    // Unsigned subtraction keeps this right across millis() wrap.
+    return active_ && static_cast<int32_t>(nowMs - dueMs_) >= 0;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace KWP {
+
+// When to connect again after a session was lost and could not be
+// resumed (see KWP1281Session::resume()).
+//
+// The first attempt waits out the ECU's own session timeout, so it is
+// ready for a new 5-baud init; every failed attempt doubles the wait up
+// to MaxDelayMs. After MaxAttempts failures the caller gives up and goes
+// back to asking the user.
+class ReconnectBackoff {
+public:
+    static constexpr uint16_t FirstDelayMs = 1300;
+    static constexpr uint16_t MaxDelayMs = 16000;
+    static constexpr uint8_t MaxAttempts = 5;
+
+    ReconnectBackoff();
+
+    // Session lost at nowMs: schedules the first attempt.
+    void start(uint32_t nowMs);
+    // An attempt failed at nowMs: schedules the next one. Returns false,
+    // and stops, once MaxAttempts have failed.
+    bool failed(uint32_t nowMs);
+    void reset();
+
+    bool active() const { return active_; }
+    bool due(uint32_t nowMs) const;
+    uint8_t attempt() const { return attempt_; }   // 1-based, next to run
+    uint16_t delayMs() const { return delayMs_; }
+
+private:
+    bool active_;
+    uint8_t attempt_;
+    uint16_t delayMs_;
+    uint32_t dueMs_;
+};
+
+} // namespace KWP
+} // namespace obd
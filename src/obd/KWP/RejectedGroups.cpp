@@ -0,0 +1,98 @@
+#include "RejectedGroups.h"
+#include "EepromLayout.h"
+#include <EEPROM.h>
+
+namespace obd {
+namespace KWP {
+
+RejectedGroups::RejectedGroups(uint16_t eepromBase)
+    : base_(eepromBase)
+    , slot_(NoSlot)
+{
+}
+
+uint16_t RejectedGroups::slotAddr_(uint8_t slot) const
+{
+    return static_cast<uint16_t>(base_ + 2 + slot * SlotBytes);
+}
+
+void RejectedGroups::format_()
+{
+    for (uint8_t i = 0; i < MaxEcus; ++i) {
+        uint16_t addr = slotAddr_(i);
+        for (uint8_t j = 0; j < SlotBytes; ++j) {
+            EEPROM.update(addr + j, 0xFF);
+        }
+    }
+    EEPROM.update(base_ + 1, 0);
+    EEPROM.update(base_, EepromLayout::RejectedGroupsVersion);
+}
+
+void RejectedGroups::select(uint8_t ecuAddr)
+{
+    if (EEPROM.read(base_) != EepromLayout::RejectedGroupsVersion) {
+        format_();
+    }
+
+    uint8_t slot = NoSlot;
+    for (uint8_t i = 0; i < MaxEcus; ++i) {
+        uint8_t tag = EEPROM.read(slotAddr_(i));
+        if (tag == ecuAddr) {
+            slot_ = i;
+            return;
+        }
+        if (tag == FreeTag && slot == NoSlot) {
+            slot = i;
+        }
+    }
+
+    if (slot == NoSlot) {
+        slot = static_cast<uint8_t>(EEPROM.read(base_ + 1) % MaxEcus);
+        EEPROM.update(base_ + 1, static_cast<uint8_t>((slot + 1) % MaxEcus));
+    }
+    slot_ = slot;
+    // Tag last, after the map is blank, so a reset in between leaves
+    // either the old owner or an empty map behind.
+    clear();
+    EEPROM.update(slotAddr_(slot_), ecuAddr);
+}
+
+bool RejectedGroups::rejected(uint8_t group) const
+{
+    if (slot_ == NoSlot) return false;
+    uint8_t bits = EEPROM.read(slotAddr_(slot_) + 1 + (group >> 3));
+    return (bits & (1 << (group & 7))) == 0;
+}
+
+void RejectedGroups::markRejected(uint8_t group)
+{
+    if (slot_ == NoSlot) return;
+    uint16_t addr = slotAddr_(slot_) + 1 + (group >> 3);
+    EEPROM.update(addr, static_cast<uint8_t>(EEPROM.read(addr) & ~(1 << (group & 7))));
+}
+
+void RejectedGroups::clear()
+{
+    if (slot_ == NoSlot) return;
+    uint16_t addr = slotAddr_(slot_) + 1;
+    for (uint8_t j = 0; j < MapBytes; ++j) {
+        EEPROM.update(addr + j, 0xFF);
+    }
+}
+
+uint16_t RejectedGroups::count() const
+{
+    if (slot_ == NoSlot) return 0;
+    uint16_t n = 0;
+    uint16_t addr = slotAddr_(slot_) + 1;
+    for (uint8_t j = 0; j < MapBytes; ++j) {
+        uint8_t bits = static_cast<uint8_t>(~EEPROM.read(addr + j));
+        for (; bits != 0; bits &= static_cast<uint8_t>(bits - 1)) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace KWP {
+
+// Measurement groups an ECU has refused, remembered in EEPROM.
+//
+// Asking for a group the ECU does not have costs a full block exchange
+// (and used to cost a two second back-off on the engine ECU), so a
+// refused group is recorded once and later requests for it are answered
+// locally. One 256-bit map per ECU address, MaxEcus of them; a bit reads
+// 0 when the group was refused, so a freshly erased EEPROM means
+// "nothing refused" and claiming a slot writes a single byte.
+class RejectedGroups {
+public:
+    static constexpr uint8_t MaxEcus = 4;
+    static constexpr uint8_t MapBytes = 32;
+    static constexpr uint8_t SlotBytes = 1 + MapBytes; // address + map
+    // version byte, next slot to reuse, slots
+    static constexpr uint16_t RegionBytes = 2 + MaxEcus * SlotBytes;
+
+    explicit RejectedGroups(uint16_t eepromBase);
+
+    // Switches to the map of ecuAddr, claiming a slot if it has none
+    // (the least recently claimed one is reused when all are taken).
+    void select(uint8_t ecuAddr);
+
+    bool rejected(uint8_t group) const;
+    void markRejected(uint8_t group);
+    // Forgets every refused group of the selected ECU.
+    void clear();
+    uint16_t count() const;
+
+private:
+    static constexpr uint8_t NoSlot = 0xFF;
+    static constexpr uint8_t FreeTag = 0xFF;
+
+    uint16_t base_;
+    uint8_t slot_;
+
+    uint16_t slotAddr_(uint8_t slot) const;
+    void format_();
+};
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,101 @@
+#include "ScreenGroups.h"
+
+namespace obd {
+namespace KWP {
+
+using Display::MenuId;
+
+namespace {
+
+struct ScreenGroup {
+    uint8_t addr;
+    MenuId menu;
+    uint8_t screen;
+    uint8_t group;
+    uint16_t periodMs;
+};
+
+// See DisplayManager::displayMenuCockpit() for what each screen shows and
+// the BINDINGS table in SignalBindings.cpp for where each value comes from.
+const ScreenGroup SCREEN_GROUPS[] PROGMEM = {
+    // ADDR_INSTRUMENTS
+    {0x17, MenuId::Cockpit, 0, 1, RateFast},     // speed, rpm
+    {0x17, MenuId::Cockpit, 0, 3, RateTempMs},   // coolant, oil temp
+    {0x17, MenuId::Cockpit, 0, 2, RateTripMs},   // fuel level
+    {0x17, MenuId::Cockpit, 1, 1, RateStatusMs}, // oil pressure
+    {0x17, MenuId::Cockpit, 1, 3, RateStatusMs}, // oil level
+    {0x17, MenuId::Cockpit, 1, 2, RateTempMs},   // ambient, odometer, fuel sender
+    {0x17, MenuId::Cockpit, 2, 1, RateStatusMs}, // ECU time
+    {0x17, MenuId::Cockpit, 2, 2, RateTripMs},   // l/100km
+    {0x17, MenuId::Cockpit, 3, 2, RateTripMs},   // km since start
+    {0x17, MenuId::Cockpit, 4, 2, RateTripMs},   // fuel burned, l/h
+    // ADDR_ENGINE
+    {0x01, MenuId::Cockpit, 0, 3, RateFast},     // throttle angle
+    {0x01, MenuId::Cockpit, 0, 4, RateStatusMs}, // voltage
+    {0x01, MenuId::Cockpit, 1, 6, RateFast},     // engine load
+    {0x01, MenuId::Cockpit, 1, 3, RateFast},     // steering angle
+    {0x01, MenuId::Cockpit, 2, 6, RateFast},     // lambda 2
+    {0x01, MenuId::Cockpit, 3, 3, RateFast},     // pressure
+    {0x01, MenuId::Cockpit, 4, 4, RateTempMs},   // temperatures
+};
+const uint8_t SCREEN_GROUP_COUNT = sizeof(SCREEN_GROUPS) / sizeof(SCREEN_GROUPS[0]);
+
+// Used for addresses without a table entry: the old fixed 1..3 loop.
+const uint8_t LEGACY_GROUP_FIRST = 1;
+const uint8_t LEGACY_GROUP_LAST = 3;
+
+// Adds the groups of one screen, every period no tighter than minPeriodMs.
+// Returns whether the address has any entries at all.
+bool addScreen(uint8_t ecuAddr, MenuId menu, uint8_t screen, uint16_t minPeriodMs,
+               GroupScheduler &scheduler)
+{
+    bool known = false;
+    for (uint8_t i = 0; i < SCREEN_GROUP_COUNT; ++i) {
+        ScreenGroup row;
+        memcpy_P(&row, &SCREEN_GROUPS[i], sizeof(row));
+        if (row.addr != ecuAddr) {
+            continue;
+        }
+        known = true;
+        if (row.menu == menu && row.screen == screen) {
+            scheduler.request(row.group, row.periodMs > minPeriodMs ? row.periodMs : minPeriodMs);
+        }
+    }
+    return known;
+}
+
+} // namespace
+
+bool planScreenGroups(uint8_t ecuAddr, MenuId menu, uint8_t screen,
+                      uint8_t screenCount, GroupScheduler &scheduler)
+{
+    scheduler.clear();
+
+    if (menu == MenuId::Experimental) {
+        // The experimental view shows the raw triplets of its group.
+        if (screen != 0) {
+            scheduler.request(screen, RateFast);
+        }
+        return true;
+    }
+
+    // Visible screen first, so its groups are read first after a switch.
+    if (!addScreen(ecuAddr, menu, screen, RateFast, scheduler)) {
+        for (uint8_t g = LEGACY_GROUP_FIRST; g <= LEGACY_GROUP_LAST; ++g) {
+            scheduler.request(g, RateFast);
+        }
+        return false;
+    }
+
+    if (screenCount > 1) {
+        uint8_t prev = (screen == 0) ? static_cast<uint8_t>(screenCount - 1)
+                                     : static_cast<uint8_t>(screen - 1);
+        uint8_t next = (screen + 1 >= screenCount) ? 0 : static_cast<uint8_t>(screen + 1);
+        addScreen(ecuAddr, menu, next, RatePrefetchMs, scheduler);
+        addScreen(ecuAddr, menu, prev, RatePrefetchMs, scheduler);
+    }
+    return true;
+}
+
+} // namespace KWP
+} // namespace obd
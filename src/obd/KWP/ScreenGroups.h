@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../Display/DisplayTypes.h"
+#include "GroupScheduler.h"
+
+namespace obd {
+namespace KWP {
+
+// Which measurement groups feed which (menu, screen), and how fresh
+// each one has to be there.
+//
+// planScreenGroups() fills the scheduler with the groups of the screen
+// being shown, plus the groups of its neighbours (the screens one button
+// press away) at a low prefetch rate so they come up with recent values.
+// Everything else is left off the bus. Menus that show no ECU values
+// (Debug, DTC, Settings) get an empty plan, so the session only sends
+// keep-alives there.
+static constexpr uint16_t RateFast = GroupScheduler::AsFastAsPossible;
+static constexpr uint16_t RateStatusMs = 1000;
+static constexpr uint16_t RateTempMs = 3000;
+static constexpr uint16_t RatePrefetchMs = 5000;
+static constexpr uint16_t RateTripMs = 10000;
+
+// screenCount is the number of screens in the menu (for wrap-around of
+// the neighbours). Returns false if the address has no table entries;
+// the scheduler then holds the old fixed groups 1..3.
+bool planScreenGroups(uint8_t ecuAddr, Display::MenuId menu, uint8_t screen,
+                      uint8_t screenCount, GroupScheduler &scheduler);
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,116 @@
+#include "SignalBindings.h"
+
+#include <stddef.h>
+
+namespace obd {
+namespace KWP {
+
+using Model::OBDSignals;
+
+namespace {
+
+enum FieldType : uint8_t {
+    TypeU8,
+    TypeI8,
+    TypeU16,
+    TypeU32,
+    TypeFloat
+};
+
+struct SignalBinding {
+    uint8_t ecu;
+    uint8_t group;
+    uint8_t idx;
+    uint8_t type;
+    uint8_t value;   // offset of the field in OBDSignals
+    uint8_t updated; // offset of its ...Updated flag
+};
+
+// offsetof() on the nested member; OBDSignals is standard layout.
+#define SIGNAL_BINDING(ecu, group, idx, type, field)                  \
+    {ecu, group, idx, type, static_cast<uint8_t>(offsetof(OBDSignals, field)), \
+     static_cast<uint8_t>(offsetof(OBDSignals, field##Updated))}
+
+// From the label files of the original sketch.
+const SignalBinding BINDINGS[] PROGMEM = {
+    // ADDR_INSTRUMENTS
+    SIGNAL_BINDING(0x17, 1, 0, TypeU16,   instruments.vehicleSpeed),
+    SIGNAL_BINDING(0x17, 1, 1, TypeU16,   instruments.engineRpm),
+    SIGNAL_BINDING(0x17, 1, 2, TypeU16,   instruments.oilPressureMin),
+    SIGNAL_BINDING(0x17, 1, 3, TypeU32,   instruments.timeEcu),
+    SIGNAL_BINDING(0x17, 2, 0, TypeU32,   instruments.odometer),
+    SIGNAL_BINDING(0x17, 2, 1, TypeU8,    instruments.fuelLevel),
+    SIGNAL_BINDING(0x17, 2, 2, TypeU16,   instruments.fuelSensorResistance),
+    SIGNAL_BINDING(0x17, 2, 3, TypeU8,    instruments.ambientTemp),
+    SIGNAL_BINDING(0x17, 3, 0, TypeU8,    instruments.coolantTemp),
+    SIGNAL_BINDING(0x17, 3, 1, TypeU8,    instruments.oilLevelOk),
+    SIGNAL_BINDING(0x17, 3, 2, TypeU8,    instruments.oilTemp),
+    // ADDR_ENGINE
+    SIGNAL_BINDING(0x01, 1, 0, TypeU16,   instruments.engineRpm),
+    SIGNAL_BINDING(0x01, 1, 1, TypeU8,    engine.tempUnknown1),
+    SIGNAL_BINDING(0x01, 1, 2, TypeI8,    engine.lambda),
+    SIGNAL_BINDING(0x01, 3, 1, TypeU16,   engine.pressure),
+    SIGNAL_BINDING(0x01, 3, 2, TypeFloat, engine.tbAngle),
+    SIGNAL_BINDING(0x01, 3, 3, TypeFloat, engine.steeringAngle),
+    SIGNAL_BINDING(0x01, 4, 1, TypeFloat, engine.voltage),
+    SIGNAL_BINDING(0x01, 4, 2, TypeU8,    engine.tempUnknown2),
+    SIGNAL_BINDING(0x01, 4, 3, TypeU8,    engine.tempUnknown3),
+    SIGNAL_BINDING(0x01, 6, 1, TypeU16,   engine.engineLoad),
+    SIGNAL_BINDING(0x01, 6, 3, TypeI8,    engine.lambda2),
+};
+const uint8_t BINDING_COUNT = sizeof(BINDINGS) / sizeof(BINDINGS[0]);
+
+#undef SIGNAL_BINDING
+
+static_assert(offsetof(OBDSignals, engine.lambda2Updated) < 256,
+              "bound fields must sit in the first 256 bytes of OBDSignals");
+
+// Stores value into the field if it differs; returns whether it did.
+template <typename T>
+bool store(uint8_t *field, T value)
+{
+    T current;
+    memcpy(&current, field, sizeof(T));
+    if (current == value) {
+        return false;
+    }
+    memcpy(field, &value, sizeof(T));
+    return true;
+}
+
+} // namespace
+
+bool applySignalBinding(uint8_t ecuAddr, uint8_t group, uint8_t idx,
+                        const Measurement &m, OBDSignals &signals)
+{
+    for (uint8_t i = 0; i < BINDING_COUNT; ++i) {
+        const SignalBinding *row = &BINDINGS[i];
+        if (pgm_read_byte(&row->ecu) != ecuAddr || pgm_read_byte(&row->group) != group ||
+            pgm_read_byte(&row->idx) != idx) {
+            continue;
+        }
+
+        uint8_t *base = reinterpret_cast<uint8_t *>(&signals);
+        uint8_t *field = base + pgm_read_byte(&row->value);
+        // Same truncating conversions the old per-field casts did.
+        int32_t whole = m.whole();
+        bool changed = false;
+        switch (pgm_read_byte(&row->type)) {
+        case TypeU8:    changed = store<uint8_t>(field, static_cast<uint8_t>(whole)); break;
+        case TypeI8:    changed = store<int8_t>(field, static_cast<int8_t>(whole)); break;
+        case TypeU16:   changed = store<uint16_t>(field, static_cast<uint16_t>(whole)); break;
+        case TypeU32:   changed = store<uint32_t>(field, static_cast<uint32_t>(whole)); break;
+        case TypeFloat: changed = store<float>(field, m.toFloat()); break;
+        default: break;
+        }
+        if (changed) {
+            const bool updated = true;
+            memcpy(base + pgm_read_byte(&row->updated), &updated, sizeof(updated));
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Arduino.h>
+#include "KWPFormula.h"
+#include "../Model/OBDSignals.h"
+
+namespace obd {
+namespace KWP {
+
+// Where a decoded measurement ends up: the (ECU address, group, triplet
+// index) -> OBDSignals field table, kept in flash. Each entry names the
+// field, its type and its "...Updated" flag, so the value is stored (and
+// the flag raised) only when it changed. Supporting another ECU or label
+// file is a matter of adding rows to the table in SignalBindings.cpp.
+//
+// Returns false if nothing is bound to (ecuAddr, group, idx).
+bool applySignalBinding(uint8_t ecuAddr, uint8_t group, uint8_t idx,
+                        const Measurement &m, Model::OBDSignals &signals);
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,139 @@
+#include "TripletDecode.h"
+
+#include "KWPFormula.h"
+#include "SignalBindings.h"
+
+namespace obd {
+namespace KWP {
+
+bool setUnitText(char *unit, const __FlashStringHelper *text)
+{
+    const char *src = reinterpret_cast<const char *>(text);
+    if (strcmp_P(unit, src) == 0) {
+        return false;
+    }
+    // Copy up to UnitWidth chars from PROGMEM
+    uint8_t j = 0;
+    for (; j < obd::Model::ExperimentalGroup::UnitWidth; ++j) {
+        char c = pgm_read_byte(src + j);
+        if (c == '\0') break;
+        unit[j] = c;
+    }
+    for (; j < obd::Model::ExperimentalGroup::UnitWidth + 1; ++j) {
+        unit[j] = '\0';
+    }
+    return true;
+}
+
+void resetExperimental(Model::OBDSignals &signals, const uint8_t *layout)
+{
+    // Reset temporary measurement arrays equivalent
+    for (uint8_t i = 0; i < Model::ExperimentalGroup::Count; ++i) {
+        signals.experimental.k[i] = 0;
+        signals.experimental.v[i] = -1;
+        if (layout != nullptr && layout[i] != 0) {
+            signals.experimental.k[i] = layout[i];
+            setUnitText(signals.experimental.unit[i],
+                        unitText(decodeMeasurement(layout[i], 0, 0).unit));
+            continue;
+        }
+        // Set unit text to "ERR" (3 chars + terminator, rest cleared)
+        signals.experimental.unit[i][0] = 'E';
+        signals.experimental.unit[i][1] = 'R';
+        signals.experimental.unit[i][2] = 'R';
+        signals.experimental.unit[i][3] = '\0';
+        for (uint8_t j = 4; j < obd::Model::ExperimentalGroup::UnitWidth + 1; ++j) {
+            signals.experimental.unit[i][j] = '\0';
+        }
+    }
+    signals.experimental.unsupported = false;
+    if (layout != nullptr) {
+        signals.experimental.kUpdated = true;
+        signals.experimental.unitUpdated = true;
+    }
+}
+
+void prepareGroupRead(uint8_t group, const uint8_t *layout, GroupPayloadCache &cache,
+                      Model::OBDSignals &signals)
+{
+    if (cache.shows(group) && !signals.experimental.unsupported) return;
+    cache.show(group, 0);
+    resetExperimental(signals, layout);
+}
+
+void failGroupRead(uint8_t group, GroupPayloadCache &cache, Model::OBDSignals &signals)
+{
+    if (cache.shows(group)) {
+        resetExperimental(signals, nullptr);
+        signals.experimental.vUpdated = true;
+        signals.experimental.kUpdated = true;
+        signals.experimental.unitUpdated = true;
+    }
+    cache.forget(group);
+}
+
+void decodeTriplets(uint8_t ecuAddr, uint8_t group, const uint8_t *triplets, int count,
+                    GroupPayloadCache &cache, Model::OBDSignals &signals)
+{
+    // Track current group number for experimental view
+    signals.experimental.groupCurrent = group;
+
+    if (count > Model::ExperimentalGroup::Count) count = Model::ExperimentalGroup::Count;
+    if (count < 0) count = 0;
+    // Slots showing this group's last answer keep what did not change; an
+    // answer of another length starts the view over.
+    bool shown = cache.shows(group);
+    if (shown && cache.shownCount() != count) {
+        resetExperimental(signals, nullptr);
+        shown = false;
+    }
+    const uint8_t changed = cache.update(group, triplets, static_cast<uint8_t>(count));
+
+    for (int idx = 0; idx < count; ++idx) {
+        const bool fresh = changed & (1 << idx);
+        if (!fresh && shown) continue;
+
+        byte k = triplets[idx * 3];
+        byte a = triplets[idx * 3 + 1];
+        byte b = triplets[idx * 3 + 2];
+        Measurement m = decodeMeasurement(k, a, b);
+        const __FlashStringHelper *units = unitText(m.unit);
+
+        // Update experimental arrays like original
+        if (signals.experimental.k[idx] != k) {
+            signals.experimental.k[idx] = k;
+            signals.experimental.kUpdated = true;
+        }
+        if (signals.experimental.v[idx] != m.scaled ||
+            signals.experimental.decimals[idx] != m.decimals) {
+            signals.experimental.v[idx] = m.scaled;
+            signals.experimental.decimals[idx] = m.decimals;
+            signals.experimental.vUpdated = true;
+        }
+        // Copy unit text from PROGMEM string into fixed-size buffer if it changed.
+        if (setUnitText(signals.experimental.unit[idx], units)) {
+            signals.experimental.unitUpdated = true;
+        }
+
+        // Map into instruments/engine signals (label file bindings); an
+        // unchanged triplet is there already.
+        if (fresh) {
+            applySignalBinding(ecuAddr, group, static_cast<uint8_t>(idx), m, signals);
+        }
+    }
+    cache.show(group, static_cast<uint8_t>(count));
+}
+
+void markGroupUnsupported(uint8_t group, Model::OBDSignals &signals)
+{
+    Model::ExperimentalGroup &eg = signals.experimental;
+    if (!eg.unsupported || eg.groupCurrent != group) {
+        eg.unsupported = true;
+        eg.vUpdated = true;
+        eg.unitUpdated = true;
+    }
+    eg.groupCurrent = group;
+}
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+#include "GroupPayloadCache.h"
+#include "../Model/OBDSignals.h"
+
+namespace obd {
+namespace KWP {
+
+// Measurement groups arrive as (formula, a, b) triplets from both the
+// KWP1281 group answer and the KWP2000 ReadDataByLocalIdentifier
+// response; these put them into the experimental view and the signal
+// bindings the same way for either session.
+
+// Copies a unit label from PROGMEM into an experimental unit slot.
+// Returns true if the text changed.
+bool setUnitText(char *unit, const __FlashStringHelper *text);
+
+// Clears the experimental slots before a group read: no formula, value
+// -1 and "ERR", or, where layout (may be null) knows the formula, its
+// unit. Marks the group supported again.
+void resetExperimental(Model::OBDSignals &signals, const uint8_t *layout);
+
+// Before a read of group: resetExperimental(), unless the experimental
+// slots still show the last answer to group (cache.shows()); a re-read
+// then rewrites only the slots whose triplets change.
+void prepareGroupRead(uint8_t group, const uint8_t *layout, GroupPayloadCache &cache,
+                      Model::OBDSignals &signals);
+
+// After a failed read of group: slots still showing its last answer are
+// cleared as by resetExperimental(), and the cached bytes dropped, so no
+// stale value stays up and the next answer is decoded in full.
+void failGroupRead(uint8_t group, GroupPayloadCache &cache, Model::OBDSignals &signals);
+
+// Decodes count triplets (3 * count bytes) of group from the ECU at
+// ecuAddr. Triplets past ExperimentalGroup::Count have no slot and are
+// skipped, and so are triplets whose bytes are the ones cache holds for
+// group: their values are already in signals.
+void decodeTriplets(uint8_t ecuAddr, uint8_t group, const uint8_t *triplets, int count,
+                    GroupPayloadCache &cache, Model::OBDSignals &signals);
+
+// Shows group as refused by the ECU ("n/a").
+void markGroupUnsupported(uint8_t group, Model::OBDSignals &signals);
+
+} // namespace KWP
+} // namespace obd
@@ -10,25 +10,72 @@ DTCStore::DTCStore()
 
 void DTCStore::reset()
 {
-    for (uint8_t i = 0; i < MaxCount; ++i) {
-        dtcErrors_[i] = 0xFFFF;
-        dtcStatus_[i] = 0xFF;
-    }
+    count_ = 0;
+    overflow_ = 0;
 }
 
 void DTCStore::resetRandom()
 {
+    reset();
     for (uint8_t i = 0; i < MaxCount; ++i) {
-        dtcErrors_[i] = (uint16_t)(i * 1000);
-        dtcStatus_[i] = (uint8_t)(i * 10);
+        add((uint16_t)(i * 1000), (uint8_t)(i * 10));
+    }
+}
+
+uint16_t DTCStore::errorAt(uint8_t idx) const
+{
+    if (idx >= count_) return NoCode;
+    const uint8_t *r = &records_[idx * RecordBytes];
+    return (uint16_t)((r[0] << 8) | r[1]);
+}
+
+uint8_t DTCStore::statusAt(uint8_t idx) const
+{
+    if (idx >= count_) return NoStatus;
+    return records_[idx * RecordBytes + 2];
+}
+
+int16_t DTCStore::find_(uint16_t error) const
+{
+    const uint8_t high = (uint8_t)(error >> 8);
+    const uint8_t low = (uint8_t)(error & 0xFF);
+    for (uint8_t i = 0; i < count_; ++i) {
+        const uint8_t *r = &records_[i * RecordBytes];
+        if (r[0] == high && r[1] == low) return i;
     }
+    return -1;
+}
+
+void DTCStore::write_(uint8_t idx, uint16_t error, uint8_t status)
+{
+    uint8_t *r = &records_[idx * RecordBytes];
+    r[0] = (uint8_t)(error >> 8);
+    r[1] = (uint8_t)(error & 0xFF);
+    r[2] = status;
+}
+
+bool DTCStore::add(uint16_t error, uint8_t status)
+{
+    const int16_t held = find_(error);
+    if (held >= 0) {
+        records_[held * RecordBytes + 2] = status;
+        return true;
+    }
+    if (count_ >= MaxCount) {
+        if (overflow_ < 0xFF) ++overflow_;
+        return false;
+    }
+    write_(count_++, error, status);
+    return true;
 }
 
 void DTCStore::set(uint8_t idx, uint16_t error, uint8_t status)
 {
-    if (idx >= MaxCount) return;
-    dtcErrors_[idx] = error;
-    dtcStatus_[idx] = status;
+    if (idx < count_) {
+        write_(idx, error, status);
+    } else if (idx == count_) {
+        add(error, status);
+    }
 }
 
 } // namespace Model
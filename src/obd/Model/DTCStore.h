@@ -2,30 +2,62 @@
 
 #include <Arduino.h>
 
+// Fault codes the store holds; 3 bytes of RAM each. Override with
+// -DOBD_DTC_CAPACITY=<n> in build_flags (see docs/BUILD_FLAGS.md).
+#ifndef OBD_DTC_CAPACITY
+#define OBD_DTC_CAPACITY 32
+#endif
+
 namespace obd {
 namespace Model {
 
+// Fault codes read from the ECU, in the order it sent them.
+//
+// A KWP1281 fault is a 16-bit code and an 8-bit status (symptom in the
+// low 7 bits, "intermittent" in the top one); each is kept as one packed
+// 3-byte record, and only count() of them are valid. A code that comes
+// again (in a later block, or a later read into the same store) takes the
+// new status instead of a second slot. Codes past the capacity are not
+// dropped without notice: overflow() counts them.
 class DTCStore {
 public:
-    static constexpr uint8_t MaxCount = 16;
+    static constexpr uint8_t MaxCount = OBD_DTC_CAPACITY;
+    static_assert(MaxCount > 0 && MaxCount <= 127,
+                  "OBD_DTC_CAPACITY must fit readDtcCodes()'s int8_t count");
+    // What errorAt()/statusAt() return past count().
+    static constexpr uint16_t NoCode = 0xFFFF;
+    static constexpr uint8_t NoStatus = 0xFF;
 
     DTCStore();
 
     void reset();
     void resetRandom();
 
-    // Returns the fixed capacity of the internal arrays (not the number of active DTCs).
-    // This mirrors the original behavior and is used by display code to iterate slots.
+    // Slots available (not the number of codes held; see count()).
     uint8_t capacity() const { return MaxCount; }
+    uint8_t count() const { return count_; }
+    // Codes reported that did not fit (saturates at 255).
+    uint8_t overflow() const { return overflow_; }
 
-    uint16_t errorAt(uint8_t idx) const { return dtcErrors_[idx]; }
-    uint8_t statusAt(uint8_t idx) const { return dtcStatus_[idx]; }
+    uint16_t errorAt(uint8_t idx) const;
+    uint8_t statusAt(uint8_t idx) const;
 
+    // Appends a code, or updates the status of the same code already
+    // held. False if it did not fit (counted in overflow()).
+    bool add(uint16_t error, uint8_t status);
+    // Overwrites slot idx; idx == count() appends as add() does. Any other
+    // index is ignored.
     void set(uint8_t idx, uint16_t error, uint8_t status);
 
 private:
-    uint16_t dtcErrors_[MaxCount];
-    uint8_t dtcStatus_[MaxCount];
+    static constexpr uint8_t RecordBytes = 3;   // code high, code low, status
+
+    uint8_t records_[MaxCount * RecordBytes];
+    uint8_t count_;
+    uint8_t overflow_;
+
+    int16_t find_(uint16_t error) const;
+    void write_(uint8_t idx, uint16_t error, uint8_t status);
 };
 
 } // namespace Model
@@ -0,0 +1,69 @@
+#include "DtcText.h"
+#include "DtcTextTable.h"
+
+namespace obd {
+namespace Model {
+
+namespace T = DtcTextTable;
+
+static_assert(T::LongestText <= DtcTextMaxLength,
+              "regenerate DtcTextTable with tools/dtc_text.py");
+
+int16_t findDtcText(uint16_t code)
+{
+    uint16_t low = 0;
+    uint16_t high = T::CodeCount;
+    while (low < high) {
+        const uint16_t mid = (uint16_t)((low + high) / 2);
+        const uint16_t at = pgm_read_word(&T::Codes[mid]);
+        if (at == code) return (int16_t)mid;
+        if (at < code) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return -1;
+}
+
+uint8_t describeDtc(uint16_t code, char *out, uint8_t size)
+{
+    if (size > 0) out[0] = '\0';
+    const int16_t slot = findDtcText(code);
+    if (slot < 0) return 0;
+
+    const uint16_t end = pgm_read_word(&T::TextStarts[slot + 1]);
+    uint8_t length = 0;
+    for (uint16_t i = pgm_read_word(&T::TextStarts[slot]); i < end; ++i) {
+        const uint8_t b = pgm_read_byte(&T::Text[i]);
+        if (!(b & 0x80)) {
+            if (length + 1 < size) out[length] = (char)b;
+            ++length;
+            continue;
+        }
+        const uint8_t token = b & 0x7F;
+        const uint16_t tokenEnd = pgm_read_word(&T::TokenStarts[token + 1]);
+        for (uint16_t k = pgm_read_word(&T::TokenStarts[token]); k < tokenEnd; ++k) {
+            if (length + 1 < size) out[length] = (char)pgm_read_byte(&T::TokenBytes[k]);
+            ++length;
+        }
+    }
+    if (size > 0) out[length + 1 < size ? length : size - 1] = '\0';
+    return length;
+}
+
+DtcTextFootprint dtcTextFootprint()
+{
+    DtcTextFootprint f;
+    f.codes = T::CodeCount;
+    f.tokens = T::TokenCount;
+    f.rawTextBytes = T::RawTextBytes;
+    f.packedTextBytes = (uint16_t)(pgm_read_word(&T::TextStarts[T::CodeCount])
+                                   + pgm_read_word(&T::TokenStarts[T::TokenCount])
+                                   + sizeof(T::TokenStarts));
+    f.indexBytes = (uint16_t)(sizeof(T::Codes) + sizeof(T::TextStarts));
+    return f;
+}
+
+} // namespace Model
+} // namespace obd
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace Model {
+
+// Short descriptions of VAG 5-digit fault codes ("00532" -> "Supply
+// Voltage B+"), kept in flash. The table (DtcTextTable.*) is generated by
+// tools/dtc_text.py from tools/dtc_text.txt: the codes sorted for a binary
+// search, and the texts token-compressed to about 40% of their plain size.
+
+// No description is longer (tools/dtc_text.py enforces it); a buffer of
+// DtcTextMaxLength + 1 never cuts one short.
+constexpr uint8_t DtcTextMaxLength = 48;
+
+// Where code sits in the table's sorted index, or -1 if it has no text.
+int16_t findDtcText(uint16_t code);
+
+// Writes the description of code to out, NUL-terminated and cut to
+// size - 1 characters. Returns its full length; 0 (and "") for a code the
+// table does not know.
+uint8_t describeDtc(uint16_t code, char *out, uint8_t size);
+
+// Flash taken by the table, against the same texts as plain strings.
+struct DtcTextFootprint {
+    uint16_t codes;
+    uint8_t tokens;
+    uint16_t rawTextBytes;    // the texts NUL-terminated, uncompressed
+    uint16_t packedTextBytes; // compressed texts, tokens and token starts
+    uint16_t indexBytes;      // sorted codes and text starts
+};
+DtcTextFootprint dtcTextFootprint();
+
+} // namespace Model
+} // namespace obd
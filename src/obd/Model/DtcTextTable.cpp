@@ -0,0 +1,232 @@
+// Generated by tools/dtc_text.py from tools/dtc_text.txt; do not edit.
+
+#include "DtcTextTable.h"
+
+namespace obd {
+namespace Model {
+namespace DtcTextTable {
+
+// 0:'Circuit ' 1:'Sensor ' 2:'Malfunction' 3:'Control ' 4:'Cylinder ' 5:'Bank ' ...
+const uint8_t TokenBytes[] PROGMEM = {
+    0x43, 0x69, 0x72, 0x63, 0x75, 0x69, 0x74, 0x20, 0x53, 0x65, 0x6E, 0x73,
+    0x6F, 0x72, 0x20, 0x4D, 0x61, 0x6C, 0x66, 0x75, 0x6E, 0x63, 0x74, 0x69,
+    0x6F, 0x6E, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x20, 0x43, 0x79,
+    0x6C, 0x69, 0x6E, 0x64, 0x65, 0x72, 0x20, 0x42, 0x61, 0x6E, 0x6B, 0x20,
+    0x54, 0x65, 0x6D, 0x70, 0x65, 0x72, 0x61, 0x74, 0x75, 0x72, 0x65, 0x20,
+    0x53, 0x79, 0x73, 0x74, 0x65, 0x6D, 0x20, 0x52, 0x61, 0x6E, 0x67, 0x65,
+    0x2F, 0x50, 0x65, 0x72, 0x66, 0x6F, 0x72, 0x6D, 0x61, 0x6E, 0x63, 0x65,
+    0x4D, 0x69, 0x73, 0x66, 0x69, 0x72, 0x65, 0x20, 0x44, 0x65, 0x74, 0x65,
+    0x63, 0x74, 0x65, 0x64, 0x4D, 0x61, 0x6E, 0x69, 0x66, 0x6F, 0x6C, 0x64,
+    0x20, 0x50, 0x72, 0x65, 0x73, 0x73, 0x75, 0x72, 0x65, 0x56, 0x6F, 0x6C,
+    0x74, 0x61, 0x67, 0x65, 0x20, 0x50, 0x6F, 0x73, 0x69, 0x74, 0x69, 0x6F,
+    0x6E, 0x20, 0x4D, 0x61, 0x73, 0x73, 0x20, 0x41, 0x69, 0x72, 0x20, 0x46,
+    0x6C, 0x6F, 0x77, 0x20, 0x49, 0x6E, 0x70, 0x75, 0x74, 0x4B, 0x6E, 0x6F,
+    0x63, 0x6B, 0x20, 0x4D, 0x6F, 0x64, 0x75, 0x6C, 0x65, 0x45, 0x6E, 0x67,
+    0x69, 0x6E, 0x65, 0x20, 0x49, 0x67, 0x6E, 0x69, 0x74, 0x69, 0x6F, 0x6E,
+    0x20, 0x50, 0x6F, 0x77, 0x65, 0x72, 0x74, 0x72, 0x61, 0x69, 0x6E, 0x20,
+    0x44, 0x61, 0x74, 0x61, 0x20, 0x42, 0x75, 0x73, 0x20, 0x4D, 0x69, 0x73,
+    0x73, 0x69, 0x6E, 0x67, 0x20, 0x4D, 0x65, 0x73, 0x73, 0x61, 0x67, 0x65,
+    0x20, 0x66, 0x72, 0x6F, 0x6D, 0x20, 0x53, 0x70, 0x65, 0x65, 0x64, 0x20,
+    0x54, 0x68, 0x72, 0x6F, 0x74, 0x74, 0x6C, 0x65, 0x20, 0x43, 0x61, 0x74,
+    0x61, 0x6C, 0x79, 0x73, 0x74, 0x20, 0x45, 0x66, 0x66, 0x69, 0x63, 0x69,
+    0x65, 0x6E, 0x63, 0x79, 0x20, 0x42, 0x65, 0x6C, 0x6F, 0x77, 0x20, 0x54,
+    0x68, 0x72, 0x65, 0x73, 0x68, 0x6F, 0x6C, 0x64, 0x20, 0x43, 0x6F, 0x6F,
+    0x6C, 0x61, 0x6E, 0x74, 0x20, 0x48, 0x69, 0x67, 0x68, 0x20, 0x49, 0x6E,
+    0x63, 0x6F, 0x72, 0x72, 0x65, 0x63, 0x74, 0x45, 0x78, 0x68, 0x61, 0x75,
+    0x73, 0x74, 0x20, 0x47, 0x61, 0x73, 0x20, 0x52, 0x65, 0x63, 0x69, 0x72,
+    0x63, 0x75, 0x6C, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x20, 0x56, 0x61, 0x6C,
+    0x76, 0x65, 0x49, 0x6E, 0x74, 0x61, 0x6B, 0x65, 0x20, 0x44, 0x65, 0x74,
+    0x65, 0x63, 0x74, 0x65, 0x64, 0x4F, 0x32, 0x20, 0x46, 0x75, 0x65, 0x6C,
+    0x20, 0x54, 0x72, 0x69, 0x6D, 0x20, 0x49, 0x6E, 0x6A, 0x65, 0x63, 0x74,
+    0x6F, 0x72, 0x20, 0x4C, 0x6F, 0x77, 0x53, 0x65, 0x63, 0x6F, 0x6E, 0x64,
+    0x61, 0x72, 0x79, 0x20, 0x41, 0x69, 0x72, 0x20, 0x49, 0x6E, 0x6A, 0x65,
+    0x63, 0x74, 0x69, 0x6F, 0x6E, 0x20, 0x74, 0x6F, 0x6F, 0x20, 0x49, 0x64,
+    0x6C, 0x65, 0x20, 0x31, 0x20, 0x4F, 0x75, 0x74, 0x70, 0x75, 0x74, 0x20,
+    0x20, 0x46, 0x6C, 0x6F, 0x77, 0x43, 0x61, 0x6D, 0x73, 0x68, 0x61, 0x66,
+    0x74, 0x20, 0x43, 0x6F, 0x69, 0x6C, 0x20, 0x41, 0x69, 0x72, 0x20, 0x46,
+    0x75, 0x65, 0x6C, 0x20, 0x50, 0x75, 0x6D, 0x70, 0x20, 0x52, 0x65, 0x6C,
+    0x61, 0x79, 0x20, 0x53, 0x69, 0x67, 0x6E, 0x61, 0x6C, 0x56, 0x61, 0x6C,
+    0x76, 0x65, 0x20, 0x65, 0x72, 0x20, 0x74, 0x68, 0x61, 0x6E, 0x20, 0x45,
+    0x78, 0x70, 0x65, 0x63, 0x74, 0x65, 0x64, 0x42, 0x6F, 0x6F, 0x73, 0x74,
+    0x20, 0x50, 0x72, 0x65, 0x73, 0x73, 0x75, 0x72, 0x65, 0x20, 0x45, 0x56,
+    0x41, 0x50, 0x20, 0x48, 0x65, 0x61, 0x74, 0x65, 0x72, 0x20, 0x4F, 0x78,
+    0x79, 0x67, 0x65, 0x6E, 0x20, 0x53, 0x75, 0x70, 0x70, 0x6C, 0x79, 0x20,
+    0x54, 0x72, 0x61, 0x6E, 0x73, 0x6D, 0x69, 0x73, 0x73, 0x69, 0x6F, 0x6E,
+    0x20, 0x49, 0x6E, 0x73, 0x75, 0x66, 0x66, 0x69, 0x63, 0x69, 0x65, 0x6E,
+    0x74, 0x4E, 0x6F, 0x20, 0x41, 0x63, 0x74, 0x69, 0x76, 0x69, 0x74, 0x79,
+    0x20, 0x43, 0x72, 0x61, 0x6E, 0x6B, 0x73, 0x68, 0x61, 0x66, 0x74, 0x20,
+    0x45, 0x6C, 0x65, 0x63, 0x74, 0x72, 0x69, 0x63, 0x61, 0x6C, 0x20, 0x49,
+    0x6D, 0x6D, 0x6F, 0x62, 0x69, 0x6C, 0x69, 0x7A, 0x65, 0x72, 0x54, 0x65,
+    0x72, 0x6D, 0x69, 0x6E, 0x61, 0x6C, 0x20, 0x33, 0x30, 0x52, 0x65, 0x67,
+    0x75, 0x6C, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x45, 0x72, 0x72, 0x6F, 0x72,
+    0x20, 0x4D, 0x65, 0x6D, 0x6F, 0x72, 0x79, 0x20, 0x32, 0x20, 0x44, 0x61,
+    0x74, 0x61, 0x20, 0x42, 0x75, 0x73, 0x56, 0x65, 0x68, 0x69, 0x63, 0x6C,
+    0x65, 0x20, 0x6C, 0x79, 0x20, 0x43, 0x6F, 0x64, 0x65, 0x64, 0x28, 0x41,
+    0x64, 0x64, 0x29, 0x3A, 0x20, 0x43, 0x6C, 0x75, 0x73, 0x74, 0x65, 0x72,
+    0x4C, 0x65, 0x61, 0x6E, 0x52, 0x69, 0x63, 0x68, 0x69, 0x6E, 0x28, 0x47,
+    0x37, 0x30, 0x29, 0x45, 0x47, 0x52, 0x4C, 0x65, 0x61, 0x6B, 0x20, 0x67,
+    0x20,
+};
+
+const uint16_t TokenStarts[TokenCount + 1] PROGMEM = {
+    0, 8, 15, 26, 34, 43, 48, 60,
+    67, 84, 100, 117, 125, 134, 148, 153,
+    159, 165, 172, 181, 222, 228, 237, 273,
+    281, 286, 295, 326, 333, 341, 344, 354,
+    363, 366, 390, 394, 399, 401, 408, 413,
+    422, 427, 431, 447, 453, 459, 475, 490,
+    495, 502, 509, 516, 529, 541, 553, 564,
+    575, 586, 597, 607, 612, 620, 622, 630,
+    638, 646, 653, 660, 664, 668, 670, 675,
+    678, 683, 685,
+};
+
+const uint16_t Codes[CodeCount] PROGMEM = {
+    513, 514, 515, 516, 518, 519, 520, 522,
+    523, 524, 525, 532, 533, 537, 540, 543,
+    545, 553, 555, 561, 575, 577, 578, 579,
+    580, 581, 582, 586, 609, 610, 611, 625,
+    668, 750, 771, 779, 1044, 1087, 1119, 1128,
+    1165, 1176, 1177, 1179, 1242, 1247, 1257, 1259,
+    1262, 1265, 1312, 1314, 1316, 1317, 1321, 1336,
+    16484, 16485, 16486, 16487, 16489, 16490, 16491, 16492,
+    16494, 16496, 16497, 16499, 16500, 16501, 16502, 16504,
+    16505, 16506, 16507, 16509, 16514, 16515, 16516, 16517,
+    16518, 16519, 16520, 16521, 16522, 16524, 16525, 16534,
+    16535, 16536, 16539, 16554, 16555, 16556, 16557, 16558,
+    16559, 16585, 16586, 16587, 16588, 16684, 16685, 16686,
+    16687, 16688, 16689, 16690, 16704, 16705, 16706, 16709,
+    16711, 16712, 16714, 16719, 16724, 16725, 16735, 16736,
+    16737, 16738, 16784, 16785, 16786, 16794, 16795, 16804,
+    16814, 16824, 16825, 16826, 16839, 16884, 16885, 16889,
+    16890, 16891, 16944, 16946, 16947, 16985, 16987, 16989,
+    17084, 17544, 17545, 17908, 17965, 17978, 18010, 18020,
+    18057, 18058,
+};
+
+const uint16_t TextStarts[CodeCount + 1] PROGMEM = {
+    0, 8, 15, 23, 36, 44, 53, 56,
+    64, 73, 81, 88, 92, 95, 98, 106,
+    124, 142, 145, 157, 175, 177, 181, 185,
+    189, 193, 197, 201, 202, 205, 208, 211,
+    213, 216, 226, 241, 257, 262, 289, 307,
+    320, 331, 339, 342, 357, 369, 402, 411,
+    417, 425, 432, 443, 446, 455, 477, 492,
+    501, 504, 507, 512, 516, 520, 524, 530,
+    535, 540, 547, 553, 557, 561, 567, 572,
+    576, 580, 586, 591, 610, 617, 627, 636,
+    657, 665, 673, 680, 690, 699, 707, 715,
+    722, 732, 741, 749, 752, 758, 764, 767,
+    773, 779, 783, 787, 791, 795, 813, 816,
+    819, 823, 827, 831, 835, 841, 847, 856,
+    864, 874, 883, 891, 896, 901, 905, 911,
+    917, 923, 929, 933, 939, 953, 956, 961,
+    964, 967, 970, 980, 990, 1000, 1004, 1008,
+    1012, 1021, 1033, 1036, 1039, 1045, 1058, 1073,
+    1081, 1085, 1092, 1099, 1102, 1122, 1141, 1147,
+    1153, 1157, 1159,
+};
+
+const uint8_t Text[] PROGMEM = {
+    0x91, 0x94, 0x81, 0x28, 0x47, 0x32, 0x38, 0x29, 0xB6, 0x8C, 0x81, 0x28,
+    0x47, 0x34, 0x29, 0xA7, 0x8C, 0x81, 0x28, 0x47, 0x34, 0x30, 0x29, 0xA3,
+    0x53, 0x77, 0x69, 0x74, 0x63, 0x68, 0x20, 0x28, 0x46, 0x36, 0x30, 0x29,
+    0x95, 0x8C, 0x81, 0x28, 0x47, 0x36, 0x39, 0x29, 0x9B, 0x8A, 0x20, 0x81,
+    0x28, 0x47, 0x37, 0x31, 0x29, 0x8D, 0x81, 0xC6, 0x97, 0x86, 0x81, 0x28,
+    0x47, 0x36, 0x32, 0x29, 0x9B, 0xA9, 0x86, 0x81, 0x28, 0x47, 0x34, 0x32,
+    0x29, 0x8F, 0x81, 0xA4, 0x28, 0x47, 0x36, 0x31, 0x29, 0xB1, 0x81, 0x28,
+    0x47, 0x33, 0x39, 0x29, 0xB2, 0x8B, 0x42, 0x2B, 0xA3, 0x94, 0xBA, 0xB1,
+    0x81, 0xBA, 0x8F, 0x81, 0xBD, 0x28, 0x47, 0x36, 0x36, 0x29, 0x4D, 0x61,
+    0x78, 0x69, 0x6D, 0x75, 0x6D, 0x20, 0x91, 0x94, 0x45, 0x78, 0x63, 0x65,
+    0x65, 0x64, 0x65, 0x64, 0x45, 0x6E, 0x67, 0xC5, 0x65, 0x2D, 0xB3, 0xB7,
+    0x43, 0x6F, 0x6E, 0x6E, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x8D, 0x81,
+    0xC6, 0xB1, 0x81, 0x85, 0xBD, 0x81, 0xA4, 0x28, 0x47, 0x31, 0x30, 0x38,
+    0x29, 0x4D, 0x69, 0x78, 0x74, 0x75, 0x72, 0x65, 0x20, 0x41, 0x64, 0x61,
+    0x70, 0x74, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x9B, 0x8A, 0x8F, 0x83, 0x84,
+    0x31, 0x8F, 0x83, 0x84, 0x32, 0x8F, 0x83, 0x84, 0x33, 0x8F, 0x83, 0x84,
+    0x34, 0x8F, 0x83, 0x84, 0x35, 0x8F, 0x83, 0x84, 0x36, 0x9A, 0x92, 0xA5,
+    0x31, 0x92, 0xA5, 0x32, 0x92, 0xA5, 0x33, 0x94, 0xAB, 0xB2, 0x8B, 0xB9,
+    0x57, 0x61, 0x72, 0x6E, 0xC5, 0xC9, 0x4C, 0x61, 0x6D, 0x70, 0x46, 0x75,
+    0x65, 0x6C, 0x20, 0x4C, 0x65, 0x76, 0x65, 0x6C, 0x20, 0x81, 0x28, 0x47,
+    0x29, 0x4F, 0x75, 0x74, 0x73, 0x69, 0x64, 0x65, 0x20, 0xA9, 0x86, 0x81,
+    0x28, 0x47, 0x31, 0x37, 0x29, 0x83, 0x90, 0x20, 0x99, 0xC0, 0x42, 0x61,
+    0x73, 0x69, 0x63, 0x20, 0x53, 0x65, 0x74, 0x74, 0xC5, 0xC9, 0x4E, 0x6F,
+    0x74, 0x20, 0x43, 0x61, 0x72, 0x72, 0x69, 0x65, 0x64, 0x20, 0x4F, 0x75,
+    0x74, 0x47, 0x65, 0x61, 0x72, 0x20, 0x52, 0x65, 0x63, 0x6F, 0x67, 0x6E,
+    0x69, 0x74, 0x69, 0x6F, 0x6E, 0x20, 0xAB, 0xB8, 0x20, 0x52, 0x65, 0x61,
+    0x64, 0xC5, 0xC9, 0xA8, 0x28, 0x44, 0x32, 0x29, 0x95, 0xAC, 0x83, 0x90,
+    0x20, 0x28, 0x4A, 0x33, 0x33, 0x38, 0x29, 0x4B, 0x65, 0x79, 0x20, 0xAB,
+    0x20, 0xA2, 0xA0, 0x91, 0x83, 0x90, 0x4B, 0x65, 0x79, 0x20, 0x50, 0x72,
+    0x6F, 0x67, 0x72, 0x61, 0x6D, 0x6D, 0xC5, 0xC9, 0x99, 0xA5, 0x53, 0x74,
+    0x61, 0x67, 0x65, 0x73, 0x20, 0xC5, 0x20, 0x83, 0x90, 0x43, 0x68, 0x61,
+    0x72, 0x63, 0x6F, 0x61, 0x6C, 0x20, 0x43, 0x61, 0x6E, 0x69, 0x73, 0x74,
+    0x65, 0x72, 0x20, 0x53, 0x6F, 0x6C, 0x65, 0x6E, 0x6F, 0x69, 0x64, 0x20,
+    0xAC, 0x28, 0x4E, 0x38, 0x30, 0x29, 0xA3, 0xA9, 0x83, 0xAC, 0x28, 0x4E,
+    0x37, 0x31, 0x29, 0xAA, 0x28, 0x4A, 0x31, 0x37, 0x29, 0xAE, 0x83, 0xAC,
+    0x28, 0x4E, 0x37, 0x35, 0x29, 0x9A, 0x20, 0x28, 0x4E, 0x31, 0x38, 0x29,
+    0x50, 0x6F, 0x77, 0x65, 0x72, 0x74, 0x72, 0x61, 0xC5, 0x20, 0xBE, 0x91,
+    0x83, 0x90, 0x42, 0x72, 0x61, 0x6B, 0x65, 0x73, 0x20, 0x83, 0x90, 0x49,
+    0x6E, 0x73, 0x74, 0x72, 0x75, 0x6D, 0x65, 0x6E, 0x74, 0x20, 0xC2, 0x20,
+    0x83, 0x90, 0x20, 0x28, 0x4A, 0x32, 0x38, 0x35, 0x29, 0x41, 0x69, 0x72,
+    0x62, 0x61, 0xC9, 0x83, 0x90, 0x20, 0x28, 0x4A, 0x32, 0x33, 0x34, 0x29,
+    0x43, 0x6F, 0x6D, 0x66, 0x6F, 0x72, 0x74, 0x20, 0xBE, 0x8D, 0x80, 0x82,
+    0x8D, 0x80, 0x88, 0x8D, 0x80, 0xA0, 0x20, 0x8E, 0x8D, 0x80, 0x98, 0x8E,
+    0x8A, 0x20, 0x80, 0x82, 0x8A, 0x20, 0x80, 0x88, 0x8A, 0x20, 0x80, 0xA0,
+    0x20, 0x8E, 0x8A, 0x20, 0x80, 0x98, 0x8E, 0x9B, 0xA9, 0x86, 0x80, 0x82,
+    0x9B, 0xA9, 0x86, 0x80, 0xA0, 0x20, 0x8E, 0x9B, 0xA9, 0x86, 0x80, 0x98,
+    0x8E, 0x97, 0x86, 0x80, 0x82, 0x97, 0x86, 0x80, 0x88, 0x97, 0x86, 0x80,
+    0xA0, 0x20, 0x8E, 0x97, 0x86, 0x80, 0x98, 0x8E, 0x95, 0x8C, 0x80, 0x82,
+    0x95, 0x8C, 0x80, 0x88, 0x95, 0x8C, 0x80, 0xA0, 0x20, 0x8E, 0x95, 0x8C,
+    0x80, 0x98, 0x8E, 0xB4, 0x20, 0x97, 0x86, 0x66, 0x6F, 0x72, 0x20, 0x43,
+    0x6C, 0x6F, 0x73, 0x65, 0x64, 0x20, 0x4C, 0x6F, 0x6F, 0x70, 0x9D, 0x81,
+    0x80, 0x85, 0xA4, 0x81, 0x31, 0x9D, 0x81, 0x80, 0xA0, 0x20, 0x8B, 0x85,
+    0xA4, 0x81, 0x31, 0x9D, 0x81, 0x80, 0x98, 0x8B, 0x85, 0xA4, 0x81, 0x31,
+    0x9D, 0x81, 0x80, 0x53, 0x6C, 0x6F, 0x77, 0x20, 0x52, 0x65, 0x73, 0x70,
+    0x6F, 0x6E, 0x73, 0x65, 0x20, 0x85, 0xA4, 0x81, 0x31, 0x9D, 0x81, 0x80,
+    0xB5, 0x85, 0xA4, 0x81, 0x31, 0x9D, 0x81, 0xB0, 0x80, 0x85, 0xA4, 0x81,
+    0x31, 0x9D, 0x81, 0x80, 0x85, 0xA4, 0x81, 0x32, 0x9D, 0x81, 0x80, 0xA0,
+    0x20, 0x8B, 0x85, 0xA4, 0x81, 0x32, 0x9D, 0x81, 0x80, 0x98, 0x8B, 0x85,
+    0xA4, 0x81, 0x32, 0x9D, 0x81, 0x80, 0xB5, 0x85, 0xA4, 0x81, 0x32, 0x9D,
+    0x81, 0xB0, 0x80, 0x85, 0xA4, 0x81, 0x32, 0x9D, 0x81, 0x80, 0x85, 0xBD,
+    0x81, 0x31, 0x9D, 0x81, 0x80, 0xA0, 0x20, 0x8B, 0x85, 0xBD, 0x81, 0x31,
+    0x9D, 0x81, 0x80, 0x98, 0x8B, 0x85, 0xBD, 0x81, 0x31, 0x9D, 0x81, 0xB0,
+    0x80, 0x85, 0xBD, 0x81, 0x31, 0x9E, 0x85, 0x31, 0x87, 0xA2, 0xC3, 0x20,
+    0x85, 0x31, 0x87, 0xA2, 0xC4, 0x20, 0x85, 0x31, 0x9E, 0x85, 0x32, 0x87,
+    0xA2, 0xC3, 0x20, 0x85, 0x32, 0x87, 0xA2, 0xC4, 0x20, 0x85, 0x32, 0x9F,
+    0x80, 0x84, 0x31, 0x9F, 0x80, 0x84, 0x32, 0x9F, 0x80, 0x84, 0x33, 0x9F,
+    0x80, 0x84, 0x34, 0x52, 0x61, 0x6E, 0x64, 0x6F, 0x6D, 0x2F, 0x4D, 0x75,
+    0x6C, 0x74, 0x69, 0x70, 0x6C, 0x65, 0x20, 0x84, 0x89, 0x84, 0xA4, 0x89,
+    0x84, 0xBD, 0x89, 0x84, 0x33, 0x20, 0x89, 0x84, 0x34, 0x20, 0x89, 0x84,
+    0x35, 0x20, 0x89, 0x84, 0x36, 0x20, 0x89, 0x91, 0x94, 0x8E, 0x20, 0x80,
+    0x82, 0x91, 0x94, 0x8E, 0x20, 0x80, 0x88, 0x91, 0x94, 0x8E, 0x20, 0x80,
+    0x4E, 0x6F, 0x20, 0xAB, 0x8F, 0x81, 0xA4, 0x80, 0x82, 0x20, 0x85, 0x31,
+    0x8F, 0x81, 0xA4, 0x80, 0xA0, 0x20, 0x8E, 0x20, 0x85, 0x31, 0x8F, 0x81,
+    0xA4, 0x80, 0x98, 0x8E, 0x20, 0x85, 0x31, 0x8F, 0x81, 0xBD, 0x80, 0x82,
+    0x20, 0x85, 0x32, 0xB6, 0x8C, 0x81, 0x80, 0x82, 0xA7, 0x8C, 0x81, 0x80,
+    0x82, 0xA7, 0x8C, 0x81, 0x88, 0x92, 0xA8, 0x41, 0x20, 0x80, 0x82, 0x92,
+    0xA8, 0x42, 0x20, 0x80, 0x82, 0x92, 0xA8, 0x43, 0x20, 0x80, 0x82, 0x92,
+    0xA8, 0x44, 0x20, 0x80, 0x82, 0xC7, 0xA6, 0x20, 0x82, 0xC7, 0x20, 0xB4,
+    0xA6, 0x20, 0x9C, 0xC7, 0x20, 0x45, 0x78, 0x63, 0x65, 0x73, 0x73, 0x69,
+    0x76, 0x65, 0xA6, 0x20, 0x9C, 0xA1, 0x87, 0x82, 0xA1, 0x99, 0xA6, 0x20,
+    0x9C, 0x96, 0x85, 0x31, 0x96, 0x85, 0x32, 0xAF, 0x87, 0x82, 0xAF, 0x87,
+    0x99, 0x20, 0x50, 0x75, 0x72, 0x67, 0x65, 0xA6, 0xAF, 0x87, 0x53, 0x6D,
+    0x61, 0x6C, 0x6C, 0x20, 0xC8, 0x9C, 0xAF, 0x87, 0x4C, 0x61, 0x72, 0x67,
+    0x65, 0x20, 0xC8, 0x9C, 0xBF, 0x94, 0x81, 0x82, 0xBF, 0x94, 0x81, 0x88,
+    0xA3, 0x83, 0x87, 0x82, 0xA3, 0x83, 0x87, 0x52, 0x50, 0x4D, 0x20, 0xA0,
+    0xAD, 0xA3, 0x83, 0x87, 0x52, 0x50, 0x4D, 0x20, 0x48, 0x69, 0x67, 0x68,
+    0xAD, 0x87, 0x8B, 0x82, 0x87, 0x8B, 0xA0, 0x87, 0x8B, 0x48, 0x69, 0x67,
+    0x68, 0x83, 0x90, 0xBC, 0x43, 0x68, 0x65, 0x63, 0x6B, 0x73, 0x75, 0x6D,
+    0x20, 0xBB, 0x83, 0x90, 0x20, 0x4B, 0x65, 0x65, 0x70, 0x20, 0x41, 0x6C,
+    0x69, 0x76, 0x65, 0xBC, 0xBB, 0x83, 0x90, 0x20, 0x52, 0x4F, 0x4D, 0x20,
+    0xBB, 0xB3, 0x83, 0x87, 0x82, 0x9E, 0x85, 0xA4, 0xC1, 0x87, 0xA2, 0xC3,
+    0x9E, 0x85, 0xA4, 0xC1, 0x87, 0xA2, 0xC4, 0xAA, 0xB7, 0x82, 0xAE, 0x83,
+    0x50, 0x6F, 0x73, 0x69, 0x74, 0x69, 0x76, 0x65, 0x20, 0x44, 0x65, 0x76,
+    0x69, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x91, 0x53, 0x74, 0x61, 0x72, 0x74,
+    0x20, 0x42, 0x6C, 0x6F, 0x63, 0x6B, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20,
+    0xB8, 0xB2, 0xB9, 0x20, 0x8B, 0xA2, 0xA0, 0x91, 0x83, 0x90, 0x20, 0x99,
+    0xC0, 0x93, 0x45, 0x43, 0x55, 0x93, 0xC2,
+};
+
+} // namespace DtcTextTable
+} // namespace Model
+} // namespace obd
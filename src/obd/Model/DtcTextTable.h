@@ -0,0 +1,29 @@
+#pragma once
+
+// Generated by tools/dtc_text.py from tools/dtc_text.txt; do not edit.
+// The packed DTC descriptions behind obd/Model/DtcText.h.
+
+#include <Arduino.h>
+
+namespace obd {
+namespace Model {
+namespace DtcTextTable {
+
+constexpr uint16_t CodeCount = 154;
+constexpr uint8_t TokenCount = 74;
+// The descriptions as plain NUL-terminated strings would take this much.
+constexpr uint16_t RawTextBytes = 5082;
+constexpr uint8_t LongestText = 48;
+
+// Token n is TokenBytes[TokenStarts[n] .. TokenStarts[n + 1]).
+extern const uint8_t TokenBytes[];
+extern const uint16_t TokenStarts[TokenCount + 1];
+// Codes in ascending order; the description of Codes[i] is
+// Text[TextStarts[i] .. TextStarts[i + 1]), 0x80 | n standing for token n.
+extern const uint16_t Codes[CodeCount];
+extern const uint16_t TextStarts[CodeCount + 1];
+extern const uint8_t Text[];
+
+} // namespace DtcTextTable
+} // namespace Model
+} // namespace obd
@@ -0,0 +1,16 @@
+#include "EcuIdentity.h"
+
+namespace obd {
+namespace Model {
+
+void EcuIdentity::reset()
+{
+    memset(partNumber, 0, sizeof(partNumber));
+    memset(component, 0, sizeof(component));
+    coding = 0;
+    workshopCode = 0;
+    valid = false;
+}
+
+} // namespace Model
+} // namespace obd
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace Model {
+
+// What an ECU says about itself in the 0xF6 identification blocks at
+// connect, e.g. "1J0920826C" / "KOMBI+WEGFAHRSP VDO V01", coding 00142,
+// workshop code 31414. Text fields are NUL-terminated and space-trimmed.
+struct EcuIdentity {
+    static constexpr uint8_t PartNumberWidth = 12;
+    static constexpr uint8_t ComponentWidth = 24;
+
+    char partNumber[PartNumberWidth + 1];
+    char component[ComponentWidth + 1];
+    uint32_t coding;       // 0 if the ECU did not send one
+    uint32_t workshopCode; // 0 if the ECU did not send one
+    bool valid;            // identification text was received
+
+    EcuIdentity() { reset(); }
+    void reset();
+};
+
+} // namespace Model
+} // namespace obd
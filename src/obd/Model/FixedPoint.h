@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace Model {
+
+// Decimal fixed-point helpers for measurement values. A value is kept as
+// an integer scaled by 10^decimals (e.g. 14.25 V -> 1425 with 2
+// decimals), so decoding and change detection never touch float math.
+static constexpr uint8_t FixedMaxDecimals = 3;
+
+inline int32_t fixedPow10(uint8_t decimals)
+{
+    switch (decimals) {
+    case 0: return 1;
+    case 1: return 10;
+    case 2: return 100;
+    default: return 1000;
+    }
+}
+
+// Integer part, truncated toward zero like a float-to-int cast.
+inline int32_t fixedWhole(int32_t scaled, uint8_t decimals)
+{
+    return scaled / fixedPow10(decimals);
+}
+
+inline float fixedToFloat(int32_t scaled, uint8_t decimals)
+{
+    return static_cast<float>(scaled) / static_cast<float>(fixedPow10(decimals));
+}
+
+// Writes e.g. "-12.5" into buf (always NUL-terminated). Returns the
+// number of characters written, or 0 if it did not fit.
+inline uint8_t formatFixed(int32_t scaled, uint8_t decimals, char *buf, uint8_t size)
+{
+    char tmp[14];
+    uint8_t n = 0;
+    bool negative = scaled < 0;
+    uint32_t mag = negative ? static_cast<uint32_t>(-(scaled + 1)) + 1u
+                            : static_cast<uint32_t>(scaled);
+    // Digits in reverse; at least one integer digit ("0.05", not ".05").
+    do {
+        tmp[n++] = static_cast<char>('0' + mag % 10u);
+        mag /= 10u;
+    } while (mag > 0 || n <= decimals);
+
+    uint8_t len = static_cast<uint8_t>(n + (decimals > 0 ? 1 : 0) + (negative ? 1 : 0));
+    if (size == 0 || len >= size) {
+        if (size > 0) {
+            buf[0] = '\0';
+        }
+        return 0;
+    }
+
+    uint8_t out = 0;
+    if (negative) {
+        buf[out++] = '-';
+    }
+    while (n > 0) {
+        buf[out++] = tmp[--n];
+        if (decimals > 0 && n == decimals) {
+            buf[out++] = '.';
+        }
+    }
+    buf[out] = '\0';
+    return out;
+}
+
+} // namespace Model
+} // namespace obd
@@ -7,7 +7,8 @@ void ExperimentalGroup::reset()
 {
     for (uint8_t i = 0; i < 4; ++i) {
         k[i] = 0;
-        v[i] = 123.4f;
+        v[i] = 1234; // 123.4
+        decimals[i] = 1;
         // Reset unit text to "N/A"
         unit[i][0] = 'N';
         unit[i][1] = '/';
@@ -19,6 +20,7 @@ void ExperimentalGroup::reset()
         }
     }
     kUpdated = vUpdated = unitUpdated = false;
+    unsupported = false;
     groupSide = false;
     groupSideUpdated = false;
 }
@@ -6,8 +6,12 @@ namespace obd {
 namespace Model {
 
 struct ExperimentalGroup {
+    // Triplets of one group answer shown on the experimental screens.
+    static constexpr uint8_t Count = 4;
     uint8_t k[4] = {0, 0, 0, 0};
-    float v[4] = {123.4f, 123.4f, 123.4f, 123.4f};
+    // Decoded values in fixed point: v[i] / 10^decimals[i] (see FixedPoint.h)
+    int32_t v[4] = {1234, 1234, 1234, 1234};
+    uint8_t decimals[4] = {1, 1, 1, 1};
     // Fixed-size unit strings to avoid dynamic String allocations; initialized to "N/A".
     static constexpr uint8_t UnitWidth = 8; // enough for typical short unit labels
     char unit[4][UnitWidth + 1] = {{'N','/','A','\0'},{'N','/','A','\0'},{'N','/','A','\0'},{'N','/','A','\0'}};
@@ -17,6 +21,7 @@ struct ExperimentalGroup {
     bool unitUpdated = false;
 
     uint8_t groupCurrent = 1; // mirrors old group_current
+    bool unsupported = false; // ECU refused groupCurrent; shown as "n/a"
     bool groupSide = false; // false: 0/1, true: 2/3
     bool groupSideUpdated = false;
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace Model {
+
+// Events per second, measured over whole windows of at least one second
+// so the number shown holds still long enough to read. Feed events with
+// add() and call update() from the loop; perSecondX10() is the rate of
+// the last finished window, in tenths.
+class RateMeter {
+public:
+    RateMeter() : count_(0), windowCount_(0), windowStartMs_(0), rateX10_(0) {}
+
+    void add(uint16_t n = 1) { count_ += n; }
+
+    void update(uint32_t nowMs)
+    {
+        const uint32_t elapsed = nowMs - windowStartMs_;
+        if (elapsed < 1000) return;
+        const uint32_t events = count_ - windowCount_;
+        rateX10_ = static_cast<uint16_t>((events * 10000UL + elapsed / 2) / elapsed);
+        windowCount_ = count_;
+        windowStartMs_ = nowMs;
+    }
+
+    void reset(uint32_t nowMs)
+    {
+        windowCount_ = count_;
+        windowStartMs_ = nowMs;
+        rateX10_ = 0;
+    }
+
+    uint32_t count() const { return count_; }
+    uint16_t perSecondX10() const { return rateX10_; }
+
+private:
+    uint32_t count_;
+    uint32_t windowCount_;
+    uint32_t windowStartMs_;
+    uint16_t rateX10_;
+};
+
+} // namespace Model
+} // namespace obd
@@ -1,4 +1,5 @@
 #include "OBDDisplay.h"
+#include "StackMonitor.h"
 
 namespace obd {
 
@@ -15,6 +16,7 @@ OBDDisplay::OBDDisplay(uint8_t rxPin, uint8_t txPin, LiquidCrystal &lcd)
     : obdSerial_(rxPin, txPin, false)
     , display_(lcd)
     , kwp_(obdSerial_)
+    , ecus_(kwp_)
     , signals_()
     , dtcStore_()
     , menuState_()
@@ -23,19 +25,28 @@ OBDDisplay::OBDDisplay(uint8_t rxPin, uint8_t txPin, LiquidCrystal &lcd)
     , autoSetup_(false)
     , baudRate_(0)
     , addrSelected_(0x00)
+    , dualEcu_(false)
     , kwpMode_(Mode::ReadSensors)
     , kwpModeLast_(Mode::ReadSensors)
     , kwpGroup_(1)
+    , scheduledMenu_(0xFF)
+    , scheduledScreen_(0xFF)
     , connected_(false)
     , connectTimeStart_(0)
     , displayFrameTimestamp_(0)
+    , frames_()
     , buttonTimeoutUntil_(0)
 {
 }
 
 void OBDDisplay::begin()
 {
-    // Serial debug is handled elsewhere if needed
+    // The hardware port only carries K-line trace dumps (see
+    // dumpTrace_()); the K-line itself is on the software UART.
+#if OBD_TRACE_SIZE > 0
+    Serial.begin(115200);
+#endif
+    paintStack(); // Debug screen 1 reports the headroom left since here
     display_.begin(16, 2);
 
     // Configure serial session initial defaults (kept same as old globals)
@@ -76,9 +87,9 @@ void OBDDisplay::startupAnimation_()
     // Mirror old AUTO_SETUP defaults when user holds SELECT during splash.
     if (autoSetup_) {
         static constexpr uint8_t AUTO_SETUP_ADDRESS = 0x17;   // ADDR_INSTRUMENTS
-        static constexpr uint16_t AUTO_SETUP_BAUD_RATE = 10400;
         addrSelected_ = AUTO_SETUP_ADDRESS;
-        baudRate_ = AUTO_SETUP_BAUD_RATE;
+        dualEcu_ = false;
+        baudRate_ = 0; // detected at connect
         kwp_.setConfig(baudRate_, addrSelected_);
     }
 
@@ -87,7 +98,7 @@ void OBDDisplay::startupAnimation_()
 
 void OBDDisplay::runSetupFlow_()
 {
-    // Mirror the old connect() setup phase: choose SIM/ECU, baud, and address.
+    // Mirror the old connect() setup phase: choose SIM/ECU and address.
 
     // For retries, pre-fill SIM/ECU from previous state.
     int8_t userSimMode = -1; // 0 = ECU, 1 = SIM
@@ -120,46 +131,16 @@ void OBDDisplay::runSetupFlow_()
 
         simulationModeActive_ = (userSimMode == 1);
 
-        // 2) Baud rate selection
-        uint16_t supportedBaudRates[5] = {1200, 2400, 4800, 9600, 10400};
-        uint8_t baudPtr = 3; // default 9600
-        uint16_t userBaud = supportedBaudRates[baudPtr];
+        // The baud rate is not asked for: the session measures it off
+        // the ECU's sync byte at every connect.
+        baudRate_ = 0;
+        delay(555); // let go of LEFT/RIGHT before the next question
 
-        display_.clear();
-        display_.print(0, 0, F("<--   Baud:  -->"));
-        display_.print(2, 1, String("-> ") + String(userBaud), 10);
-
-        bool pressedEnter = false;
-        while (!pressedEnter) {
-            int v = analogRead(A0);
-            if (v < 60) {
-                // RIGHT
-                baudPtr = (baudPtr >= 4) ? 0 : static_cast<uint8_t>(baudPtr + 1);
-                userBaud = supportedBaudRates[baudPtr];
-                display_.print(2, 1, String("-> ") + String(userBaud), 10);
-                delay(333);
-            } else if (v >= 400 && v < 600) {
-                // LEFT
-                baudPtr = (baudPtr == 0) ? 4 : static_cast<uint8_t>(baudPtr - 1);
-                userBaud = supportedBaudRates[baudPtr];
-                display_.print(2, 1, String("-> ") + String(userBaud), 10);
-                delay(333);
-            } else if (v >= 600 && v < 800) {
-                // SELECT = enter
-                pressedEnter = true;
-            }
-            delay(10);
-        }
-
-        baudRate_ = userBaud;
-        delay(555);
-
-        // 3) ECU address selection: 0x01 or 0x17
-        int8_t userAddr = -1; // 0 -> 0x01, 1 -> 0x17
+        // 2) ECU address selection: 0x01, 0x17 or both
+        int8_t userAddr = -1; // 0 -> 0x01, 1 -> 0x17, 2 -> both
         display_.clear();
         display_.print(0, 0, F("ECU address:"));
-        display_.print(0, 1, F("<-- 01"));
-        display_.print(9, 1, F("17 -->"));
+        display_.print(0, 1, F("<-01  both  17->"));
 
         while (userAddr == -1) {
             int v = analogRead(A0);
@@ -169,10 +150,18 @@ void OBDDisplay::runSetupFlow_()
             } else if (v >= 400 && v < 600) {
                 // LEFT
                 userAddr = 0;
+            } else if (buttons_.isSelectPressed()) {
+                userAddr = 2;
             }
         }
 
+        // Both: the session is time-sliced between the two (see
+        // MultiEcuSession); the instruments come first.
+        dualEcu_ = (userAddr == 2);
         addrSelected_ = (userAddr == 0) ? 0x01 : 0x17;
+        if (dualEcu_) {
+            delay(555); // let go of SELECT before PRESS SELECT
+        }
     } else {
         // Auto-setup path already populated simulationModeActive_, baudRate_, addrSelected_
         // in startupAnimation_(). Nothing extra needed here.
@@ -216,8 +205,7 @@ void OBDDisplay::update()
         // labels are drawn immediately after leaving the PRESS SELECT
         // screen.
         phase_ = Phase::Running;
-        menuState_ = Input::MenuState();
-        menuState_.markMenuChanged();
+        resetMenu_();
 
         // In simulation mode, there is no real ECU to connect to; treat as
         // immediately "connected" and skip ensureConnected_().
@@ -226,6 +214,22 @@ void OBDDisplay::update()
         }
     }
 
+    if (phase_ == Phase::Reconnecting) {
+        // The session was lost and could not be resumed: retry on the
+        // backoff (or right away on SELECT) instead of waiting for the
+        // user at PRESS SELECT.
+        bool select = millis() >= buttonTimeoutUntil_ && buttons_.isSelectPressed();
+        if (!select && !reconnect_.due(millis())) {
+            return;
+        }
+        if (select) {
+            buttonTimeoutUntil_ = millis() + BUTTON_TIMEOUT_MS;
+        }
+        display_.clear();
+        display_.print(0, 0, F("Reconnecting..."));
+        phase_ = Phase::Running;
+    }
+
     // Always keep UI responsive, even when not connected to an ECU.
     bool wasConnected = connected_;
     bool nowConnected = ensureConnected_();
@@ -238,6 +242,10 @@ void OBDDisplay::update()
         updateKwpOrSimulation_();
         computeValues_();
     }
+    if (phase_ != Phase::Running) {
+        // Keep the connect/reconnect notice on the LCD.
+        return;
+    }
 
     handleInput_();
     updateDisplay_();
@@ -256,13 +264,55 @@ bool OBDDisplay::ensureConnected_()
 
     // If we have no valid configuration yet, don't block the UI; behave like
     // the original sketch where menus were shown before any connection.
-    if (baudRate_ == 0 || addrSelected_ == 0x00) {
+    if (addrSelected_ == 0x00) {
+        return false;
+    }
+
+    if (dualEcu_) {
+        // MultiEcuSession connects (and reconnects) each ECU itself as
+        // it gets the line; a missing one just leaves it to the other.
+        ecus_.clear();
+        ecus_.addEcu(0x17);
+        ecus_.addEcu(0x01);
+        connected_ = true;
+        connectTimeStart_ = millis();
+        resetMenu_();
+        scheduledMenu_ = 0xFF;
+        configureScheduler_();
+        return true;
+    }
+
+    // The 5-baud address init takes 2 s; it is clocked out from here on
+    // every pass of the main loop so the LCD keeps moving meanwhile.
+    if (phase_ != Phase::Connecting) {
+        kwp_.startConnect(baudRate_, addrSelected_);
+        phase_ = Phase::Connecting;
+        display_.clear();
+        display_.print(0, 0, F("Init"));
+        display_.print(5, 0, String(addrSelected_, HEX));
+        return false;
+    }
+    PollStatus status = kwp_.poll(signals_);
+    if (status == PollStatus::Busy) {
+        // One dot per address bit on the line
+        uint8_t bits = kwp_.addressInit().bitsSent();
+        if (bits > 0) {
+            display_.print(bits - 1, 1, F("."));
+        }
         return false;
     }
+    phase_ = Phase::Running;
 
-    if (!kwp_.connectToEcu(simulationModeActive_, autoSetup_, baudRate_, addrSelected_)) {
+    if (status != PollStatus::Done || !kwp_.finishConnect()) {
         kwp_.disconnect();
         connected_ = false;
+        dumpTrace_();
+
+        if (!simulationModeActive_ && reconnect_.failed(millis())) {
+            phase_ = Phase::Reconnecting;
+            showReconnect_();
+            return false;
+        }
 
         // In ECU mode, a failed connect should behave like the old obd_connect():
         // show an error and do not start the tripcomputer loop.
@@ -277,7 +327,7 @@ bool OBDDisplay::ensureConnected_()
             delay(ECU_TIMEOUT_MS);
             phase_ = Phase::WaitingForConnect;
             connected_ = false;
-            menuState_ = Input::MenuState();
+            resetMenu_();
             display_.clear();
             display_.print(0, 0, F("->   ENTER   <-"));
             display_.print(0, 1, F("Press SELECT"));
@@ -287,53 +337,193 @@ bool OBDDisplay::ensureConnected_()
     }
 
     connected_ = true;
+    reconnect_.reset();
     connectTimeStart_ = millis();
     // After a successful connect, always start in the cockpit menu (tripcomputer)
     // like the original sketch did.
-    menuState_ = Input::MenuState(); // reset to defaults (Cockpit, screen 0)
-    menuState_.markMenuChanged();
+    resetMenu_(); // reset to defaults (Cockpit, screen 0)
 
     // Seed one round of data so the very first cockpit frame drawn
     // after connect is fully populated without waiting for a manual
-    // screen change.
-    updateKwpOrSimulation_();
+    // screen change: every scheduled group is read once, each exchange
+    // run to completion here.
+    scheduledMenu_ = 0xFF;
+    configureScheduler_();
+    for (uint8_t i = 0; i < scheduler_.size() && connected_; ++i) {
+        do {
+            updateKwpOrSimulation_();
+        } while (connected_ && kwp_.busy());
+    }
     computeValues_();
     return true;
 }
 
 void OBDDisplay::updateKwpOrSimulation_()
 {
-    if (!simulationModeActive_) {
+    if (!simulationModeActive_ && dualEcu_) {
+        // Always the scheduled reads: ACK and single-group modes are for
+        // looking at one ECU, which the single-address setup is for.
+        configureScheduler_();
+        ecus_.poll(signals_);
+    } else if (!simulationModeActive_) {
+        // Advance the exchange in flight by whatever the K-line has ready
+        // and hand the loop straight back to input and LCD refresh.
+        PollStatus status = kwp_.poll(signals_);
+        if (status == PollStatus::Busy || status == PollStatus::Done) {
+            return;
+        }
+        if (status == PollStatus::Error) {
+            // Most line errors are a lost or garbled byte: pick the
+            // session up again within the ECU's timeout before paying
+            // for a full 5-baud init.
+            if (kwp_.resume()) {
+                return;
+            }
+            kwp_.disconnect();
+            connected_ = false;
+            dumpTrace_();
+            reconnect_.start(millis());
+            phase_ = Phase::Reconnecting;
+            showReconnect_();
+            return;
+        }
+
+        // Idle: start the next exchange for the current mode. With
+        // nothing to read the line stays free (and the loop with it for
+        // input and LCD) until the ECU is about to time the session out.
         switch (kwpMode_) {
         case Mode::Ack:
-            if (!kwp_.keepAlive()) {
-                kwp_.disconnect();
-                connected_ = false;
+            if (kwp_.keepAliveDue()) {
+                kwp_.startKeepAlive();
             }
             break;
         case Mode::ReadGroup:
-            if (!kwp_.readSensorsGroup(kwpGroup_, signals_)) {
-                kwp_.disconnect();
-                connected_ = false;
+            // A group the ECU refused before is not asked for again.
+            if (!kwp_.startGroupRead(kwpGroup_, signals_) && kwp_.keepAliveDue()) {
+                kwp_.startKeepAlive();
             }
             break;
         case Mode::ReadSensors:
-        default:
-            for (uint8_t g = 1; g <= 3; ++g) {
-                if (!kwp_.readSensorsGroup(g, signals_)) {
-                    kwp_.disconnect();
-                    connected_ = false;
-                    break;
+        default: {
+            configureScheduler_();
+            uint8_t group = 0;
+            bool started = scheduler_.next(millis(), group)
+                           && kwp_.startGroupRead(group, signals_);
+            if (!started && kwp_.keepAliveDue()) {
+                // Everything on screen is fresh, but the ECU needs to hear
+                // from us: read the group closest to due early instead of
+                // sending an empty ACK.
+                started = scheduler_.nextSoonest(millis(), group)
+                          && kwp_.startGroupRead(group, signals_);
+                if (!started) {
+                    kwp_.startKeepAlive();
                 }
             }
             break;
         }
+        }
     } else {
         signals_.updateSimulation();
         delay(222);
     }
 }
 
+// Sends the K-line trace to the hardware Serial port for
+// tools/kline_trace.py; called whenever a session is lost or a connect
+// fails. The ring is emptied so the next dump only has what came after.
+void OBDDisplay::dumpTrace_()
+{
+#if OBD_TRACE_SIZE > 0
+    if (simulationModeActive_) return;
+    kwp_.trace().dump(Serial);
+    kwp_.trace().clear(micros());
+#endif
+}
+
+// A blocking exchange was asked for while the line is between the two
+// ECUs; the user tries again once one is connected.
+void OBDDisplay::showSwitching_()
+{
+    display_.clear();
+    display_.print(0, 0, F("Switching ECU"));
+    display_.print(0, 1, F("try again"));
+    delay(1222);
+    menuState_.markScreenChanged();
+}
+
+void OBDDisplay::showReconnect_()
+{
+    display_.clear();
+    display_.print(0, 0, F("ECU lost"));
+    display_.print(0, 1, F("Retry  /"));
+    display_.print(6, 1, static_cast<int>(reconnect_.attempt()));
+    display_.print(8, 1, static_cast<int>(ReconnectBackoff::MaxAttempts));
+}
+
+void OBDDisplay::configureScheduler_()
+{
+    uint8_t menu = static_cast<uint8_t>(menuState_.currentMenu());
+    uint8_t screen = menuState_.currentScreen();
+    if (menu == scheduledMenu_ && screen == scheduledScreen_) {
+        return;
+    }
+    scheduledMenu_ = menu;
+    scheduledScreen_ = screen;
+
+    // Rebuilt from scratch so the groups of the new screen are read once
+    // straight away.
+    if (!dualEcu_) {
+        planScreenGroups(addrSelected_, menuState_.currentMenu(), screen,
+                         menuState_.currentScreenCount(), scheduler_);
+        return;
+    }
+
+    // Both ECUs: the one whose cockpit screen is shown has the line, the
+    // other keeps the screen it is entered at (its first) fresh. Other
+    // menus plan both alike and leave the line where it is.
+    const uint8_t perEcu = Input::MenuState::CockpitScreensPerEcu;
+    const bool cockpit = menuState_.currentMenu() == MenuId::Cockpit;
+    const uint8_t shown = screen / perEcu;
+    for (uint8_t i = 0; i < ecus_.ecuCount(); ++i) {
+        if (!cockpit) {
+            ecus_.plan(ecus_.ecuAddress(i), menuState_.currentMenu(), screen,
+                       menuState_.currentScreenCount());
+        } else {
+            ecus_.plan(ecus_.ecuAddress(i), MenuId::Cockpit,
+                       i == shown ? screen % perEcu : 0, perEcu);
+        }
+    }
+    ecus_.setForeground(cockpit ? ecus_.ecuAddress(shown) : 0);
+}
+
+void OBDDisplay::resetMenu_()
+{
+    menuState_ = Input::MenuState();
+    menuState_.setCockpitEcus(dualEcu_ ? ecus_.ecuCount() : 1);
+    menuState_.markMenuChanged();
+}
+
+// The ECU the LCD shows values of: with both ECUs, the one of the cockpit
+// screen, elsewhere the one connected (DTCs, Settings).
+uint8_t OBDDisplay::shownAddress_() const
+{
+    if (!dualEcu_ || ecus_.ecuCount() == 0) return addrSelected_;
+    if (menuState_.currentMenu() == MenuId::Cockpit) {
+        return ecus_.ecuAddress(menuState_.cockpitScreen() / Input::MenuState::CockpitScreensPerEcu);
+    }
+    const uint8_t active = ecus_.activeAddress();
+    return active != 0 ? active : addrSelected_;
+}
+
+// Runs the exchange in flight to completion before a blocking one. With
+// both ECUs that needs one connected: false while the line is switching.
+bool OBDDisplay::settle_()
+{
+    if (dualEcu_) return ecus_.settle(signals_);
+    kwp_.completePending(signals_);
+    return true;
+}
+
 void OBDDisplay::computeValues_()
 {
     signals_.compute(millis(), connectTimeStart_);
@@ -358,6 +548,7 @@ void OBDDisplay::handleInput_()
         // resets counters but keeps us running.
         if (!simulationModeActive_) {
             kwp_.disconnect();
+            ecus_.reset();
             connected_ = false;
             phase_ = Phase::WaitingForConnect;
             display_.clear();
@@ -371,10 +562,11 @@ void OBDDisplay::handleInput_()
         // Settings screen 0: Exit ECU. Match old behaviour:
         // send KWP end block, disconnect, and go back to
         // "press to connect" if we are in ECU mode.
-        if (connected_ && !simulationModeActive_) {
+        if (connected_ && !simulationModeActive_ && settle_()) {
             kwp_.exitSession();
         }
         kwp_.disconnect();
+        ecus_.reset();
         connected_ = false;
 
     // After exit, go back into the setup phase so the user can
@@ -402,6 +594,10 @@ void OBDDisplay::handleInput_()
         }
         menuState_.markScreenChanged();
     }
+    if (actions.scanGroups) {
+        scanGroups_();
+        return;
+    }
     if (actions.invertGroupSide) {
         signals_.experimental.invertGroupSide();
         menuState_.markScreenChanged();
@@ -428,32 +624,22 @@ void OBDDisplay::handleInput_()
                 uint8_t status = (uint8_t)(i * 10u);
                 dtcStore_.set(i, code, status);
             }
+        } else if (!settle_()) {
+            showSwitching_();
         } else {
-            int8_t dtcCount = kwp_.readDtcCodes(dtcStore_);
-            if (dtcCount < 0) {
-                // Communication error while reading DTCs: show error,
-                // disconnect and go back to press-to-connect.
-                display_.clear();
-                display_.print(0, 0, F("DTC read error"));
-                display_.print(0, 1, F("Disconnecting..."));
-                delay(1222);
-                kwp_.disconnect();
-                connected_ = false;
-                phase_ = Phase::WaitingForConnect;
-                display_.clear();
-                display_.print(0, 0, F("->   ENTER   <-"));
-                display_.print(0, 1, F("Press SELECT"));
-            } else {
-                // Success: briefly show success on second line like old code.
-                display_.print(3, 1, F("<Success>"));
-                delay(500);
-            }
+            // The codes come in over the next passes of the loop, one
+            // block at a time, and the DTC screens show them as they
+            // arrive (the count on this one ticks up). A line error on
+            // the way is handled like one in a group read.
+            kwp_.startDtcRead(dtcStore_);
         }
     }
     if (actions.clearDtc) {
         if (simulationModeActive_) {
             // In SIM mode, just clear stored codes and do not touch ECU.
             dtcStore_.reset();
+        } else if (!settle_()) {
+            showSwitching_();
         } else {
             if (!kwp_.deleteDtcCodes()) {
                 // Not supported or communication problem: show message
@@ -471,22 +657,83 @@ void OBDDisplay::handleInput_()
     }
 }
 
+void OBDDisplay::scanGroups_()
+{
+    if (simulationModeActive_ || !connected_) {
+        display_.clear();
+        display_.print(0, 0, F("Scan groups"));
+        display_.print(0, 1, F("needs ECU"));
+        delay(1222);
+        menuState_.markScreenChanged();
+        return;
+    }
+
+    if (!settle_()) {
+        showSwitching_();
+        return;
+    }
+    display_.clear();
+    display_.print(0, 0, F("Scan G:"));
+    display_.print(0, 1, F("Found:"));
+
+    GroupScan scan(kwp_);
+    scan.begin();
+    do {
+        display_.clearRegion(8, 0, 3);
+        display_.print(8, 0, static_cast<int>(scan.nextGroup()));
+        display_.clearRegion(8, 1, 3);
+        display_.print(8, 1, static_cast<int>(scan.found()));
+    } while (scan.step(signals_));
+
+    if (scan.failed()) {
+        display_.clear();
+        display_.print(0, 0, F("Scan error"));
+        display_.print(0, 1, F("Disconnecting..."));
+        delay(1222);
+        kwp_.disconnect();
+        ecus_.reset();
+        connected_ = false;
+        phase_ = Phase::WaitingForConnect;
+        display_.clear();
+        display_.print(0, 0, F("->   ENTER   <-"));
+        display_.print(0, 1, F("Press SELECT"));
+        return;
+    }
+
+    display_.clearRegion(0, 0, 16);
+    display_.print(0, 0, F("Scan done"));
+    delay(1222);
+    // The scheduler re-plans with the new map on the next loop.
+    scheduledMenu_ = 0xFF;
+    menuState_.markScreenChanged();
+}
+
 void OBDDisplay::updateDisplay_()
 {
     uint32_t now = millis();
 
+    kwp_.stats().update(now);
+    frames_.update(now);
+    DebugStatus debug;
+    debug.connected = connected_ && !(dualEcu_ && ecus_.switching());
+    debug.blockCounter = kwp_.blockCounter();
+    debug.framesPerSecondX10 = frames_.perSecondX10();
+    debug.bus = &kwp_.stats();
+
     // If menu or screen changed, re-init and force a full render once
     if (menuState_.consumeMenuChanged() || menuState_.consumeScreenChanged()) {
         display_.clear();
-        display_.initMenu(menuState_, addrSelected_, static_cast<int>(kwpMode_));
-        display_.render(menuState_, signals_, dtcStore_, addrSelected_,
-                        static_cast<int>(kwpMode_), true);
+        display_.initMenu(menuState_, shownAddress_(), static_cast<int>(kwpMode_));
+        display_.render(menuState_, signals_, dtcStore_, shownAddress_(),
+                        static_cast<int>(kwpMode_), debug, true);
+        frames_.add();
     }
 
     // Periodic refresh like DISPLAY_FRAME_LENGTH in old sketch
     if (now >= displayFrameTimestamp_) {
-        display_.render(menuState_, signals_, dtcStore_, addrSelected_,
-                        static_cast<int>(kwpMode_), false);
+        display_.render(menuState_, signals_, dtcStore_, shownAddress_(),
+                        static_cast<int>(kwpMode_), debug, false);
+        frames_.add();
         displayFrameTimestamp_ = now + DISPLAY_FRAME_LENGTH_MS;
     }
 }
@@ -5,8 +5,14 @@
 #include "../NewSoftwareSerial.h"
 #include "Display/DisplayManager.h"
 #include "KWP/KWP1281Session.h"
+#include "KWP/GroupScan.h"
+#include "KWP/GroupScheduler.h"
+#include "KWP/MultiEcuSession.h"
+#include "KWP/ReconnectBackoff.h"
+#include "KWP/ScreenGroups.h"
 #include "Model/OBDSignals.h"
 #include "Model/DTCStore.h"
+#include "Model/RateMeter.h"
 #include "Input/MenuState.h"
 #include "Input/ButtonInput.h"
 
@@ -26,6 +32,7 @@ private:
     NewSoftwareSerial obdSerial_;
     Display::DisplayManager display_;
     KWP::KWP1281Session kwp_;
+    KWP::MultiEcuSession ecus_;     // both ECUs: time-slices kwp_
     Model::OBDSignals signals_;
     Model::DTCStore dtcStore_;
     Input::MenuState menuState_;
@@ -36,19 +43,27 @@ private:
     bool autoSetup_;
     uint16_t baudRate_;
     uint8_t addrSelected_;
+    bool dualEcu_;                  // instruments and engine together
     KWP::Mode kwpMode_;
     KWP::Mode kwpModeLast_;
     uint8_t kwpGroup_;
+    KWP::GroupScheduler scheduler_; // Mode::ReadSensors group selection
+    uint8_t scheduledMenu_;         // menu/screen scheduler_ was set up for
+    uint8_t scheduledScreen_;
 
     bool connected_;
     uint16_t connectionAttempts_ = 0;
+    KWP::ReconnectBackoff reconnect_; // session lost: automatic reconnects
     uint32_t connectTimeStart_;
     uint32_t displayFrameTimestamp_;
+    Model::RateMeter frames_;          // LCD frames drawn, Debug screen 0
     uint32_t buttonTimeoutUntil_;
 
     enum class Phase : uint8_t {
         Setup,
         WaitingForConnect,
+        Reconnecting,
+        Connecting,     // 5-baud address init in progress
         Running
     } phase_ = Phase::Setup;
 
@@ -56,10 +71,18 @@ private:
     void startupAnimation_();
     void runSetupFlow_();
     void resetState_();
+    void resetMenu_();
+    uint8_t shownAddress_() const;
+    bool settle_();
     bool ensureConnected_();
     void updateKwpOrSimulation_();
+    void showReconnect_();
+    void showSwitching_();
+    void dumpTrace_();
+    void configureScheduler_();
     void computeValues_();
     void handleInput_();
+    void scanGroups_();
     void updateDisplay_();
 
     void incrementExperimentalGroup_();
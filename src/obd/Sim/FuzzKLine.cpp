@@ -0,0 +1,198 @@
+#include "FuzzKLine.h"
+
+#include <EEPROM.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../KWP/KWP1281Session.h"
+
+namespace obd {
+namespace Sim {
+
+static uint32_t delayUs(uint8_t code)
+{
+    return code < 0xF0 ? code * 100UL : (code - 0xEFUL) * 250000UL;
+}
+
+FuzzKLine::FuzzKLine(const uint8_t *data, size_t size)
+    : data_(data)
+    , size_(size)
+    , pos_(0)
+    , lastEventUs_(native_arduino::clockUs())
+    , txRemaining_(0)
+    , lastWasRx_(false)
+    , lastRx_(0)
+    , echo_(-1)
+    , ecuBytes_(0)
+{
+}
+
+void FuzzKLine::begin(long speed)
+{
+    (void)speed;
+    txRemaining_ = 0;
+    echo_ = -1;
+    lastEventUs_ = native_arduino::clockUs();
+}
+
+size_t FuzzKLine::write(uint8_t data)
+{
+    if (txRemaining_ == 0 && lastWasRx_ && data == (lastRx_ ^ 0xFF)) {
+        // The session's complement of our last byte
+    } else {
+        // Length byte first: that many bytes follow, the last (block
+        // end) without a complement.
+        txRemaining_ = (txRemaining_ == 0) ? data : txRemaining_ - 1;
+        if (txRemaining_ != 0) echo_ = data ^ 0xFF;
+    }
+    lastWasRx_ = false;
+    lastEventUs_ = native_arduino::clockUs();
+    return 1;
+}
+
+uint64_t FuzzKLine::dueUs_() const
+{
+    if (echo_ >= 0) return lastEventUs_ + EchoUs;
+    if (pos_ + 1 >= size_) return UINT64_MAX;
+    return lastEventUs_ + delayUs(data_[pos_]);
+}
+
+void FuzzKLine::checkHang_(uint64_t nowUs) const
+{
+    if (nowUs - lastEventUs_ <= HangUs) return;
+    fprintf(stderr, "FuzzKLine: session polled a silent line for %u ms\n",
+            static_cast<unsigned>((nowUs - lastEventUs_) / 1000));
+    abort();
+}
+
+int FuzzKLine::available()
+{
+    const uint64_t due = dueUs_();
+    uint64_t now = native_arduino::clockUs();
+    if (now >= due) return 1;
+    // Polling costs a little time, as with the virtual ECU. Once the line
+    // has been quiet for a while the steps grow, up to the next byte, so
+    // the timeouts fuzzed inputs keep running into stay cheap; close to
+    // the last byte they stay short, as the session's checks for a byte
+    // already waiting depend on it.
+    uint64_t step = PollStepUs;
+    if (now - lastEventUs_ >= QuietUs) {
+        step = due - now < IdleStepUs ? due - now : IdleStepUs;
+    }
+    native_arduino::advanceClockUs(step);
+    now += step;
+    if (now >= due) return 1;
+    checkHang_(now);
+    return 0;
+}
+
+int FuzzKLine::read()
+{
+    const uint64_t now = native_arduino::clockUs();
+    if (now < dueUs_()) return -1;
+    int data;
+    if (echo_ >= 0) {
+        data = echo_;
+        echo_ = -1;
+        lastWasRx_ = false;
+    } else {
+        data = data_[pos_ + 1];
+        pos_ += 2;
+        ++ecuBytes_;
+        lastWasRx_ = true;
+        lastRx_ = static_cast<uint8_t>(data);
+    }
+    lastEventUs_ = now;
+    return data;
+}
+
+void FuzzKLine::setTxLevel(bool high)
+{
+    (void)high;
+    // An address init abandons any block in progress.
+    txRemaining_ = 0;
+    echo_ = -1;
+    lastWasRx_ = false;
+    lastEventUs_ = native_arduino::clockUs();
+}
+
+static void fuzzCheck(bool ok, const char *what)
+{
+    if (ok) return;
+    fprintf(stderr, "runFuzzInput: %s\n", what);
+    abort();
+}
+
+// An exchange that reports success got a whole block: length, counter,
+// title and end byte at the least.
+static void checkWholeBlock(const KWP::BasicKWP1281Session<FuzzKLine> &kwp)
+{
+    fuzzCheck(kwp.lastBlockSize() >= 4, "exchange done on a block shorter than 4 bytes");
+}
+
+FuzzStats runFuzzInput(const uint8_t *data, size_t size)
+{
+    static const uint16_t Rates[] = {1200, 2400, 4800, 9600, 10400};
+    static constexpr uint16_t MaxExchanges = 64;
+
+    FuzzStats stats;
+    if (size == 0) return stats;
+
+    // Rejected groups and cached identities live in EEPROM; every input
+    // starts from a blank one.
+    native_arduino::eepromErase();
+    FuzzKLine line(data + 1, size - 1);
+    KWP::BasicKWP1281Session<FuzzKLine> kwp(line);
+    Model::OBDSignals signals;
+    signals.reset();
+    Model::DTCStore dtcs;
+
+    uint16_t baud = Rates[(data[0] & 0x07) % 5];
+    uint8_t addr = (data[0] & 0x08) ? 0x01 : 0x17;
+    stats.connected = kwp.connectToEcu(false, false, baud, addr);
+    if (stats.connected) checkWholeBlock(kwp);
+
+    const uint8_t first = data[0] >> 4;
+    while (!line.exhausted() && stats.exchanges < MaxExchanges) {
+        const uint8_t group = 1 + stats.exchanges % 4;
+        bool ok = false;
+        switch ((first + stats.exchanges) % 5) {
+        case 0:
+            ok = kwp.readSensorsGroup(group, signals);
+            break;
+        case 1:
+            if (kwp.startGroupRead(group, signals)) {
+                KWP::PollStatus status;
+                while ((status = kwp.poll(signals)) == KWP::PollStatus::Busy) {
+                }
+                ok = status == KWP::PollStatus::Done;
+            }
+            break;
+        case 2:
+            ok = kwp.keepAlive();
+            break;
+        case 3:
+            ok = kwp.readDtcCodes(dtcs) >= 0;
+            break;
+        default:
+            ok = kwp.resume();
+            break;
+        }
+        ++stats.exchanges;
+        if (ok) checkWholeBlock(kwp);
+
+        fuzzCheck(!kwp.busy(), "exchange left in flight");
+        fuzzCheck(!kwp.arena().held(), "block buffers still held");
+        for (uint8_t i = 0; i < Model::ExperimentalGroup::Count; ++i) {
+            fuzzCheck(memchr(signals.experimental.unit[i], '\0',
+                             Model::ExperimentalGroup::UnitWidth + 1) != nullptr,
+                      "unit label not terminated");
+        }
+    }
+    stats.ecuBytes = line.ecuBytes();
+    return stats;
+}
+
+} // namespace Sim
+} // namespace obd
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Arduino.h>
+#include "HostKLine.h"
+
+namespace obd {
+namespace Sim {
+
+// Plays an arbitrary byte string as the ECU side of a K-line, for
+// fuzzing the session's receive path (see runFuzzInput()).
+//
+// The string is read as (delay, byte) pairs. Each ECU byte is ready
+// delay after the later of the last byte the session read and the last
+// byte it sent, so an input can answer in step with the session or run
+// ahead of it. Delay codes below 0xF0 count 100 us, the others 250 ms
+// each (enough to run into every timeout the session has). Tester blocks
+// get their complements from the line itself, as from a well-behaved
+// ECU, so inputs only carry the ECU's own blocks.
+//
+// A session that keeps polling a silent line for HangUs without sending
+// anything is taken to be stuck: the line aborts, which the fuzzer
+// reports as a crash.
+class FuzzKLine final : public HostKLine {
+public:
+    static constexpr uint32_t HangUs = 10000000UL;
+
+    FuzzKLine(const uint8_t *data, size_t size);
+
+    // Every ECU byte of the input has been read.
+    bool exhausted() const { return pos_ + 1 >= size_ && echo_ < 0; }
+    uint32_t ecuBytes() const { return ecuBytes_; }
+
+    void begin(long speed) override;
+    void end() override {}
+    size_t write(uint8_t data) override;
+    int read() override;
+    int available() override;
+    void flush() override {}
+    void setTxLevel(bool high) override;
+    bool rxHigh() override { return true; }
+
+private:
+    static constexpr uint32_t PollStepUs = 10;
+    static constexpr uint32_t QuietUs = 5000;
+    static constexpr uint32_t IdleStepUs = 1000;
+    static constexpr uint32_t EchoUs = 1000;
+
+    const uint8_t *data_;
+    size_t size_;
+    size_t pos_;             // next (delay, byte) pair
+    uint64_t lastEventUs_;   // last byte either way, or init edge
+    uint8_t txRemaining_;    // bytes left in the tester block being sent
+    bool lastWasRx_;
+    uint8_t lastRx_;
+    int16_t echo_;           // complement owed to the tester, or -1
+    uint32_t ecuBytes_;
+
+    uint64_t dueUs_() const;   // when the next ECU byte is ready
+    void checkHang_(uint64_t nowUs) const;
+};
+
+struct FuzzStats {
+    uint32_t ecuBytes = 0;   // input bytes the session read
+    uint16_t exchanges = 0;
+    bool connected = false;
+};
+
+// Runs one fuzz input through a KWP1281 session: the first byte picks the
+// baud rate (bits 0..2, of 1200/2400/4800/9600/10400), the ECU address
+// (bit 3: 0x01, else 0x17) and where the round of exchanges after the
+// connect starts (bits 4..7: group read, polled group read, keep-alive,
+// DTC read, resume); the rest is the FuzzKLine input. Exchanges run
+// until the input is used up. Aborts if the session breaks one of its
+// invariants (an exchange left in flight, buffers still held, a unit
+// label without its terminator, success on a block shorter than 4 bytes).
+FuzzStats runFuzzInput(const uint8_t *data, size_t size);
+
+} // namespace Sim
+} // namespace obd
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+namespace Sim {
+
+// Host-side stand-in for the K-line serial port. It exposes exactly the
+// subset of NewSoftwareSerial that KWP1281Session uses, so the session can
+// be compiled unchanged for [env:native] and driven by a simulated ECU.
+// Virtual dispatch is fine here; this header is never built for AVR. The
+// final implementations can also be given to BasicKWP1281Session directly
+// (see SimSessions.cpp for the instantiated ones).
+class HostKLine {
+public:
+    virtual ~HostKLine() {}
+
+    virtual void begin(long speed) = 0;
+    virtual void end() = 0;
+    virtual size_t write(uint8_t data) = 0;
+    virtual int read() = 0;
+    virtual int available() = 0;
+    virtual void flush() = 0;
+    // Drives the TX line directly, bypassing the UART (5-baud init).
+    virtual void setTxLevel(bool high) = 0;
+    // Current RX line level, for timing the sync byte.
+    virtual bool rxHigh() = 0;
+};
+
+} // namespace Sim
+} // namespace obd
@@ -0,0 +1,206 @@
+#include "ReplayKLine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace obd {
+namespace Sim {
+
+// Must match KWP::KLineTrace (128 us units).
+static constexpr uint8_t TraceUnitShift = 7;
+
+static uint32_t nowUs()
+{
+    return static_cast<uint32_t>(native_arduino::clockUs());
+}
+
+static int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool parseTraceDump(const char *text, LineCapture &out)
+{
+    out.clear();
+    const char *p = strstr(text, "#KLT1 ");
+    if (p == nullptr) return false;
+    p += 6;
+    char *end = nullptr;
+    strtoul(p, &end, 16);                      // base
+    strtoul(end, &end, 16);                    // dropped
+    const unsigned long size = strtoul(end, &end, 16);
+    p = strchr(end, '\n');
+    if (p == nullptr) return false;
+
+    std::vector<uint8_t> raw;
+    while (*p != '\0' && *p != '#') {
+        const int hi = hexDigit(p[0]);
+        const int lo = (hi >= 0) ? hexDigit(p[1]) : -1;
+        if (hi >= 0 && lo >= 0) {
+            raw.push_back(static_cast<uint8_t>(hi << 4 | lo));
+            p += 2;
+        } else {
+            ++p;
+        }
+    }
+    if (strncmp(p, "#END", 4) != 0 || raw.size() != size) return false;
+
+    // Same record layout as KLineTrace: varint ((delta << 1) | tx), data.
+    uint32_t units = 0;
+    size_t i = 0;
+    while (i < raw.size()) {
+        uint32_t value = 0;
+        uint8_t shift = 0;
+        bool more = true;
+        while (more && i < raw.size() && shift < 28) {
+            value |= static_cast<uint32_t>(raw[i] & 0x7F) << shift;
+            more = (raw[i++] & 0x80) != 0;
+            shift += 7;
+        }
+        if (more || i >= raw.size()) return false;
+        units += value >> 1;
+        LineRecord r;
+        r.us = units << TraceUnitShift;
+        r.tx = (value & 1) != 0;
+        r.data = raw[i++];
+        out.push_back(r);
+    }
+    return true;
+}
+
+// ---- CaptureKLine ----
+
+CaptureKLine::CaptureKLine(HostKLine &line)
+    : line_(line)
+    , initBits_(0)
+    , initAddress_(0)
+    , initStartUs_(0)
+{
+}
+
+size_t CaptureKLine::write(uint8_t data)
+{
+    const uint32_t us = nowUs();
+    size_t n = line_.write(data);
+    capture_.push_back(LineRecord{us, true, data});
+    return n;
+}
+
+int CaptureKLine::read()
+{
+    int data = line_.read();
+    if (data >= 0) {
+        capture_.push_back(LineRecord{nowUs(), false, static_cast<uint8_t>(data)});
+    }
+    return data;
+}
+
+void CaptureKLine::setTxLevel(bool high)
+{
+    line_.setTxLevel(high);
+    if (initBits_ == 0) {
+        if (high) return;
+        initStartUs_ = nowUs();
+        initAddress_ = 0;
+    } else if (initBits_ <= 7 && high) {
+        initAddress_ |= static_cast<uint8_t>(1u << (initBits_ - 1));
+    }
+    if (++initBits_ == 10) {
+        capture_.push_back(LineRecord{initStartUs_, true, initAddress_});
+        initBits_ = 0;
+    }
+}
+
+// ---- ReplayKLine ----
+
+ReplayKLine::ReplayKLine(const LineCapture &capture, Timing timing)
+    : capture_(capture)
+    , timing_(timing)
+    , byteTimeUs_(0)
+{
+    rewind();
+}
+
+void ReplayKLine::rewind()
+{
+    next_ = 0;
+    initActive_ = false;
+    txMatched_ = 0;
+    mismatches_ = 0;
+    rxDelivered_ = 0;
+    anchor_(capture_.empty() ? 0 : capture_[0].us);
+}
+
+void ReplayKLine::anchor_(uint32_t recordUs)
+{
+    anchorClockUs_ = native_arduino::clockUs();
+    anchorRecordUs_ = recordUs;
+}
+
+void ReplayKLine::begin(long speed)
+{
+    // 8N1: ten bits per byte
+    byteTimeUs_ = (speed > 0) ? static_cast<uint32_t>(10000000L / speed) : 0;
+}
+
+size_t ReplayKLine::write(uint8_t data)
+{
+    native_arduino::advanceClockUs(byteTimeUs_);
+    if (finished() || !capture_[next_].tx) {
+        // Nothing from the tester was recorded here
+        ++mismatches_;
+        return 1;
+    }
+    const LineRecord &r = capture_[next_++];
+    if (r.data == data) {
+        ++txMatched_;
+    } else {
+        ++mismatches_;
+    }
+    // r.us is the start of the byte; the clock is at its end.
+    anchor_(r.us + byteTimeUs_);
+    return 1;
+}
+
+bool ReplayKLine::rxDue_(uint64_t clockUs) const
+{
+    if (finished() || capture_[next_].tx) return false;
+    if (timing_ == Timing::Fast) return true;
+    return clockUs - anchorClockUs_ >= capture_[next_].us - anchorRecordUs_;
+}
+
+int ReplayKLine::available()
+{
+    // Like the virtual ECU: polling costs the caller a little time, so
+    // the session's busy waits move the virtual clock.
+    if (rxDue_(native_arduino::clockUs())) return 1;
+    native_arduino::advanceClockUs(PollStepUs);
+    return rxDue_(native_arduino::clockUs()) ? 1 : 0;
+}
+
+int ReplayKLine::read()
+{
+    if (!rxDue_(native_arduino::clockUs())) return -1;
+    ++rxDelivered_;
+    return capture_[next_++].data;
+}
+
+void ReplayKLine::setTxLevel(bool high)
+{
+    // The first falling edge of an address init stands for the whole
+    // recorded address byte.
+    if (high || initActive_) return;
+    initActive_ = true;
+    if (!finished() && capture_[next_].tx) {
+        ++txMatched_;
+        anchor_(capture_[next_++].us);
+    } else {
+        ++mismatches_;
+    }
+}
+
+} // namespace Sim
+} // namespace obd
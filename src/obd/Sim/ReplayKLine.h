@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "HostKLine.h"
+
+namespace obd {
+namespace Sim {
+
+// One byte of a K-line capture: when it was on the wire (us from any
+// fixed origin), who sent it, and its value.
+struct LineRecord {
+    uint32_t us;
+    bool tx;       // sent by the tester
+    uint8_t data;
+};
+
+using LineCapture = std::vector<LineRecord>;
+
+// Reads the records of the first #KLT1 dump (KWP::KLineTrace::dump(),
+// as captured from the firmware's Serial port) in text; us counts from
+// the dump's base. Lines outside the dump are skipped. False if there is
+// no complete dump.
+bool parseTraceDump(const char *text, LineCapture &out);
+
+// Forwards everything to another line and records every byte that
+// crosses it, against the native virtual clock; the 5-baud address is
+// recorded as one TX byte at its start bit (setTxLevel() is called once
+// per bit, as KWP1281Session clocks them). Used to capture sessions with
+// the virtual ECU for replay.
+class CaptureKLine : public HostKLine {
+public:
+    explicit CaptureKLine(HostKLine &line);
+
+    const LineCapture &capture() const { return capture_; }
+    void clear() { capture_.clear(); }
+
+    void begin(long speed) override { line_.begin(speed); }
+    void end() override { line_.end(); }
+    size_t write(uint8_t data) override;
+    int read() override;
+    int available() override { return line_.available(); }
+    void flush() override { line_.flush(); }
+    void setTxLevel(bool high) override;
+    bool rxHigh() override { return line_.rxHigh(); }
+
+private:
+    HostKLine &line_;
+    LineCapture capture_;
+    uint8_t initBits_;     // 5-baud bits seen since the start bit
+    uint8_t initAddress_;
+    uint32_t initStartUs_;
+};
+
+// Plays a capture back to a KWP1281Session in place of the ECU. The
+// capture's ECU bytes are handed out in order once the session has sent
+// every tester byte recorded before them; what the session sends is
+// checked against the recorded tester bytes (see mismatches()), so a
+// replay doubles as a regression check of the session's decisions.
+//
+// RealTime keeps the recorded timing on the native virtual clock: every
+// tester byte re-anchors the replay, and each ECU byte arrives as long
+// after it as it did in the capture, so timeouts and pacing behave as on
+// the car. Fast hands ECU bytes out as soon as they are next, for
+// measuring the session's CPU cost.
+//
+// The address init is matched as one tester byte at its first edge.
+// The session's bytes take one frame each at the rate begin() was given.
+// rxHigh() always reads idle, so replays need the capture's fixed baud
+// rate rather than detection.
+class ReplayKLine final : public HostKLine {
+public:
+    enum class Timing : uint8_t { RealTime, Fast };
+
+    ReplayKLine(const LineCapture &capture, Timing timing);
+
+    // Back to the first record.
+    void rewind();
+    bool finished() const { return next_ >= capture_.size(); }
+    size_t position() const { return next_; }
+
+    uint32_t txMatched() const { return txMatched_; }
+    uint32_t mismatches() const { return mismatches_; }
+    uint32_t rxDelivered() const { return rxDelivered_; }
+
+    // Only the baud rate matters: a tester byte occupies the line (and
+    // write()) for one frame, as on the real UART.
+    void begin(long speed) override;
+    void end() override {}
+    size_t write(uint8_t data) override;
+    int read() override;
+    int available() override;
+    void flush() override { initActive_ = false; }
+    void setTxLevel(bool high) override;
+    bool rxHigh() override { return true; }
+
+private:
+    static constexpr uint32_t PollStepUs = 10;
+
+    const LineCapture &capture_;
+    Timing timing_;
+    uint32_t byteTimeUs_;
+    size_t next_;
+    uint64_t anchorClockUs_;   // virtual clock at the last tester byte
+    uint32_t anchorRecordUs_;  // its time in the capture
+    bool initActive_;
+    uint32_t txMatched_;
+    uint32_t mismatches_;
+    uint32_t rxDelivered_;
+
+    bool rxDue_(uint64_t nowUs) const;
+    void anchor_(uint32_t recordUs);
+};
+
+} // namespace Sim
+} // namespace obd
@@ -0,0 +1,91 @@
+#include "SharedKLine.h"
+
+namespace obd {
+namespace Sim {
+
+SharedKLine::SharedKLine()
+    : nodes_()
+    , count_(0)
+{
+}
+
+bool SharedKLine::attach(HostKLine &node)
+{
+    if (count_ >= MaxNodes) return false;
+    nodes_[count_++] = &node;
+    return true;
+}
+
+void SharedKLine::begin(long speed)
+{
+    for (uint8_t i = 0; i < count_; ++i) nodes_[i]->begin(speed);
+}
+
+void SharedKLine::end()
+{
+    for (uint8_t i = 0; i < count_; ++i) nodes_[i]->end();
+}
+
+size_t SharedKLine::write(uint8_t data)
+{
+    const uint64_t startUs = native_arduino::clockUs();
+    uint64_t endUs = startUs;
+    for (uint8_t i = 0; i < count_; ++i) {
+        native_arduino::setClockUs(startUs);
+        nodes_[i]->write(data);
+        if (native_arduino::clockUs() > endUs) endUs = native_arduino::clockUs();
+    }
+    native_arduino::setClockUs(endUs);
+    return 1;
+}
+
+int SharedKLine::read()
+{
+    for (uint8_t i = 0; i < count_; ++i) {
+        const int data = nodes_[i]->read();
+        if (data >= 0) return data;
+    }
+    return -1;
+}
+
+int SharedKLine::available()
+{
+    const uint64_t startUs = native_arduino::clockUs();
+    uint64_t endUs = startUs;
+    int count = 0;
+    for (uint8_t i = 0; i < count_; ++i) {
+        native_arduino::setClockUs(startUs);
+        count += nodes_[i]->available();
+        if (native_arduino::clockUs() > endUs) endUs = native_arduino::clockUs();
+    }
+    native_arduino::setClockUs(endUs);
+    return count;
+}
+
+void SharedKLine::flush()
+{
+    for (uint8_t i = 0; i < count_; ++i) nodes_[i]->flush();
+}
+
+void SharedKLine::setTxLevel(bool high)
+{
+    for (uint8_t i = 0; i < count_; ++i) nodes_[i]->setTxLevel(high);
+}
+
+bool SharedKLine::rxHigh()
+{
+    // Wired-AND: any node pulling the line low wins.
+    const uint64_t startUs = native_arduino::clockUs();
+    uint64_t endUs = startUs;
+    bool high = true;
+    for (uint8_t i = 0; i < count_; ++i) {
+        native_arduino::setClockUs(startUs);
+        if (!nodes_[i]->rxHigh()) high = false;
+        if (native_arduino::clockUs() > endUs) endUs = native_arduino::clockUs();
+    }
+    native_arduino::setClockUs(endUs);
+    return high;
+}
+
+} // namespace Sim
+} // namespace obd
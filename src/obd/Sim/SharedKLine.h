@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Arduino.h>
+#include "HostKLine.h"
+
+namespace obd {
+namespace Sim {
+
+// Several simulated ECUs on one K-line, as in the car: every node sees
+// what the tester sends (5-baud address bits and bytes alike) and the
+// tester reads whatever any node puts on the wire. Each node keeps its
+// own time for a byte or a poll; on the shared wire those happen at once,
+// so the virtual clock moves by the longest of them, not their sum.
+// Collisions are not modelled: only the addressed ECU ever talks.
+class SharedKLine final : public HostKLine {
+public:
+    static constexpr uint8_t MaxNodes = 4;
+
+    SharedKLine();
+
+    bool attach(HostKLine &node);
+
+    void begin(long speed) override;
+    void end() override;
+    size_t write(uint8_t data) override;
+    int read() override;
+    int available() override;
+    void flush() override;
+    void setTxLevel(bool high) override;
+    bool rxHigh() override;
+
+private:
+    HostKLine *nodes_[MaxNodes];
+    uint8_t count_;
+};
+
+} // namespace Sim
+} // namespace obd
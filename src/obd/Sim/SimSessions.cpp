@@ -0,0 +1,23 @@
+// The KWP sessions bound directly to the host stand-ins, without going
+// through HostKLine's vtable. A new test or bench line is added here; the
+// firmware's session sources only instantiate KLineSerial.
+
+#include "FuzzKLine.h"
+#include "ReplayKLine.h"
+#include "VirtualEcu.h"
+#include "VirtualKwp2000Ecu.h"
+
+#include "../KWP/KWP1281SessionImpl.h"
+#include "../KWP/KWP2000SessionImpl.h"
+
+namespace obd {
+namespace KWP {
+
+template class BasicKWP1281Session<Sim::FuzzKLine>;
+template class BasicKWP1281Session<Sim::VirtualEcu>;
+template class BasicKWP1281Session<Sim::ReplayKLine>;
+
+template class BasicKWP2000Session<Sim::VirtualKwp2000Ecu>;
+
+} // namespace KWP
+} // namespace obd
@@ -0,0 +1,567 @@
+#include "VirtualEcu.h"
+
+#include <string.h>
+
+namespace obd {
+namespace Sim {
+
+VirtualEcu::VirtualEcu(const VirtualEcuConfig &config)
+    : config_(config)
+    , stats_()
+    , dtcCount_(0)
+    , phase_(Phase::Off)
+    , counter_(0)
+    , byteTimeUs_(10UL * 1000000UL / config.baudRate)
+    , testerBaudOk_(false)
+    , listenFromUs_(0)
+    , lineHigh_(true)
+    , capturing_(false)
+    , edgeCount_(0)
+    , lastInitAddress_(-1)
+    , rxHead_(0)
+    , rxCount_(0)
+    , lineFreeUs_(0)
+    , dropIn_(-1)
+    , errorPattern_(false)
+    , patternSent_(false)
+    , tx_()
+    , txPos_(0)
+    , rx_()
+    , rxExpected_(0)
+    , pendingHead_(0)
+    , pendingCount_(0)
+{
+    memset(groups_, 0, sizeof(groups_));
+    memset(groupValid_, 0, sizeof(groupValid_));
+    ident_[0] = '\0';
+    loadDefaults();
+}
+
+void VirtualEcu::setGroup(uint8_t group, const uint8_t triplets[TripletBytes])
+{
+    memcpy(groups_[group], triplets, TripletBytes);
+    groupValid_[group] = true;
+}
+
+void VirtualEcu::setTriplet(uint8_t group, uint8_t idx, uint8_t k, uint8_t a, uint8_t b)
+{
+    if (idx >= 4) return;
+    groups_[group][idx * 3] = k;
+    groups_[group][idx * 3 + 1] = a;
+    groups_[group][idx * 3 + 2] = b;
+    groupValid_[group] = true;
+}
+
+void VirtualEcu::clearGroup(uint8_t group)
+{
+    memset(groups_[group], 0, TripletBytes);
+    groupValid_[group] = false;
+}
+
+bool VirtualEcu::hasGroup(uint8_t group) const
+{
+    return groupValid_[group];
+}
+
+void VirtualEcu::setIdentification(const char *text)
+{
+    strncpy(ident_, text, sizeof(ident_) - 1);
+    ident_[sizeof(ident_) - 1] = '\0';
+}
+
+void VirtualEcu::setDtcs(const uint16_t *codes, const uint8_t *status, uint8_t count)
+{
+    if (count > MaxDtcs) count = MaxDtcs;
+    for (uint8_t i = 0; i < count; ++i) {
+        dtcCodes_[i] = codes[i];
+        dtcStatus_[i] = status[i];
+    }
+    dtcCount_ = count;
+}
+
+void VirtualEcu::dropByteToTester(uint16_t skip)
+{
+    dropIn_ = skip;
+}
+
+void VirtualEcu::loadDefaults()
+{
+    memset(groupValid_, 0, sizeof(groupValid_));
+    dtcCount_ = 0;
+
+    switch (config_.address) {
+    case 0x17: // instruments
+        setTriplet(1, 0, 7, 100, 50);    // 50 km/h
+        setTriplet(1, 1, 1, 50, 200);    // 2000 rpm
+        setTriplet(1, 2, 8, 10, 0);      // oil pressure min
+        setTriplet(1, 3, 8, 10, 123);    // ECU time
+        setTriplet(2, 0, 36, 48, 57);    // 123450 km
+        setTriplet(2, 1, 19, 100, 45);   // 45 l
+        setTriplet(2, 2, 8, 10, 70);     // fuel sender resistance
+        setTriplet(2, 3, 5, 10, 120);    // 20 C ambient
+        setTriplet(3, 0, 5, 10, 190);    // 90 C coolant
+        setTriplet(3, 1, 8, 10, 1);      // oil level ok
+        setTriplet(3, 2, 5, 10, 185);    // 85 C oil
+        setTriplet(3, 3, 8, 0, 0);
+        setIdentification("1J0920826C  KOMBI+WEGFAHRSP VDO V01   00142 31414");
+        break;
+    case 0x01: // engine
+        setTriplet(1, 0, 1, 50, 80);     // 800 rpm
+        setTriplet(1, 1, 5, 10, 190);    // 90 C
+        setTriplet(1, 2, 8, 10, 3);      // lambda
+        setTriplet(1, 3, 8, 0, 0);
+        setTriplet(3, 0, 1, 50, 80);
+        setTriplet(3, 1, 18, 250, 100);  // 1000 mbar
+        setTriplet(3, 2, 3, 100, 25);    // 5.0 deg throttle
+        setTriplet(3, 3, 3, 100, 10);    // 2.0 deg steering
+        setTriplet(4, 0, 1, 50, 80);
+        setTriplet(4, 1, 6, 200, 70);    // 14.0 V
+        setTriplet(4, 2, 5, 10, 190);
+        setTriplet(4, 3, 5, 10, 150);
+        setTriplet(6, 0, 1, 50, 80);
+        setTriplet(6, 1, 2, 100, 125);   // 25 % load
+        setTriplet(6, 2, 8, 0, 0);
+        setTriplet(6, 3, 8, 10, 2);      // lambda 2
+        setIdentification("036906034AM MARELLI 4LV    2312   00031 31414");
+        break;
+    default:
+        setIdentification("VIRTUAL ECU");
+        break;
+    }
+}
+
+// ---- HostKLine ----
+
+void VirtualEcu::begin(long speed)
+{
+    // The session itself starts on the 5-baud init, not here: the tester
+    // may only open its UART once it has timed our sync byte.
+    // A tester listening at the wrong rate only ever sees silence.
+    const uint32_t rate = config_.baudRate;
+    const uint32_t tester = speed > 0 ? static_cast<uint32_t>(speed) : 0;
+    const uint32_t diff = tester > rate ? tester - rate : rate - tester;
+    testerBaudOk_ = diff * 50 <= rate;
+    listenFromUs_ = native_arduino::clockUs();
+}
+
+void VirtualEcu::end()
+{
+    phase_ = Phase::Off;
+    rxHead_ = rxCount_ = 0;
+    capturing_ = false;
+    testerBaudOk_ = false;
+}
+
+size_t VirtualEcu::write(uint8_t data)
+{
+    const uint64_t startUs = native_arduino::clockUs();
+
+    // The tester's own byte occupies the line for one frame.
+    if (byteTimeUs_ > 0) {
+        native_arduino::advanceClockUs(byteTimeUs_);
+    }
+    ++stats_.bytesFromTester;
+
+    // Sent too soon after (or on top of) our own byte: the ECU is not
+    // listening yet and the byte is lost.
+    if (phase_ != Phase::Off && startUs < lineFreeUs_ + config_.minTesterGapUs) {
+        ++stats_.missedBytes;
+        return 1;
+    }
+    if (timedOut_(startUs)) {
+        return 1;
+    }
+
+    switch (phase_) {
+    case Phase::Off:
+        break;
+    case Phase::Keyword:
+        if (data == (0x8A ^ 0xFF)) {
+            respondNext_();
+        } else {
+            ++stats_.complementErrors;
+            phase_ = Phase::Off;
+        }
+        break;
+    case Phase::EcuTalking:
+        if (data != (tx_.data[txPos_ - 1] ^ 0xFF)) {
+            ++stats_.complementErrors;
+            phase_ = Phase::Off;
+            break;
+        }
+        sendNextByte_(config_.interByteLatencyUs);
+        break;
+    case Phase::TesterTalking:
+        if (rx_.size < MaxBlock) {
+            rx_.data[rx_.size++] = data;
+        }
+        if (rx_.size == 1) {
+            rxExpected_ = static_cast<uint8_t>(data + 1);
+        }
+        if (rx_.size < rxExpected_) {
+            schedule_(data ^ 0xFF, config_.interByteLatencyUs);
+        } else {
+            ++stats_.blocksFromTester;
+            if (rx_.data[1] != counter_) {
+                ++stats_.counterErrors;
+            }
+            counter_ = static_cast<uint8_t>(rx_.data[1] + 1);
+            if (patternSent_) {
+                // The tester's answer to the error pattern: both sides
+                // count blocks from 0 again.
+                patternSent_ = false;
+                counter_ = 0;
+            }
+            handleTesterBlock_();
+        }
+        break;
+    }
+    return 1;
+}
+
+int VirtualEcu::read()
+{
+    decodeAddress_(native_arduino::clockUs());
+    dropUnreadable_(native_arduino::clockUs());
+    if (rxCount_ == 0 || rxArrival_[rxHead_] > native_arduino::clockUs()) {
+        return -1;
+    }
+    uint8_t data = rxData_[rxHead_];
+    rxHead_ = static_cast<uint8_t>((rxHead_ + 1) % RxQueueSize);
+    --rxCount_;
+    return data;
+}
+
+int VirtualEcu::available()
+{
+    // Every poll costs the caller a little time, like a spinning MCU, so
+    // busy-wait loops in the session make progress on the virtual clock.
+    native_arduino::advanceClockUs(PollStepUs);
+    const uint64_t now = native_arduino::clockUs();
+    decodeAddress_(now);
+    dropUnreadable_(now);
+
+    int count = 0;
+    for (uint8_t i = 0; i < rxCount_; ++i) {
+        if (rxArrival_[(rxHead_ + i) % RxQueueSize] > now) break;
+        ++count;
+    }
+    return count;
+}
+
+void VirtualEcu::flush()
+{
+    uint64_t now = native_arduino::clockUs();
+    decodeAddress_(now);
+    while (rxCount_ > 0 && rxArrival_[rxHead_] <= now) {
+        rxHead_ = static_cast<uint8_t>((rxHead_ + 1) % RxQueueSize);
+        --rxCount_;
+    }
+}
+
+void VirtualEcu::setTxLevel(bool high)
+{
+    const uint64_t now = native_arduino::clockUs();
+    decodeAddress_(now);
+    if (high == lineHigh_) return;
+    lineHigh_ = high;
+
+    if (!capturing_) {
+        if (high) return;
+        // Falling edge of the start bit
+        capturing_ = true;
+        edgeCount_ = 0;
+    }
+    if (edgeCount_ < InitBits) {
+        edgeUs_[edgeCount_] = now;
+        edgeHigh_[edgeCount_] = high;
+        ++edgeCount_;
+    }
+}
+
+bool VirtualEcu::rxHigh()
+{
+    native_arduino::advanceClockUs(PinReadUs);
+    const uint64_t now = native_arduino::clockUs();
+    decodeAddress_(now);
+
+    for (uint8_t i = 0; i < rxCount_; ++i) {
+        const uint8_t slot = static_cast<uint8_t>((rxHead_ + i) % RxQueueSize);
+        const uint64_t endUs = rxArrival_[slot];
+        if (now >= endUs || now < endUs - byteTimeUs_) continue;
+        // 8N1 frame: start bit, 8 data bits LSB first, stop bit
+        const uint8_t bit = static_cast<uint8_t>((now - (endUs - byteTimeUs_)) * 10 / byteTimeUs_);
+        if (bit == 0) return false;
+        if (bit >= 9) return true;
+        return ((rxData_[slot] >> (bit - 1)) & 1) != 0;
+    }
+    return true;
+}
+
+// ---- ECU side ----
+
+// Bytes that started while the tester's UART was off, or arrived while
+// it ran at the wrong rate, are lost to it.
+void VirtualEcu::dropUnreadable_(uint64_t nowUs)
+{
+    while (rxCount_ > 0 && rxArrival_[rxHead_] <= nowUs
+           && (!testerBaudOk_ || rxArrival_[rxHead_] - byteTimeUs_ < listenFromUs_)) {
+        rxHead_ = static_cast<uint8_t>((rxHead_ + 1) % RxQueueSize);
+        --rxCount_;
+    }
+}
+
+bool VirtualEcu::lineLevelAt_(uint64_t us) const
+{
+    bool high = true;
+    for (uint8_t i = 0; i < edgeCount_ && edgeUs_[i] <= us; ++i) {
+        high = edgeHigh_[i];
+    }
+    return high;
+}
+
+// Samples a captured 5-baud frame once the middle of its stop bit has
+// passed, and starts the keyword exchange if it carried our address.
+void VirtualEcu::decodeAddress_(uint64_t nowUs)
+{
+    if (!capturing_) return;
+    const uint64_t startUs = edgeUs_[0];
+    if (nowUs < startUs + (InitBits - 1) * InitBitUs + InitBitUs / 2) return;
+    capturing_ = false;
+
+    bool bits[InitBits];
+    for (uint8_t i = 0; i < InitBits; ++i) {
+        bits[i] = lineLevelAt_(startUs + i * InitBitUs + InitBitUs / 2);
+    }
+    uint8_t address = 0;
+    bool odd = false;
+    for (uint8_t i = 1; i <= 7; ++i) {
+        if (bits[i]) {
+            address = static_cast<uint8_t>(address | (1 << (i - 1)));
+            odd = !odd;
+        }
+    }
+    if (bits[0] || !bits[InitBits - 1] || bits[8] == odd) {
+        lastInitAddress_ = -1;
+        return;
+    }
+    lastInitAddress_ = address;
+    if (address != config_.address) return;
+
+    ++stats_.addressInits;
+    rxHead_ = rxCount_ = 0;
+    pendingHead_ = pendingCount_ = 0;
+    lineFreeUs_ = startUs + InitBits * InitBitUs;
+
+    // Sync byte and keyword; the tester complements the last keyword byte.
+    schedule_(0x55, config_.syncDelayUs);
+    schedule_(0x01, config_.interByteLatencyUs);
+    schedule_(0x8A, config_.interByteLatencyUs);
+    counter_ = 1;
+    queueIdentification_();
+    phase_ = Phase::Keyword;
+}
+
+// Applies the ECU's timeouts to the silence before a tester byte that
+// starts at startUs. Returns true if the session has ended.
+bool VirtualEcu::timedOut_(uint64_t startUs)
+{
+    if (phase_ != Phase::EcuTalking && phase_ != Phase::TesterTalking) {
+        return false;
+    }
+    const uint64_t idleUs = startUs - lineFreeUs_;
+    if (idleUs > config_.sessionTimeoutUs) {
+        ++stats_.sessionTimeouts;
+        phase_ = Phase::Off;
+        return true;
+    }
+    if (idleUs <= config_.byteTimeoutUs) {
+        return false;
+    }
+    if (phase_ == Phase::EcuTalking) {
+        // Counts as sent: the next block continues from its counter.
+        counter_ = static_cast<uint8_t>(tx_.data[1] + 1);
+        ++stats_.abandonedBlocks;
+    } else if (rx_.size > 0) {
+        ++stats_.abandonedBlocks;
+    }
+    rx_.size = 0;
+    rxExpected_ = 0;
+    phase_ = Phase::TesterTalking;
+    return false;
+}
+
+void VirtualEcu::schedule_(uint8_t data, uint32_t gapUs)
+{
+    if (rxCount_ >= RxQueueSize) return;
+
+    uint64_t now = native_arduino::clockUs();
+    uint64_t start = (lineFreeUs_ > now ? lineFreeUs_ : now) + gapUs;
+    uint64_t arrival = start + byteTimeUs_;
+    lineFreeUs_ = arrival;
+    ++stats_.bytesToTester;
+
+    if (dropIn_ >= 0 && dropIn_-- == 0) {
+        ++stats_.droppedBytes;
+        return;
+    }
+
+    uint8_t slot = static_cast<uint8_t>((rxHead_ + rxCount_) % RxQueueSize);
+    rxData_[slot] = data;
+    rxArrival_[slot] = arrival;
+    ++rxCount_;
+}
+
+void VirtualEcu::startBlock_(const Block &block, uint32_t gapUs)
+{
+    tx_ = block;
+    tx_.data[1] = counter_;
+    txPos_ = 0;
+    sendNextByte_(gapUs);
+}
+
+void VirtualEcu::sendNextByte_(uint32_t gapUs)
+{
+    schedule_(tx_.data[txPos_], gapUs);
+    ++txPos_;
+    if (txPos_ >= tx_.size) {
+        // Block end byte is never complemented; the tester has the turn.
+        ++counter_;
+        ++stats_.blocksToTester;
+        rx_.size = 0;
+        rxExpected_ = 0;
+        phase_ = Phase::TesterTalking;
+    } else {
+        phase_ = Phase::EcuTalking;
+    }
+}
+
+void VirtualEcu::handleTesterBlock_()
+{
+    const uint8_t title = rx_.size > 2 ? rx_.data[2] : 0x00;
+
+    switch (title) {
+    case 0x09: // ACK: continue a multi-block answer or ack back
+        respondNext_();
+        return;
+    case 0x06: // End output
+        phase_ = Phase::Off;
+        return;
+    case 0x29: // Group reading
+        pendingHead_ = pendingCount_ = 0;
+        if (errorPattern_) {
+            sendErrorPattern_();
+            return;
+        }
+        queueGroup_(rx_.size > 3 ? rx_.data[3] : 0);
+        break;
+    case 0x07: // Read DTCs
+        pendingHead_ = pendingCount_ = 0;
+        queueDtcs_();
+        break;
+    case 0x05: // Delete DTCs
+        pendingHead_ = pendingCount_ = 0;
+        dtcCount_ = 0;
+        queueAck_();
+        break;
+    default:
+        pendingHead_ = pendingCount_ = 0;
+        queueAck_();
+        break;
+    }
+    respondNext_();
+}
+
+void VirtualEcu::respondNext_()
+{
+    if (pendingCount_ == 0) {
+        queueAck_();
+    }
+    Block block = pending_[pendingHead_];
+    pendingHead_ = static_cast<uint8_t>((pendingHead_ + 1) % MaxPending);
+    --pendingCount_;
+    startBlock_(block, config_.blockTurnaroundUs);
+}
+
+void VirtualEcu::push_(const uint8_t *payload, uint8_t payloadSize, uint8_t title)
+{
+    if (pendingCount_ >= MaxPending || payloadSize > MaxBlock - 4) return;
+
+    Block &block = pending_[(pendingHead_ + pendingCount_) % MaxPending];
+    block.data[0] = static_cast<uint8_t>(payloadSize + 3);
+    block.data[1] = 0; // filled with the live counter when sent
+    block.data[2] = title;
+    if (payloadSize > 0) {
+        memcpy(&block.data[3], payload, payloadSize);
+    }
+    block.data[3 + payloadSize] = 0x03;
+    block.size = static_cast<uint8_t>(payloadSize + 4);
+    ++pendingCount_;
+}
+
+void VirtualEcu::queueAck_()
+{
+    push_(nullptr, 0, 0x09);
+}
+
+void VirtualEcu::queueIdentification_()
+{
+    const uint8_t chunk = 12;
+    const size_t len = strlen(ident_);
+    for (size_t pos = 0; pos < len; pos += chunk) {
+        uint8_t n = static_cast<uint8_t>((len - pos) < chunk ? (len - pos) : chunk);
+        push_(reinterpret_cast<const uint8_t *>(&ident_[pos]), n, 0xF6);
+    }
+    queueAck_();
+}
+
+void VirtualEcu::queueGroup_(uint8_t group)
+{
+    if (groupValid_[group]) {
+        push_(groups_[group], TripletBytes, 0xE7);
+    } else {
+        queueAck_();
+    }
+}
+
+void VirtualEcu::sendErrorPattern_()
+{
+    errorPattern_ = false;
+    static const uint8_t pattern[6] = {0x0B, 0xFB, 0x00, 0x0B, 0xFB, 0x00};
+    const uint8_t first = static_cast<uint8_t>((rxHead_ + rxCount_) % RxQueueSize);
+    for (uint8_t i = 0; i < sizeof(pattern); ++i) {
+        schedule_(pattern[i], i == 0 ? config_.blockTurnaroundUs : 0);
+    }
+    // The tester finds the first two bytes waiting together: the ECU did
+    // not wait for a complement. Its complements are lost under the burst.
+    if (rxCount_ >= 2) {
+        rxArrival_[first] = rxArrival_[(first + 1) % RxQueueSize];
+    }
+    ++stats_.blocksToTester;
+    rx_.size = 0;
+    rxExpected_ = 0;
+    patternSent_ = true;
+    phase_ = Phase::TesterTalking;
+}
+
+void VirtualEcu::queueDtcs_()
+{
+    if (dtcCount_ == 0) {
+        const uint8_t none[3] = {0xFF, 0xFF, 0x88};
+        push_(none, 3, 0xFC);
+    }
+    for (uint8_t i = 0; i < dtcCount_; i += 4) {
+        uint8_t payload[12];
+        uint8_t n = 0;
+        for (uint8_t j = i; j < dtcCount_ && j < i + 4; ++j) {
+            payload[n++] = static_cast<uint8_t>(dtcCodes_[j] >> 8);
+            payload[n++] = static_cast<uint8_t>(dtcCodes_[j] & 0xFF);
+            payload[n++] = dtcStatus_[j];
+        }
+        push_(payload, n, 0xFC);
+    }
+    queueAck_();
+}
+
+} // namespace Sim
+} // namespace obd
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <Arduino.h>
+#include "HostKLine.h"
+
+namespace obd {
+namespace Sim {
+
+struct VirtualEcuConfig {
+    uint8_t address = 0x17;
+    uint32_t baudRate = 10400;
+    // ECU turnaround before each byte it puts on the wire (complements
+    // and data bytes alike).
+    uint32_t interByteLatencyUs = 1000;
+    // ECU processing time between the last byte of a tester block and
+    // the first byte of its answer.
+    uint32_t blockTurnaroundUs = 5000;
+    // Quiet time the ECU needs after its own last byte before it can
+    // receive again. Tester bytes arriving sooner are lost.
+    uint32_t minTesterGapUs = 500;
+    // Silence after which the ECU gives up the block in progress (no
+    // complement for its byte, or no next byte of a tester block) and
+    // waits for the tester to start a new block.
+    uint32_t byteTimeoutUs = 50000;
+    // Silence after which the ECU ends the session altogether.
+    uint32_t sessionTimeoutUs = 1100000;
+    // From the end of the 5-baud address stop bit to the 0x55 sync byte
+    // (20..300 ms on real ECUs).
+    uint32_t syncDelayUs = 60000;
+};
+
+struct VirtualEcuStats {
+    uint32_t blocksToTester = 0;
+    uint32_t blocksFromTester = 0;
+    uint32_t bytesToTester = 0;
+    uint32_t bytesFromTester = 0;
+    uint32_t complementErrors = 0;
+    uint32_t counterErrors = 0;
+    uint32_t missedBytes = 0;
+    uint32_t droppedBytes = 0;     // lost on the wire, see dropByteToTester()
+    uint32_t abandonedBlocks = 0;
+    uint32_t sessionTimeouts = 0;
+    uint32_t addressInits = 0;     // 5-baud inits addressed to this ECU
+};
+
+// Simulated KWP1281 ECU sitting on a virtual K-line. It wakes up on a
+// 5-baud init carrying its address (sampled from setTxLevel() edges in
+// the middle of each 200 ms bit), shows its bytes bit by bit on rxHigh()
+// and, to a tester UART set within 2 % of its rate, as bytes; it answers
+// the tester byte by byte with the usual complement handshake, timestamps
+// every byte against the native virtual clock (see native_arduino) and
+// serves configurable measurement groups, identification text and DTCs.
+// Host-only; never built for AVR.
+class VirtualEcu final : public HostKLine {
+public:
+    static constexpr uint8_t TripletBytes = 12;
+    static constexpr uint8_t MaxDtcs = 32;
+
+    explicit VirtualEcu(const VirtualEcuConfig &config = VirtualEcuConfig());
+
+    const VirtualEcuConfig &config() const { return config_; }
+    const VirtualEcuStats &stats() const { return stats_; }
+    void resetStats() { stats_ = VirtualEcuStats(); }
+
+    // Group contents are stored as the four raw (formula, a, b) triplets
+    // the ECU sends in its 0xE7 answer.
+    void setGroup(uint8_t group, const uint8_t triplets[TripletBytes]);
+    void setTriplet(uint8_t group, uint8_t idx, uint8_t k, uint8_t a, uint8_t b);
+    void clearGroup(uint8_t group);
+    bool hasGroup(uint8_t group) const;
+
+    void setIdentification(const char *text);
+    void setDtcs(const uint16_t *codes, const uint8_t *status, uint8_t count);
+    uint8_t dtcCount() const { return dtcCount_; }
+
+    // Fills the groups the firmware maps for the configured address
+    // (0x17 instruments or 0x01 engine) with plausible values.
+    void loadDefaults();
+
+    bool sessionActive() const { return phase_ != Phase::Off; }
+    // Address of the last well-formed 5-baud init seen, for any ECU;
+    // -1 if none, or if its start, stop or parity bit was wrong.
+    int16_t lastInitAddress() const { return lastInitAddress_; }
+
+    // Line noise: the byte the ECU sends `skip` bytes from now (0 = the
+    // next one) occupies the line but never reaches the tester.
+    void dropByteToTester(uint16_t skip);
+    // Line trouble on the ECU's side: the answer to the next group read
+    // is the 6-byte error pattern, sent in one burst without waiting for
+    // complements, instead of the group.
+    void sendErrorPattern() { errorPattern_ = true; }
+
+    // HostKLine
+    void begin(long speed) override;
+    void end() override;
+    size_t write(uint8_t data) override;
+    int read() override;
+    int available() override;
+    void flush() override;
+    void setTxLevel(bool high) override;
+    bool rxHigh() override;
+
+private:
+    enum class Phase : uint8_t {
+        Off,
+        Keyword,       // sync/keyword bytes sent, waiting for ~0x8A
+        EcuTalking,    // sending a block, waiting for the tester complement
+        TesterTalking  // receiving a tester block
+    };
+
+    static constexpr uint8_t MaxBlock = 64;
+    static constexpr uint8_t MaxPending = 16;
+    static constexpr uint8_t RxQueueSize = 16;
+    static constexpr uint32_t PollStepUs = 10;
+    static constexpr uint32_t PinReadUs = 2;
+    static constexpr uint32_t InitBitUs = 200000;
+    static constexpr uint8_t InitBits = 10;
+
+    struct Block {
+        uint8_t data[MaxBlock];
+        uint8_t size;
+    };
+
+    VirtualEcuConfig config_;
+    VirtualEcuStats stats_;
+
+    uint8_t groups_[256][TripletBytes];
+    bool groupValid_[256];
+    char ident_[64];
+    uint16_t dtcCodes_[MaxDtcs];
+    uint8_t dtcStatus_[MaxDtcs];
+    uint8_t dtcCount_;
+
+    Phase phase_;
+    uint8_t counter_;
+    uint32_t byteTimeUs_;
+    bool testerBaudOk_;   // tester UART on, within 2 % of our rate
+    uint64_t listenFromUs_; // when it was turned on
+
+    // 5-baud init capture: TX line edges since the start bit
+    bool lineHigh_;
+    bool capturing_;
+    uint8_t edgeCount_;
+    uint64_t edgeUs_[InitBits];
+    bool edgeHigh_[InitBits];
+    int16_t lastInitAddress_;
+
+    // ECU -> tester bytes, each with the virtual time it finishes arriving
+    uint8_t rxData_[RxQueueSize];
+    uint64_t rxArrival_[RxQueueSize];
+    uint8_t rxHead_;
+    uint8_t rxCount_;
+    uint64_t lineFreeUs_;
+    int32_t dropIn_;   // bytes until the injected loss, -1 = none
+    bool errorPattern_; // see sendErrorPattern()
+    bool patternSent_;  // the tester's next block restarts the counter
+
+    Block tx_;
+    uint8_t txPos_;
+    Block rx_;
+    uint8_t rxExpected_;
+
+    Block pending_[MaxPending];
+    uint8_t pendingHead_;
+    uint8_t pendingCount_;
+
+    void dropUnreadable_(uint64_t nowUs);
+    bool lineLevelAt_(uint64_t us) const;
+    void decodeAddress_(uint64_t nowUs);
+    bool timedOut_(uint64_t startUs);
+    void schedule_(uint8_t data, uint32_t gapUs);
+    void startBlock_(const Block &block, uint32_t gapUs);
+    void sendNextByte_(uint32_t gapUs);
+    void handleTesterBlock_();
+    void respondNext_();
+    void queueAck_();
+    void queueIdentification_();
+    void queueGroup_(uint8_t group);
+    void queueDtcs_();
+    void sendErrorPattern_();
+    void push_(const uint8_t *payload, uint8_t payloadSize, uint8_t title);
+};
+
+} // namespace Sim
+} // namespace obd
@@ -0,0 +1,354 @@
+#include "VirtualKwp2000Ecu.h"
+
+#include <string.h>
+
+namespace obd {
+namespace Sim {
+
+using KWP::KWP2000Frame;
+
+VirtualKwp2000Ecu::VirtualKwp2000Ecu(const VirtualKwp2000EcuConfig &config)
+    : config_(config)
+    , stats_()
+    , session_(false)
+    , awake_(false)
+    , timing_()
+    , pendingAnswers_(0)
+    , corruptNext_(false)
+    , byteTimeUs_(10UL * 1000000UL / BaudRate)
+    , testerBaudOk_(false)
+    , listenFromUs_(0)
+    , lineHigh_(true)
+    , lowSinceUs_(0)
+    , quietSinceUs_(native_arduino::clockUs())
+    , wakeCandidate_(false)
+    , request_()
+    , inRequest_(false)
+    , requestStartUs_(0)
+    , lastTesterByteUs_(0)
+    , rxHead_(0)
+    , rxCount_(0)
+    , lineFreeUs_(0)
+{
+    memset(groups_, 0, sizeof(groups_));
+    memset(tripletCount_, 0, sizeof(tripletCount_));
+    loadDefaults();
+}
+
+void VirtualKwp2000Ecu::setTriplet(uint8_t group, uint8_t idx, uint8_t k, uint8_t a, uint8_t b)
+{
+    if (idx >= MaxTriplets) return;
+    groups_[group][idx * 3] = k;
+    groups_[group][idx * 3 + 1] = a;
+    groups_[group][idx * 3 + 2] = b;
+    if (tripletCount_[group] <= idx) {
+        tripletCount_[group] = static_cast<uint8_t>(idx + 1);
+    }
+}
+
+void VirtualKwp2000Ecu::clearGroup(uint8_t group)
+{
+    memset(groups_[group], 0, sizeof(groups_[group]));
+    tripletCount_[group] = 0;
+}
+
+void VirtualKwp2000Ecu::loadDefaults()
+{
+    memset(tripletCount_, 0, sizeof(tripletCount_));
+
+    switch (config_.address) {
+    case 0x17: // instruments
+        setTriplet(1, 0, 7, 100, 50);    // 50 km/h
+        setTriplet(1, 1, 1, 50, 200);    // 2000 rpm
+        setTriplet(1, 2, 8, 10, 0);      // oil pressure min
+        setTriplet(1, 3, 8, 10, 123);    // ECU time
+        setTriplet(2, 0, 36, 48, 57);    // 123450 km
+        setTriplet(2, 1, 19, 100, 45);   // 45 l
+        setTriplet(2, 2, 8, 10, 70);     // fuel sender resistance
+        setTriplet(2, 3, 5, 10, 120);    // 20 C ambient
+        setTriplet(3, 0, 5, 10, 190);    // 90 C coolant
+        setTriplet(3, 1, 8, 10, 1);      // oil level ok
+        setTriplet(3, 2, 5, 10, 185);    // 85 C oil
+        setTriplet(3, 3, 8, 0, 0);
+        break;
+    case 0x01: // engine
+        setTriplet(1, 0, 1, 50, 80);     // 800 rpm
+        setTriplet(1, 1, 5, 10, 190);    // 90 C
+        setTriplet(1, 2, 8, 10, 3);      // lambda
+        setTriplet(1, 3, 8, 0, 0);
+        setTriplet(3, 0, 1, 50, 80);
+        setTriplet(3, 1, 18, 250, 100);  // 1000 mbar
+        setTriplet(3, 2, 3, 100, 25);    // 5.0 deg throttle
+        setTriplet(3, 3, 3, 100, 10);    // 2.0 deg steering
+        setTriplet(4, 0, 1, 50, 80);
+        setTriplet(4, 1, 6, 200, 70);    // 14.0 V
+        setTriplet(4, 2, 5, 10, 190);
+        setTriplet(4, 3, 5, 10, 150);
+        setTriplet(6, 0, 1, 50, 80);
+        setTriplet(6, 1, 2, 100, 125);   // 25 % load
+        setTriplet(6, 2, 8, 0, 0);
+        setTriplet(6, 3, 8, 10, 2);      // lambda 2
+        break;
+    default:
+        break;
+    }
+}
+
+// ---- HostKLine ----
+
+void VirtualKwp2000Ecu::begin(long speed)
+{
+    // A tester listening at the wrong rate only ever sees silence, and
+    // we cannot make out what it sends.
+    const uint32_t tester = speed > 0 ? static_cast<uint32_t>(speed) : 0;
+    const uint32_t diff = tester > BaudRate ? tester - BaudRate : BaudRate - tester;
+    testerBaudOk_ = diff * 50 <= BaudRate;
+    listenFromUs_ = native_arduino::clockUs();
+}
+
+void VirtualKwp2000Ecu::end()
+{
+    testerBaudOk_ = false;
+}
+
+size_t VirtualKwp2000Ecu::write(uint8_t data)
+{
+    const uint64_t startUs = native_arduino::clockUs();
+    native_arduino::advanceClockUs(byteTimeUs_);
+    const uint64_t endUs = native_arduino::clockUs();
+    ++stats_.bytesFromTester;
+
+    if (inRequest_ && startUs - lastTesterByteUs_ > FrameGapUs) {
+        inRequest_ = false;
+    }
+    lastTesterByteUs_ = endUs;
+    if (!testerBaudOk_) {
+        inRequest_ = false;
+        return 1;
+    }
+    if (!inRequest_) {
+        request_.reset();
+        requestStartUs_ = startUs;
+        inRequest_ = true;
+    }
+
+    switch (request_.feed(data)) {
+    case KWP2000Frame::Status::More:
+        break;
+    case KWP2000Frame::Status::Done:
+        inRequest_ = false;
+        handleRequest_(requestStartUs_);
+        break;
+    case KWP2000Frame::Status::Error:
+        inRequest_ = false;
+        ++stats_.checksumErrors;
+        break;
+    }
+    return 1;
+}
+
+int VirtualKwp2000Ecu::read()
+{
+    dropUnreadable_(native_arduino::clockUs());
+    if (rxCount_ == 0 || rxArrival_[rxHead_] > native_arduino::clockUs()) {
+        return -1;
+    }
+    const uint8_t data = rxData_[rxHead_];
+    rxHead_ = static_cast<uint8_t>((rxHead_ + 1) % RxQueueSize);
+    --rxCount_;
+    return data;
+}
+
+int VirtualKwp2000Ecu::available()
+{
+    // Polling costs the caller a little time, as with VirtualEcu.
+    native_arduino::advanceClockUs(PollStepUs);
+    const uint64_t now = native_arduino::clockUs();
+    dropUnreadable_(now);
+
+    int count = 0;
+    for (uint8_t i = 0; i < rxCount_; ++i) {
+        if (rxArrival_[(rxHead_ + i) % RxQueueSize] > now) break;
+        ++count;
+    }
+    return count;
+}
+
+void VirtualKwp2000Ecu::flush()
+{
+    const uint64_t now = native_arduino::clockUs();
+    while (rxCount_ > 0 && rxArrival_[rxHead_] <= now) {
+        rxHead_ = static_cast<uint8_t>((rxHead_ + 1) % RxQueueSize);
+        --rxCount_;
+    }
+}
+
+void VirtualKwp2000Ecu::setTxLevel(bool high)
+{
+    const uint64_t now = native_arduino::clockUs();
+    if (high == lineHigh_) return;
+    lineHigh_ = high;
+
+    if (!high) {
+        uint64_t quiet = quietSinceUs_;
+        if (lastTesterByteUs_ > quiet) quiet = lastTesterByteUs_;
+        if (lineFreeUs_ > quiet) quiet = lineFreeUs_;
+        lowSinceUs_ = now;
+        wakeCandidate_ = now - quiet >= WakeIdleUs;
+        awake_ = false;
+        return;
+    }
+
+    const uint64_t lowUs = now - lowSinceUs_;
+    quietSinceUs_ = now;
+    if (wakeCandidate_ && lowUs >= WakeLowMinUs && lowUs <= WakeLowMaxUs) {
+        // A new fast init ends whatever session there was.
+        awake_ = true;
+        session_ = false;
+        inRequest_ = false;
+        timing_ = KWP::KWP2000Timing();
+        ++stats_.wakeUps;
+    }
+}
+
+// ---- ECU side ----
+
+// Bytes that started while the tester's UART was off, or arrived while
+// it ran at the wrong rate, are lost to it.
+void VirtualKwp2000Ecu::dropUnreadable_(uint64_t nowUs)
+{
+    while (rxCount_ > 0 && rxArrival_[rxHead_] <= nowUs
+           && (!testerBaudOk_ || rxArrival_[rxHead_] - byteTimeUs_ < listenFromUs_)) {
+        rxHead_ = static_cast<uint8_t>((rxHead_ + 1) % RxQueueSize);
+        --rxCount_;
+    }
+}
+
+void VirtualKwp2000Ecu::handleRequest_(uint64_t startUs)
+{
+    ++stats_.framesFromTester;
+    if ((request_.format() & 0xC0) && request_.target() != config_.address) return;
+
+    const uint8_t *data = request_.data();
+    const uint8_t size = request_.size();
+    const uint8_t service = request_.service();
+
+    if (!session_) {
+        if (!awake_ || service != KWP2000Frame::StartCommunication) return;
+        awake_ = false;
+        session_ = true;
+        const uint8_t answer[3] = {
+            static_cast<uint8_t>(service + KWP2000Frame::PositiveOffset),
+            static_cast<uint8_t>(config_.keyBytes & 0xFF),
+            static_cast<uint8_t>(config_.keyBytes >> 8)};
+        answer_(answer, 3);
+        return;
+    }
+
+    if (startUs < lineFreeUs_ + timing_.p3Min * 1000ULL) {
+        ++stats_.earlyRequests;
+        return;
+    }
+    if (startUs > lineFreeUs_ + timing_.p3Max * 1000ULL) {
+        ++stats_.sessionTimeouts;
+        session_ = false;
+        return;
+    }
+
+    const uint8_t positive = static_cast<uint8_t>(service + KWP2000Frame::PositiveOffset);
+    switch (service) {
+    case KWP2000Frame::StartCommunication: {
+        const uint8_t answer[3] = {positive, static_cast<uint8_t>(config_.keyBytes & 0xFF),
+                                   static_cast<uint8_t>(config_.keyBytes >> 8)};
+        answer_(answer, 3);
+        break;
+    }
+    case KWP2000Frame::StopCommunication:
+        answer_(&positive, 1);
+        session_ = false;
+        break;
+    case KWP2000Frame::TesterPresent:
+        answer_(&positive, 1);
+        break;
+    case KWP2000Frame::AccessTimingParameters: {
+        KWP::KWP2000Timing requested;
+        if (size == 7 && data[1] == 0x03 && requested.decode(&data[2])) {
+            // Answered with the old timing; the new one holds from here.
+            const uint8_t answer[2] = {positive, 0x03};
+            answer_(answer, 2);
+            timing_ = requested;
+        } else if (size == 2 && data[1] == 0x02) {
+            uint8_t answer[7] = {positive, 0x02};
+            timing_.encode(&answer[2]);
+            answer_(answer, 7);
+        } else {
+            negative_(service, KWP2000Frame::SubFunctionNotSupported);
+        }
+        break;
+    }
+    case KWP2000Frame::ReadDataByLocalId: {
+        const uint8_t group = size > 1 ? data[1] : 0;
+        if (size < 2 || tripletCount_[group] == 0) {
+            negative_(service, KWP2000Frame::RequestOutOfRange);
+            break;
+        }
+        uint8_t answer[2 + MaxTriplets * 3] = {positive, group};
+        memcpy(&answer[2], groups_[group], tripletCount_[group] * 3);
+        answer_(answer, static_cast<uint8_t>(2 + tripletCount_[group] * 3));
+        break;
+    }
+    default:
+        negative_(service, KWP2000Frame::ServiceNotSupported);
+        break;
+    }
+}
+
+void VirtualKwp2000Ecu::negative_(uint8_t service, uint8_t code)
+{
+    const uint8_t answer[3] = {KWP2000Frame::NegativeResponse, service, code};
+    ++stats_.negativeAnswers;
+    answer_(answer, 3);
+}
+
+void VirtualKwp2000Ecu::answer_(const uint8_t *data, uint8_t size)
+{
+    // Not before P2min after the request, nor on top of our own bytes
+    const uint64_t now = native_arduino::clockUs();
+    const uint64_t p2MinUs = timing_.p2Min * 1000ULL;
+    uint64_t startUs = now + (config_.processingUs > p2MinUs ? config_.processingUs : p2MinUs);
+    if (startUs < lineFreeUs_) startUs = lineFreeUs_;
+
+    for (uint8_t i = 0; i < pendingAnswers_; ++i) {
+        const uint8_t pending[3] = {KWP2000Frame::NegativeResponse, request_.service(),
+                                    KWP2000Frame::ResponsePending};
+        startUs = queueFrame_(pending, 3, startUs, false) + config_.pendingDelayUs;
+    }
+    queueFrame_(data, size, startUs, corruptNext_);
+    corruptNext_ = false;
+}
+
+uint64_t VirtualKwp2000Ecu::queueFrame_(const uint8_t *data, uint8_t size, uint64_t startUs,
+                                        bool corrupt)
+{
+    uint8_t frame[KWP2000Frame::MaxFrame];
+    const uint8_t length = KWP2000Frame::build(frame, KWP2000Frame::TesterAddress, config_.address,
+                                               data, size);
+    if (corrupt && length > 0) {
+        frame[length - 1] ^= 0xFF;
+    }
+    for (uint8_t i = 0; i < length && rxCount_ < RxQueueSize; ++i) {
+        const uint64_t arrival = startUs + byteTimeUs_;
+        const uint8_t slot = static_cast<uint8_t>((rxHead_ + rxCount_) % RxQueueSize);
+        rxData_[slot] = frame[i];
+        rxArrival_[slot] = arrival;
+        ++rxCount_;
+        ++stats_.bytesToTester;
+        lineFreeUs_ = arrival;
+        startUs = arrival + config_.interByteUs;
+    }
+    ++stats_.framesToTester;
+    return lineFreeUs_;
+}
+
+} // namespace Sim
+} // namespace obd
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <Arduino.h>
+#include "HostKLine.h"
+#include "../KWP/KWP2000Frame.h"
+
+namespace obd {
+namespace Sim {
+
+struct VirtualKwp2000EcuConfig {
+    uint8_t address = 0x01;
+    // KB1 in the low byte, as StartCommunication sends them
+    uint16_t keyBytes = 0x8FEF;
+    // ECU turnaround before each byte of an answer after the first (P1)
+    uint32_t interByteUs = 1000;
+    // Processing time before an answer; it never starts before P2min.
+    uint32_t processingUs = 2000;
+    // From a "response pending" answer to the next one or the real one
+    uint32_t pendingDelayUs = 100000;
+};
+
+struct VirtualKwp2000EcuStats {
+    uint32_t wakeUps = 0;           // fast-init patterns seen
+    uint32_t framesFromTester = 0;
+    uint32_t framesToTester = 0;
+    uint32_t bytesFromTester = 0;
+    uint32_t bytesToTester = 0;
+    uint32_t checksumErrors = 0;
+    uint32_t earlyRequests = 0;     // inside P3min of our answer, ignored
+    uint32_t sessionTimeouts = 0;   // request after P3max; session over
+    uint32_t negativeAnswers = 0;
+};
+
+// Simulated KWP2000 (ISO 14230) ECU on a virtual K-line. It wakes up on
+// the fast-init pattern (25 ms low after at least 300 ms of quiet line,
+// seen through setTxLevel()), takes StartCommunication and then answers
+// ReadDataByLocalIdentifier with the same triplets VirtualEcu serves,
+// TesterPresent, AccessTimingParameters and StopCommunication. It keeps
+// to P2min/P1 on its side, holds the tester to P3min/P3max and drops
+// frames with a bad checksum, all against the native virtual clock.
+// Host-only; never built for AVR.
+class VirtualKwp2000Ecu final : public HostKLine {
+public:
+    static constexpr uint8_t MaxTriplets = 10;
+
+    explicit VirtualKwp2000Ecu(const VirtualKwp2000EcuConfig &config = VirtualKwp2000EcuConfig());
+
+    const VirtualKwp2000EcuConfig &config() const { return config_; }
+    const VirtualKwp2000EcuStats &stats() const { return stats_; }
+    void resetStats() { stats_ = VirtualKwp2000EcuStats(); }
+
+    void setTriplet(uint8_t group, uint8_t idx, uint8_t k, uint8_t a, uint8_t b);
+    void clearGroup(uint8_t group);
+    bool hasGroup(uint8_t group) const { return tripletCount_[group] > 0; }
+    // The groups VirtualEcu serves for the configured address, with the
+    // same values, so both sessions can be checked against each other.
+    void loadDefaults();
+
+    bool sessionActive() const { return session_; }
+    // Timing the tester has agreed with us (AccessTimingParameters)
+    const KWP::KWP2000Timing &timing() const { return timing_; }
+
+    // Each of the following answers goes out after count "response
+    // pending" answers.
+    void setPendingAnswers(uint8_t count) { pendingAnswers_ = count; }
+    // The next answer carries a wrong checksum.
+    void corruptNextAnswer() { corruptNext_ = true; }
+
+    // HostKLine
+    void begin(long speed) override;
+    void end() override;
+    size_t write(uint8_t data) override;
+    int read() override;
+    int available() override;
+    void flush() override;
+    void setTxLevel(bool high) override;
+    bool rxHigh() override { return true; }
+
+private:
+    static constexpr uint32_t BaudRate = 10400;
+    static constexpr uint8_t RxQueueSize = 128;
+    static constexpr uint32_t PollStepUs = 10;
+    // Fast init: quiet line before (W5) and the low pulse (TiniL), with
+    // a little slack for the tester's timer.
+    static constexpr uint32_t WakeIdleUs = 299000;
+    static constexpr uint32_t WakeLowMinUs = 24000;
+    static constexpr uint32_t WakeLowMaxUs = 26000;
+    // Gap after which a partly received request is thrown away (P4max)
+    static constexpr uint32_t FrameGapUs = 20000;
+
+    VirtualKwp2000EcuConfig config_;
+    VirtualKwp2000EcuStats stats_;
+
+    uint8_t groups_[256][MaxTriplets * 3];
+    uint8_t tripletCount_[256];
+
+    bool session_;
+    bool awake_;          // fast init seen, StartCommunication next
+    KWP::KWP2000Timing timing_;
+    uint8_t pendingAnswers_;
+    bool corruptNext_;
+
+    uint32_t byteTimeUs_;
+    bool testerBaudOk_;   // tester UART on, within 2 % of our rate
+    uint64_t listenFromUs_;
+
+    bool lineHigh_;
+    uint64_t lowSinceUs_;
+    uint64_t quietSinceUs_;  // end of the last byte or edge on the line
+    bool wakeCandidate_;     // the line was quiet long enough before this low
+
+    KWP::KWP2000Frame request_;
+    bool inRequest_;
+    uint64_t requestStartUs_;
+    uint64_t lastTesterByteUs_;
+
+    // ECU -> tester bytes, each with the virtual time it finishes arriving
+    uint8_t rxData_[RxQueueSize];
+    uint64_t rxArrival_[RxQueueSize];
+    uint8_t rxHead_;
+    uint8_t rxCount_;
+    uint64_t lineFreeUs_;    // end of our last byte
+
+    void dropUnreadable_(uint64_t nowUs);
+    void handleRequest_(uint64_t startUs);
+    void answer_(const uint8_t *data, uint8_t size);
+    void negative_(uint8_t service, uint8_t code);
+    uint64_t queueFrame_(const uint8_t *data, uint8_t size, uint64_t startUs, bool corrupt);
+};
+
+} // namespace Sim
+} // namespace obd
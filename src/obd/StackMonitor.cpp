@@ -0,0 +1,66 @@
+#include "StackMonitor.h"
+
+#if defined(__AVR__)
+extern uint8_t __heap_start;
+extern uint8_t *__brkval;
+#endif
+
+namespace obd {
+
+#if defined(__AVR__)
+
+static constexpr uint8_t StackPaint = 0xC5;
+// Left alone below the stack pointer for paintStack()'s own frame.
+static constexpr uint8_t StackPaintMargin = 16;
+
+static uint8_t *heapEnd_()
+{
+    return __brkval != nullptr ? __brkval : &__heap_start;
+}
+
+void paintStack()
+{
+    uint8_t marker;
+    uint8_t *end = &marker - StackPaintMargin;
+    for (uint8_t *p = heapEnd_(); p < end; ++p) {
+        *p = StackPaint;
+    }
+}
+
+uint16_t stackFreeNow()
+{
+    uint8_t marker;
+    return static_cast<uint16_t>(&marker - heapEnd_());
+}
+
+uint16_t stackFreeMin()
+{
+    uint8_t marker;
+    const uint8_t *p = heapEnd_();
+    uint16_t free = 0;
+    while (p < &marker && *p == StackPaint) {
+        ++p;
+        ++free;
+    }
+    return free;
+}
+
+#else
+
+void paintStack()
+{
+}
+
+uint16_t stackFreeNow()
+{
+    return 0;
+}
+
+uint16_t stackFreeMin()
+{
+    return 0;
+}
+
+#endif
+
+} // namespace obd
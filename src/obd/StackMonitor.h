@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace obd {
+
+// Stack high-water measurement by painting: paintStack() fills the free
+// SRAM between the heap and the current stack pointer with a marker byte,
+// and stackFreeMin() later counts how much of it was never overwritten.
+// That is the worst-case headroom since painting, including interrupt
+// frames. Host builds have no such gap and report 0.
+void paintStack();
+
+// Bytes between the heap end and the stack pointer right now.
+uint16_t stackFreeNow();
+
+// Smallest headroom seen since paintStack().
+uint16_t stackFreeMin();
+
+} // namespace obd
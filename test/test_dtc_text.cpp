@@ -0,0 +1,83 @@
+// Unity tests for the DTC description table: the sorted code index, the
+// token decompression and cutting a text to the caller's buffer.
+// Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <string.h>
+
+#include "obd/Model/DtcText.h"
+#include "obd/Model/DtcTextTable.h"
+
+using namespace obd;
+
+void test_dtc_text_lookup_and_decode()
+{
+    char text[Model::DtcTextMaxLength + 1];
+
+    // Plain VAG codes, and OBD-II P codes in their VAG form
+    TEST_ASSERT_EQUAL_UINT8(17, Model::describeDtc(532, text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING("Supply Voltage B+", text);
+    Model::describeDtc(513, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("Engine Speed Sensor (G28)", text);
+    Model::describeDtc(16684, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("Random/Multiple Cylinder Misfire Detected", text);
+    Model::describeDtc(16515, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("O2 Sensor Circuit Low Voltage Bank 1 Sensor 1", text);
+    Model::describeDtc(18058, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("Powertrain Data Bus Missing Message from Cluster", text);
+
+    // First and last slots of the index, and codes it does not have
+    // (between entries, below the first, above the last)
+    TEST_ASSERT_EQUAL_INT16(0, Model::findDtcText(pgm_read_word(&Model::DtcTextTable::Codes[0])));
+    const uint16_t last = Model::DtcTextTable::CodeCount - 1;
+    TEST_ASSERT_EQUAL_INT16(last, Model::findDtcText(pgm_read_word(&Model::DtcTextTable::Codes[last])));
+    TEST_ASSERT_EQUAL_INT16(-1, Model::findDtcText(531));
+    TEST_ASSERT_EQUAL_INT16(-1, Model::findDtcText(0));
+    TEST_ASSERT_EQUAL_INT16(-1, Model::findDtcText(0xFFFF));
+    strcpy(text, "stale");
+    TEST_ASSERT_EQUAL_UINT8(0, Model::describeDtc(531, text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING("", text);
+
+    // Every entry: sorted, found where it is, printable and in bounds
+    uint16_t previous = 0;
+    for (uint16_t i = 0; i < Model::DtcTextTable::CodeCount; ++i) {
+        const uint16_t code = pgm_read_word(&Model::DtcTextTable::Codes[i]);
+        if (i > 0) TEST_ASSERT_TRUE(code > previous);
+        previous = code;
+        TEST_ASSERT_EQUAL_INT16(i, Model::findDtcText(code));
+        const uint8_t length = Model::describeDtc(code, text, sizeof(text));
+        TEST_ASSERT_TRUE(length > 0 && length <= Model::DtcTextMaxLength);
+        TEST_ASSERT_EQUAL_UINT8(length, strlen(text));
+        for (uint8_t k = 0; k < length; ++k) {
+            TEST_ASSERT_TRUE(text[k] >= 0x20 && text[k] <= 0x7E);
+        }
+    }
+}
+
+void test_dtc_text_cut_to_buffer()
+{
+    // One LCD row: the text is cut, the length is still the full one
+    char row[17];
+    memset(row, 'x', sizeof(row));
+    TEST_ASSERT_EQUAL_UINT8(41, Model::describeDtc(16684, row, sizeof(row)));
+    TEST_ASSERT_EQUAL_STRING("Random/Multiple ", row);
+
+    // A token straddling the end of the buffer
+    char shortBuf[10];
+    Model::describeDtc(16515, shortBuf, sizeof(shortBuf));
+    TEST_ASSERT_EQUAL_STRING("O2 Sensor", shortBuf);
+
+    // Nothing written past size, and size 0 writes nothing at all
+    char guard[4] = {'a', 'b', 'c', 'd'};
+    Model::describeDtc(532, guard, 2);
+    TEST_ASSERT_EQUAL_INT('S', guard[0]);
+    TEST_ASSERT_EQUAL_INT('\0', guard[1]);
+    TEST_ASSERT_EQUAL_INT('c', guard[2]);
+    TEST_ASSERT_EQUAL_UINT8(17, Model::describeDtc(532, guard + 3, 0));
+    TEST_ASSERT_EQUAL_INT('d', guard[3]);
+
+    // The dictionary pays for itself
+    const Model::DtcTextFootprint f = Model::dtcTextFootprint();
+    TEST_ASSERT_EQUAL_UINT16(Model::DtcTextTable::CodeCount, f.codes);
+    TEST_ASSERT_TRUE(f.packedTextBytes < f.rawTextBytes / 2);
+}
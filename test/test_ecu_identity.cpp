@@ -0,0 +1,126 @@
+// Unity tests for the ECU identification record: parsing the 0xF6 text,
+// caching it in EEPROM and the faster reconnect that cache allows.
+// Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <EEPROM.h>
+#include <string.h>
+
+#include "obd/KWP/IdentParser.h"
+#include "obd/KWP/IdentityCache.h"
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+
+// Feeds text the way VirtualEcu sends it, in 12-character blocks.
+static void parseIdent(const char *text, Model::EcuIdentity &out)
+{
+    KWP::IdentParser parser(out);
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(text);
+    size_t len = strlen(text);
+    for (size_t pos = 0; pos < len; pos += 12) {
+        parser.feed(p + pos, static_cast<uint8_t>(len - pos < 12 ? len - pos : 12));
+    }
+    parser.finish();
+}
+
+void test_ident_parse_cluster()
+{
+    Model::EcuIdentity id;
+    parseIdent("1J0920826C  KOMBI+WEGFAHRSP VDO V01   00142 31414", id);
+    TEST_ASSERT_TRUE(id.valid);
+    TEST_ASSERT_EQUAL_STRING("1J0920826C", id.partNumber);
+    TEST_ASSERT_EQUAL_STRING("KOMBI+WEGFAHRSP VDO V01", id.component);
+    TEST_ASSERT_EQUAL_UINT32(142, id.coding);
+    TEST_ASSERT_EQUAL_UINT32(31414, id.workshopCode);
+}
+
+void test_ident_parse_engine_and_plain_text()
+{
+    Model::EcuIdentity id;
+    parseIdent("036906034AM MARELLI 4LV    2312   00031 31414", id);
+    TEST_ASSERT_EQUAL_STRING("036906034AM", id.partNumber);
+    TEST_ASSERT_EQUAL_STRING("MARELLI 4LV    2312", id.component);
+    TEST_ASSERT_EQUAL_UINT32(31, id.coding);
+    TEST_ASSERT_EQUAL_UINT32(31414, id.workshopCode);
+
+    // No trailing coding/workshop pair
+    parseIdent("VIRTUAL ECU", id);
+    TEST_ASSERT_EQUAL_STRING("VIRTUAL ECU", id.partNumber);
+    TEST_ASSERT_EQUAL_STRING("", id.component);
+    TEST_ASSERT_EQUAL_UINT32(0, id.coding);
+
+    parseIdent("", id);
+    TEST_ASSERT_FALSE(id.valid);
+}
+
+void test_identity_cache_round_trip()
+{
+    native_arduino::eepromErase();
+    KWP::IdentityCache cache(0);
+    Model::EcuIdentity id;
+    parseIdent("1J0920826C  KOMBI+WEGFAHRSP VDO V01   00142 31414", id);
+    cache.store(0x17, 10400, 0xCAFEF00D, 1250, id);
+
+    // Storing the same record again writes nothing.
+    const uint32_t writes = native_arduino::eepromWrites();
+    cache.store(0x17, 10400, 0xCAFEF00D, 1250, id);
+    TEST_ASSERT_EQUAL_UINT32(writes, native_arduino::eepromWrites());
+
+    KWP::IdentityCache reloaded(0);
+    Model::EcuIdentity back;
+    uint32_t identity = 0;
+    uint16_t pacingUs = 0;
+    TEST_ASSERT_FALSE(reloaded.load(0x17, 9600, identity, pacingUs, back));
+    TEST_ASSERT_TRUE(reloaded.load(0x17, 10400, identity, pacingUs, back));
+    TEST_ASSERT_EQUAL_HEX32(0xCAFEF00D, identity);
+    TEST_ASSERT_EQUAL_UINT16(1250, pacingUs);
+    TEST_ASSERT_EQUAL_STRING("1J0920826C", back.partNumber);
+    TEST_ASSERT_EQUAL_STRING("KOMBI+WEGFAHRSP VDO V01", back.component);
+    TEST_ASSERT_EQUAL_UINT32(142, back.coding);
+    TEST_ASSERT_EQUAL_UINT32(31414, back.workshopCode);
+
+    reloaded.forget(0x17, 10400);
+    TEST_ASSERT_FALSE(reloaded.load(0x17, 10400, identity, pacingUs, back));
+}
+
+// Virtual time from the start of the connect to the first group value.
+static void timeToFirstValue(Sim::VirtualEcu &ecu, Model::OBDSignals &signals,
+                             uint32_t &spentUs)
+{
+    // A new session object each time: nothing survives in RAM.
+    KWP::KWP1281Session kwp(ecu);
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    const uint64_t start = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+    spentUs = static_cast<uint32_t>(native_arduino::clockUs() - start);
+
+    TEST_ASSERT_EQUAL_STRING("1J0920826C", kwp.ecuIdentity().partNumber);
+    TEST_ASSERT_EQUAL_UINT32(142, kwp.ecuIdentity().coding);
+    kwp.disconnect();
+}
+
+void test_kwp_reconnect_restores_pacing()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcuConfig config;
+    config.address = 0x17;
+    config.baudRate = 10400;
+    Sim::VirtualEcu ecu(config);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    uint32_t firstUs = 0;
+    uint32_t againUs = 0;
+    timeToFirstValue(ecu, signals, firstUs);
+    timeToFirstValue(ecu, signals, againUs);
+    char msg[96];
+    snprintf(msg, sizeof(msg), "time to first value: %.1f ms first connect, %.1f ms known ECU",
+             firstUs / 1000.0, againUs / 1000.0);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_THAN(firstUs, againUs);
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().missedBytes);
+}
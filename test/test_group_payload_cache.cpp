@@ -0,0 +1,191 @@
+// Unity tests for GroupPayloadCache and the delta decode it drives: a
+// group answer with the same bytes as last time is not decoded again.
+// Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <EEPROM.h>
+
+#include "obd/KWP/GroupPayloadCache.h"
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/KWP/KWPFormula.h"
+#include "obd/KWP/TripletDecode.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+using KWP::GroupPayloadCache;
+
+void test_group_payload_cache_changed_triplets()
+{
+    GroupPayloadCache cache;
+    uint8_t answer[12] = {7, 100, 50, 1, 50, 200, 8, 10, 0, 8, 10, 123};
+
+    // Not held yet, then the same bytes again
+    TEST_ASSERT_EQUAL_HEX8(GroupPayloadCache::AllChanged, cache.update(1, answer, 4));
+    TEST_ASSERT_EQUAL_HEX8(0x00, cache.update(1, answer, 4));
+
+    // One bit per triplet whose bytes moved (formula or either value byte)
+    answer[5] = 201;
+    answer[9] = 5;
+    TEST_ASSERT_EQUAL_HEX8(0x0A, cache.update(1, answer, 4));
+    TEST_ASSERT_EQUAL_HEX8(0x00, cache.update(1, answer, 4));
+
+    // Another length is a new answer; more than fits counts as the max
+    TEST_ASSERT_EQUAL_HEX8(GroupPayloadCache::AllChanged, cache.update(1, answer, 3));
+    TEST_ASSERT_EQUAL_HEX8(GroupPayloadCache::AllChanged, cache.update(1, answer, 9));
+    TEST_ASSERT_EQUAL_HEX8(0x00, cache.update(1, answer, 4));
+
+    // A fifth group takes the slot updated longest ago (group 2 here)
+    for (uint8_t g = 2; g <= 4; ++g) cache.update(g, answer, 4);
+    TEST_ASSERT_EQUAL_HEX8(0x00, cache.update(1, answer, 4));
+    TEST_ASSERT_EQUAL_HEX8(GroupPayloadCache::AllChanged, cache.update(5, answer, 4));
+    TEST_ASSERT_EQUAL_HEX8(GroupPayloadCache::AllChanged, cache.update(2, answer, 4));
+    TEST_ASSERT_EQUAL_HEX8(0x00, cache.update(1, answer, 4));
+    TEST_ASSERT_EQUAL_HEX8(0x00, cache.update(5, answer, 4));
+
+    // Forgotten or cleared: decoded in full again
+    cache.show(5, 4);
+    cache.forget(5);
+    TEST_ASSERT_FALSE(cache.shows(5));
+    TEST_ASSERT_EQUAL_HEX8(GroupPayloadCache::AllChanged, cache.update(5, answer, 4));
+    cache.show(1, 4);
+    TEST_ASSERT_TRUE(cache.shows(1));
+    cache.clear();
+    TEST_ASSERT_FALSE(cache.shows(1));
+    TEST_ASSERT_EQUAL_HEX8(GroupPayloadCache::AllChanged, cache.update(1, answer, 4));
+}
+
+static void clearFlags(Model::OBDSignals &signals)
+{
+    signals.instruments.odometerUpdated = false;
+    signals.instruments.fuelLevelUpdated = false;
+    signals.instruments.ambientTempUpdated = false;
+    signals.instruments.vehicleSpeedUpdated = false;
+    signals.experimental.kUpdated = false;
+    signals.experimental.vUpdated = false;
+    signals.experimental.unitUpdated = false;
+}
+
+void test_kwp_group_read_decodes_changed_triplets()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcuConfig config;
+    config.address = 0x17;
+    Sim::VirtualEcu ecu(config);
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_EQUAL_UINT32(123450, signals.instruments.odometer);
+    TEST_ASSERT_TRUE(signals.experimental.vUpdated);
+
+    // The same answer again: nothing to decode, nothing to redraw, and
+    // the experimental slots still show it
+    clearFlags(signals);
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_FALSE(signals.instruments.odometerUpdated);
+    TEST_ASSERT_FALSE(signals.experimental.kUpdated);
+    TEST_ASSERT_FALSE(signals.experimental.vUpdated);
+    TEST_ASSERT_FALSE(signals.experimental.unitUpdated);
+    TEST_ASSERT_EQUAL_UINT32(123450, signals.instruments.odometer);
+    TEST_ASSERT_EQUAL_UINT8(45, signals.instruments.fuelLevel);
+    TEST_ASSERT_EQUAL_UINT8(19, signals.experimental.k[1]);
+    TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(19, 100, 45).scaled, signals.experimental.v[1]);
+    TEST_ASSERT_EQUAL_STRING("l", signals.experimental.unit[1]);
+
+    // One triplet moves: only its field is stored and flagged
+    ecu.setTriplet(2, 1, 19, 100, 30);
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_EQUAL_UINT8(30, signals.instruments.fuelLevel);
+    TEST_ASSERT_TRUE(signals.instruments.fuelLevelUpdated);
+    TEST_ASSERT_FALSE(signals.instruments.odometerUpdated);
+    TEST_ASSERT_FALSE(signals.instruments.ambientTempUpdated);
+    TEST_ASSERT_TRUE(signals.experimental.vUpdated);
+    TEST_ASSERT_FALSE(signals.experimental.kUpdated);
+    TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(19, 100, 30).scaled, signals.experimental.v[1]);
+
+    // Another group in between takes the experimental slots; the next
+    // group 2 answer fills them all again, its bound fields stay as they are
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+    TEST_ASSERT_EQUAL_UINT8(7, signals.experimental.k[0]);
+    clearFlags(signals);
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_EQUAL_UINT8(2, signals.experimental.groupCurrent);
+    TEST_ASSERT_EQUAL_UINT8(36, signals.experimental.k[0]);
+    TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(36, 48, 57).scaled, signals.experimental.v[0]);
+    TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(5, 10, 120).scaled, signals.experimental.v[3]);
+    TEST_ASSERT_FALSE(signals.instruments.odometerUpdated);
+    TEST_ASSERT_FALSE(signals.instruments.fuelLevelUpdated);
+
+    // A fresh connect starts from nothing: signals may have been reset
+    kwp.disconnect();
+    signals.reset();
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_EQUAL_UINT32(123450, signals.instruments.odometer);
+    TEST_ASSERT_EQUAL_UINT8(30, signals.instruments.fuelLevel);
+}
+
+void test_group_delta_decode_answer_shrinks()
+{
+    GroupPayloadCache cache;
+    Model::OBDSignals signals;
+    signals.reset();
+    const uint8_t four[12] = {7, 100, 50, 1, 50, 200, 8, 10, 0, 8, 10, 123};
+
+    KWP::prepareGroupRead(1, nullptr, cache, signals);
+    KWP::decodeTriplets(0x17, 1, four, 4, cache, signals);
+    TEST_ASSERT_EQUAL_UINT8(8, signals.experimental.k[3]);
+
+    // Three triplets where there were four: the fourth slot is not left
+    // showing the old value
+    KWP::prepareGroupRead(1, nullptr, cache, signals);
+    KWP::decodeTriplets(0x17, 1, four, 3, cache, signals);
+    TEST_ASSERT_EQUAL_UINT8(8, signals.experimental.k[2]);
+    TEST_ASSERT_EQUAL_UINT8(0, signals.experimental.k[3]);
+    TEST_ASSERT_EQUAL_INT32(-1, signals.experimental.v[3]);
+
+    // A refused group is cleared before its next read
+    KWP::markGroupUnsupported(1, signals);
+    KWP::prepareGroupRead(1, nullptr, cache, signals);
+    TEST_ASSERT_FALSE(signals.experimental.unsupported);
+    TEST_ASSERT_EQUAL_UINT8(0, signals.experimental.k[0]);
+}
+
+void test_kwp_failed_group_read_clears_slots()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcuConfig config;
+    config.address = 0x17;
+    Sim::VirtualEcu ecu(config);
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_EQUAL_UINT8(19, signals.experimental.k[1]);
+
+    // The re-read fails: the slots do not keep showing the last answer
+    clearFlags(signals);
+    ecu.sendErrorPattern();
+    TEST_ASSERT_FALSE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_TRUE(signals.experimental.vUpdated);
+    for (uint8_t i = 0; i < Model::ExperimentalGroup::Count; ++i) {
+        TEST_ASSERT_EQUAL_UINT8(0, signals.experimental.k[i]);
+        TEST_ASSERT_EQUAL_INT32(-1, signals.experimental.v[i]);
+        TEST_ASSERT_EQUAL_STRING("ERR", signals.experimental.unit[i]);
+    }
+
+    // The same bytes as before the failure are decoded in full again
+    clearFlags(signals);
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_TRUE(signals.experimental.kUpdated);
+    TEST_ASSERT_EQUAL_UINT8(19, signals.experimental.k[1]);
+    TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(19, 100, 45).scaled, signals.experimental.v[1]);
+    TEST_ASSERT_EQUAL_STRING("l", signals.experimental.unit[1]);
+}
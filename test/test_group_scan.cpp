@@ -0,0 +1,151 @@
+// Unity tests for the group capability scan and its EEPROM map. Registered
+// in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <EEPROM.h>
+
+#include "obd/KWP/GroupCapabilities.h"
+#include "obd/KWP/GroupScan.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+using KWP::GroupCapabilities;
+
+static const uint8_t NoFormulas[GroupCapabilities::Formulas] = {0, 0, 0, 0};
+
+void test_capabilities_record_and_select()
+{
+    native_arduino::eepromErase();
+    GroupCapabilities caps(0);
+    TEST_ASSERT_FALSE(caps.select(0x1234));
+
+    const uint8_t f2[GroupCapabilities::Formulas] = {36, 19, 8, 5};
+    caps.beginRecord(0x1234);
+    for (uint16_t g = 0; g <= 255; ++g) {
+        caps.record(static_cast<uint8_t>(g), g == 2, g == 2 ? f2 : NoFormulas);
+    }
+    // Nothing is trusted until the scan is committed.
+    TEST_ASSERT_FALSE(caps.absent(7));
+    caps.endRecord();
+
+    GroupCapabilities reloaded(0);
+    TEST_ASSERT_FALSE(reloaded.select(0x9999));
+    TEST_ASSERT_TRUE(reloaded.select(0x1234));
+    TEST_ASSERT_EQUAL_UINT8(1, reloaded.count());
+    TEST_ASSERT_TRUE(reloaded.absent(7));
+    TEST_ASSERT_TRUE(reloaded.absent(255));
+    TEST_ASSERT_FALSE(reloaded.absent(2));
+    uint8_t f[GroupCapabilities::Formulas];
+    TEST_ASSERT_TRUE(reloaded.formulas(2, f));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(f2, f, GroupCapabilities::Formulas);
+    TEST_ASSERT_FALSE(reloaded.formulas(7, f));
+}
+
+void test_capabilities_interrupted_scan_is_invalid()
+{
+    native_arduino::eepromErase();
+    GroupCapabilities caps(0);
+    caps.beginRecord(0x42);
+    caps.record(0, false, NoFormulas);
+    caps.record(1, true, NoFormulas);
+    // Power lost here: no endRecord()
+
+    GroupCapabilities reloaded(0);
+    TEST_ASSERT_FALSE(reloaded.select(0x42));
+    TEST_ASSERT_FALSE(reloaded.absent(0));
+}
+
+void test_capabilities_overflow_limits_coverage()
+{
+    native_arduino::eepromErase();
+    GroupCapabilities caps(0);
+    caps.beginRecord(0x77);
+    for (uint16_t g = 0; g <= 255; ++g) {
+        caps.record(static_cast<uint8_t>(g), true, NoFormulas);
+    }
+    caps.endRecord();
+
+    TEST_ASSERT_TRUE(caps.select(0x77));
+    TEST_ASSERT_EQUAL_UINT8(GroupCapabilities::MaxEntries, caps.count());
+    // Groups past the last stored one are unknown, not absent.
+    TEST_ASSERT_FALSE(caps.absent(GroupCapabilities::MaxEntries));
+    TEST_ASSERT_FALSE(caps.absent(200));
+}
+
+void test_kwp_group_scan_builds_map()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcuConfig config;
+    config.address = 0x17;
+    config.baudRate = 10400;
+    Sim::VirtualEcu ecu(config);
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_FALSE(kwp.capabilities().known());
+
+    KWP::GroupScan scan(kwp);
+    scan.begin();
+    uint16_t steps = 1;
+    while (scan.step(signals)) {
+        ++steps;
+    }
+    TEST_ASSERT_FALSE(scan.failed());
+    TEST_ASSERT_EQUAL_UINT16(256, steps);
+    TEST_ASSERT_EQUAL_UINT16(3, scan.found());
+    TEST_ASSERT_TRUE(kwp.capabilities().known());
+
+    // Next session with the same ECU: layout known right after connect.
+    kwp.disconnect();
+    KWP::KWP1281Session again(ecu);
+    baud = 10400;
+    addr = 0x17;
+    TEST_ASSERT_TRUE(again.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_TRUE(again.capabilities().known());
+
+    const uint32_t blocks = ecu.stats().blocksFromTester;
+    TEST_ASSERT_FALSE(again.startGroupRead(9, signals));
+    TEST_ASSERT_EQUAL_UINT32(blocks, ecu.stats().blocksFromTester);
+    TEST_ASSERT_TRUE(signals.experimental.unsupported);
+
+    TEST_ASSERT_TRUE(again.startGroupRead(2, signals));
+    TEST_ASSERT_EQUAL_UINT8(36, signals.experimental.k[0]);
+    TEST_ASSERT_EQUAL_UINT8(19, signals.experimental.k[1]);
+    TEST_ASSERT_EQUAL_STRING("km", signals.experimental.unit[0]);
+    TEST_ASSERT_TRUE(again.completePending(signals));
+    TEST_ASSERT_EQUAL_UINT32(123450, signals.instruments.odometer);
+}
+
+void test_kwp_group_map_keyed_by_identity()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcuConfig config;
+    config.address = 0x17;
+    config.baudRate = 10400;
+    Sim::VirtualEcu ecu(config);
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    const uint32_t identity = kwp.identity();
+    KWP::GroupScan scan(kwp);
+    scan.begin();
+    while (scan.step(signals)) {
+    }
+    kwp.disconnect();
+
+    // Same address, different cluster: the map does not apply.
+    ecu.setIdentification("1J0920906L  KOMBI+WEGFAHRSP VDO V02   00142 31414");
+    baud = 10400;
+    addr = 0x17;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_TRUE(kwp.identity() != identity);
+    TEST_ASSERT_FALSE(kwp.capabilities().known());
+}
@@ -0,0 +1,205 @@
+// Unity tests for the KWP2000 (ISO 14230) session: the frame parser and
+// timing encoding, and KWP2000Session against Sim::VirtualKwp2000Ecu.
+// Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <string.h>
+
+#include "obd/KWP/KWP2000Frame.h"
+#include "obd/KWP/KWP2000Session.h"
+#include "obd/KWP/KWPFormula.h"
+#include "obd/Sim/VirtualKwp2000Ecu.h"
+
+using namespace obd;
+
+namespace {
+
+using Session = KWP::BasicKWP2000Session<Sim::VirtualKwp2000Ecu>;
+
+KWP::KWP2000Frame::Status feedAll(KWP::KWP2000Frame &parser, const uint8_t *bytes, uint8_t size)
+{
+    KWP::KWP2000Frame::Status status = KWP::KWP2000Frame::Status::More;
+    for (uint8_t i = 0; i < size; ++i) {
+        status = parser.feed(bytes[i]);
+    }
+    return status;
+}
+
+} // namespace
+
+void test_kwp2000_frame_build_and_parse()
+{
+    using KWP::KWP2000Frame;
+
+    // StartCommunication to the engine ECU, as on the wire
+    const uint8_t start = KWP2000Frame::StartCommunication;
+    uint8_t frame[KWP2000Frame::MaxFrame];
+    TEST_ASSERT_EQUAL_UINT8(5, KWP2000Frame::build(frame, 0x01, 0xF1, &start, 1));
+    const uint8_t wire[5] = {0x81, 0x01, 0xF1, 0x81, 0xF4};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(wire, frame, 5);
+
+    KWP2000Frame parser;
+    TEST_ASSERT_EQUAL(KWP2000Frame::Status::Done, feedAll(parser, frame, 5));
+    TEST_ASSERT_EQUAL_HEX8(0x01, parser.target());
+    TEST_ASSERT_EQUAL_HEX8(0xF1, parser.source());
+    TEST_ASSERT_EQUAL_UINT8(1, parser.size());
+    TEST_ASSERT_EQUAL_HEX8(0x81, parser.service());
+
+    // Without addresses, and with a length byte of its own
+    const uint8_t bare[4] = {0x02, 0x7E, 0x00, 0x80};
+    TEST_ASSERT_EQUAL(KWP2000Frame::Status::Done, feedAll(parser, bare, 4));
+    TEST_ASSERT_EQUAL_UINT8(0, parser.target());
+    TEST_ASSERT_EQUAL_UINT8(2, parser.size());
+    uint8_t data[KWP2000Frame::MaxData];
+    for (uint8_t i = 0; i < sizeof(data); ++i) {
+        data[i] = i;
+    }
+    const uint8_t length = KWP2000Frame::build(frame, 0xF1, 0x01, data, KWP2000Frame::MaxData);
+    TEST_ASSERT_EQUAL_UINT8(KWP2000Frame::MaxFrame, length);
+    TEST_ASSERT_EQUAL_HEX8(0x80, frame[0]);
+    TEST_ASSERT_EQUAL_UINT8(KWP2000Frame::MaxData, frame[3]);
+    TEST_ASSERT_EQUAL(KWP2000Frame::Status::Done, feedAll(parser, frame, length));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, parser.data(), KWP2000Frame::MaxData);
+
+    // A bad checksum fails the frame, and the parser starts over
+    frame[length - 1] ^= 0x01;
+    TEST_ASSERT_EQUAL(KWP2000Frame::Status::Error, feedAll(parser, frame, length));
+    TEST_ASSERT_EQUAL_UINT8(0, parser.size());
+    TEST_ASSERT_EQUAL(KWP2000Frame::Status::Done, feedAll(parser, wire, 5));
+
+    // Longer than we keep, or empty: failed as soon as the length is in
+    const uint8_t tooLong[4] = {0x80, 0xF1, 0x01, KWP2000Frame::MaxData + 1};
+    TEST_ASSERT_EQUAL(KWP2000Frame::Status::Error, feedAll(parser, tooLong, 4));
+    const uint8_t empty[4] = {0x80, 0xF1, 0x01, 0x00};
+    TEST_ASSERT_EQUAL(KWP2000Frame::Status::Error, feedAll(parser, empty, 4));
+    TEST_ASSERT_EQUAL_UINT8(0, KWP2000Frame::build(frame, 0x01, 0xF1, data, 0));
+
+    // Timing: the standard's defaults survive the round trip; minimums
+    // round up to the 0.5 ms steps, maximums to 25 and 250 ms.
+    KWP::KWP2000Timing timing;
+    uint8_t encoded[5];
+    timing.encode(encoded);
+    const uint8_t defaults[5] = {50, 2, 110, 20, 10};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(defaults, encoded, 5);
+    KWP::KWP2000Timing decoded;
+    TEST_ASSERT_TRUE(decoded.decode(encoded));
+    TEST_ASSERT_EQUAL_UINT16(timing.p2Max, decoded.p2Max);
+    TEST_ASSERT_EQUAL_UINT16(timing.p3Max, decoded.p3Max);
+    TEST_ASSERT_EQUAL_UINT16(timing.p3Min, decoded.p3Min);
+    const uint8_t odd[5] = {1, 1, 3, 1, 0};
+    TEST_ASSERT_TRUE(decoded.decode(odd));
+    TEST_ASSERT_EQUAL_UINT16(1, decoded.p2Min);
+    TEST_ASSERT_EQUAL_UINT16(25, decoded.p2Max);
+    TEST_ASSERT_EQUAL_UINT16(2, decoded.p3Min);
+    TEST_ASSERT_EQUAL_UINT16(250, decoded.p3Max);
+    const uint8_t noP2Max[5] = {0, 0, 0, 1, 0};
+    TEST_ASSERT_FALSE(decoded.decode(noP2Max));
+}
+
+void test_kwp2000_connect_and_read_groups()
+{
+    Sim::VirtualKwp2000Ecu ecu;
+    Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    // Fast init: 300 ms of quiet line, the 50 ms pattern and one
+    // exchange at the default timing, against KWP1281's 2 s address
+    const uint64_t startUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(kwp.connect(0x01));
+    const uint64_t connectUs = native_arduino::clockUs() - startUs;
+    TEST_ASSERT_TRUE(connectUs < 450000);
+    TEST_ASSERT_TRUE(ecu.sessionActive());
+    TEST_ASSERT_EQUAL_UINT32(1, ecu.stats().wakeUps);
+    TEST_ASSERT_EQUAL_HEX16(0x8FEF, kwp.keyBytes());
+
+    // Group 1 of the engine ECU: rpm and coolant through the bindings,
+    // all four in the experimental view
+    TEST_ASSERT_TRUE(kwp.readGroup(1, signals));
+    TEST_ASSERT_EQUAL_UINT8(1, signals.experimental.groupCurrent);
+    TEST_ASSERT_FALSE(signals.experimental.unsupported);
+    TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(1, 50, 80).scaled, signals.experimental.v[0]);
+    TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(5, 10, 190).scaled, signals.experimental.v[1]);
+    TEST_ASSERT_EQUAL_UINT16(800, signals.instruments.engineRpm);
+
+    // A group the ECU does not have is refused, and shown as such
+    TEST_ASSERT_TRUE(kwp.readGroup(2, signals));
+    TEST_ASSERT_TRUE(signals.experimental.unsupported);
+    TEST_ASSERT_EQUAL_HEX8(KWP::KWP2000Frame::RequestOutOfRange, kwp.lastNegative());
+
+    // More triplets than there are slots: the rest is dropped
+    for (uint8_t i = 0; i < Sim::VirtualKwp2000Ecu::MaxTriplets; ++i) {
+        ecu.setTriplet(9, i, 1, static_cast<uint8_t>(10 + i), 50);
+    }
+    TEST_ASSERT_TRUE(kwp.readGroup(9, signals));
+    TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(1, 13, 50).scaled,
+                            signals.experimental.v[Model::ExperimentalGroup::Count - 1]);
+
+    TEST_ASSERT_TRUE(kwp.keepAlive());
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().earlyRequests);
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().checksumErrors);
+
+    kwp.disconnect();
+    TEST_ASSERT_FALSE(kwp.connected());
+    TEST_ASSERT_FALSE(ecu.sessionActive());
+    TEST_ASSERT_FALSE(kwp.readGroup(1, signals));
+
+    // No answer for an address nobody has
+    TEST_ASSERT_FALSE(kwp.connect(0x17));
+    TEST_ASSERT_EQUAL(Session::Result::NoAnswer, kwp.lastResult());
+}
+
+void test_kwp2000_timing_pending_and_errors()
+{
+    Sim::VirtualKwp2000Ecu ecu;
+    Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+    TEST_ASSERT_TRUE(kwp.connect(0x01));
+
+    // Shorter P2/P3: both sides keep to it from the next request on
+    const uint64_t slowStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(kwp.readGroup(1, signals));
+    const uint64_t slowUs = native_arduino::clockUs() - slowStartUs;
+    KWP::KWP2000Timing fast;
+    fast.p2Min = 0;
+    fast.p3Min = 5;
+    fast.p4Min = 0;
+    TEST_ASSERT_TRUE(kwp.setTiming(fast));
+    TEST_ASSERT_EQUAL_UINT16(5, ecu.timing().p3Min);
+    TEST_ASSERT_EQUAL_UINT16(5, kwp.timing().p3Min);
+    const uint64_t fastStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(kwp.readGroup(1, signals));
+    const uint64_t fastUs = native_arduino::clockUs() - fastStartUs;
+    TEST_ASSERT_TRUE(fastUs * 2 < slowUs);
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().earlyRequests);
+
+    // "Response pending" is waited through, past P2max
+    ecu.setPendingAnswers(2);
+    const uint64_t pendingStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(kwp.readGroup(3, signals));
+    TEST_ASSERT_TRUE(native_arduino::clockUs() - pendingStartUs > 2 * ecu.config().pendingDelayUs);
+    TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(18, 250, 100).scaled, signals.experimental.v[1]);
+    ecu.setPendingAnswers(0);
+
+    // A corrupted answer fails that read only
+    ecu.corruptNextAnswer();
+    TEST_ASSERT_FALSE(kwp.readGroup(1, signals));
+    TEST_ASSERT_EQUAL(Session::Result::BadFrame, kwp.lastResult());
+    TEST_ASSERT_TRUE(kwp.readGroup(1, signals));
+
+    // Idle past P3max: keep-alive was due, and the ECU has let go
+    TEST_ASSERT_FALSE(kwp.keepAliveDue());
+    delay(Session::KeepAliveIdleMs);
+    TEST_ASSERT_TRUE(kwp.keepAliveDue());
+    delay(kwp.timing().p3Max);
+    TEST_ASSERT_FALSE(kwp.readGroup(1, signals));
+    TEST_ASSERT_EQUAL(Session::Result::NoAnswer, kwp.lastResult());
+    TEST_ASSERT_EQUAL_UINT32(1, ecu.stats().sessionTimeouts);
+
+    // A new fast init starts over with the default timing
+    TEST_ASSERT_TRUE(kwp.connect(0x01));
+    TEST_ASSERT_EQUAL_UINT16(KWP::KWP2000Timing().p3Min, ecu.timing().p3Min);
+    TEST_ASSERT_TRUE(kwp.readGroup(4, signals));
+    TEST_ASSERT_EQUAL_UINT32(2, ecu.stats().wakeUps);
+}
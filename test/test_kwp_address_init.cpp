@@ -0,0 +1,122 @@
+// Unity tests for the 5-baud address init: the 7O1 bit pattern, its bit
+// timing on the virtual clock, and the virtual ECU only waking up for
+// its own address. Registered in the combined runner in
+// test_obd_signals_more.cpp.
+
+#include <unity.h>
+
+#include "obd/KWP/FiveBaudInit.h"
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+
+namespace {
+
+// A K-line with nothing on it that records every TX level change.
+class RecordingLine : public Sim::HostKLine {
+public:
+    static constexpr uint8_t MaxEdges = 16;
+
+    uint8_t count = 0;
+    uint64_t edgeUs[MaxEdges];
+    bool edgeHigh[MaxEdges];
+
+    void begin(long) override {}
+    void end() override {}
+    size_t write(uint8_t) override { return 1; }
+    int read() override { return -1; }
+    int available() override
+    {
+        native_arduino::advanceClockUs(10);
+        return 0;
+    }
+    void flush() override {}
+    bool rxHigh() override
+    {
+        native_arduino::advanceClockUs(2);
+        return true;
+    }
+    void setTxLevel(bool high) override
+    {
+        if (count < MaxEdges) {
+            edgeUs[count] = native_arduino::clockUs();
+            edgeHigh[count] = high;
+            ++count;
+        }
+    }
+};
+
+} // namespace
+
+void test_five_baud_bit_pattern()
+{
+    // start, 7 data bits LSB first, odd parity, stop
+    const bool instruments[10] = {0, 1, 1, 1, 0, 1, 0, 0, 1, 1}; // 0x17
+    const bool engine[10] = {0, 1, 0, 0, 0, 0, 0, 0, 0, 1};      // 0x01
+    for (uint8_t i = 0; i < KWP::FiveBaudInit::Bits; ++i) {
+        TEST_ASSERT_EQUAL(instruments[i], KWP::FiveBaudInit::bitLevel(0x17, i));
+        TEST_ASSERT_EQUAL(engine[i], KWP::FiveBaudInit::bitLevel(0x01, i));
+    }
+}
+
+void test_kwp_address_init_bit_timing()
+{
+    RecordingLine line;
+    KWP::KWP1281Session kwp(line);
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+
+    // Blocking connect: every edge exactly on the 200 ms grid
+    TEST_ASSERT_FALSE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_EQUAL_UINT8(KWP::FiveBaudInit::Bits, line.count);
+    for (uint8_t i = 0; i < line.count; ++i) {
+        uint32_t sinceStart = static_cast<uint32_t>(line.edgeUs[i] - line.edgeUs[0]);
+        TEST_ASSERT_UINT32_WITHIN(5, i * KWP::FiveBaudInit::BitUs, sinceStart);
+        TEST_ASSERT_EQUAL(KWP::FiveBaudInit::bitLevel(0x17, i), line.edgeHigh[i]);
+    }
+
+    // Non-blocking: a main loop doing ~7 ms of other work per pass. No
+    // poll() waits, and late edges do not push the later ones back.
+    RecordingLine polled;
+    KWP::KWP1281Session kwp2(polled);
+    Model::OBDSignals signals;
+    signals.reset();
+    baud = 10400;
+    const uint64_t start = native_arduino::clockUs();
+    kwp2.startConnect(baud, 0x17);
+    KWP::PollStatus status;
+    uint32_t passes = 0;
+    do {
+        const uint64_t before = native_arduino::clockUs();
+        status = kwp2.poll(signals);
+        TEST_ASSERT_TRUE(native_arduino::clockUs() - before < 100);
+        native_arduino::advanceClockUs(7000);
+        ++passes;
+    } while (status == KWP::PollStatus::Busy);
+    TEST_ASSERT_EQUAL(KWP::PollStatus::Done, status);
+    TEST_ASSERT_TRUE(passes > 250);
+    TEST_ASSERT_EQUAL_UINT8(KWP::FiveBaudInit::Bits, polled.count);
+    for (uint8_t i = 0; i < polled.count; ++i) {
+        uint64_t ideal = start + i * KWP::FiveBaudInit::BitUs;
+        TEST_ASSERT_TRUE(polled.edgeUs[i] >= ideal);
+        TEST_ASSERT_TRUE(polled.edgeUs[i] - ideal < 7100);
+    }
+}
+
+void test_kwp_address_init_wakes_addressed_ecu_only()
+{
+    Sim::VirtualEcu ecu; // instruments, 0x17
+    KWP::KWP1281Session kwp(ecu);
+    uint16_t baud = 10400;
+    uint8_t addr = 0x01;
+
+    TEST_ASSERT_FALSE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_EQUAL_INT16(0x01, ecu.lastInitAddress());
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().addressInits);
+
+    addr = 0x17;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_EQUAL_INT16(0x17, ecu.lastInitAddress());
+    TEST_ASSERT_EQUAL_UINT32(1, ecu.stats().addressInits);
+}
@@ -0,0 +1,68 @@
+// Unity tests for detecting the ECU's baud rate from the timing of its
+// 0x55 sync byte (connect with baud rate 0). Registered in the combined
+// runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+
+static Sim::VirtualEcuConfig instrumentsAt(uint32_t baudRate)
+{
+    Sim::VirtualEcuConfig config;
+    config.address = 0x17;
+    config.baudRate = baudRate;
+    return config;
+}
+
+void test_kwp_autobaud_standard_rates()
+{
+    const uint16_t rates[] = {1200, 2400, 4800, 9600, 10400};
+    for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i) {
+        Sim::VirtualEcu ecu(instrumentsAt(rates[i]));
+        KWP::KWP1281Session kwp(ecu);
+        Model::OBDSignals signals;
+        signals.reset();
+
+        uint16_t baud = 0;
+        uint8_t addr = 0x17;
+        TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+        TEST_ASSERT_EQUAL_UINT16(rates[i], kwp.baudRate());
+        TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+        TEST_ASSERT_EQUAL_UINT16(50, signals.instruments.vehicleSpeed);
+        TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().complementErrors);
+        kwp.disconnect();
+    }
+}
+
+void test_kwp_autobaud_off_table_rate()
+{
+    // Too far from 10400 and 9600 to be snapped to either
+    Sim::VirtualEcu ecu(instrumentsAt(10000));
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    uint16_t baud = 0;
+    uint8_t addr = 0x17;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_UINT16_WITHIN(100, 10000, kwp.baudRate());
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+    TEST_ASSERT_EQUAL_UINT16(2000, signals.instruments.engineRpm);
+}
+
+void test_kwp_autobaud_no_sync_fails_fast()
+{
+    Sim::VirtualEcu ecu(instrumentsAt(10400));
+    KWP::KWP1281Session kwp(ecu);
+
+    // Nobody answers address 0x01: give up once the sync is overdue
+    // instead of waiting out the byte timeout as well.
+    uint16_t baud = 0;
+    uint8_t addr = 0x01;
+    const uint32_t start = millis();
+    TEST_ASSERT_FALSE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_TRUE(millis() - start < 2000 + 400);
+}
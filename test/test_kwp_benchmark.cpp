@@ -0,0 +1,408 @@
+// End-to-end throughput benchmark: KWP1281Session against the virtual ECU.
+// Bus figures are in virtual (simulated wire) time, so they show what the
+// session's pacing and block handling cost on a real K-line; the host
+// figure is the CPU time spent in the session per group read.
+// Registered in the combined runner in test_obd_signals_more.cpp; run with
+// `pio test -e native -v` to see the report.
+
+#include <unity.h>
+#include <EEPROM.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "obd/KWP/GroupScheduler.h"
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/KWP/KWP2000Session.h"
+#include "obd/KWP/KWPFormula.h"
+#include "obd/KWP/TripletDecode.h"
+#include "obd/Model/DtcText.h"
+#include "obd/Model/DtcTextTable.h"
+#include "obd/Sim/ReplayKLine.h"
+#include "obd/Sim/VirtualEcu.h"
+#include "obd/Sim/VirtualKwp2000Ecu.h"
+
+using namespace obd;
+
+static void benchmarkGroupReads(uint8_t address, uint32_t baudRate, uint8_t firstGroup,
+                                uint8_t lastGroup, uint16_t rounds)
+{
+    // Every run starts from a first connect, whatever earlier tests
+    // left in the identity cache.
+    native_arduino::eepromErase();
+    Sim::VirtualEcuConfig config;
+    config.address = address;
+    config.baudRate = baudRate;
+    Sim::VirtualEcu ecu(config);
+    KWP::BasicKWP1281Session<Sim::VirtualEcu> kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    uint16_t baud = static_cast<uint16_t>(baudRate);
+    uint8_t addr = address;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    ecu.resetStats();
+
+    const uint64_t busStartUs = native_arduino::clockUs();
+    const auto hostStart = std::chrono::steady_clock::now();
+    uint32_t groups = 0;
+    for (uint16_t r = 0; r < rounds; ++r) {
+        for (uint8_t g = firstGroup; g <= lastGroup; ++g) {
+            TEST_ASSERT_TRUE(kwp.readSensorsGroup(g, signals));
+            ++groups;
+        }
+    }
+    const auto hostEnd = std::chrono::steady_clock::now();
+    const double busSeconds = (native_arduino::clockUs() - busStartUs) / 1e6;
+    const double hostUs =
+        std::chrono::duration<double, std::micro>(hostEnd - hostStart).count();
+
+    const Sim::VirtualEcuStats &st = ecu.stats();
+    const uint32_t blocks = st.blocksToTester + st.blocksFromTester;
+    const uint32_t bytes = st.bytesToTester + st.bytesFromTester;
+    TEST_ASSERT_EQUAL_UINT32(0, st.complementErrors);
+
+    printf("[bench] addr 0x%02X @%5u baud: %6.2f groups/s %6.2f blocks/s %7.1f bytes/s"
+           " %6.2f ms/group (bus) %7.2f us/group (host)\n",
+           address, static_cast<unsigned>(baudRate), groups / busSeconds, blocks / busSeconds,
+           bytes / busSeconds, busSeconds * 1000.0 / groups, hostUs / groups);
+}
+
+void test_kwp_benchmark_group_reads()
+{
+    benchmarkGroupReads(0x17, 10400, 1, 3, 100);
+    benchmarkGroupReads(0x01, 9600, 3, 4, 100);
+}
+
+// Replays the capture runs times through a session of type Session;
+// hostSeconds is the time taken, blocks the blocks handled.
+template <class Session>
+static void replayRuns(const Sim::LineCapture &capture, uint16_t runs, double &hostSeconds,
+                       uint32_t &blocks)
+{
+    blocks = 0;
+    const auto hostStart = std::chrono::steady_clock::now();
+    for (uint16_t run = 0; run < runs; ++run) {
+        native_arduino::eepromErase();
+        Sim::ReplayKLine replay(capture, Sim::ReplayKLine::Timing::Fast);
+        Session kwp(replay);
+        Model::OBDSignals signals;
+        signals.reset();
+        uint16_t baud = 10400;
+        uint8_t addr = 0x17;
+        TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+        for (uint16_t i = 0; i < 300; ++i) {
+            TEST_ASSERT_TRUE(kwp.readSensorsGroup(1 + i % 3, signals));
+        }
+        TEST_ASSERT_TRUE(replay.finished());
+        TEST_ASSERT_EQUAL_UINT32(0, replay.mismatches());
+        blocks += kwp.stats().blocks();
+    }
+    hostSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
+}
+
+// Session CPU cost without the bus: a captured session (connect, then
+// groups 1..3 over and over) replayed as fast as the session takes the
+// bytes, once through the HostKLine interface (KWP1281Session on the
+// host) and once with the replay bound at compile time, as the firmware
+// binds NewSoftwareSerial. Every run re-checks the session's bytes
+// against the capture.
+void test_kwp_benchmark_replay()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcu ecu;
+    Sim::CaptureKLine capture(ecu);
+    {
+        KWP::KWP1281Session kwp(capture);
+        Model::OBDSignals signals;
+        signals.reset();
+        uint16_t baud = 10400;
+        uint8_t addr = 0x17;
+        TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+        for (uint16_t i = 0; i < 300; ++i) {
+            TEST_ASSERT_TRUE(kwp.readSensorsGroup(1 + i % 3, signals));
+        }
+    }
+
+    const uint16_t runs = 20;
+    double hostSeconds = 0;
+    uint32_t blocks = 0;
+    replayRuns<KWP::KWP1281Session>(capture.capture(), runs, hostSeconds, blocks);
+    printf("[bench] replay (fast, HostKLine): %u blocks in %.1f ms host, %.0f blocks/s,"
+           " %.2f us/block\n",
+           static_cast<unsigned>(blocks), hostSeconds * 1000.0, blocks / hostSeconds,
+           hostSeconds * 1e6 / blocks);
+    TEST_ASSERT_TRUE(blocks / hostSeconds > 1000.0);
+
+    double directSeconds = 0;
+    uint32_t directBlocks = 0;
+    replayRuns<KWP::BasicKWP1281Session<Sim::ReplayKLine>>(capture.capture(), runs,
+                                                           directSeconds, directBlocks);
+    printf("[bench] replay (fast, bound):     %u blocks in %.1f ms host, %.0f blocks/s,"
+           " %.2f us/block\n",
+           static_cast<unsigned>(directBlocks), directSeconds * 1000.0,
+           directBlocks / directSeconds, directSeconds * 1e6 / directBlocks);
+    TEST_ASSERT_EQUAL_UINT32(blocks, directBlocks);
+}
+
+// Group 1 (speed, rpm) refresh rate on the default cockpit screen over a
+// minute of bus time: fixed 1..3 loop versus the group scheduler with
+// the periods OBDDisplay uses for that screen.
+static void fastGroupRate(bool scheduled, double &rateHz)
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcu ecu(Sim::VirtualEcuConfig{});
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+
+    KWP::GroupScheduler scheduler;
+    scheduler.request(1, KWP::GroupScheduler::AsFastAsPossible);
+    scheduler.request(3, 3000);
+    scheduler.request(2, 10000);
+
+    const uint32_t startMs = millis();
+    uint32_t fastReads = 0;
+    uint8_t rotation = 1;
+    while (millis() - startMs < 60000UL) {
+        uint8_t group = rotation;
+        if (scheduled) {
+            if (!scheduler.next(millis(), group)) {
+                TEST_ASSERT_TRUE(kwp.keepAlive());
+                continue;
+            }
+        } else {
+            rotation = (rotation >= 3) ? 1 : static_cast<uint8_t>(rotation + 1);
+        }
+        TEST_ASSERT_TRUE(kwp.readSensorsGroup(group, signals));
+        if (group == 1) {
+            ++fastReads;
+        }
+    }
+    rateHz = fastReads / ((millis() - startMs) / 1000.0);
+}
+
+void test_kwp_benchmark_scheduled_reads()
+{
+    double fixed = 0;
+    double scheduled = 0;
+    fastGroupRate(false, fixed);
+    fastGroupRate(true, scheduled);
+    printf("[bench] cockpit screen 0 speed/rpm refresh: %5.2f Hz fixed loop,"
+           " %5.2f Hz scheduled (x%.2f)\n",
+           fixed, scheduled, scheduled / fixed);
+    TEST_ASSERT_TRUE(scheduled > 2.5 * fixed);
+}
+
+// The float switch KWP1281Session used before the formula table, kept
+// here as the baseline for the decode micro-benchmark.
+static float legacyDecode(uint8_t k, uint8_t a, uint8_t b, const char *&units)
+{
+    float v = 0;
+    units = "";
+    switch (k) {
+        case 1:  v = 0.2f * a * b; units = "rpm"; break;
+        case 2:  v = a * 0.002f * b; units = "%%"; break;
+        case 3:  v = 0.002f * a * b; units = "Deg"; break;
+        case 4:  v = abs(b - 127) * 0.01f * a; units = "ATDC"; break;
+        case 5:  v = a * (b - 100) * 0.1f; units = "C"; break;
+        case 6:  v = 0.001f * a * b; units = "V"; break;
+        case 7:  v = 0.01f * a * b; units = "km/h"; break;
+        case 8:  v = 0.1f * a * b; units = " "; break;
+        case 14: v = 0.005f * a * b; units = "bar"; break;
+        case 18: v = 0.04f * a * b; units = "mbar"; break;
+        case 19: v = a * b * 0.01f; units = "l"; break;
+        case 36: v = ((unsigned long)a) * 2560 + ((unsigned long)b) * 10; units = "km"; break;
+        default: break;
+    }
+    return v;
+}
+
+// Host figures only: with an FPU the float switch is cheap. The Uno has
+// none, so every float multiply there is a soft-float library call while
+// the table path is integer multiply and shift.
+void test_kwp_benchmark_formula_decode()
+{
+    // Formula mix of the default instrument and engine groups.
+    static const uint8_t formulas[] = {7, 1, 14, 44, 36, 19, 12, 5, 5, 10, 5, 1, 6, 5};
+    const uint32_t triplets = 2000000;
+
+    volatile float legacySink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < triplets; ++i) {
+        const char *units = nullptr;
+        legacySink = legacySink + legacyDecode(formulas[i % sizeof(formulas)],
+                                               static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8),
+                                               units);
+    }
+    const double legacyNs =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    volatile uint32_t tableSink = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < triplets; ++i) {
+        KWP::Measurement m = KWP::decodeMeasurement(formulas[i % sizeof(formulas)],
+                                                    static_cast<uint8_t>(i),
+                                                    static_cast<uint8_t>(i >> 8));
+        tableSink = tableSink + static_cast<uint32_t>(m.scaled) + m.unit;
+    }
+    const double tableNs =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("[bench] triplet decode: %6.2f ns float switch (12 formulas), %6.2f ns fixed-point"
+           " table (63 formulas)\n",
+           legacyNs / triplets, tableNs / triplets);
+}
+
+// Host cost of putting one group answer into OBDSignals (reset before
+// the read, decode, experimental slots, bindings): every answer new, as
+// before the payload cache, against the instruments' group 2 sent
+// unchanged and with only the fuel level moving.
+static double groupDecodeNs(uint8_t changingTriplets)
+{
+    KWP::GroupPayloadCache cache;
+    Model::OBDSignals signals;
+    signals.reset();
+    uint8_t answer[12] = {36, 48, 57, 19, 100, 45, 8, 10, 70, 5, 10, 120};
+    const uint32_t reads = 500000;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < reads; ++i) {
+        if (changingTriplets > 1) cache.clear();
+        if (changingTriplets > 0) answer[5] = static_cast<uint8_t>(i);
+        KWP::prepareGroupRead(2, nullptr, cache, signals);
+        KWP::decodeTriplets(0x17, 2, answer, 4, cache, signals);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+           / reads;
+}
+
+void test_kwp_benchmark_delta_decode()
+{
+    const double fullNs = groupDecodeNs(4);
+    const double oneNs = groupDecodeNs(1);
+    const double stableNs = groupDecodeNs(0);
+    printf("[bench] group 2 answer: %6.1f ns every triplet decoded, %6.1f ns one changed,"
+           " %6.1f ns unchanged\n",
+           fullNs, oneNs, stableNs);
+    TEST_ASSERT_TRUE(stableNs < fullNs);
+}
+
+// Connect time and group rate of the engine ECU's groups 1, 3 and 4 at
+// 10400 baud: KWP1281, KWP2000 at the standard's default timing, and
+// KWP2000 after AccessTimingParameters. At the default timing P3min
+// (55 ms) and P4min (5 ms per request byte) make KWP2000 slower per
+// group than KWP1281; it is the shorter timing that pays.
+static void kwp2000GroupRate(bool fastTiming, double &connectMs, double &groupsPerSecond)
+{
+    Sim::VirtualKwp2000Ecu ecu;
+    KWP::BasicKWP2000Session<Sim::VirtualKwp2000Ecu> kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    const uint64_t connectStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(kwp.connect(0x01));
+    connectMs = (native_arduino::clockUs() - connectStartUs) / 1000.0;
+    if (fastTiming) {
+        KWP::KWP2000Timing timing;
+        timing.p2Min = 0;
+        timing.p3Min = 5;
+        timing.p4Min = 0;
+        TEST_ASSERT_TRUE(kwp.setTiming(timing));
+    }
+
+    const uint64_t startUs = native_arduino::clockUs();
+    const uint16_t groups = 300;
+    static const uint8_t order[] = {1, 3, 4};
+    for (uint16_t i = 0; i < groups; ++i) {
+        TEST_ASSERT_TRUE(kwp.readGroup(order[i % 3], signals));
+    }
+    groupsPerSecond = groups / ((native_arduino::clockUs() - startUs) / 1e6);
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().earlyRequests);
+}
+
+void test_kwp_benchmark_kwp2000()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcuConfig config;
+    config.address = 0x01;
+    Sim::VirtualEcu ecu(config);
+    KWP::BasicKWP1281Session<Sim::VirtualEcu> kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+    uint16_t baud = 10400;
+    uint8_t addr = 0x01;
+    const uint64_t connectStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    const double kwp1281ConnectMs = (native_arduino::clockUs() - connectStartUs) / 1000.0;
+    const uint64_t startUs = native_arduino::clockUs();
+    static const uint8_t order[] = {1, 3, 4};
+    for (uint16_t i = 0; i < 300; ++i) {
+        TEST_ASSERT_TRUE(kwp.readSensorsGroup(order[i % 3], signals));
+    }
+    const double kwp1281Rate = 300 / ((native_arduino::clockUs() - startUs) / 1e6);
+
+    double defaultConnectMs = 0;
+    double defaultRate = 0;
+    double fastConnectMs = 0;
+    double fastRate = 0;
+    kwp2000GroupRate(false, defaultConnectMs, defaultRate);
+    kwp2000GroupRate(true, fastConnectMs, fastRate);
+
+    printf("[bench] engine 0x01: KWP1281 %7.1f ms connect %6.2f groups/s;"
+           " KWP2000 %6.1f ms connect %6.2f groups/s (default timing), %6.2f groups/s (fast)\n",
+           kwp1281ConnectMs, kwp1281Rate, defaultConnectMs, defaultRate, fastRate);
+    TEST_ASSERT_TRUE(defaultConnectMs * 4 < kwp1281ConnectMs);
+    TEST_ASSERT_TRUE(fastRate > 1.5 * kwp1281Rate);
+}
+
+// What a DTC description costs: flash for the table against the same
+// texts as plain strings, and host time for the binary search and for
+// expanding one text. A DTC page draws one description per frame.
+void test_kwp_benchmark_dtc_text()
+{
+    const Model::DtcTextFootprint f = Model::dtcTextFootprint();
+    const uint16_t codes = Model::DtcTextTable::CodeCount;
+    const uint32_t rounds = 20000;
+
+    volatile int32_t findSink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t r = 0; r < rounds; ++r) {
+        for (uint16_t i = 0; i < codes; ++i) {
+            // Every table code, and the one after it (mostly a miss)
+            const uint16_t code = pgm_read_word(&Model::DtcTextTable::Codes[i]);
+            findSink = findSink + Model::findDtcText(code) + Model::findDtcText(code + 1);
+        }
+    }
+    const double findNs =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+        / (2.0 * rounds * codes);
+
+    char text[Model::DtcTextMaxLength + 1];
+    volatile uint32_t decodeSink = 0;
+    uint32_t chars = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t r = 0; r < rounds; ++r) {
+        for (uint16_t i = 0; i < codes; ++i) {
+            const uint8_t length = Model::describeDtc(pgm_read_word(&Model::DtcTextTable::Codes[i]),
+                                                      text, sizeof(text));
+            chars += length;
+            decodeSink = decodeSink + static_cast<uint8_t>(text[length / 2]);
+        }
+    }
+    const double describeNs =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+        / (static_cast<double>(rounds) * codes);
+
+    printf("[bench] DTC text: %u codes, %u tokens; %u bytes flash (%u text + %u index)"
+           " for %u bytes of plain text (%.0f%%)\n",
+           f.codes, f.tokens, f.packedTextBytes + f.indexBytes, f.packedTextBytes, f.indexBytes,
+           f.rawTextBytes, 100.0 * (f.packedTextBytes + f.indexBytes) / f.rawTextBytes);
+    printf("[bench] DTC text: %6.2f ns lookup, %6.2f ns lookup + expand (%.1f chars avg)\n",
+           findNs, describeNs, static_cast<double>(chars) / (static_cast<double>(rounds) * codes));
+    TEST_ASSERT_TRUE(f.packedTextBytes + f.indexBytes < f.rawTextBytes);
+}
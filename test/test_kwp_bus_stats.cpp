@@ -0,0 +1,99 @@
+// Unity tests for the session's bus statistics (BusStats, RateMeter)
+// behind the Debug screens. Registered in the combined runner in
+// test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <stdio.h>
+
+#include "obd/KWP/BusStats.h"
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/Model/RateMeter.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+
+void test_kwp_bus_stats_bins_and_rates()
+{
+    using KWP::BusStats;
+    TEST_ASSERT_EQUAL_UINT8(0, BusStats::binOf(0));
+    TEST_ASSERT_EQUAL_UINT8(0, BusStats::binOf(15));
+    TEST_ASSERT_EQUAL_UINT8(1, BusStats::binOf(16));
+    TEST_ASSERT_EQUAL_UINT8(3, BusStats::binOf(88));
+    TEST_ASSERT_EQUAL_UINT8(6, BusStats::binOf(1023));
+    TEST_ASSERT_EQUAL_UINT8(7, BusStats::binOf(1024));
+    TEST_ASSERT_EQUAL_UINT8(7, BusStats::binOf(600000));
+    TEST_ASSERT_TRUE(BusStats::kindOf(0x29) == BusStats::Kind::GroupRead);
+    TEST_ASSERT_TRUE(BusStats::kindOf(0x07) == BusStats::Kind::Dtc);
+    TEST_ASSERT_TRUE(BusStats::kindOf(0x06) == BusStats::Kind::Other);
+
+    // The rate holds the last whole window.
+    Model::RateMeter meter;
+    meter.reset(5000);
+    meter.add(3);
+    meter.update(5999);
+    TEST_ASSERT_EQUAL_UINT16(0, meter.perSecondX10());
+    meter.add(8);
+    meter.update(7000);
+    TEST_ASSERT_EQUAL_UINT16(55, meter.perSecondX10());   // 11 in 2 s
+    meter.update(7500);
+    TEST_ASSERT_EQUAL_UINT16(55, meter.perSecondX10());
+    meter.update(8000);
+    TEST_ASSERT_EQUAL_UINT16(0, meter.perSecondX10());
+    TEST_ASSERT_EQUAL_UINT32(11, meter.count());
+}
+
+void test_kwp_bus_stats_measure_session()
+{
+    Sim::VirtualEcu ecu;
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    KWP::BusStats &stats = kwp.stats();
+    stats.reset(millis());
+    ecu.resetStats();
+
+    const uint32_t startMs = millis();
+    uint16_t reads = 0;
+    while (millis() - startMs < 3000) {
+        TEST_ASSERT_TRUE(kwp.readSensorsGroup(1 + reads % 3, signals));
+        ++reads;
+        stats.update(millis());
+    }
+    TEST_ASSERT_TRUE(kwp.keepAlive());
+
+    // Every block on the wire counted, the counter is the session's
+    TEST_ASSERT_EQUAL_UINT32(ecu.stats().blocksToTester + ecu.stats().blocksFromTester,
+                             stats.blocks());
+    // The last window's rate is the run's, give or take a read
+    const uint32_t overallX10 = reads * 10000UL / (millis() - startMs);
+    const uint16_t groupRate = stats.groupsPerSecondX10();
+    TEST_ASSERT_UINT32_WITHIN(overallX10 / 8, overallX10, groupRate);
+    TEST_ASSERT_TRUE(stats.blocksPerSecondX10() >= 2 * groupRate - 5);
+
+    const KWP::BusStats::Latency &grp = stats.latency(KWP::BusStats::Kind::GroupRead);
+    TEST_ASSERT_EQUAL_UINT16(reads, grp.count);
+    TEST_ASSERT_EQUAL_UINT16(reads, grp.bins[KWP::BusStats::binOf(grp.meanMs())]);
+    TEST_ASSERT_TRUE(grp.meanMs() > 50 && grp.meanMs() <= grp.maxMs);
+    const KWP::BusStats::Latency &ack = stats.latency(KWP::BusStats::Kind::Ack);
+    TEST_ASSERT_EQUAL_UINT16(1, ack.count);
+    TEST_ASSERT_TRUE(ack.meanMs() < grp.meanMs());
+    TEST_ASSERT_EQUAL_UINT16(0, stats.timeouts());
+
+    // A lost byte: the session times out on it and resumes.
+    ecu.dropByteToTester(8);
+    TEST_ASSERT_FALSE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_EQUAL_UINT16(1, stats.timeouts());
+    TEST_ASSERT_TRUE(kwp.resume());
+    TEST_ASSERT_EQUAL_UINT16(1, stats.retries());
+    TEST_ASSERT_EQUAL_UINT16(0, stats.complementErrors());
+    TEST_ASSERT_EQUAL_UINT16(0, stats.counterErrors());
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "bus stats: %.1f groups/s, %.1f blocks/s, group round trip %u ms (max %u)",
+             groupRate / 10.0, stats.blocksPerSecondX10() / 10.0, grp.meanMs(), grp.maxMs);
+    TEST_MESSAGE(msg);
+}
@@ -0,0 +1,162 @@
+// Unity tests for the fixed-point KWP1281 formula table. Every table
+// entry is checked against its real-valued formula over a sweep of a/b.
+// Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "obd/KWP/KWPFormula.h"
+
+using namespace obd;
+using namespace obd::KWP;
+
+struct Reference {
+    uint8_t id;
+    double (*value)(double a, double b);
+};
+
+static const Reference REFERENCES[] = {
+    {1,  [](double a, double b) { return 0.2 * a * b; }},
+    {2,  [](double a, double b) { return 0.002 * a * b; }},
+    {3,  [](double a, double b) { return 0.002 * a * b; }},
+    {4,  [](double a, double b) { return fabs(b - 127) * 0.01 * a; }},
+    {5,  [](double a, double b) { return a * (b - 100) * 0.1; }},
+    {6,  [](double a, double b) { return 0.001 * a * b; }},
+    {7,  [](double a, double b) { return 0.01 * a * b; }},
+    {8,  [](double a, double b) { return 0.1 * a * b; }},
+    {9,  [](double a, double b) { return (b - 127) * 0.02 * a; }},
+    {11, [](double a, double b) { return 0.0001 * a * (b - 128) + 1; }},
+    {12, [](double a, double b) { return 0.001 * a * b; }},
+    {13, [](double a, double b) { return (b - 127) * 0.001 * a; }},
+    {14, [](double a, double b) { return 0.005 * a * b; }},
+    {15, [](double a, double b) { return 0.01 * a * b; }},
+    {18, [](double a, double b) { return 0.04 * a * b; }},
+    {19, [](double a, double b) { return 0.01 * a * b; }},
+    {20, [](double a, double b) { return a * (b - 128) / 128; }},
+    {21, [](double a, double b) { return 0.001 * a * b; }},
+    {22, [](double a, double b) { return 0.001 * a * b; }},
+    {23, [](double a, double b) { return b / 256 * a; }},
+    {24, [](double a, double b) { return 0.001 * a * b; }},
+    {25, [](double a, double b) { return b * 1.421 + a / 182; }},
+    {26, [](double a, double b) { return b - a; }},
+    {27, [](double a, double b) { return fabs(b - 128) * 0.01 * a; }},
+    {28, [](double a, double b) { return b - a; }},
+    {30, [](double a, double b) { return b / 12 * a; }},
+    {31, [](double a, double b) { return b / 2560 * a; }},
+    {33, [](double a, double b) { return a == 0 ? 0 : 100 * b / a; }},
+    {34, [](double a, double b) { return (b - 128) * 0.01 * a; }},
+    {35, [](double a, double b) { return 0.01 * a * b; }},
+    {36, [](double a, double b) { return a * 2560 + b * 10; }},
+    {37, [](double, double b) { return b; }},
+    {38, [](double a, double b) { return (b - 128) * 0.001 * a; }},
+    {39, [](double a, double b) { return b / 256 * a; }},
+    {40, [](double a, double b) { return b * 0.1 + 25.5 * a - 400; }},
+    {41, [](double a, double b) { return b + a * 255; }},
+    {42, [](double a, double b) { return b * 0.1 + 25.5 * a - 400; }},
+    {43, [](double a, double b) { return b * 0.1 + 25.5 * a; }},
+    {45, [](double a, double b) { return 0.1 * a * b / 100; }},
+    {46, [](double a, double b) { return (a * b - 3200) * 0.0027; }},
+    {47, [](double a, double b) { return (b - 128) * a; }},
+    {48, [](double a, double b) { return b + a * 255; }},
+    {49, [](double a, double b) { return (b / 4) * a * 0.1; }},
+    {50, [](double a, double b) { return a == 0 ? 0 : (b - 128) / (0.01 * a); }},
+    {51, [](double a, double b) { return ((b - 128) / 255) * a; }},
+    {52, [](double a, double b) { return b * 0.02 * a - a; }},
+    {53, [](double a, double b) { return (b - 128) * 1.4222 + 0.006 * a; }},
+    {54, [](double a, double b) { return a * 256 + b; }},
+    {55, [](double a, double b) { return a * b / 200; }},
+    {56, [](double a, double b) { return a * 256 + b; }},
+    {57, [](double a, double b) { return a * 256 + b + 65536; }},
+    {59, [](double a, double b) { return (a * 256 + b) / 32768; }},
+    {60, [](double a, double b) { return (a * 256 + b) * 0.01; }},
+    {62, [](double a, double b) { return 0.256 * a * b; }},
+    {64, [](double a, double b) { return a + b; }},
+    {65, [](double a, double b) { return 0.01 * a * (b - 127); }},
+    {66, [](double a, double b) { return (a * b) / 511.12; }},
+    {67, [](double a, double b) { return (640 * a) + b * 2.5; }},
+    {68, [](double a, double b) { return (256 * a + b) / 7.365; }},
+    {69, [](double a, double b) { return (256 * a + b) * 0.3254; }},
+    {70, [](double a, double b) { return (256 * a + b) * 0.192; }},
+};
+
+void test_formula_table_matches_reference()
+{
+    for (const Reference &ref : REFERENCES) {
+        for (int a = 0; a <= 255; a += 3) {
+            for (int b = 0; b <= 255; b += 5) {
+                Measurement m = decodeMeasurement(ref.id, a, b);
+                TEST_ASSERT_TRUE(m.known);
+                double expected = ref.value(a, b) * Model::fixedPow10(m.decimals);
+                // One count of the last displayed digit for rounding,
+                // plus a little for the rational approximations.
+                double tolerance = 1.0 + fabs(expected) * 1e-4;
+                if (fabs(m.scaled - expected) > tolerance) {
+                    printf("  formula %u a=%d b=%d: got %ld, want %.3f\n",
+                           ref.id, a, b, static_cast<long>(m.scaled), expected);
+                    TEST_FAIL();
+                }
+            }
+        }
+    }
+}
+
+void test_formula_known_values()
+{
+    Measurement rpm = decodeMeasurement(1, 40, 250);
+    TEST_ASSERT_EQUAL_INT32(2000, rpm.scaled);
+    TEST_ASSERT_EQUAL_UINT8(0, rpm.decimals);
+    TEST_ASSERT_EQUAL_STRING("rpm", reinterpret_cast<const char *>(unitText(rpm.unit)));
+
+    Measurement volt = decodeMeasurement(6, 140, 100);
+    TEST_ASSERT_EQUAL_INT32(1400, volt.scaled);
+    TEST_ASSERT_EQUAL_UINT8(2, volt.decimals);
+    TEST_ASSERT_EQUAL_INT32(14, volt.whole());
+
+    Measurement cold = decodeMeasurement(5, 10, 80);
+    TEST_ASSERT_EQUAL_INT32(-200, cold.scaled);
+    TEST_ASSERT_EQUAL_INT32(-20, cold.whole());
+
+    Measurement odo = decodeMeasurement(36, 48, 57);
+    TEST_ASSERT_EQUAL_INT32(123450, odo.scaled);
+}
+
+void test_formula_text_formulas()
+{
+    Measurement warm = decodeMeasurement(10, 0, 1);
+    TEST_ASSERT_EQUAL_STRING("WARM", reinterpret_cast<const char *>(unitText(warm.unit)));
+    Measurement cold = decodeMeasurement(10, 0, 0);
+    TEST_ASSERT_EQUAL_STRING("COLD", reinterpret_cast<const char *>(unitText(cold.unit)));
+
+    Measurement clock = decodeMeasurement(44, 21, 50);
+    TEST_ASSERT_EQUAL_INT32(2150, clock.scaled);
+}
+
+void test_formula_unknown_is_raw()
+{
+    Measurement m = decodeMeasurement(200, 0x12, 0x34);
+    TEST_ASSERT_FALSE(m.known);
+    TEST_ASSERT_EQUAL_INT32(0x1234, m.scaled);
+    TEST_ASSERT_EQUAL_STRING("", reinterpret_cast<const char *>(unitText(m.unit)));
+}
+
+void test_format_fixed()
+{
+    char buf[12];
+    Model::formatFixed(1425, 2, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("14.25", buf);
+    Model::formatFixed(5, 2, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("0.05", buf);
+    Model::formatFixed(-200, 1, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("-20.0", buf);
+    Model::formatFixed(2000, 0, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("2000", buf);
+    char wide[16];
+    Model::formatFixed(-2147483647L - 1, 3, wide, sizeof(wide));
+    TEST_ASSERT_EQUAL_STRING("-2147483.648", wide);
+
+    char small[4];
+    TEST_ASSERT_EQUAL_UINT8(0, Model::formatFixed(12345, 1, small, sizeof(small)));
+    TEST_ASSERT_EQUAL_STRING("", small);
+}
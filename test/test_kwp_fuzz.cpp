@@ -0,0 +1,336 @@
+// Unity tests for the session's receive path under hostile ECU input
+// (Sim::FuzzKLine, Sim::runFuzzInput): regressions for what fuzzing
+// found, and a seeded mutation run of the fuzz harness (the same one
+// fuzz/kwp_receive_fuzzer.cpp hands to libFuzzer). Registered in the
+// combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <EEPROM.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/KWP/KWPFormula.h"
+#include "obd/Sim/FuzzKLine.h"
+
+using namespace obd;
+
+namespace {
+
+using FuzzSession = KWP::BasicKWP1281Session<Sim::FuzzKLine>;
+
+// Delay codes (see FuzzKLine): in step with the session, or ahead of it.
+constexpr uint8_t Paced = 10;    // 1 ms after the session's last byte
+constexpr uint8_t Ahead = 0;
+
+// ECU side of a session in FuzzKLine's (delay, byte) format, with the
+// block counter kept the way the session expects it.
+struct Script {
+    std::vector<uint8_t> bytes;
+    uint8_t counter = 1;   // the sync bytes count as the first block
+
+    explicit Script(uint8_t setup) { bytes.push_back(setup); }
+
+    void byte(uint8_t delay, uint8_t data)
+    {
+        bytes.push_back(delay);
+        bytes.push_back(data);
+    }
+    void block(uint8_t title, const std::vector<uint8_t> &payload, uint8_t delay = Paced)
+    {
+        byte(delay, static_cast<uint8_t>(payload.size() + 3));
+        byte(delay, counter);
+        byte(delay, title);
+        for (uint8_t b : payload) byte(delay, b);
+        byte(delay, 0x03);
+        counter += 2;   // our block, then the tester's answer
+    }
+    void connect()
+    {
+        byte(200, 0x55);
+        byte(Paced, 0x01);
+        byte(Paced, 0x8A);
+        const char *text = "036906034AM MARELLI";
+        block(0xF6, std::vector<uint8_t>(text, text + strlen(text)));
+        ack();
+    }
+    void ack() { block(0x09, {}); }
+    // An ACK whose length byte says it ends after length bytes, 0 to 2
+    void shortAck(uint8_t length)
+    {
+        byte(Paced, length);
+        for (uint8_t i = 0; i < length; ++i) byte(Paced, i == 1 ? 0x09 : counter);
+        counter += 2;
+    }
+    // An ACK with end instead of the 0x03 block end
+    void ackEndingIn(uint8_t end)
+    {
+        byte(Paced, 0x03);
+        byte(Paced, counter);
+        byte(Paced, 0x09);
+        byte(Paced, end);
+        counter += 2;
+    }
+    void group(uint8_t title, uint8_t triplets, uint8_t delay = Paced)
+    {
+        std::vector<uint8_t> payload;
+        for (uint8_t i = 0; i < triplets; ++i) {
+            payload.push_back(1);                        // rpm: 0.2 * a * b
+            payload.push_back(static_cast<uint8_t>(10 + i));
+            payload.push_back(50);
+        }
+        block(title, payload, delay);
+    }
+    // Codes 0x0100 + first ... + count - 1
+    void dtcs(uint8_t count, uint8_t first = 0)
+    {
+        std::vector<uint8_t> payload;
+        for (uint8_t i = 0; i < count; ++i) {
+            payload.push_back(0x01);
+            payload.push_back(static_cast<uint8_t>(first + i));
+            payload.push_back(0x23);
+        }
+        block(0xFC, payload);
+    }
+    // Input without the setup byte, for FuzzKLine itself
+    const uint8_t *line() const { return bytes.data() + 1; }
+    size_t lineSize() const { return bytes.size() - 1; }
+};
+
+bool connect(FuzzSession &kwp)
+{
+    native_arduino::eepromErase();
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    return kwp.connectToEcu(false, false, baud, addr);
+}
+
+uint32_t nextRandom(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+} // namespace
+
+void test_kwp_fuzz_regressions()
+{
+    Model::OBDSignals signals;
+    signals.reset();
+
+    // A group answer the ECU sends without waiting for our complements
+    // is still a group answer, not the ECU's error pattern.
+    {
+        Script script(0x04);
+        script.connect();
+        script.group(0xE7, 4, Ahead);
+        Sim::FuzzKLine line(script.line(), script.lineSize());
+        FuzzSession kwp(line);
+        TEST_ASSERT_TRUE(connect(kwp));
+        TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+        TEST_ASSERT_EQUAL_UINT16(0, kwp.stats().retries());
+        TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(1, 13, 50).scaled,
+                                signals.experimental.v[3]);
+        TEST_ASSERT_TRUE(line.exhausted());
+    }
+
+    // A keep-alive answered by a block too short for a title, or without
+    // its block end, fails; it used to take the ACK title the previous
+    // block left in the buffer.
+    for (uint8_t length = 0; length < 3; ++length) {
+        Script script(0x04);
+        script.connect();
+        script.shortAck(length);
+        Sim::FuzzKLine line(script.line(), script.lineSize());
+        FuzzSession kwp(line);
+        TEST_ASSERT_TRUE(connect(kwp));
+        TEST_ASSERT_FALSE(kwp.keepAlive());
+    }
+    {
+        Script script(0x04);
+        script.connect();
+        script.ackEndingIn(0x00);
+        Sim::FuzzKLine line(script.line(), script.lineSize());
+        FuzzSession kwp(line);
+        TEST_ASSERT_TRUE(connect(kwp));
+        TEST_ASSERT_FALSE(kwp.keepAlive());
+        TEST_ASSERT_TRUE(line.exhausted());
+    }
+
+    // Six triplets: the two without an experimental slot are dropped,
+    // not written past the arrays.
+    {
+        Script script(0x04);
+        script.connect();
+        script.group(0xE7, 6);
+        Sim::FuzzKLine line(script.line(), script.lineSize());
+        FuzzSession kwp(line);
+        TEST_ASSERT_TRUE(connect(kwp));
+        TEST_ASSERT_TRUE(kwp.readSensorsGroup(4, signals));
+        for (uint8_t i = 0; i < Model::ExperimentalGroup::Count; ++i) {
+            TEST_ASSERT_EQUAL_UINT8(1, signals.experimental.k[i]);
+            TEST_ASSERT_EQUAL_INT32(KWP::decodeMeasurement(1, 10 + i, 50).scaled,
+                                    signals.experimental.v[i]);
+        }
+        TEST_ASSERT_EQUAL_UINT8(4, signals.experimental.groupCurrent);
+    }
+
+    // More DTCs than the store holds: the count is what it kept, and the
+    // rest is counted as overflow. A code sent twice takes one slot.
+    {
+        static constexpr uint8_t Blocks = Model::DTCStore::MaxCount / 4 + 2;
+        Script script(0x04);
+        script.connect();
+        script.dtcs(4);
+        for (uint8_t i = 0; i < Blocks; ++i) {
+            script.dtcs(4, static_cast<uint8_t>(4 * i));
+        }
+        script.ack();
+        Sim::FuzzKLine line(script.line(), script.lineSize());
+        FuzzSession kwp(line);
+        Model::DTCStore dtcs;
+        TEST_ASSERT_TRUE(connect(kwp));
+        TEST_ASSERT_EQUAL_INT8(Model::DTCStore::MaxCount, kwp.readDtcCodes(dtcs));
+        TEST_ASSERT_EQUAL_UINT16(0x0100 + Model::DTCStore::MaxCount - 1,
+                                 dtcs.errorAt(Model::DTCStore::MaxCount - 1));
+        TEST_ASSERT_EQUAL_UINT8(4 * Blocks - Model::DTCStore::MaxCount, dtcs.overflow());
+    }
+
+    // An ECU that never stops sending DTC or identification blocks is
+    // given up on instead of holding the session.
+    {
+        Script script(0x04);
+        script.connect();
+        for (uint8_t i = 0; i < 40; ++i) {
+            script.dtcs(1);
+        }
+        Sim::FuzzKLine line(script.line(), script.lineSize());
+        FuzzSession kwp(line);
+        Model::DTCStore dtcs;
+        TEST_ASSERT_TRUE(connect(kwp));
+        TEST_ASSERT_EQUAL_INT8(-1, kwp.readDtcCodes(dtcs));
+        TEST_ASSERT_FALSE(line.exhausted());
+    }
+    {
+        Script script(0x04);
+        script.byte(200, 0x55);
+        script.byte(Paced, 0x01);
+        script.byte(Paced, 0x8A);
+        for (uint8_t i = 0; i < 40; ++i) {
+            script.block(0xF6, {'X'});
+        }
+        Sim::FuzzKLine line(script.line(), script.lineSize());
+        FuzzSession kwp(line);
+        TEST_ASSERT_FALSE(connect(kwp));
+        TEST_ASSERT_FALSE(line.exhausted());
+    }
+}
+
+void test_kwp_fuzz_mutated_sessions()
+{
+    // Seeds: one round of every exchange at 10400 baud, the 0x01 engine
+    // ECU's own group answers at 9600, a 1200 baud connect with a
+    // repeated sync, and keep-alives answered by malformed blocks.
+    std::vector<Script> seeds;
+    {
+        Script s(0x04);
+        s.connect();
+        s.group(0xE7, 4);
+        s.group(0xE7, 4);
+        s.ack();
+        s.dtcs(2);
+        s.ack();
+        s.ack();
+        seeds.push_back(s);
+    }
+    {
+        Script s(0x0B);
+        s.connect();
+        for (uint8_t i = 0; i < 4; ++i) {
+            s.group(0x02, 3);
+        }
+        seeds.push_back(s);
+    }
+    {
+        Script s(0x00);
+        s.byte(200, 0x55);
+        s.byte(Paced, 0x01);
+        s.byte(Ahead, 0x8A);
+        s.byte(Ahead, 0xFF);
+        s.byte(Ahead, 0x55);
+        s.byte(Paced, 0x01);
+        s.byte(Paced, 0x8A);
+        s.ack();
+        s.group(0xE7, 4);
+        seeds.push_back(s);
+    }
+
+    {
+        // Keep-alives first: a length byte of 0, then a wrong block end
+        Script s(0x24);
+        s.connect();
+        s.ack();
+        s.shortAck(0);
+        s.ack();
+        s.ackEndingIn(0x00);
+        s.ack();
+        seeds.push_back(s);
+    }
+
+    // Every seed is a full session as it stands.
+    for (const Script &s : seeds) {
+        TEST_ASSERT_TRUE(Sim::runFuzzInput(s.bytes.data(), s.bytes.size()).connected);
+    }
+
+    const uint16_t inputs = 2000;
+    uint32_t state = 0x1281;
+    uint32_t ecuBytes = 0;
+    uint32_t exchanges = 0;
+    uint16_t connected = 0;
+    const auto hostStart = std::chrono::steady_clock::now();
+    for (uint16_t n = 0; n < inputs; ++n) {
+        std::vector<uint8_t> input = seeds[nextRandom(state) % seeds.size()].bytes;
+        const uint8_t mutations = 1 + nextRandom(state) % 4;
+        for (uint8_t m = 0; m < mutations; ++m) {
+            const size_t at = nextRandom(state) % input.size();
+            const uint8_t value = static_cast<uint8_t>(nextRandom(state));
+            switch (nextRandom(state) % 5) {
+            case 0:
+                input[at] = value;
+                break;
+            case 1:
+                input[at] ^= static_cast<uint8_t>(1u << (value % 8));
+                break;
+            case 2:
+                input.insert(input.begin() + at, value);
+                break;
+            case 3:
+                if (input.size() > 1) input.erase(input.begin() + at);
+                break;
+            default:
+                input.resize(at + 1);   // cut short
+                break;
+            }
+        }
+        const Sim::FuzzStats st = Sim::runFuzzInput(input.data(), input.size());
+        ecuBytes += st.ecuBytes;
+        exchanges += st.exchanges;
+        if (st.connected) ++connected;
+    }
+    const double hostSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
+
+    // Mutations mostly land after the connect, so most inputs still get
+    // to the exchanges.
+    TEST_ASSERT_TRUE(connected > inputs / 4);
+
+    char msg[128];
+    snprintf(msg, sizeof(msg),
+             "fuzz: %u inputs (%u connected), %u exchanges, %.0f inputs/s, %.0f ECU bytes/s host",
+             static_cast<unsigned>(inputs), static_cast<unsigned>(connected),
+             static_cast<unsigned>(exchanges), inputs / hostSeconds, ecuBytes / hostSeconds);
+    TEST_MESSAGE(msg);
+}
@@ -0,0 +1,221 @@
+// Unity tests for MultiEcuSession: the engine (0x01) and instruments
+// (0x17) ECUs sharing one K-line (Sim::SharedKLine) and one session.
+// Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <EEPROM.h>
+
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/KWP/MultiEcuSession.h"
+#include "obd/Sim/SharedKLine.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+using Display::MenuId;
+
+namespace {
+
+Sim::VirtualEcuConfig ecuConfig(uint8_t address)
+{
+    Sim::VirtualEcuConfig config;
+    config.address = address;
+    return config;
+}
+
+// The firmware's main loop, cut down to the bus: poll, and sleep a
+// little when there is nothing to do.
+void runFor(KWP::MultiEcuSession &multi, Model::OBDSignals &signals, uint32_t ms)
+{
+    const uint32_t start = millis();
+    while (millis() - start < ms) {
+        if (multi.poll(signals) == KWP::PollStatus::Idle) {
+            delay(5);
+        }
+    }
+}
+
+// Runs until the ECU at ecuAddr has the line; the time that took.
+uint32_t runUntilActive(KWP::MultiEcuSession &multi, Model::OBDSignals &signals,
+                        uint8_t ecuAddr, uint32_t limitMs)
+{
+    const uint32_t start = millis();
+    while (multi.activeAddress() != ecuAddr && millis() - start < limitMs) {
+        if (multi.poll(signals) == KWP::PollStatus::Idle) {
+            delay(5);
+        }
+    }
+    return millis() - start;
+}
+
+void planCockpit(KWP::MultiEcuSession &multi, uint8_t screen)
+{
+    for (uint8_t i = 0; i < multi.ecuCount(); ++i) {
+        multi.plan(multi.ecuAddress(i), MenuId::Cockpit, screen, 5);
+    }
+}
+
+} // namespace
+
+void test_kwp_multi_ecu_feeds_one_signal_set()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcu instruments(ecuConfig(0x17));
+    Sim::VirtualEcu engine(ecuConfig(0x01));
+    instruments.loadDefaults();
+    engine.loadDefaults();
+    Sim::SharedKLine line;
+    TEST_ASSERT_TRUE(line.attach(instruments));
+    TEST_ASSERT_TRUE(line.attach(engine));
+    KWP::KWP1281Session kwp(line);
+    KWP::MultiEcuSession multi(kwp);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    TEST_ASSERT_TRUE(multi.addEcu(0x17));
+    TEST_ASSERT_TRUE(multi.addEcu(0x01));
+    TEST_ASSERT_FALSE(multi.addEcu(0x01));
+    TEST_ASSERT_FALSE(multi.addEcu(0x02));
+    planCockpit(multi, 0);
+    multi.setForeground(0x17);
+
+    // One foreground slice, one visit to the engine and back
+    runFor(multi, signals, KWP::MultiEcuSession::ForegroundSliceMs + 10000);
+    TEST_ASSERT_TRUE(multi.switches() >= 3);
+    TEST_ASSERT_EQUAL_UINT16(0, multi.failures());
+    TEST_ASSERT_EQUAL_UINT8(0x17, multi.activeAddress());
+
+    // Cluster and engine values side by side
+    TEST_ASSERT_EQUAL_UINT16(50, signals.instruments.vehicleSpeed);
+    TEST_ASSERT_EQUAL_UINT8(90, signals.instruments.coolantTemp);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 5.0f, signals.engine.tbAngle);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 14.0f, signals.engine.voltage);
+
+    // Every switch ended the session with End Output; no ECU was left to
+    // time out, and nobody answered for the other one.
+    TEST_ASSERT_EQUAL_UINT32(0, instruments.stats().sessionTimeouts);
+    TEST_ASSERT_EQUAL_UINT32(0, engine.stats().sessionTimeouts);
+    TEST_ASSERT_EQUAL_UINT32(0, instruments.stats().complementErrors);
+    TEST_ASSERT_EQUAL_UINT32(0, engine.stats().complementErrors);
+    TEST_ASSERT_EQUAL_UINT32(0, engine.stats().counterErrors);
+    TEST_ASSERT_TRUE(engine.stats().addressInits >= 1);
+}
+
+void test_kwp_multi_ecu_weights_foreground()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcu instruments(ecuConfig(0x17));
+    Sim::VirtualEcu engine(ecuConfig(0x01));
+    instruments.loadDefaults();
+    engine.loadDefaults();
+    Sim::SharedKLine line;
+    line.attach(instruments);
+    line.attach(engine);
+    KWP::KWP1281Session kwp(line);
+    KWP::MultiEcuSession multi(kwp);
+    Model::OBDSignals signals;
+    signals.reset();
+    multi.addEcu(0x17);
+    multi.addEcu(0x01);
+    planCockpit(multi, 0);
+    multi.setForeground(0x01);
+
+    // Past the first visits, so both baud rates are known
+    runFor(multi, signals, KWP::MultiEcuSession::ForegroundSliceMs + 5000);
+    instruments.resetStats();
+    engine.resetStats();
+    const uint16_t switchesBefore = multi.switches();
+    runFor(multi, signals, 3 * KWP::MultiEcuSession::ForegroundSliceMs);
+
+    // The screen's ECU has most of the line; the other one is visited
+    // once per slice for a round of its groups.
+    const uint16_t switches = multi.switches() - switchesBefore;
+    TEST_ASSERT_TRUE(switches >= 4 && switches <= 8);
+    TEST_ASSERT_TRUE(engine.stats().blocksFromTester > 4 * instruments.stats().blocksFromTester);
+    TEST_ASSERT_TRUE(instruments.stats().blocksFromTester > 0);
+
+    // A switch is End Output, W5 and the 2 s address init with its
+    // identification blocks; nothing waits for an ECU timeout.
+    TEST_ASSERT_TRUE(multi.lastSwitchMs() < 3000);
+    TEST_ASSERT_EQUAL_UINT32(0, instruments.stats().sessionTimeouts);
+    TEST_ASSERT_EQUAL_UINT32(0, engine.stats().sessionTimeouts);
+    TEST_ASSERT_EQUAL_UINT16(0, multi.failures());
+}
+
+void test_kwp_multi_ecu_follows_screen()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcu instruments(ecuConfig(0x17));
+    Sim::VirtualEcu engine(ecuConfig(0x01));
+    instruments.loadDefaults();
+    engine.loadDefaults();
+    Sim::SharedKLine line;
+    line.attach(instruments);
+    line.attach(engine);
+    KWP::KWP1281Session kwp(line);
+    KWP::MultiEcuSession multi(kwp);
+    Model::OBDSignals signals;
+    signals.reset();
+    multi.addEcu(0x17);
+    multi.addEcu(0x01);
+    planCockpit(multi, 0);
+
+    // A screen of no ECU: the first one is connected and kept
+    multi.setForeground(0);
+    runFor(multi, signals, KWP::MultiEcuSession::ForegroundSliceMs + 5000);
+    TEST_ASSERT_EQUAL_UINT8(0x17, multi.activeAddress());
+    TEST_ASSERT_EQUAL_UINT16(1, multi.switches());
+
+    // Moving to an engine screen switches as soon as the read in flight
+    // is over, not at the end of a slice (a first visit: the engine's
+    // pacing is not learned yet)
+    multi.setForeground(0x01);
+    TEST_ASSERT_TRUE(runUntilActive(multi, signals, 0x01, 10000) < 3500);
+    runFor(multi, signals, 5000);
+    TEST_ASSERT_EQUAL_UINT8(0x01, multi.activeAddress());
+
+    // And straight back, with nothing left unplanned on the bus
+    multi.unplan(0x01);
+    multi.setForeground(0x17);
+    TEST_ASSERT_TRUE(runUntilActive(multi, signals, 0x17, 10000) < 3000);
+    const uint32_t engineBlocks = engine.stats().blocksFromTester;
+    runFor(multi, signals, 2 * KWP::MultiEcuSession::ForegroundSliceMs);
+    TEST_ASSERT_EQUAL_UINT32(engineBlocks, engine.stats().blocksFromTester);
+    TEST_ASSERT_EQUAL_UINT16(0, multi.failures());
+}
+
+void test_kwp_multi_ecu_missing_ecu()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcu instruments(ecuConfig(0x17));
+    instruments.loadDefaults();
+    Sim::SharedKLine line;
+    line.attach(instruments);
+    KWP::KWP1281Session kwp(line);
+    KWP::MultiEcuSession multi(kwp);
+    Model::OBDSignals signals;
+    signals.reset();
+    multi.addEcu(0x01);
+    multi.addEcu(0x17);
+    planCockpit(multi, 0);
+    multi.setForeground(0x01);
+
+    // No engine ECU on this line: its connects fail, and the cluster is
+    // read in between
+    runFor(multi, signals, 2 * KWP::MultiEcuSession::ForegroundSliceMs);
+    TEST_ASSERT_TRUE(multi.failures() >= 1);
+    TEST_ASSERT_TRUE(multi.switches() >= 1);
+    TEST_ASSERT_EQUAL_UINT16(50, signals.instruments.vehicleSpeed);
+    TEST_ASSERT_TRUE(instruments.stats().blocksFromTester > 10);
+
+    // Forgotten ECUs leave the line to the ones still there
+    multi.clear();
+    multi.addEcu(0x17);
+    planCockpit(multi, 0);
+    multi.setForeground(0x17);
+    kwp.disconnect();
+    TEST_ASSERT_TRUE(runUntilActive(multi, signals, 0x17, 10000) < 5000);
+    const uint16_t failures = multi.failures();
+    runFor(multi, signals, KWP::MultiEcuSession::ForegroundSliceMs + 5000);
+    TEST_ASSERT_EQUAL_UINT16(failures, multi.failures());
+    TEST_ASSERT_EQUAL_UINT8(0x17, multi.activeAddress());
+}
@@ -0,0 +1,175 @@
+// Unity tests for driving KWP1281Session from recorded K-line captures
+// (Sim::CaptureKLine, Sim::ReplayKLine, Sim::parseTraceDump).
+// Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <EEPROM.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "obd/KWP/KLineTrace.h"
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/Sim/ReplayKLine.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+
+namespace {
+
+struct TextSink {
+    std::string text;
+    size_t write(uint8_t c)
+    {
+        text.push_back(static_cast<char>(c));
+        return 1;
+    }
+};
+
+// The same session script for capture and replay: connect, three
+// rounds of groups 1..3, the DTCs and a keep-alive.
+bool runScript(Sim::HostKLine &line, Model::OBDSignals &signals, Model::DTCStore &dtcs,
+               char *partNumber)
+{
+    native_arduino::eepromErase();
+    KWP::KWP1281Session kwp(line);
+    signals.reset();
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    if (!kwp.connectToEcu(false, false, baud, addr)) return false;
+    for (uint8_t round = 0; round < 3; ++round) {
+        for (uint8_t g = 1; g <= 3; ++g) {
+            if (!kwp.readSensorsGroup(g, signals)) return false;
+        }
+    }
+    dtcs.reset();
+    if (kwp.readDtcCodes(dtcs) < 0) return false;
+    if (!kwp.keepAlive()) return false;
+    strcpy(partNumber, kwp.ecuIdentity().partNumber);
+    return true;
+}
+
+void assertSameSignals(const Model::OBDSignals &a, const Model::OBDSignals &b)
+{
+    TEST_ASSERT_EQUAL_UINT16(a.instruments.vehicleSpeed, b.instruments.vehicleSpeed);
+    TEST_ASSERT_EQUAL_UINT16(a.instruments.engineRpm, b.instruments.engineRpm);
+    TEST_ASSERT_EQUAL_UINT8(a.instruments.coolantTemp, b.instruments.coolantTemp);
+    TEST_ASSERT_EQUAL_UINT32(a.instruments.odometer, b.instruments.odometer);
+    TEST_ASSERT_EQUAL_UINT8(a.instruments.fuelLevel, b.instruments.fuelLevel);
+    for (uint8_t i = 0; i < 4; ++i) {
+        TEST_ASSERT_EQUAL_INT32(a.experimental.v[i], b.experimental.v[i]);
+        TEST_ASSERT_EQUAL_STRING(a.experimental.unit[i], b.experimental.unit[i]);
+    }
+}
+
+} // namespace
+
+void test_kwp_replay_reproduces_captured_session()
+{
+    Sim::VirtualEcu ecu;
+    Sim::CaptureKLine capture(ecu);
+    Model::OBDSignals live;
+    Model::DTCStore liveDtcs;
+    char livePart[Model::EcuIdentity::PartNumberWidth + 1] = {0};
+    const uint64_t liveStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(runScript(capture, live, liveDtcs, livePart));
+    const uint64_t liveUs = native_arduino::clockUs() - liveStartUs;
+    TEST_ASSERT_EQUAL_HEX8(0x17, capture.capture().front().data);
+    TEST_ASSERT_TRUE(capture.capture().front().tx);
+
+    // Real time: same bytes, same decisions, same bus time
+    Sim::ReplayKLine replay(capture.capture(), Sim::ReplayKLine::Timing::RealTime);
+    Model::OBDSignals replayed;
+    Model::DTCStore replayedDtcs;
+    char replayedPart[Model::EcuIdentity::PartNumberWidth + 1] = {0};
+    const uint64_t replayStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(runScript(replay, replayed, replayedDtcs, replayedPart));
+    const uint64_t replayUs = native_arduino::clockUs() - replayStartUs;
+    TEST_ASSERT_TRUE(replay.finished());
+    TEST_ASSERT_EQUAL_UINT32(0, replay.mismatches());
+    assertSameSignals(live, replayed);
+    TEST_ASSERT_EQUAL_STRING(livePart, replayedPart);
+    for (uint8_t i = 0; i < Model::DTCStore::MaxCount; ++i) {
+        TEST_ASSERT_EQUAL_UINT16(liveDtcs.errorAt(i), replayedDtcs.errorAt(i));
+    }
+    TEST_ASSERT_UINT32_WITHIN(static_cast<uint32_t>(liveUs / 50), static_cast<uint32_t>(liveUs),
+                              static_cast<uint32_t>(replayUs));
+
+    // Fast: the same again, without waiting for the ECU
+    Sim::ReplayKLine fast(capture.capture(), Sim::ReplayKLine::Timing::Fast);
+    const uint64_t fastStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(runScript(fast, replayed, replayedDtcs, replayedPart));
+    const uint64_t fastUs = native_arduino::clockUs() - fastStartUs;
+    TEST_ASSERT_TRUE(fast.finished());
+    TEST_ASSERT_EQUAL_UINT32(0, fast.mismatches());
+    assertSameSignals(live, replayed);
+    TEST_ASSERT_TRUE(fastUs < liveUs);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "replay: %u bytes, %.0f ms captured, %.0f ms real time, %.0f ms fast",
+             static_cast<unsigned>(capture.capture().size()), liveUs / 1000.0,
+             replayUs / 1000.0, fastUs / 1000.0);
+    TEST_MESSAGE(msg);
+}
+
+void test_kwp_replay_flags_diverging_session()
+{
+    Sim::VirtualEcu ecu;
+    Sim::CaptureKLine capture(ecu);
+    Model::OBDSignals signals;
+    Model::DTCStore dtcs;
+    char part[Model::EcuIdentity::PartNumberWidth + 1] = {0};
+    TEST_ASSERT_TRUE(runScript(capture, signals, dtcs, part));
+
+    // The capture asked for another group on its first read than the
+    // script will: the replay notices the tester byte.
+    Sim::LineCapture edited = capture.capture();
+    size_t groupByte = 0;
+    for (size_t i = 2; i < edited.size(); ++i) {
+        if (edited[i].tx && edited[i - 1].tx == false && edited[i].data == 0x29) {
+            groupByte = i + 2;   // title, complement, group number
+            break;
+        }
+    }
+    TEST_ASSERT_TRUE(groupByte > 0);
+    TEST_ASSERT_EQUAL_UINT8(1, edited[groupByte].data);
+    edited[groupByte].data = 7;
+
+    Sim::ReplayKLine replay(edited, Sim::ReplayKLine::Timing::Fast);
+    runScript(replay, signals, dtcs, part);
+    TEST_ASSERT_EQUAL_UINT32(1, replay.mismatches());
+}
+
+void test_kwp_replay_parses_trace_dump()
+{
+    Sim::VirtualEcu ecu;
+    KWP::KWP1281Session kwp(ecu);
+    kwp.trace().clear(micros());
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    ecu.dropByteToTester(3);
+    TEST_ASSERT_FALSE(kwp.connectToEcu(false, false, baud, addr));
+
+    TextSink sink;
+    sink.text = "boot\n";          // Serial chatter around the dump
+    kwp.trace().dump(sink);
+    sink.text += "more\n";
+
+    Sim::LineCapture records;
+    TEST_ASSERT_TRUE(Sim::parseTraceDump(sink.text.c_str(), records));
+    KWP::KLineTrace::Reader reader(kwp.trace());
+    KWP::KLineTrace::Entry e;
+    size_t i = 0;
+    while (reader.next(e)) {
+        TEST_ASSERT_TRUE(i < records.size());
+        TEST_ASSERT_EQUAL_UINT32(e.us, records[i].us);
+        TEST_ASSERT_EQUAL(e.tx, records[i].tx);
+        TEST_ASSERT_EQUAL_HEX8(e.data, records[i].data);
+        ++i;
+    }
+    TEST_ASSERT_EQUAL(records.size(), i);
+
+    // Cut short: no #END
+    sink.text.resize(sink.text.find("#END"));
+    TEST_ASSERT_FALSE(Sim::parseTraceDump(sink.text.c_str(), records));
+}
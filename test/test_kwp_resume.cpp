@@ -0,0 +1,132 @@
+// Unity tests for picking a KWP session up again after a line error
+// (KWP1281Session::resume()) and for the reconnect backoff used when
+// that is not possible. Registered in the combined runner in
+// test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <stdio.h>
+
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/KWP/ReconnectBackoff.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+
+static bool connectInstruments(KWP::KWP1281Session &kwp)
+{
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    return kwp.connectToEcu(false, false, baud, addr);
+}
+
+void test_kwp_resume_after_lost_answer_byte()
+{
+    Sim::VirtualEcu ecu;
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    const uint64_t connectStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(connectInstruments(kwp));
+    const uint64_t connectUs = native_arduino::clockUs() - connectStartUs;
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+
+    // 4 complements of the request, then the answer: length, counter,
+    // title, first triplet byte, ... -> lose a data byte mid block.
+    ecu.dropByteToTester(8);
+    TEST_ASSERT_FALSE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_EQUAL_UINT32(1, ecu.stats().droppedBytes);
+
+    const uint64_t resumeStartUs = native_arduino::clockUs();
+    TEST_ASSERT_TRUE(kwp.resume());
+    const uint64_t resumeUs = native_arduino::clockUs() - resumeStartUs;
+    TEST_ASSERT_TRUE(resumeUs < 200000);
+    TEST_ASSERT_EQUAL_UINT32(1, ecu.stats().abandonedBlocks);
+    TEST_ASSERT_TRUE(ecu.sessionActive());
+
+    // Same session, counters back in step
+    const uint32_t counterErrors = ecu.stats().counterErrors;
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(3, signals));
+    TEST_ASSERT_TRUE(kwp.keepAlive());
+    TEST_ASSERT_EQUAL_UINT8(90, signals.instruments.coolantTemp);
+    TEST_ASSERT_EQUAL_UINT32(counterErrors, ecu.stats().counterErrors);
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().complementErrors);
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "back online: %.1f ms resume, %.1f ms full connect",
+             resumeUs / 1000.0, connectUs / 1000.0);
+    TEST_MESSAGE(msg);
+}
+
+void test_kwp_resume_after_lost_complement()
+{
+    Sim::VirtualEcu ecu;
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    TEST_ASSERT_TRUE(connectInstruments(kwp));
+
+    // The ECU's complement of our first request byte never arrives; the
+    // ECU meanwhile waits for the rest of our block.
+    ecu.dropByteToTester(0);
+    TEST_ASSERT_FALSE(kwp.readSensorsGroup(1, signals));
+    TEST_ASSERT_TRUE(kwp.resume());
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+    TEST_ASSERT_EQUAL_UINT16(50, signals.instruments.vehicleSpeed);
+}
+
+void test_kwp_resume_gives_up_after_session_timeout()
+{
+    Sim::VirtualEcu ecu;
+    KWP::KWP1281Session kwp(ecu);
+
+    TEST_ASSERT_TRUE(connectInstruments(kwp));
+
+    // Silent for longer than the ECU keeps a session open
+    native_arduino::advanceClockUs(1500000);
+    TEST_ASSERT_FALSE(kwp.keepAlive());
+    TEST_ASSERT_FALSE(ecu.sessionActive());
+
+    const uint32_t start = millis();
+    TEST_ASSERT_FALSE(kwp.resume());
+    TEST_ASSERT_TRUE(millis() - start <= 1100);
+
+    // A full connect still works
+    kwp.disconnect();
+    TEST_ASSERT_TRUE(connectInstruments(kwp));
+    TEST_ASSERT_TRUE(kwp.keepAlive());
+}
+
+void test_kwp_reconnect_backoff()
+{
+    KWP::ReconnectBackoff backoff;
+    TEST_ASSERT_FALSE(backoff.active());
+    TEST_ASSERT_FALSE(backoff.due(0));
+
+    backoff.start(1000);
+    TEST_ASSERT_EQUAL_UINT8(1, backoff.attempt());
+    TEST_ASSERT_FALSE(backoff.due(1000 + KWP::ReconnectBackoff::FirstDelayMs - 1));
+    TEST_ASSERT_TRUE(backoff.due(1000 + KWP::ReconnectBackoff::FirstDelayMs));
+
+    uint16_t delays[KWP::ReconnectBackoff::MaxAttempts];
+    delays[0] = backoff.delayMs();
+    for (uint8_t i = 1; i < KWP::ReconnectBackoff::MaxAttempts; ++i) {
+        TEST_ASSERT_TRUE(backoff.failed(5000));
+        delays[i] = backoff.delayMs();
+        TEST_ASSERT_TRUE(delays[i] > delays[i - 1] || delays[i] == KWP::ReconnectBackoff::MaxDelayMs);
+        TEST_ASSERT_TRUE(delays[i] <= KWP::ReconnectBackoff::MaxDelayMs);
+    }
+    TEST_ASSERT_EQUAL_UINT16(2600, delays[1]);
+    TEST_ASSERT_EQUAL_UINT8(KWP::ReconnectBackoff::MaxAttempts, backoff.attempt());
+
+    // Out of attempts
+    TEST_ASSERT_FALSE(backoff.failed(6000));
+    TEST_ASSERT_FALSE(backoff.active());
+    TEST_ASSERT_FALSE(backoff.due(100000));
+
+    // Across millis() wrap
+    backoff.start(0xFFFFFF00UL);
+    TEST_ASSERT_FALSE(backoff.due(0xFFFFFFF0UL));
+    TEST_ASSERT_TRUE(backoff.due(0x00000600UL));
+}
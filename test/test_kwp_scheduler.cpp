@@ -0,0 +1,142 @@
+// Unity tests for the Mode::ReadSensors group scheduler. Registered in
+// the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+
+#include "obd/KWP/GroupScheduler.h"
+
+using namespace obd::KWP;
+
+void test_scheduler_reads_new_groups_first_in_order()
+{
+    GroupScheduler s;
+    TEST_ASSERT_TRUE(s.request(1, GroupScheduler::AsFastAsPossible));
+    TEST_ASSERT_TRUE(s.request(3, 3000));
+    TEST_ASSERT_TRUE(s.request(2, 60000));
+
+    uint8_t g = 0;
+    TEST_ASSERT_TRUE(s.next(0, g));
+    TEST_ASSERT_EQUAL_UINT8(1, g);
+    TEST_ASSERT_TRUE(s.next(90, g));
+    TEST_ASSERT_EQUAL_UINT8(3, g);
+    TEST_ASSERT_TRUE(s.next(180, g));
+    TEST_ASSERT_EQUAL_UINT8(2, g);
+    // Only the fast group is due after that.
+    TEST_ASSERT_TRUE(s.next(270, g));
+    TEST_ASSERT_EQUAL_UINT8(1, g);
+}
+
+void test_scheduler_request_tightens_period()
+{
+    GroupScheduler s;
+    s.request(2, 60000);
+    s.request(2, 10000);
+    s.request(2, 30000);
+    TEST_ASSERT_EQUAL_UINT8(1, s.size());
+    TEST_ASSERT_EQUAL_UINT16(10000, s.periodMs(2));
+}
+
+void test_scheduler_reports_nothing_due()
+{
+    GroupScheduler s;
+    s.request(2, 1000);
+
+    uint8_t g = 0;
+    TEST_ASSERT_TRUE(s.next(0, g));
+    TEST_ASSERT_FALSE(s.next(999, g));
+    TEST_ASSERT_TRUE(s.next(1000, g));
+    TEST_ASSERT_EQUAL_UINT8(2, g);
+}
+
+void test_scheduler_shares_bus_by_period()
+{
+    // One exchange every 90 ms for a minute, like a 10400 baud
+    // instrument cluster.
+    GroupScheduler s;
+    s.request(1, GroupScheduler::AsFastAsPossible);
+    s.request(3, 3000);
+    s.request(2, 60000);
+
+    uint16_t reads[4] = {0, 0, 0, 0};
+    for (uint32_t now = 0; now < 60000; now += 90) {
+        uint8_t g = 0;
+        TEST_ASSERT_TRUE(s.next(now, g));
+        ++reads[g];
+    }
+
+    TEST_ASSERT_EQUAL_UINT16(1, reads[2]);
+    TEST_ASSERT_UINT16_WITHIN(2, 20, reads[3]);
+    TEST_ASSERT_TRUE(reads[1] > 600);
+}
+
+void test_scheduler_due_slow_group_beats_fast_ones()
+{
+    // Three fast groups are always more overdue than the slow group is
+    // when it comes due; it still goes at the next exchange.
+    GroupScheduler s;
+    s.request(1, GroupScheduler::AsFastAsPossible);
+    s.request(4, GroupScheduler::AsFastAsPossible);
+    s.request(5, GroupScheduler::AsFastAsPossible);
+    s.request(3, 1000);
+
+    uint8_t g = 0;
+    uint32_t lastSlow = 0;
+    for (uint32_t now = 0; now < 20000; now += 90) {
+        TEST_ASSERT_TRUE(s.next(now, g));
+        if (g == 3) {
+            TEST_ASSERT_TRUE(now - lastSlow <= 1000 + 90);
+            lastSlow = now;
+        }
+    }
+    TEST_ASSERT_TRUE(lastSlow >= 20000 - 1000 - 90);
+}
+
+void test_scheduler_survives_millis_wrap()
+{
+    GroupScheduler s;
+    s.request(4, 1000);
+
+    uint8_t g = 0;
+    TEST_ASSERT_TRUE(s.next(0xFFFFFF00UL, g));
+    TEST_ASSERT_FALSE(s.next(0x00000100UL, g));
+    TEST_ASSERT_TRUE(s.next(0x00000300UL, g));
+}
+
+void test_scheduler_table_full()
+{
+    GroupScheduler s;
+    for (uint8_t g = 0; g < GroupScheduler::MaxGroups; ++g) {
+        TEST_ASSERT_TRUE(s.request(g, 1000));
+    }
+    TEST_ASSERT_FALSE(s.request(GroupScheduler::MaxGroups, 1000));
+    TEST_ASSERT_TRUE(s.request(0, 500));
+}
+
+void test_scheduler_soonest_group_for_keep_alive()
+{
+    GroupScheduler s;
+    uint8_t g = 0;
+    TEST_ASSERT_FALSE(s.nextSoonest(0, g));
+
+    s.request(3, 3000);
+    s.request(2, 10000);
+    TEST_ASSERT_TRUE(s.next(0, g));
+    TEST_ASSERT_TRUE(s.next(100, g));
+
+    // Nothing due at 700 ms; group 3 has the least time left.
+    TEST_ASSERT_FALSE(s.next(700, g));
+    TEST_ASSERT_TRUE(s.nextSoonest(700, g));
+    TEST_ASSERT_EQUAL_UINT8(3, g);
+    // Read early counts as read: its period restarts from 700.
+    TEST_ASSERT_FALSE(s.next(3000, g));
+    TEST_ASSERT_TRUE(s.next(3700, g));
+    TEST_ASSERT_EQUAL_UINT8(3, g);
+
+    // Anything actually due still goes first, most overdue first.
+    TEST_ASSERT_TRUE(s.nextSoonest(6700, g));
+    TEST_ASSERT_EQUAL_UINT8(3, g);
+    TEST_ASSERT_TRUE(s.next(9700, g));
+    TEST_ASSERT_EQUAL_UINT8(3, g);
+    TEST_ASSERT_TRUE(s.nextSoonest(10100, g));
+    TEST_ASSERT_EQUAL_UINT8(2, g);
+}
@@ -0,0 +1,336 @@
+// Unity tests for KWP1281Session running against the host-side virtual
+// ECU. Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <stdio.h>
+#include <EEPROM.h>
+
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+
+static Sim::VirtualEcuConfig ecuConfig(uint8_t address, uint32_t baudRate)
+{
+    Sim::VirtualEcuConfig config;
+    config.address = address;
+    config.baudRate = baudRate;
+    return config;
+}
+
+static bool connectSession(KWP::KWP1281Session &kwp, uint16_t baudRate, uint8_t address)
+{
+    uint16_t baud = baudRate;
+    uint8_t addr = address;
+    return kwp.connectToEcu(false, false, baud, addr);
+}
+
+void test_kwp_connect_to_virtual_ecu()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().complementErrors);
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().counterErrors);
+    TEST_ASSERT_TRUE(ecu.stats().blocksToTester > 1);
+}
+
+void test_kwp_connect_wrong_baud_times_out()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+
+    TEST_ASSERT_FALSE(connectSession(kwp, 9600, 0x17));
+}
+
+void test_kwp_read_instrument_groups()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    for (uint8_t g = 1; g <= 3; ++g) {
+        TEST_ASSERT_TRUE(kwp.readSensorsGroup(g, signals));
+    }
+
+    TEST_ASSERT_EQUAL_UINT16(50, signals.instruments.vehicleSpeed);
+    TEST_ASSERT_EQUAL_UINT16(2000, signals.instruments.engineRpm);
+    TEST_ASSERT_EQUAL_UINT32(123450, signals.instruments.odometer);
+    TEST_ASSERT_EQUAL_UINT8(45, signals.instruments.fuelLevel);
+    TEST_ASSERT_EQUAL_UINT8(90, signals.instruments.coolantTemp);
+    TEST_ASSERT_EQUAL_UINT8(85, signals.instruments.oilTemp);
+    TEST_ASSERT_TRUE(signals.instruments.odometerUpdated);
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().complementErrors);
+}
+
+void test_kwp_read_engine_groups()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x01, 9600));
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 9600, 0x01));
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(4, signals));
+
+    TEST_ASSERT_EQUAL_UINT16(800, signals.instruments.engineRpm);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 14.0f, signals.engine.voltage);
+    TEST_ASSERT_EQUAL_UINT8(50, signals.engine.tempUnknown3);
+}
+
+void test_kwp_read_dtc_codes()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    const uint16_t codes[5] = {0x0102, 0x0203, 0x0304, 0x0405, 0x0506};
+    const uint8_t status[5] = {0x23, 0x24, 0x25, 0x26, 0x27};
+    ecu.setDtcs(codes, status, 5);
+    KWP::KWP1281Session kwp(ecu);
+    Model::DTCStore store;
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    TEST_ASSERT_EQUAL_INT8(5, kwp.readDtcCodes(store));
+    TEST_ASSERT_EQUAL_HEX16(0x0102, store.errorAt(0));
+    TEST_ASSERT_EQUAL_HEX16(0x0506, store.errorAt(4));
+    TEST_ASSERT_EQUAL_HEX8(0x27, store.statusAt(4));
+
+    TEST_ASSERT_TRUE(kwp.deleteDtcCodes());
+    TEST_ASSERT_EQUAL_INT8(0, kwp.readDtcCodes(store));
+}
+
+void test_kwp_dtc_read_streams_blocks()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    uint16_t codes[30];
+    uint8_t status[30];
+    for (uint8_t i = 0; i < 30; ++i) {
+        codes[i] = static_cast<uint16_t>(1000 + i);
+        status[i] = static_cast<uint8_t>(0x20 + i);
+    }
+    ecu.setDtcs(codes, status, 30);
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    Model::DTCStore store;
+    store.add(0x0001, 0x01); // left over from an earlier read
+
+    // Each 0xFC block (four codes) is in the store as soon as it is in,
+    // long before the ECU's last one
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    TEST_ASSERT_TRUE(kwp.startDtcRead(store));
+    TEST_ASSERT_EQUAL_UINT8(0, store.count());
+    TEST_ASSERT_FALSE(kwp.startKeepAlive());
+    uint8_t seen = 0;
+    uint8_t steps = 0;
+    KWP::PollStatus result;
+    while ((result = kwp.poll(signals)) == KWP::PollStatus::Busy) {
+        if (store.count() != seen) {
+            TEST_ASSERT_TRUE(store.count() == seen + 4 || store.count() == 30);
+            seen = store.count();
+            ++steps;
+        }
+    }
+    TEST_ASSERT_EQUAL(KWP::PollStatus::Done, result);
+    TEST_ASSERT_EQUAL_UINT8(8, steps);
+    TEST_ASSERT_EQUAL_UINT8(30, store.count());
+    TEST_ASSERT_EQUAL_UINT8(0, store.overflow());
+    TEST_ASSERT_EQUAL_HEX16(1029, store.errorAt(29));
+    TEST_ASSERT_EQUAL_HEX8(0x20 + 29, store.statusAt(29));
+
+    // The session carries on where the read left it
+    TEST_ASSERT_FALSE(kwp.arena().held());
+    TEST_ASSERT_TRUE(kwp.keepAlive());
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().counterErrors);
+}
+
+void test_kwp_keep_alive()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    for (uint8_t i = 0; i < 10; ++i) {
+        TEST_ASSERT_TRUE(kwp.keepAlive());
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().counterErrors);
+}
+
+// Mode::Ack over 10 s of bus time: ACK ping-pong versus an ACK only
+// when keepAliveDue().
+static void idleSession(bool onlyWhenDue, uint32_t &blocks)
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    ecu.resetStats();
+    const uint32_t startMs = millis();
+    while (millis() - startMs < 10000UL) {
+        if (!onlyWhenDue || kwp.keepAliveDue()) {
+            TEST_ASSERT_TRUE(kwp.keepAlive());
+        } else {
+            delay(10); // one pass of the UI loop
+        }
+    }
+    TEST_ASSERT_TRUE(ecu.sessionActive());
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().sessionTimeouts);
+    blocks = ecu.stats().blocksFromTester + ecu.stats().blocksToTester;
+}
+
+void test_kwp_keep_alive_only_when_due()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    TEST_ASSERT_FALSE(kwp.keepAliveDue());
+    delay(KWP::KWP1281Session::KeepAliveIdleMs - 50);
+    TEST_ASSERT_FALSE(kwp.keepAliveDue());
+    delay(50);
+    TEST_ASSERT_TRUE(kwp.keepAliveDue());
+    TEST_ASSERT_TRUE(kwp.keepAlive());
+    TEST_ASSERT_FALSE(kwp.keepAliveDue());
+
+    uint32_t pingPong = 0;
+    uint32_t scheduled = 0;
+    idleSession(false, pingPong);
+    idleSession(true, scheduled);
+    TEST_ASSERT_TRUE(scheduled * 20 < pingPong);
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "idle session: %.1f blocks/s ping-pong, %.1f blocks/s scheduled",
+             pingPong / 10.0, scheduled / 10.0);
+    TEST_MESSAGE(msg);
+}
+
+void test_kwp_pacing_calibrates_below_fixed_delay()
+{
+    native_arduino::eepromErase(); // no pacing learned in earlier tests
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    TEST_ASSERT_LESS_THAN(KWP::KWPPacing::conservativeGapUs(10400), kwp.pacing().gapUs());
+    TEST_ASSERT_GREATER_OR_EQUAL(KWP::KWPPacing::FloorUs, kwp.pacing().gapUs());
+
+    for (uint8_t i = 0; i < 20; ++i) {
+        TEST_ASSERT_TRUE(kwp.readSensorsGroup(static_cast<uint8_t>(1 + i % 3), signals));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, ecu.stats().missedBytes);
+}
+
+void test_kwp_pacing_backs_off_on_slow_ecu()
+{
+    Sim::VirtualEcuConfig config = ecuConfig(0x17, 10400);
+    config.minTesterGapUs = 3000; // slower to listen than to answer
+    native_arduino::eepromErase();
+    Sim::VirtualEcu ecu(config);
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    // Each failure doubles the gap and the profile remembers it across
+    // reconnects, so a few attempts must be enough to settle.
+    bool ok = false;
+    for (uint8_t attempt = 0; attempt < 4 && !ok; ++attempt) {
+        kwp.disconnect();
+        ok = connectSession(kwp, 10400, 0x17) && kwp.readSensorsGroup(1, signals) &&
+             kwp.readSensorsGroup(2, signals);
+    }
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_GREATER_OR_EQUAL(3000, kwp.pacing().gapUs());
+    TEST_ASSERT_GREATER_THAN(0, ecu.stats().missedBytes);
+}
+
+void test_kwp_poll_never_stalls()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    TEST_ASSERT_TRUE(kwp.startGroupRead(2, signals));
+    TEST_ASSERT_FALSE(kwp.startKeepAlive()); // one exchange at a time
+
+    uint64_t worstStepUs = 0;
+    uint16_t steps = 0;
+    KWP::PollStatus status;
+    do {
+        const uint64_t before = native_arduino::clockUs();
+        status = kwp.poll(signals);
+        const uint64_t spent = native_arduino::clockUs() - before;
+        if (spent > worstStepUs) worstStepUs = spent;
+        ++steps;
+    } while (status == KWP::PollStatus::Busy);
+
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(KWP::PollStatus::Done),
+                            static_cast<uint8_t>(status));
+    TEST_ASSERT_EQUAL_UINT32(123450, signals.instruments.odometer);
+    TEST_ASSERT_GREATER_THAN(20, steps);
+    // A poll never spends more than about one byte on the wire.
+    TEST_ASSERT_LESS_THAN(2000, worstStepUs);
+    TEST_ASSERT_FALSE(kwp.busy());
+}
+
+void test_kwp_transfers_survive_millis_wrap()
+{
+    // Six seconds before the 32-bit millis() wraps: a byte wait started
+    // there must neither time out at once nor run forever.
+    const uint64_t resumeUs = native_arduino::clockUs();
+    native_arduino::setClockUs((0x100000000ULL - 6000) * 1000ULL);
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    const uint64_t wrapUs = 0x100000000ULL * 1000ULL;
+    while (native_arduino::clockUs() < wrapUs + 1000000ULL) {
+        TEST_ASSERT_TRUE(kwp.readSensorsGroup(2, signals));
+    }
+
+    // A lost byte after the wrap still ends in a timeout.
+    ecu.dropByteToTester(3);
+    const uint64_t start = native_arduino::clockUs();
+    TEST_ASSERT_FALSE(kwp.readSensorsGroup(2, signals));
+    TEST_ASSERT_LESS_THAN(2000000, native_arduino::clockUs() - start);
+    TEST_ASSERT_EQUAL_UINT16(1, kwp.stats().timeouts());
+
+    // The host's millis() is 64 bits wide; later tests keep 32-bit starts.
+    native_arduino::setClockUs(resumeUs);
+}
+
+void test_kwp_arena_single_owner()
+{
+    Sim::VirtualEcu ecu(ecuConfig(0x17, 10400));
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    Model::DTCStore dtcStore;
+    signals.reset();
+
+    TEST_ASSERT_TRUE(connectSession(kwp, 10400, 0x17));
+    TEST_ASSERT_FALSE(kwp.arena().held());
+
+    // An in-flight group read owns the block buffers; blocking exchanges
+    // are refused instead of overwriting its answer.
+    TEST_ASSERT_TRUE(kwp.startGroupRead(2, signals));
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(KWP::BlockArena::Owner::GroupRead),
+                            static_cast<uint8_t>(kwp.arena().owner()));
+    TEST_ASSERT_EQUAL_INT8(-1, kwp.readDtcCodes(dtcStore));
+    TEST_ASSERT_FALSE(kwp.deleteDtcCodes());
+
+    TEST_ASSERT_TRUE(kwp.completePending(signals));
+    TEST_ASSERT_FALSE(kwp.arena().held());
+    TEST_ASSERT_EQUAL_UINT32(123450, signals.instruments.odometer);
+
+    // Blocking exchanges hand the buffers back when they return.
+    TEST_ASSERT_TRUE(kwp.readDtcCodes(dtcStore) >= 0);
+    TEST_ASSERT_FALSE(kwp.arena().held());
+    TEST_ASSERT_TRUE(kwp.keepAlive());
+    TEST_ASSERT_FALSE(kwp.arena().held());
+}
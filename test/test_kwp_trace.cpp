@@ -0,0 +1,140 @@
+// Unity tests for the K-line trace ring (KLineTrace) and the session
+// filling it. Registered in the combined runner in
+// test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "obd/KWP/KLineTrace.h"
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+
+namespace {
+
+// Stands in for Serial in dump().
+struct TextSink {
+    std::string text;
+    size_t write(uint8_t c)
+    {
+        text.push_back(static_cast<char>(c));
+        return 1;
+    }
+};
+
+} // namespace
+
+void test_kwp_trace_records_time_and_direction()
+{
+    KWP::KLineTrace trace;
+    trace.clear(1000000);
+    trace.record(true, 0x03, 1000000 + 960);
+    trace.record(false, 0xFC, 1000000 + 2900);
+    trace.record(true, 0x03, 1000000 + 2900 + 1500000);   // long silence
+
+    // Short gaps take one header byte, the 1.5 s one three.
+    TEST_ASSERT_EQUAL_UINT16(2 + 2 + 4, trace.used());
+
+    KWP::KLineTrace::Reader reader(trace);
+    KWP::KLineTrace::Entry e;
+    TEST_ASSERT_TRUE(reader.next(e));
+    TEST_ASSERT_TRUE(e.tx);
+    TEST_ASSERT_EQUAL_UINT8(0x03, e.data);
+    TEST_ASSERT_UINT32_WITHIN(128, 960, e.us);
+    TEST_ASSERT_TRUE(reader.next(e));
+    TEST_ASSERT_FALSE(e.tx);
+    TEST_ASSERT_EQUAL_UINT8(0xFC, e.data);
+    TEST_ASSERT_UINT32_WITHIN(128, 2900, e.us);
+    TEST_ASSERT_TRUE(reader.next(e));
+    TEST_ASSERT_UINT32_WITHIN(128, 1502900, e.us);
+    TEST_ASSERT_FALSE(reader.next(e));
+}
+
+void test_kwp_trace_ring_drops_oldest_and_keeps_time()
+{
+    KWP::KLineTrace trace;
+    trace.clear(0);
+    // 400 bytes, 1.04 ms apart: more than the ring holds
+    for (uint32_t i = 0; i < 400; ++i) {
+        trace.record(i & 1, static_cast<uint8_t>(i), i * 1040);
+    }
+    TEST_ASSERT_TRUE(trace.used() <= KWP::KLineTrace::Size);
+    TEST_ASSERT_EQUAL_UINT16(400 - trace.used() / 2, trace.dropped());
+
+    // The oldest kept record is still placed at its real time.
+    KWP::KLineTrace::Reader reader(trace);
+    KWP::KLineTrace::Entry e;
+    uint32_t i = trace.dropped();
+    while (reader.next(e)) {
+        const uint32_t us = (trace.base() << KWP::KLineTrace::UnitShift) + e.us;
+        TEST_ASSERT_UINT32_WITHIN(128, i * 1040, us);
+        TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(i), e.data);
+        TEST_ASSERT_EQUAL(i & 1, e.tx);
+        ++i;
+    }
+    TEST_ASSERT_EQUAL_UINT32(400, i);
+}
+
+void test_kwp_trace_session_connect_and_dump()
+{
+    Sim::VirtualEcu ecu;
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    // A connect that fails after the keywords (the first identification
+    // byte is lost) leaves a trace short enough to see all of it.
+    kwp.trace().clear(micros());
+    ecu.dropByteToTester(3);
+    uint16_t baud = 10400;
+    uint8_t addr = 0x17;
+    TEST_ASSERT_FALSE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_EQUAL_UINT16(0, kwp.trace().dropped());
+
+    // 5-baud address, sync, keywords and our complement of 0x8A
+    KWP::KLineTrace::Reader reader(kwp.trace());
+    KWP::KLineTrace::Entry e;
+    KWP::KLineTrace::Entry address{};
+    const uint8_t expect[] = {0x17, 0x55, 0x01, 0x8A, 0x75};
+    const bool expectTx[] = {true, false, false, false, true};
+    for (uint8_t i = 0; i < sizeof(expect); ++i) {
+        TEST_ASSERT_TRUE(reader.next(e));
+        TEST_ASSERT_EQUAL_UINT8(expect[i], e.data);
+        TEST_ASSERT_EQUAL(expectTx[i], e.tx);
+        if (i == 0) address = e;
+    }
+    // The address init takes 2 s before the sync.
+    TEST_ASSERT_TRUE(e.us - address.us > 2000000);
+
+    delay(2000); // ECU session timeout
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+
+    // A group read costs about one header byte per line byte.
+    kwp.trace().clear(micros());
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+    uint16_t records = 0;
+    KWP::KLineTrace::Reader groupReader(kwp.trace());
+    while (groupReader.next(e)) ++records;
+    TEST_ASSERT_TRUE(records > 20);
+    TEST_ASSERT_TRUE(kwp.trace().used() <= records * 2 + records / 8);
+
+    TextSink sink;
+    kwp.trace().dump(sink);
+    char header[32];
+    snprintf(header, sizeof(header), "#KLT1 %08X 0000 %04X\n",
+             static_cast<unsigned>(kwp.trace().base()), kwp.trace().used());
+    TEST_ASSERT_EQUAL_STRING(header, sink.text.substr(0, strlen(header)).c_str());
+    TEST_ASSERT_EQUAL_STRING("#END\n", sink.text.substr(sink.text.size() - 5).c_str());
+    // Two hex digits per byte, 32 bytes per line
+    const size_t lines = (kwp.trace().used() + 31) / 32;
+    TEST_ASSERT_EQUAL(strlen(header) + kwp.trace().used() * 2 + lines + 5, sink.text.size());
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "trace: %u line bytes in %u ring bytes (%.1f bits/byte overhead)",
+             records, kwp.trace().used(),
+             8.0 * (kwp.trace().used() - records) / records);
+    TEST_MESSAGE(msg);
+}
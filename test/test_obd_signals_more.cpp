@@ -1,4 +1,5 @@
-// Combined Unity test runner for host-safe model components.
+// Combined Unity test runner for host-safe model components and the KWP
+// session (which runs against the virtual ECU from obd/Sim).
 
 #include <unity.h>
 
@@ -97,6 +98,139 @@ void test_dtc_store_set_out_of_range_is_ignored()
     }
 }
 
+void test_dtc_store_dedup_and_overflow()
+{
+    DTCStore store;
+
+    // Codes keep the order they came in; a repeat only takes the new status
+    TEST_ASSERT_TRUE(store.add(0x4711, 0x23));
+    TEST_ASSERT_TRUE(store.add(0x0001, 0x80));
+    TEST_ASSERT_TRUE(store.add(0x4711, 0xA3));
+    TEST_ASSERT_EQUAL_UINT8(2, store.count());
+    TEST_ASSERT_EQUAL_HEX16(0x4711, store.errorAt(0));
+    TEST_ASSERT_EQUAL_HEX8(0xA3, store.statusAt(0));
+    TEST_ASSERT_EQUAL_HEX16(0x0001, store.errorAt(1));
+    TEST_ASSERT_EQUAL_HEX16(DTCStore::NoCode, store.errorAt(2));
+
+    // Full: new codes are counted, held ones still update
+    for (uint16_t code = 0x0100; store.count() < DTCStore::MaxCount; ++code) {
+        TEST_ASSERT_TRUE(store.add(code, 0x01));
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, store.overflow());
+    TEST_ASSERT_FALSE(store.add(0xFFFE, 0x01));
+    TEST_ASSERT_FALSE(store.add(0xFFFD, 0x01));
+    TEST_ASSERT_TRUE(store.add(0x0001, 0x81));
+    TEST_ASSERT_EQUAL_UINT8(2, store.overflow());
+    TEST_ASSERT_EQUAL_UINT8(DTCStore::MaxCount, store.count());
+    TEST_ASSERT_EQUAL_HEX8(0x81, store.statusAt(1));
+    TEST_ASSERT_EQUAL_HEX16(0x0100 + DTCStore::MaxCount - 3, store.errorAt(DTCStore::MaxCount - 1));
+
+    // Three bytes a code, nothing else per slot
+    TEST_ASSERT_TRUE(sizeof(DTCStore) <= 3u * DTCStore::MaxCount + 2);
+
+    store.reset();
+    TEST_ASSERT_EQUAL_UINT8(0, store.count());
+    TEST_ASSERT_EQUAL_UINT8(0, store.overflow());
+}
+
+// ---- KWP tests (test_kwp_*.cpp, test_screen_groups.cpp, test_signal_bindings.cpp,
+//      test_rejected_groups.cpp, test_group_scan.cpp, test_ecu_identity.cpp,
+//      test_kwp_resume.cpp, test_kwp_address_init.cpp, test_kwp_autobaud.cpp,
+//      test_kwp_trace.cpp, test_kwp_bus_stats.cpp, test_kwp_replay.cpp,
+//      test_kwp_fuzz.cpp, test_kwp2000.cpp, test_kwp_multi_ecu.cpp,
+//      test_dtc_text.cpp, test_group_payload_cache.cpp) ----
+
+void test_kwp_connect_to_virtual_ecu();
+void test_kwp_connect_wrong_baud_times_out();
+void test_kwp_read_instrument_groups();
+void test_kwp_read_engine_groups();
+void test_kwp_read_dtc_codes();
+void test_kwp_dtc_read_streams_blocks();
+void test_kwp_keep_alive();
+void test_kwp_pacing_calibrates_below_fixed_delay();
+void test_kwp_pacing_backs_off_on_slow_ecu();
+void test_kwp_poll_never_stalls();
+void test_kwp_arena_single_owner();
+void test_rejected_groups_mark_and_query();
+void test_rejected_groups_per_ecu_and_persistent();
+void test_rejected_groups_reuses_oldest_slot();
+void test_rejected_groups_reformat_on_version_change();
+void test_kwp_refused_group_is_skipped();
+void test_capabilities_record_and_select();
+void test_capabilities_interrupted_scan_is_invalid();
+void test_capabilities_overflow_limits_coverage();
+void test_kwp_group_scan_builds_map();
+void test_kwp_group_map_keyed_by_identity();
+void test_ident_parse_cluster();
+void test_ident_parse_engine_and_plain_text();
+void test_identity_cache_round_trip();
+void test_kwp_reconnect_restores_pacing();
+void test_kwp_resume_after_lost_answer_byte();
+void test_kwp_resume_after_lost_complement();
+void test_kwp_resume_gives_up_after_session_timeout();
+void test_kwp_reconnect_backoff();
+void test_five_baud_bit_pattern();
+void test_kwp_address_init_bit_timing();
+void test_kwp_address_init_wakes_addressed_ecu_only();
+void test_kwp_autobaud_standard_rates();
+void test_kwp_autobaud_off_table_rate();
+void test_kwp_autobaud_no_sync_fails_fast();
+void test_scheduler_soonest_group_for_keep_alive();
+void test_kwp_keep_alive_only_when_due();
+void test_kwp_trace_records_time_and_direction();
+void test_kwp_trace_ring_drops_oldest_and_keeps_time();
+void test_kwp_trace_session_connect_and_dump();
+void test_kwp_bus_stats_bins_and_rates();
+void test_kwp_bus_stats_measure_session();
+void test_kwp_replay_reproduces_captured_session();
+void test_kwp_replay_flags_diverging_session();
+void test_kwp_replay_parses_trace_dump();
+void test_kwp_fuzz_regressions();
+void test_kwp_fuzz_mutated_sessions();
+void test_kwp2000_frame_build_and_parse();
+void test_kwp2000_connect_and_read_groups();
+void test_kwp2000_timing_pending_and_errors();
+void test_kwp_multi_ecu_feeds_one_signal_set();
+void test_kwp_multi_ecu_weights_foreground();
+void test_kwp_multi_ecu_follows_screen();
+void test_kwp_multi_ecu_missing_ecu();
+void test_dtc_text_lookup_and_decode();
+void test_dtc_text_cut_to_buffer();
+void test_group_payload_cache_changed_triplets();
+void test_kwp_group_read_decodes_changed_triplets();
+void test_group_delta_decode_answer_shrinks();
+void test_kwp_error_pattern_does_not_reject_group();
+void test_kwp_failed_group_read_clears_slots();
+void test_scheduler_due_slow_group_beats_fast_ones();
+void test_kwp_transfers_survive_millis_wrap();
+void test_kwp_benchmark_group_reads();
+void test_kwp_benchmark_scheduled_reads();
+void test_kwp_benchmark_formula_decode();
+void test_kwp_benchmark_delta_decode();
+void test_kwp_benchmark_replay();
+void test_kwp_benchmark_kwp2000();
+void test_kwp_benchmark_dtc_text();
+void test_scheduler_reads_new_groups_first_in_order();
+void test_scheduler_request_tightens_period();
+void test_scheduler_reports_nothing_due();
+void test_scheduler_shares_bus_by_period();
+void test_scheduler_survives_millis_wrap();
+void test_scheduler_table_full();
+void test_formula_table_matches_reference();
+void test_formula_known_values();
+void test_formula_text_formulas();
+void test_formula_unknown_is_raw();
+void test_format_fixed();
+void test_bindings_store_and_flag_changes();
+void test_bindings_field_types();
+void test_bindings_unbound_slots();
+void test_screen_groups_visible_screen_first();
+void test_screen_groups_prefetch_neighbours_slowly();
+void test_screen_groups_prefetch_wraps_around();
+void test_screen_groups_menus_without_ecu_values();
+void test_screen_groups_experimental_reads_its_group();
+void test_screen_groups_unknown_address_uses_legacy_loop();
+
 int main(int argc, char **argv)
 {
     (void)argc;
@@ -111,6 +245,99 @@ int main(int argc, char **argv)
     RUN_TEST(test_dtc_store_reset);
     RUN_TEST(test_dtc_store_set_and_read_back);
     RUN_TEST(test_dtc_store_set_out_of_range_is_ignored);
+    RUN_TEST(test_dtc_store_dedup_and_overflow);
+
+    // KWP1281Session
+    RUN_TEST(test_kwp_connect_to_virtual_ecu);
+    RUN_TEST(test_kwp_connect_wrong_baud_times_out);
+    RUN_TEST(test_kwp_read_instrument_groups);
+    RUN_TEST(test_kwp_read_engine_groups);
+    RUN_TEST(test_kwp_read_dtc_codes);
+    RUN_TEST(test_kwp_dtc_read_streams_blocks);
+    RUN_TEST(test_kwp_keep_alive);
+    RUN_TEST(test_kwp_pacing_calibrates_below_fixed_delay);
+    RUN_TEST(test_kwp_pacing_backs_off_on_slow_ecu);
+    RUN_TEST(test_kwp_poll_never_stalls);
+    RUN_TEST(test_kwp_arena_single_owner);
+    RUN_TEST(test_scheduler_reads_new_groups_first_in_order);
+    RUN_TEST(test_scheduler_request_tightens_period);
+    RUN_TEST(test_scheduler_reports_nothing_due);
+    RUN_TEST(test_scheduler_shares_bus_by_period);
+    RUN_TEST(test_scheduler_survives_millis_wrap);
+    RUN_TEST(test_scheduler_table_full);
+    RUN_TEST(test_formula_table_matches_reference);
+    RUN_TEST(test_formula_known_values);
+    RUN_TEST(test_formula_text_formulas);
+    RUN_TEST(test_formula_unknown_is_raw);
+    RUN_TEST(test_format_fixed);
+    RUN_TEST(test_bindings_store_and_flag_changes);
+    RUN_TEST(test_bindings_field_types);
+    RUN_TEST(test_bindings_unbound_slots);
+    RUN_TEST(test_screen_groups_visible_screen_first);
+    RUN_TEST(test_screen_groups_prefetch_neighbours_slowly);
+    RUN_TEST(test_screen_groups_prefetch_wraps_around);
+    RUN_TEST(test_screen_groups_menus_without_ecu_values);
+    RUN_TEST(test_screen_groups_experimental_reads_its_group);
+    RUN_TEST(test_screen_groups_unknown_address_uses_legacy_loop);
+    RUN_TEST(test_rejected_groups_mark_and_query);
+    RUN_TEST(test_rejected_groups_per_ecu_and_persistent);
+    RUN_TEST(test_rejected_groups_reuses_oldest_slot);
+    RUN_TEST(test_rejected_groups_reformat_on_version_change);
+    RUN_TEST(test_kwp_refused_group_is_skipped);
+    RUN_TEST(test_capabilities_record_and_select);
+    RUN_TEST(test_capabilities_interrupted_scan_is_invalid);
+    RUN_TEST(test_capabilities_overflow_limits_coverage);
+    RUN_TEST(test_kwp_group_scan_builds_map);
+    RUN_TEST(test_kwp_group_map_keyed_by_identity);
+    RUN_TEST(test_ident_parse_cluster);
+    RUN_TEST(test_ident_parse_engine_and_plain_text);
+    RUN_TEST(test_identity_cache_round_trip);
+    RUN_TEST(test_kwp_reconnect_restores_pacing);
+    RUN_TEST(test_kwp_resume_after_lost_answer_byte);
+    RUN_TEST(test_kwp_resume_after_lost_complement);
+    RUN_TEST(test_kwp_resume_gives_up_after_session_timeout);
+    RUN_TEST(test_kwp_reconnect_backoff);
+    RUN_TEST(test_five_baud_bit_pattern);
+    RUN_TEST(test_kwp_address_init_bit_timing);
+    RUN_TEST(test_kwp_address_init_wakes_addressed_ecu_only);
+    RUN_TEST(test_kwp_autobaud_standard_rates);
+    RUN_TEST(test_kwp_autobaud_off_table_rate);
+    RUN_TEST(test_kwp_autobaud_no_sync_fails_fast);
+    RUN_TEST(test_scheduler_soonest_group_for_keep_alive);
+    RUN_TEST(test_kwp_keep_alive_only_when_due);
+    RUN_TEST(test_kwp_trace_records_time_and_direction);
+    RUN_TEST(test_kwp_trace_ring_drops_oldest_and_keeps_time);
+    RUN_TEST(test_kwp_trace_session_connect_and_dump);
+    RUN_TEST(test_kwp_bus_stats_bins_and_rates);
+    RUN_TEST(test_kwp_bus_stats_measure_session);
+    RUN_TEST(test_kwp_replay_reproduces_captured_session);
+    RUN_TEST(test_kwp_replay_flags_diverging_session);
+    RUN_TEST(test_kwp_replay_parses_trace_dump);
+    RUN_TEST(test_kwp_fuzz_regressions);
+    RUN_TEST(test_kwp_fuzz_mutated_sessions);
+    RUN_TEST(test_kwp2000_frame_build_and_parse);
+    RUN_TEST(test_kwp2000_connect_and_read_groups);
+    RUN_TEST(test_kwp2000_timing_pending_and_errors);
+    RUN_TEST(test_kwp_multi_ecu_feeds_one_signal_set);
+    RUN_TEST(test_kwp_multi_ecu_weights_foreground);
+    RUN_TEST(test_kwp_multi_ecu_follows_screen);
+    RUN_TEST(test_kwp_multi_ecu_missing_ecu);
+    RUN_TEST(test_dtc_text_lookup_and_decode);
+    RUN_TEST(test_dtc_text_cut_to_buffer);
+    RUN_TEST(test_group_payload_cache_changed_triplets);
+    RUN_TEST(test_kwp_group_read_decodes_changed_triplets);
+    RUN_TEST(test_group_delta_decode_answer_shrinks);
+    RUN_TEST(test_kwp_error_pattern_does_not_reject_group);
+    RUN_TEST(test_kwp_failed_group_read_clears_slots);
+    RUN_TEST(test_scheduler_due_slow_group_beats_fast_ones);
+    RUN_TEST(test_kwp_transfers_survive_millis_wrap);
+    RUN_TEST(test_kwp_benchmark_group_reads);
+    RUN_TEST(test_kwp_benchmark_scheduled_reads);
+    RUN_TEST(test_kwp_benchmark_formula_decode);
+    RUN_TEST(test_kwp_benchmark_delta_decode);
+    RUN_TEST(test_kwp_benchmark_replay);
+    RUN_TEST(test_kwp_benchmark_kwp2000);
+    RUN_TEST(test_kwp_benchmark_dtc_text);
 
     return UNITY_END();
 }
@@ -0,0 +1,170 @@
+// Unity tests for the EEPROM-backed map of groups an ECU refused, alone
+// and through KWP1281Session. Registered in the combined runner in
+// test_obd_signals_more.cpp.
+
+#include <unity.h>
+#include <EEPROM.h>
+
+#include "obd/KWP/KWP1281Session.h"
+#include "obd/KWP/RejectedGroups.h"
+#include "obd/Sim/VirtualEcu.h"
+
+using namespace obd;
+using KWP::RejectedGroups;
+
+void test_rejected_groups_mark_and_query()
+{
+    native_arduino::eepromErase();
+    RejectedGroups groups(0);
+    groups.select(0x01);
+    TEST_ASSERT_EQUAL_UINT16(0, groups.count());
+
+    groups.markRejected(0);
+    groups.markRejected(64);
+    groups.markRejected(255);
+    TEST_ASSERT_TRUE(groups.rejected(0));
+    TEST_ASSERT_TRUE(groups.rejected(64));
+    TEST_ASSERT_TRUE(groups.rejected(255));
+    TEST_ASSERT_FALSE(groups.rejected(1));
+    TEST_ASSERT_EQUAL_UINT16(3, groups.count());
+
+    // Marking twice does not wear the cell again.
+    uint32_t writes = native_arduino::eepromWrites();
+    groups.markRejected(64);
+    TEST_ASSERT_EQUAL_UINT32(writes, native_arduino::eepromWrites());
+
+    groups.clear();
+    TEST_ASSERT_EQUAL_UINT16(0, groups.count());
+}
+
+void test_rejected_groups_per_ecu_and_persistent()
+{
+    native_arduino::eepromErase();
+    {
+        RejectedGroups groups(0);
+        groups.select(0x01);
+        groups.markRejected(20);
+        groups.select(0x17);
+        groups.markRejected(7);
+        TEST_ASSERT_FALSE(groups.rejected(20));
+    }
+
+    // A new instance (power cycle) reads the same EEPROM.
+    RejectedGroups groups(0);
+    groups.select(0x01);
+    TEST_ASSERT_TRUE(groups.rejected(20));
+    TEST_ASSERT_FALSE(groups.rejected(7));
+    groups.select(0x17);
+    TEST_ASSERT_TRUE(groups.rejected(7));
+}
+
+void test_rejected_groups_reuses_oldest_slot()
+{
+    native_arduino::eepromErase();
+    RejectedGroups groups(0);
+    for (uint8_t i = 0; i < RejectedGroups::MaxEcus; ++i) {
+        groups.select(static_cast<uint8_t>(0x10 + i));
+        groups.markRejected(i);
+    }
+
+    // A fifth ECU takes over the first slot, with an empty map.
+    groups.select(0x40);
+    TEST_ASSERT_EQUAL_UINT16(0, groups.count());
+    groups.select(0x11);
+    TEST_ASSERT_TRUE(groups.rejected(1));
+    // 0x10 lost its map; it comes back empty in the next slot in turn.
+    groups.select(0x10);
+    TEST_ASSERT_FALSE(groups.rejected(0));
+    groups.select(0x11);
+    TEST_ASSERT_EQUAL_UINT16(0, groups.count());
+}
+
+void test_rejected_groups_reformat_on_version_change()
+{
+    native_arduino::eepromErase();
+    // Left over from something else
+    for (uint16_t i = 0; i < RejectedGroups::RegionBytes; ++i) {
+        EEPROM.write(i, 0x00);
+    }
+    RejectedGroups groups(0);
+    groups.select(0x01);
+    TEST_ASSERT_EQUAL_UINT16(0, groups.count());
+}
+
+void test_kwp_refused_group_is_skipped()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcuConfig config;
+    config.address = 0x01;
+    config.baudRate = 9600;
+    Sim::VirtualEcu ecu(config);
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    uint16_t baud = 9600;
+    uint8_t addr = 0x01;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+    TEST_ASSERT_FALSE(ecu.hasGroup(20));
+
+    // First request goes to the ECU, which answers with a bare ACK. The
+    // session stays up and no longer backs off for two seconds.
+    uint32_t start = millis();
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(20, signals));
+    TEST_ASSERT_LESS_THAN(500, millis() - start);
+    TEST_ASSERT_FALSE(kwp.groupRejected(20));
+    TEST_ASSERT_TRUE(signals.experimental.unsupported);
+    TEST_ASSERT_EQUAL_UINT8(20, signals.experimental.groupCurrent);
+
+    // The same refusal again makes it stick.
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(20, signals));
+    TEST_ASSERT_TRUE(kwp.groupRejected(20));
+
+    // Later requests are answered without a bus round-trip.
+    const uint32_t blocks = ecu.stats().blocksFromTester;
+    signals.experimental.vUpdated = false;
+    signals.experimental.groupCurrent = 1;
+    TEST_ASSERT_FALSE(kwp.startGroupRead(20, signals));
+    TEST_ASSERT_FALSE(kwp.busy());
+    TEST_ASSERT_EQUAL_UINT32(blocks, ecu.stats().blocksFromTester);
+    TEST_ASSERT_TRUE(signals.experimental.vUpdated);
+    TEST_ASSERT_EQUAL_UINT8(20, signals.experimental.groupCurrent);
+
+    // Supported groups are unaffected and clear the "n/a" state.
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+    TEST_ASSERT_FALSE(signals.experimental.unsupported);
+    TEST_ASSERT_EQUAL_UINT16(800, signals.instruments.engineRpm);
+    TEST_ASSERT_FALSE(kwp.groupRejected(1));
+}
+
+void test_kwp_error_pattern_does_not_reject_group()
+{
+    native_arduino::eepromErase();
+    Sim::VirtualEcuConfig config;
+    config.address = 0x01;
+    config.baudRate = 9600;
+    Sim::VirtualEcu ecu(config);
+    KWP::KWP1281Session kwp(ecu);
+    Model::OBDSignals signals;
+    signals.reset();
+
+    uint16_t baud = 9600;
+    uint8_t addr = 0x01;
+    TEST_ASSERT_TRUE(kwp.connectToEcu(false, false, baud, addr));
+
+    // The ECU answers group 1 with its error pattern: a failed read that
+    // says nothing about the group, twice over.
+    for (uint8_t i = 0; i < 2; ++i) {
+        ecu.sendErrorPattern();
+        const uint16_t retries = kwp.stats().retries();
+        TEST_ASSERT_FALSE(kwp.readSensorsGroup(1, signals));
+        TEST_ASSERT_EQUAL_UINT16(retries + 1, kwp.stats().retries());
+        TEST_ASSERT_FALSE(kwp.groupRejected(1));
+        TEST_ASSERT_FALSE(signals.experimental.unsupported);
+    }
+
+    // After the recovery the next read is answered normally.
+    TEST_ASSERT_TRUE(kwp.readSensorsGroup(1, signals));
+    TEST_ASSERT_EQUAL_UINT16(800, signals.instruments.engineRpm);
+    TEST_ASSERT_FALSE(kwp.groupRejected(1));
+}
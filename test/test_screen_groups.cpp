@@ -0,0 +1,80 @@
+// Unity tests for the (menu, screen) -> measurement group plan.
+// Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+
+#include "obd/KWP/ScreenGroups.h"
+
+using namespace obd;
+using namespace obd::KWP;
+
+static const uint8_t CockpitScreens = 5;
+
+void test_screen_groups_visible_screen_first()
+{
+    GroupScheduler s;
+    TEST_ASSERT_TRUE(planScreenGroups(0x17, Display::MenuId::Cockpit, 0, CockpitScreens, s));
+
+    TEST_ASSERT_EQUAL_UINT8(3, s.size());
+    TEST_ASSERT_EQUAL_UINT16(RateFast, s.periodMs(1));
+    TEST_ASSERT_EQUAL_UINT16(RateTempMs, s.periodMs(3));
+    // Fuel level alone would be RateTripMs, but screen 1 next door shows
+    // the odometer from the same group.
+    TEST_ASSERT_EQUAL_UINT16(RatePrefetchMs, s.periodMs(2));
+
+    uint8_t g = 0;
+    TEST_ASSERT_TRUE(s.next(0, g));
+    TEST_ASSERT_EQUAL_UINT8(1, g);
+}
+
+void test_screen_groups_prefetch_neighbours_slowly()
+{
+    // Engine screen 2 shows lambda 2 (group 6); screen 3 next to it needs
+    // group 3. Groups 1 and 4 are nowhere near and stay off the bus.
+    GroupScheduler s;
+    TEST_ASSERT_TRUE(planScreenGroups(0x01, Display::MenuId::Cockpit, 2, CockpitScreens, s));
+
+    TEST_ASSERT_EQUAL_UINT16(RateFast, s.periodMs(6));
+    TEST_ASSERT_TRUE(s.contains(3));
+    TEST_ASSERT_EQUAL_UINT16(RatePrefetchMs, s.periodMs(3));
+    TEST_ASSERT_FALSE(s.contains(1));
+    TEST_ASSERT_FALSE(s.contains(4));
+}
+
+void test_screen_groups_prefetch_wraps_around()
+{
+    // Engine screen 0 sits next to screen 4 (temperatures, group 4).
+    GroupScheduler s;
+    planScreenGroups(0x01, Display::MenuId::Cockpit, 4, CockpitScreens, s);
+    TEST_ASSERT_EQUAL_UINT16(RateTempMs, s.periodMs(4));
+    TEST_ASSERT_EQUAL_UINT16(RatePrefetchMs, s.periodMs(3));
+    TEST_ASSERT_FALSE(s.contains(6));
+}
+
+void test_screen_groups_menus_without_ecu_values()
+{
+    GroupScheduler s;
+    planScreenGroups(0x17, Display::MenuId::Dtc, 0, 10, s);
+    TEST_ASSERT_EQUAL_UINT8(0, s.size());
+
+    uint8_t g = 0;
+    TEST_ASSERT_FALSE(s.next(0, g));
+}
+
+void test_screen_groups_experimental_reads_its_group()
+{
+    GroupScheduler s;
+    planScreenGroups(0x17, Display::MenuId::Experimental, 7, 65, s);
+    TEST_ASSERT_EQUAL_UINT8(1, s.size());
+    TEST_ASSERT_TRUE(s.contains(7));
+}
+
+void test_screen_groups_unknown_address_uses_legacy_loop()
+{
+    GroupScheduler s;
+    TEST_ASSERT_FALSE(planScreenGroups(0x56, Display::MenuId::Cockpit, 0, CockpitScreens, s));
+    TEST_ASSERT_EQUAL_UINT8(3, s.size());
+    for (uint8_t g = 1; g <= 3; ++g) {
+        TEST_ASSERT_EQUAL_UINT16(RateFast, s.periodMs(g));
+    }
+}
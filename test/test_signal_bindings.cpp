@@ -0,0 +1,60 @@
+// Unity tests for the (ECU, group, index) -> OBDSignals binding table.
+// Registered in the combined runner in test_obd_signals_more.cpp.
+
+#include <unity.h>
+
+#include "obd/KWP/SignalBindings.h"
+
+using namespace obd;
+using namespace obd::KWP;
+
+void test_bindings_store_and_flag_changes()
+{
+    Model::OBDSignals signals;
+    signals.reset();
+
+    // 0x17 group 1 index 1 is engine speed, formula 1 (0.2*a*b rpm).
+    TEST_ASSERT_TRUE(applySignalBinding(0x17, 1, 1, decodeMeasurement(1, 40, 250), signals));
+    TEST_ASSERT_EQUAL_UINT16(2000, signals.instruments.engineRpm);
+    TEST_ASSERT_TRUE(signals.instruments.engineRpmUpdated);
+    TEST_ASSERT_FALSE(signals.instruments.vehicleSpeedUpdated);
+
+    // Same value again: stored value unchanged, flag left alone.
+    signals.instruments.engineRpmUpdated = false;
+    applySignalBinding(0x17, 1, 1, decodeMeasurement(1, 40, 250), signals);
+    TEST_ASSERT_FALSE(signals.instruments.engineRpmUpdated);
+}
+
+void test_bindings_field_types()
+{
+    Model::OBDSignals signals;
+    signals.reset();
+
+    // u32 odometer, formula 36
+    applySignalBinding(0x17, 2, 0, decodeMeasurement(36, 48, 57), signals);
+    TEST_ASSERT_EQUAL_UINT32(123450, signals.instruments.odometer);
+    TEST_ASSERT_TRUE(signals.instruments.odometerUpdated);
+
+    // float voltage, formula 6
+    applySignalBinding(0x01, 4, 1, decodeMeasurement(6, 140, 100), signals);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 14.0f, signals.engine.voltage);
+    TEST_ASSERT_TRUE(signals.engine.voltageUpdated);
+
+    // signed lambda, formula 47 (a*(b-128))
+    applySignalBinding(0x01, 1, 2, decodeMeasurement(47, 1, 118), signals);
+    TEST_ASSERT_EQUAL_INT8(-10, signals.engine.lambda);
+    TEST_ASSERT_TRUE(signals.engine.lambdaUpdated);
+}
+
+void test_bindings_unbound_slots()
+{
+    Model::OBDSignals signals;
+    signals.reset();
+    TEST_ASSERT_FALSE(applySignalBinding(0x17, 3, 3, decodeMeasurement(1, 1, 1), signals));
+    TEST_ASSERT_FALSE(applySignalBinding(0x01, 2, 0, decodeMeasurement(1, 1, 1), signals));
+    TEST_ASSERT_FALSE(applySignalBinding(0x56, 1, 0, decodeMeasurement(1, 1, 1), signals));
+    TEST_ASSERT_FALSE(signals.instruments.vehicleSpeedUpdated);
+    TEST_ASSERT_FALSE(signals.instruments.engineRpmUpdated);
+    TEST_ASSERT_FALSE(signals.engine.tempUnknown1Updated);
+    TEST_ASSERT_EQUAL_UINT16(0, signals.instruments.engineRpm);
+}
@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+"""Packs tools/dtc_text.txt into the firmware's DTC description table.
+
+    tools/dtc_text.py [tools/dtc_text.txt] [--out src/obd/Model]
+
+writes DtcTextTable.h and DtcTextTable.cpp (obd::Model::DtcTextTable) and
+prints how many bytes of flash they take next to the plain strings.
+
+The descriptions are token-compressed: a dictionary of up to 127 common
+words and phrases ("Sensor ", "Circuit ", "Bank 1", ...) is picked
+greedily by the bytes each one saves, and every description becomes a
+byte string in which 0x00-0x7F is a literal ASCII character and
+0x80 | n stands for token n. Tokens hold only literals, so a description
+decodes in one pass. The codes are stored sorted, next to the offset of
+each description, for a binary search (obd/Model/DtcText.cpp).
+"""
+
+import argparse
+import os
+import sys
+
+MAX_TEXT = 48
+MAX_TOKENS = 127
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def load(path):
+    entries = {}
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.rstrip("\n")
+            if not line.strip() or line.startswith("#"):
+                continue
+            code, _, text = line.partition(" ")
+            where = "%s:%d" % (path, number)
+            if len(code) != 5 or not code.isdigit() or int(code) > 0xFFFF:
+                sys.exit("%s: bad code %r" % (where, code))
+            if not text or len(text) > MAX_TEXT:
+                sys.exit("%s: text must be 1-%d characters" % (where, MAX_TEXT))
+            if any(ord(c) < 0x20 or ord(c) > 0x7E for c in text):
+                sys.exit("%s: text must be printable ASCII" % where)
+            if int(code) in entries:
+                sys.exit("%s: code %s twice" % (where, code))
+            entries[int(code)] = text
+    return sorted(entries.items())
+
+
+def tokenize(text, tokens):
+    """Splits text into literal strings and token indices, longest token first."""
+    out = []
+    literal = ""
+    i = 0
+    while i < len(text):
+        best = -1
+        for n, token in enumerate(tokens):
+            if text.startswith(token, i) and (best < 0 or len(token) > len(tokens[best])):
+                best = n
+        if best < 0:
+            literal += text[i]
+            i += 1
+            continue
+        if literal:
+            out.append(literal)
+            literal = ""
+        out.append(best)
+        i += len(tokens[best])
+    if literal:
+        out.append(literal)
+    return out
+
+
+def candidates(run):
+    """Word-aligned substrings of a literal run, with or without the space after."""
+    starts = [i for i in range(len(run)) if i == 0 or run[i - 1] == " "]
+    ends = [j for j in range(1, len(run) + 1) if j == len(run) or run[j] == " "]
+    for i in starts:
+        for j in ends:
+            if j <= i:
+                continue
+            yield run[i:j]
+            if j < len(run):
+                yield run[i:j + 1]
+
+
+def pick_tokens(texts):
+    tokens = []
+    while len(tokens) < MAX_TOKENS:
+        runs = [part for text in texts for part in tokenize(text, tokens) if isinstance(part, str)]
+        seen = set(c for run in runs for c in candidates(run) if len(c) >= 2)
+        best, best_saving = None, 0
+        for c in sorted(seen):
+            uses = sum(run.count(c) for run in runs)
+            # Each use shrinks to one byte; the token itself costs its
+            # bytes and a 2-byte start in the token index.
+            saving = uses * (len(c) - 1) - (len(c) + 2)
+            if saving > best_saving:
+                best, best_saving = c, saving
+        if best is None:
+            break
+        tokens.append(best)
+    return tokens
+
+
+def encode(text, tokens):
+    data = bytearray()
+    for part in tokenize(text, tokens):
+        if isinstance(part, str):
+            data += part.encode("ascii")
+        else:
+            data.append(0x80 | part)
+    return bytes(data)
+
+
+def c_bytes(data, indent="    ", per_line=12):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ", ".join("0x%02X" % b for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def c_words(words, indent="    ", per_line=8):
+    lines = []
+    for i in range(0, len(words), per_line):
+        lines.append(indent + ", ".join("%u" % w for w in words[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+HEADER = """\
+#pragma once
+
+// Generated by tools/dtc_text.py from tools/dtc_text.txt; do not edit.
+// The packed DTC descriptions behind obd/Model/DtcText.h.
+
+#include <Arduino.h>
+
+namespace obd {{
+namespace Model {{
+namespace DtcTextTable {{
+
+constexpr uint16_t CodeCount = {codes};
+constexpr uint8_t TokenCount = {tokens};
+// The descriptions as plain NUL-terminated strings would take this much.
+constexpr uint16_t RawTextBytes = {raw};
+constexpr uint8_t LongestText = {longest};
+
+// Token n is TokenBytes[TokenStarts[n] .. TokenStarts[n + 1]).
+extern const uint8_t TokenBytes[];
+extern const uint16_t TokenStarts[TokenCount + 1];
+// Codes in ascending order; the description of Codes[i] is
+// Text[TextStarts[i] .. TextStarts[i + 1]), 0x80 | n standing for token n.
+extern const uint16_t Codes[CodeCount];
+extern const uint16_t TextStarts[CodeCount + 1];
+extern const uint8_t Text[];
+
+}} // namespace DtcTextTable
+}} // namespace Model
+}} // namespace obd
+"""
+
+SOURCE = """\
+// Generated by tools/dtc_text.py from tools/dtc_text.txt; do not edit.
+
+#include "DtcTextTable.h"
+
+namespace obd {{
+namespace Model {{
+namespace DtcTextTable {{
+
+// {tokenList}
+const uint8_t TokenBytes[] PROGMEM = {{
+{tokenBytes}
+}};
+
+const uint16_t TokenStarts[TokenCount + 1] PROGMEM = {{
+{tokenStarts}
+}};
+
+const uint16_t Codes[CodeCount] PROGMEM = {{
+{codes}
+}};
+
+const uint16_t TextStarts[CodeCount + 1] PROGMEM = {{
+{textStarts}
+}};
+
+const uint8_t Text[] PROGMEM = {{
+{text}
+}};
+
+}} // namespace DtcTextTable
+}} // namespace Model
+}} // namespace obd
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", nargs="?", default=os.path.join(HERE, "dtc_text.txt"))
+    parser.add_argument("--out", default=os.path.join(HERE, "..", "src", "obd", "Model"))
+    args = parser.parse_args()
+
+    entries = load(args.source)
+    texts = [text for _, text in entries]
+    tokens = pick_tokens(texts)
+
+    token_bytes = bytearray()
+    token_starts = []
+    for token in tokens:
+        token_starts.append(len(token_bytes))
+        token_bytes += token.encode("ascii")
+    token_starts.append(len(token_bytes))
+
+    text = bytearray()
+    text_starts = []
+    for _, description in entries:
+        text_starts.append(len(text))
+        text += encode(description, tokens)
+    text_starts.append(len(text))
+
+    # Round trip before anything is written
+    for n, (_, description) in enumerate(entries):
+        decoded = ""
+        for b in text[text_starts[n]:text_starts[n + 1]]:
+            decoded += tokens[b & 0x7F] if b & 0x80 else chr(b)
+        assert decoded == description, (decoded, description)
+
+    raw = sum(len(t) + 1 for t in texts)
+    with open(os.path.join(args.out, "DtcTextTable.h"), "w") as f:
+        f.write(HEADER.format(codes=len(entries), tokens=len(tokens), raw=raw,
+                              longest=max(len(t) for t in texts)))
+    with open(os.path.join(args.out, "DtcTextTable.cpp"), "w") as f:
+        f.write(SOURCE.format(
+            tokenList=" ".join("%d:%r" % (n, t) for n, t in enumerate(tokens[:6])) + " ...",
+            tokenBytes=c_bytes(token_bytes),
+            tokenStarts=c_words(token_starts),
+            codes=c_words([code for code, _ in entries]),
+            textStarts=c_words(text_starts),
+            text=c_bytes(text)))
+
+    index = 2 * len(entries) + 2 * (len(entries) + 1)
+    packed = len(text) + len(token_bytes) + 2 * len(token_starts)
+    print("%d codes, %d tokens" % (len(entries), len(tokens)))
+    print("text:  %5d bytes plain, %5d packed (%d text + %d tokens + %d token index), %.0f%%"
+          % (raw, packed, len(text), len(token_bytes), 2 * len(token_starts), 100.0 * packed / raw))
+    print("index: %5d bytes (codes and text starts)" % index)
+    print("flash: %5d bytes" % (packed + index))
+
+
+if __name__ == "__main__":
+    main()
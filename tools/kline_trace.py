@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+"""Decodes K-line trace dumps (obd::KWP::KLineTrace::dump()) into KW1281 blocks.
+
+The firmware writes a dump to the hardware Serial port whenever a session
+is lost or a connect fails. Capture the port (e.g. `pio device monitor |
+tee log.txt`) and run:
+
+    tools/kline_trace.py log.txt [--gap-ms 50] [--bytes]
+
+Every #KLT1 ... #END section in the input is decoded on its own. The
+output lists the 5-baud address, the sync and keyword bytes and every
+block with its sender, counter, title and data, checks the complement of
+each byte, and flags silences longer than --gap-ms.
+"""
+
+import argparse
+import sys
+
+UNIT_US = 128
+
+TITLES = {
+    0x05: "DTC delete",
+    0x06: "end output",
+    0x07: "DTC read",
+    0x09: "ACK",
+    0x0A: "NAK",
+    0x29: "group read",
+    0xE7: "group answer",
+    0xF6: "ASCII",
+    0xFC: "DTC answer",
+}
+
+
+def parse_dumps(lines):
+    """Yields (base_units, dropped, raw_bytes) for each dump in the input."""
+    dump = None
+    for line in lines:
+        line = line.strip()
+        if line.startswith("#KLT1"):
+            fields = line.split()
+            dump = (int(fields[1], 16), int(fields[2], 16), int(fields[3], 16), bytearray())
+        elif line.startswith("#END") and dump is not None:
+            base, dropped, size, raw = dump
+            if len(raw) != size:
+                print("warning: dump has %d bytes, header says %d" % (len(raw), size),
+                      file=sys.stderr)
+            yield base, dropped, bytes(raw)
+            dump = None
+        elif dump is not None and line:
+            dump[3].extend(bytes.fromhex(line))
+
+
+def records(raw):
+    """Yields (us, tx, byte) with us counted from the dump's base."""
+    pos = 0
+    units = 0
+    while pos < len(raw):
+        value = 0
+        shift = 0
+        while True:
+            if pos >= len(raw):
+                return
+            b = raw[pos]
+            pos += 1
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        if pos >= len(raw):
+            return
+        units += value >> 1
+        yield units * UNIT_US, bool(value & 1), raw[pos]
+        pos += 1
+
+
+def block_at(recs, i):
+    """True if a whole, cleanly acknowledged block starts at recs[i]."""
+    _, tx, length = recs[i]
+    if not 3 <= length <= 63:
+        return False
+    pos = i
+    for n in range(length + 1):
+        if pos >= len(recs) or recs[pos][1] != tx:
+            return False
+        sent = recs[pos][2]
+        if n == length:
+            return sent == 0x03
+        pos += 1
+        if pos >= len(recs) or recs[pos][1] == tx or recs[pos][2] != sent ^ 0xFF:
+            return False
+        pos += 1
+    return False
+
+
+def first_block(recs):
+    """Index of the first record that starts a whole block. A full ring
+    drops its oldest records, so a dump usually begins mid block."""
+    for i in range(len(recs)):
+        if block_at(recs, i):
+            return i
+    return len(recs)
+
+
+def side(tx):
+    return "tester" if tx else "ECU   "
+
+
+class Decoder:
+    """Follows the KW1281 byte exchange: the sender of a block sends one
+    byte at a time and the receiver answers every byte but the last (0x03)
+    with its complement."""
+
+    def __init__(self, gap_us, show_bytes):
+        self.gap_us = gap_us
+        self.show_bytes = show_bytes
+        self.block = None          # (start_us, tx, bytes) of the block in progress
+        self.expect_complement = None
+        self.keywords = None       # sync/keyword bytes after the 0x55
+        self.last_us = None
+
+    def note(self, us, text):
+        print("%10.1f ms  %s" % (us / 1000.0, text))
+
+    def feed(self, us, tx, data):
+        if self.last_us is not None and us - self.last_us > self.gap_us:
+            self.note(self.last_us, "-- %.1f ms silence --" % ((us - self.last_us) / 1000.0))
+        self.last_us = us
+        if self.show_bytes:
+            self.note(us, "  %s %02X" % ("TX" if tx else "RX", data))
+
+        if self.expect_complement is not None:
+            sent, from_tx = self.expect_complement
+            if tx != from_tx:
+                self.expect_complement = None
+                if data != sent ^ 0xFF:
+                    self.note(us, "!! %s complement %02X for %02X, expected %02X"
+                              % (side(tx).strip(), data, sent, sent ^ 0xFF))
+                    self.abort(us)
+                return
+            self.note(us, "!! %s sent %02X before the complement of %02X"
+                      % (side(tx).strip(), data, sent))
+            self.expect_complement = None
+            self.abort(us)
+
+        if self.keywords is not None:
+            self.feed_keywords(us, tx, data)
+            return
+
+        if self.block is None:
+            if tx and data > 0x0F:
+                # Only the 5-baud address starts with a tester byte that
+                # is no block length.
+                self.note(us, "5-baud address %02X" % data)
+                return
+            if not tx and data == 0x55:
+                self.note(us, "sync 55")
+                self.keywords = []
+                return
+            self.block = (us, tx, [data])
+            self.expect_complement = (data, tx)
+            return
+
+        start, from_tx, body = self.block
+        if tx != from_tx:
+            self.note(us, "!! %s byte %02X inside a %s block"
+                      % (side(tx).strip(), data, side(from_tx).strip()))
+            self.abort(us)
+            self.feed(us, tx, data)
+            return
+        body.append(data)
+        if len(body) == body[0] + 1:
+            if data != 0x03:
+                self.note(us, "!! block end %02X, expected 03" % data)
+            self.print_block(start, us, from_tx, body)
+            self.block = None
+        else:
+            self.expect_complement = (data, tx)
+
+    def feed_keywords(self, us, tx, data):
+        if not tx:
+            self.keywords.append(data)
+            return
+        kw = self.keywords
+        self.keywords = None
+        text = " ".join("%02X" % b for b in kw)
+        if kw and data == kw[-1] ^ 0xFF:
+            self.note(us, "keywords %s, tester answers %02X" % (text, data))
+        else:
+            self.note(us, "!! keywords %s, tester answers %02X" % (text, data))
+
+    def print_block(self, start, end, tx, body):
+        title = body[2] if len(body) > 3 else None
+        name = TITLES.get(title, "?") if title is not None else "?"
+        data = " ".join("%02X" % b for b in body[3:-1])
+        self.note(start, "%s #%02X %02X %-12s %s  (%.1f ms)"
+                  % (side(tx), body[1], title if title is not None else 0, name, data,
+                     (end - start) / 1000.0))
+
+    def abort(self, us):
+        if self.block is not None:
+            start, tx, body = self.block
+            self.note(start, "!! %s block cut short: %s"
+                      % (side(tx).strip(), " ".join("%02X" % b for b in body)))
+        self.block = None
+        self.keywords = None
+
+    def finish(self):
+        if self.block is not None or self.keywords is not None:
+            self.abort(self.last_us or 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", help="serial capture (default: stdin)")
+    parser.add_argument("--gap-ms", type=float, default=50.0,
+                        help="report silences longer than this")
+    parser.add_argument("--bytes", action="store_true", help="also list every byte")
+    args = parser.parse_args()
+
+    source = open(args.log) if args.log else sys.stdin
+    count = 0
+    for base, dropped, raw in parse_dumps(source):
+        count += 1
+        print("== dump %d: base %.3f s, %d bytes, %d older records dropped =="
+              % (count, base * UNIT_US / 1e6, len(raw), dropped))
+        recs = list(records(raw))
+        start = first_block(recs) if dropped else 0
+        if start:
+            print("(skipped %d bytes up to the first whole block)" % start)
+        decoder = Decoder(args.gap_ms * 1000.0, args.bytes)
+        for us, tx, data in recs[start:]:
+            decoder.feed(us, tx, data)
+        decoder.finish()
+    if count == 0:
+        print("no #KLT1 dump found", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())